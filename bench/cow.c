@@ -0,0 +1,112 @@
+// Compares passing an f64 array by value as a copy-on-write array of arr.h with
+// passing it as an eager copy made by `arr_clone`. The array is passed 1000
+// times, every callee reads one element and every 100th callee also writes
+// one, which makes the copy-on-write array copy itself. The total time of all
+// passes is printed, the best of several runs.
+//
+//     cc -O2 bench/cow.c -o cow
+//     ./cow [number of elements, default 1000000]
+
+#define FCLIB_IMPLEMENTATION
+#include "../fclib/arr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define RUNS 5
+#define PASSES 1000
+#define WRITE_EVERY 100
+
+static double now(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static double *values(fclib_arr_t *arr) {
+    return (double *)(void *)fclib_arr_get_data(arr);
+}
+
+// A callee receiving its own copy-on-write reference, returns the element it
+// read
+static double cow_callee(fclib_arr_t *arr, const size_t pass) {
+    const size_t index = pass % fclib_arr_get_len(arr);
+    const double read = values(arr)[index];
+    if (pass % WRITE_EVERY == 0) {
+        const double value = read + 1;
+        if (!fclib_arr_cow_assign_at(&arr, sizeof(double), &index, &value)) {
+            fprintf(stderr, "the copy could not be allocated\n");
+            exit(1);
+        }
+    }
+    fclib_arr_cow_release(arr);
+    return read;
+}
+
+// A callee receiving its own eager copy, returns the element it read
+static double eager_callee(fclib_arr_t *arr, const size_t pass) {
+    const size_t index = pass % fclib_arr_get_len(arr);
+    const double read = values(arr)[index];
+    if (pass % WRITE_EVERY == 0) {
+        const double value = read + 1;
+        fclib_arr_assign_at(arr, sizeof(double), &index, &value);
+    }
+    fclib_arr_free_clone(arr, 0);
+    return read;
+}
+
+int main(int argc, char **argv) {
+    const size_t len = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    fclib_arr_t *eager = fclib_arr_create(1, sizeof(double), &len);
+    fclib_arr_t *cow = fclib_arr_cow_create(1, sizeof(double), &len);
+    if (eager == NULL || cow == NULL) {
+        fprintf(stderr, "not enough memory for %zu elements\n", len);
+        return 1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        values(eager)[i] = (double)i;
+        values(cow)[i] = (double)i;
+    }
+    printf("%zu f64 elements passed %d times, a write on every %dth pass\n\n",
+        len, PASSES, WRITE_EVERY);
+
+    double cow_best = 1e30;
+    double eager_best = 1e30;
+    double cow_sum = 0;
+    double eager_sum = 0;
+    for (int run = 0; run < RUNS; run++) {
+        cow_sum = 0;
+        double start = now();
+        for (size_t pass = 0; pass < PASSES; pass++) {
+            cow_sum += cow_callee(fclib_arr_cow_share(cow), pass);
+        }
+        double elapsed = now() - start;
+        cow_best = elapsed < cow_best ? elapsed : cow_best;
+
+        eager_sum = 0;
+        start = now();
+        for (size_t pass = 0; pass < PASSES; pass++) {
+            fclib_arr_t *copy = fclib_arr_clone(eager, 0, sizeof(double));
+            if (copy == NULL) {
+                fprintf(stderr, "the copy could not be allocated\n");
+                return 1;
+            }
+            eager_sum += eager_callee(copy, pass);
+        }
+        elapsed = now() - start;
+        eager_best = elapsed < eager_best ? elapsed : eager_best;
+    }
+    // The callers' arrays must be unchanged by the writes of the callees
+    if (cow_sum != eager_sum || fclib_arr_cow_refs(cow) != 1 ||
+        values(cow)[0] != 0 || values(eager)[0] != 0) {
+        fprintf(stderr, "the copies differ\n");
+        return 1;
+    }
+    printf("copy-on-write %8.1f ms\n", cow_best * 1e3);
+    printf("eager copies  %8.1f ms\n", eager_best * 1e3);
+
+    fclib_arr_cow_release(cow);
+    free(eager);
+    return 0;
+}
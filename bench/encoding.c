@@ -0,0 +1,213 @@
+// Compares the Base64 and hex codecs of encoding.h with naive table-driven
+// loops which handle one group of bytes per iteration. Random bytes are
+// encoded and the text is decoded again, the throughput is printed in GB/s of
+// binary data, the best of several runs. The codecs use AVX2 when the CPU
+// supports it, `FCLIB_NO_SIMD` measures their scalar loops instead.
+//
+//     cc -O2 -march=native bench/encoding.c -o encoding
+//     ./encoding [MiB of binary data, default 64]
+
+#define FCLIB_IMPLEMENTATION
+#include "../fclib/encoding.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RUNS 5
+
+static const char naive_base64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char naive_hex_alphabet[] = "0123456789abcdef";
+
+static double now(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static size_t naive_base64_encode(char *dest, const uint8_t *src, size_t len) {
+    char *out = dest;
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3) {
+        const uint32_t group = (uint32_t)src[i] << 16 |
+            (uint32_t)src[i + 1] << 8 | src[i + 2];
+        *out++ = naive_base64_alphabet[group >> 18];
+        *out++ = naive_base64_alphabet[(group >> 12) & 63];
+        *out++ = naive_base64_alphabet[(group >> 6) & 63];
+        *out++ = naive_base64_alphabet[group & 63];
+    }
+    if (i < len) {
+        const uint32_t group = (uint32_t)src[i] << 16 |
+            (i + 1 < len ? (uint32_t)src[i + 1] << 8 : 0);
+        *out++ = naive_base64_alphabet[group >> 18];
+        *out++ = naive_base64_alphabet[(group >> 12) & 63];
+        *out++ = i + 1 < len ? naive_base64_alphabet[(group >> 6) & 63] : '=';
+        *out++ = '=';
+    }
+    return (size_t)(out - dest);
+}
+
+// Decodes padded standard Base64, returns 0 on invalid input
+static size_t naive_base64_decode( //
+    uint8_t *dest,                 //
+    const uint8_t *src,            //
+    size_t len,                    //
+    const int8_t *table            //
+) {
+    while (len > 0 && src[len - 1] == '=') {
+        len--;
+    }
+    uint8_t *out = dest;
+    uint32_t group = 0;
+    size_t bits = 0;
+    for (size_t i = 0; i < len; i++) {
+        const int8_t value = table[src[i]];
+        if (value < 0) {
+            return 0;
+        }
+        group = group << 6 | (uint32_t)value;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            *out++ = (uint8_t)(group >> bits);
+        }
+    }
+    return (size_t)(out - dest);
+}
+
+static void naive_hex_encode(char *dest, const uint8_t *src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dest[2 * i] = naive_hex_alphabet[src[i] >> 4];
+        dest[2 * i + 1] = naive_hex_alphabet[src[i] & 15];
+    }
+}
+
+// Returns false on invalid input
+static bool naive_hex_decode( //
+    uint8_t *dest,            //
+    const uint8_t *src,       //
+    size_t len,               //
+    const int8_t *table       //
+) {
+    for (size_t i = 0; i < len / 2; i++) {
+        const int8_t high = table[src[2 * i]];
+        const int8_t low = table[src[2 * i + 1]];
+        if ((high | low) < 0) {
+            return false;
+        }
+        dest[i] = (uint8_t)(high << 4 | low);
+    }
+    return true;
+}
+
+static void report(const char *name, const double seconds, const size_t len) {
+    printf("%-16s %6.2f GB/s\n", name, (double)len / seconds * 1e-9);
+}
+
+static void check(const bool condition, const char *what) {
+    if (!condition) {
+        fprintf(stderr, "%s differs from the naive loop\n", what);
+        exit(1);
+    }
+}
+
+// Keeps the fastest of `RUNS` runs of the statement in `best`
+#define MEASURE(best, statement)                                               \
+    do {                                                                       \
+        best = 1e30;                                                           \
+        for (int run = 0; run < RUNS; run++) {                                 \
+            const double start = now();                                        \
+            statement;                                                         \
+            const double elapsed = now() - start;                              \
+            best = elapsed < best ? elapsed : best;                            \
+        }                                                                      \
+    } while (0)
+
+int main(int argc, char **argv) {
+    const size_t len = (argc > 1 ? (size_t)atol(argv[1]) : 64) << 20;
+    uint8_t *data = (uint8_t *)malloc(len);
+    uint8_t *decoded = (uint8_t *)malloc(len);
+    const size_t text_cap = 2 * len + 4;
+    char *text = (char *)malloc(text_cap);
+    char *naive_text = (char *)malloc(text_cap);
+    if (data == NULL || decoded == NULL || text == NULL ||
+        naive_text == NULL) {
+        fprintf(stderr, "not enough memory for %zu bytes\n", len);
+        return 1;
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < len; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        data[i] = (uint8_t)state;
+    }
+    int8_t base64_table[256];
+    int8_t hex_table[256];
+    memset(base64_table, -1, sizeof(base64_table));
+    memset(hex_table, -1, sizeof(hex_table));
+    for (int i = 0; i < 64; i++) {
+        base64_table[(uint8_t)naive_base64_alphabet[i]] = (int8_t)i;
+    }
+    for (int i = 0; i < 16; i++) {
+        hex_table[(uint8_t)naive_hex_alphabet[i]] = (int8_t)i;
+        hex_table[(uint8_t)("0123456789ABCDEF"[i])] = (int8_t)i;
+    }
+    printf("%zu MiB of random bytes, best of %d runs\n\n", len >> 20, RUNS);
+
+    const char *src = (const char *)data;
+    double seconds;
+    size_t text_len = 0;
+    size_t naive_len = 0;
+    size_t written = 0;
+    bool valid = true;
+
+    MEASURE(seconds, naive_len = naive_base64_encode(naive_text, data, len));
+    report("base64 enc naive", seconds, len);
+    MEASURE(seconds,
+        text_len = fclib_base64_encode_to(
+            text, src, len, FCLIB_BASE64_STANDARD));
+    report("base64 enc fclib", seconds, len);
+    check(text_len == naive_len && memcmp(text, naive_text, text_len) == 0,
+        "base64 encoding");
+
+    MEASURE(seconds,
+        written = naive_base64_decode(
+            decoded, (const uint8_t *)text, text_len, base64_table));
+    report("base64 dec naive", seconds, len);
+    check(written == len && memcmp(decoded, data, len) == 0,
+        "base64 decoding");
+    memset(decoded, 0, len);
+    MEASURE(seconds,
+        valid = fclib_base64_decode_to((char *)decoded, text, text_len,
+            FCLIB_BASE64_STANDARD, &written));
+    report("base64 dec fclib", seconds, len);
+    check(valid && written == len && memcmp(decoded, data, len) == 0,
+        "base64 decoding");
+
+    MEASURE(seconds, naive_hex_encode(naive_text, data, len));
+    report("hex enc naive", seconds, len);
+    MEASURE(seconds, text_len = fclib_hex_encode_to(text, src, len));
+    report("hex enc fclib", seconds, len);
+    check(text_len == 2 * len && memcmp(text, naive_text, text_len) == 0,
+        "hex encoding");
+
+    MEASURE(seconds,
+        valid = naive_hex_decode(
+            decoded, (const uint8_t *)text, text_len, hex_table));
+    report("hex dec naive", seconds, len);
+    check(valid && memcmp(decoded, data, len) == 0, "hex decoding");
+    memset(decoded, 0, len);
+    MEASURE(seconds,
+        valid = fclib_hex_decode_to((char *)decoded, text, text_len));
+    report("hex dec fclib", seconds, len);
+    check(valid && memcmp(decoded, data, len) == 0, "hex decoding");
+
+    free(naive_text);
+    free(text);
+    free(decoded);
+    free(data);
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Compares `linalg_matmul_into` with the naive triple loop for square f64 and
+// f32 matrices of random values in [-1, 1). The time of one product and the
+// resulting GFLOP/s are printed, the best of several runs for the blocked
+// product and a single run for the naive loop, which takes seconds at the
+// default size. The kernels use AVX-512 or AVX2 when the CPU supports them,
+// `FCLIB_NO_SIMD` measures the scalar micro-kernel instead. Products are split
+// across `parallel_get_threads` threads.
+//
+//     cc -O2 -march=native -D_GNU_SOURCE bench/linalg.c -o linalg -lpthread -lm
+//     ./linalg [matrix size, default 1024]
+
+#define FCLIB_IMPLEMENTATION
+#include "../fclib/linalg.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define RUNS 5
+
+static double now(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static uint64_t random_state = 88172645463325252ULL;
+
+// Returns a random value in [-1, 1)
+static double random_value(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return (double)(random_state >> 11) * 0x1.0p-52 - 1.0;
+}
+
+// The textbook loop, one dot product along a row of `a` per element of `c`
+#define NAIVE_MATMUL(T)                                                        \
+    static void naive_matmul_##T(T *c, const T *a, const T *b, size_t n) {     \
+        for (size_t i = 0; i < n; i++) {                                       \
+            for (size_t j = 0; j < n; j++) {                                   \
+                T sum = 0;                                                     \
+                for (size_t p = 0; p < n; p++) {                               \
+                    sum += a[i + p * n] * b[p + j * n];                        \
+                }                                                              \
+                c[i + j * n] = sum;                                            \
+            }                                                                  \
+        }                                                                      \
+    }
+
+NAIVE_MATMUL(float)
+NAIVE_MATMUL(double)
+
+static fclib_arr_t *random_matrix(const size_t n, const fclib_arr_type_t type) {
+    const size_t lengths[2] = {n, n};
+    const bool is_f32 = type == FCLIB_ARR_TYPE_F32;
+    fclib_arr_t *arr = fclib_arr_create( //
+        2, is_f32 ? sizeof(float) : sizeof(double), lengths);
+    if (arr == NULL) {
+        fprintf(stderr, "not enough memory for a %zu x %zu matrix\n", n, n);
+        exit(1);
+    }
+    void *data = fclib_arr_get_data(arr);
+    for (size_t i = 0; i < n * n; i++) {
+        if (is_f32) {
+            ((float *)data)[i] = (float)random_value();
+        } else {
+            ((double *)data)[i] = random_value();
+        }
+    }
+    return arr;
+}
+
+// Returns the largest difference between two matrices
+static double max_difference( //
+    fclib_arr_t *c,           //
+    fclib_arr_t *ref,         //
+    const size_t n,           //
+    const bool is_f32         //
+) {
+    const void *x = fclib_arr_get_data(c);
+    const void *y = fclib_arr_get_data(ref);
+    double max = 0;
+    for (size_t i = 0; i < n * n; i++) {
+        const double difference = is_f32
+            ? fabs((double)((const float *)x)[i] -
+                  (double)((const float *)y)[i])
+            : fabs(((const double *)x)[i] - ((const double *)y)[i]);
+        max = difference > max ? difference : max;
+    }
+    return max;
+}
+
+static void measure(const size_t n, const fclib_arr_type_t type) {
+    const bool is_f32 = type == FCLIB_ARR_TYPE_F32;
+    fclib_arr_t *a = random_matrix(n, type);
+    fclib_arr_t *b = random_matrix(n, type);
+    fclib_arr_t *c = random_matrix(n, type);
+    fclib_arr_t *ref = random_matrix(n, type);
+
+    double best = 1e30;
+    for (int run = 0; run < RUNS; run++) {
+        const double start = now();
+        fclib_linalg_matmul_into(c, a, b, type, false);
+        const double elapsed = now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    double start = now();
+    if (is_f32) {
+        naive_matmul_float((float *)fclib_arr_get_data(ref),
+            (const float *)fclib_arr_get_data(a),
+            (const float *)fclib_arr_get_data(b), n);
+    } else {
+        naive_matmul_double((double *)fclib_arr_get_data(ref),
+            (const double *)fclib_arr_get_data(a),
+            (const double *)fclib_arr_get_data(b), n);
+    }
+    const double naive = now() - start;
+
+    // Both sum n products of magnitude below 1 in a different order
+    const double tolerance = (double)n * (is_f32 ? 0x1.0p-23 : 0x1.0p-52);
+    if (max_difference(c, ref, n, is_f32) > tolerance) {
+        fprintf(stderr, "the %s products differ\n", is_f32 ? "f32" : "f64");
+        exit(1);
+    }
+    const double flops = 2.0 * (double)n * (double)n * (double)n;
+    printf("%s  %9.4f s %8.1f GFLOP/s %9.3f s %8.2f GFLOP/s\n",
+        is_f32 ? "f32" : "f64", best, flops / best * 1e-9, naive,
+        flops / naive * 1e-9);
+
+    free(ref);
+    free(c);
+    free(b);
+    free(a);
+}
+
+int main(int argc, char **argv) {
+    const size_t n = argc > 1 ? (size_t)atol(argv[1]) : 1024;
+    printf("%zu x %zu matrices on %zu threads\n\n", n, n,
+        fclib_parallel_get_threads());
+    printf("            blocked                    naive\n");
+    measure(n, FCLIB_ARR_TYPE_F64);
+    measure(n, FCLIB_ARR_TYPE_F32);
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Compares the searches of search.h with a standard binary search. Sorted u32
+// arrays of 1e3 up to 1e9 elements are searched for 1M random keys and the
+// time per query is printed for every search, along with the time it took to
+// build the search tree. Sizes which do not fit into the available memory are
+// skipped. The batch searches use `parallel_get_threads` threads.
+//
+//     cc -O2 -march=native -D_GNU_SOURCE bench/search.c -o search -lpthread
+//     ./search [largest power of ten, default 9]
+
+#define FCLIB_IMPLEMENTATION
+#include "../fclib/search.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define QUERIES 1000000
+
+static double now(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+// Returns the number of bytes which can be allocated without swapping
+static size_t available_memory(void) {
+    FILE *meminfo = fopen("/proc/meminfo", "r");
+    if (meminfo != NULL) {
+        char line[128];
+        unsigned long long kib;
+        while (fgets(line, sizeof(line), meminfo) != NULL) {
+            if (sscanf(line, "MemAvailable: %llu kB", &kib) == 1) {
+                fclose(meminfo);
+                return (size_t)kib * 1024;
+            }
+        }
+        fclose(meminfo);
+    }
+    return (size_t)sysconf(_SC_PHYS_PAGES) * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static uint64_t random_state = 88172645463325252ULL;
+
+static uint64_t random_next(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+// The classic lower bound loop, as found in most standard libraries
+static size_t standard_lower_bound( //
+    const uint32_t *data,           //
+    const size_t len,               //
+    const uint32_t key              //
+) {
+    size_t low = 0;
+    size_t high = len;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (data[middle] < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static size_t sum_indices(fclib_arr_t *indices) {
+    const size_t *data = (const size_t *)(void *)fclib_arr_get_data(indices);
+    size_t sum = 0;
+    for (size_t i = 0; i < QUERIES; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    const int largest = argc > 1 ? atoi(argv[1]) : 9;
+    printf("ns per query for %d random u32 keys, batches on %zu threads\n\n",
+        QUERIES, fclib_parallel_get_threads());
+    printf("   n   standard  branchless   batch    tree  tree batch  build\n");
+    size_t n = 1000;
+    for (int exponent = 3; exponent <= largest; exponent++, n *= 10) {
+        // The array and the tree, plus the keys and two result arrays
+        const size_t needed = 2 * n * sizeof(uint32_t) +
+            QUERIES * (sizeof(uint32_t) + 2 * sizeof(size_t));
+        if (needed > available_memory() / 10 * 9) {
+            printf(" 1e%d   skipped, needs %zu MiB\n", exponent,
+                needed >> 20);
+            continue;
+        }
+        fclib_arr_t *arr = fclib_arr_create(1, sizeof(uint32_t), &n);
+        uint32_t *data = (uint32_t *)(void *)fclib_arr_get_data(arr);
+        for (size_t i = 0; i < n; i++) {
+            data[i] = (uint32_t)(i * 4);
+        }
+        const size_t query_count = QUERIES;
+        fclib_arr_t *keys = fclib_arr_create(1, sizeof(uint32_t), &query_count);
+        uint32_t *key_data = (uint32_t *)(void *)fclib_arr_get_data(keys);
+        for (size_t i = 0; i < QUERIES; i++) {
+            key_data[i] = (uint32_t)(random_next() % (n * 4));
+        }
+
+        double start = now();
+        size_t standard_sum = 0;
+        for (size_t i = 0; i < QUERIES; i++) {
+            standard_sum += standard_lower_bound(data, n, key_data[i]);
+        }
+        const double standard = now() - start;
+
+        start = now();
+        size_t branchless_sum = 0;
+        for (size_t i = 0; i < QUERIES; i++) {
+            branchless_sum += fclib_search_lower_bound( //
+                arr, FCLIB_ARR_TYPE_U32, &key_data[i]);
+        }
+        const double branchless = now() - start;
+
+        start = now();
+        fclib_arr_t *batch_result = fclib_search_batch( //
+            arr, FCLIB_ARR_TYPE_U32, keys, false);
+        const double batch = now() - start;
+
+        start = now();
+        fclib_search_tree_t *tree = fclib_search_tree_create( //
+            arr, FCLIB_ARR_TYPE_U32);
+        const double build = now() - start;
+
+        start = now();
+        size_t tree_sum = 0;
+        for (size_t i = 0; i < QUERIES; i++) {
+            tree_sum += fclib_search_tree_lower_bound(tree, &key_data[i]);
+        }
+        const double tree_single = now() - start;
+
+        start = now();
+        fclib_arr_t *tree_result = fclib_search_tree_batch(tree, keys, false);
+        const double tree_batch = now() - start;
+
+        if (branchless_sum != standard_sum || tree_sum != standard_sum ||
+            sum_indices(batch_result) != standard_sum ||
+            sum_indices(tree_result) != standard_sum) {
+            fprintf(stderr, "1e%d: the searches disagree\n", exponent);
+            return 1;
+        }
+        const double scale = 1e9 / QUERIES;
+        printf(" 1e%d %9.1f %11.1f %7.1f %7.1f %11.1f %6.0f ms\n", exponent,
+            standard * scale, branchless * scale, batch * scale,
+            tree_single * scale, tree_batch * scale, build * 1e3);
+
+        free(tree_result);
+        fclib_search_tree_free(tree);
+        free(batch_result);
+        free(keys);
+        free(arr);
+    }
+    return 0;
+}
@@ -15,11 +15,20 @@ extern "C" {
 
 #include "str.h"
 
+#ifndef FCLIB_MINIMAL
+// The parallel copies of `arr_concat` and `arr_stack` are not part of Flint
+#include "parallel.h"
+#endif
+
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <time.h>
 
+#ifndef FCLIB_MINIMAL
+#include <stdatomic.h>
+#endif
+
 // The str struct is just a wrapper around a byte array, so this means that
 // it can be used for arrays of any type. The 'len' field of the 'str'
 // struct is the dimensionality of the array, and the first 4xdimensionality
@@ -210,6 +219,463 @@ FCLIB_API void fclib_arr_assign_val_at( //
     const size_t value                  //
 );
 
+// FCLIB_MINIMAL controls whether to *only* emit symbols which are actually
+// present in Flint too, see `str.h` for more details
+#ifndef FCLIB_MINIMAL
+/// @enum `arr_type_t`
+/// @brief The primitive element types an array can contain. The array itself
+/// only knows about the `element_size` of its elements, so all typed array
+/// operations take the element type as an additional parameter
+typedef enum fclib_arr_type_t {
+    FCLIB_ARR_TYPE_I8,
+    FCLIB_ARR_TYPE_I16,
+    FCLIB_ARR_TYPE_I32,
+    FCLIB_ARR_TYPE_I64,
+    FCLIB_ARR_TYPE_U8,
+    FCLIB_ARR_TYPE_U16,
+    FCLIB_ARR_TYPE_U32,
+    FCLIB_ARR_TYPE_U64,
+    FCLIB_ARR_TYPE_F32,
+    FCLIB_ARR_TYPE_F64,
+} fclib_arr_type_t;
+
+/// @function `arr_type_size`
+/// @brief Returns the size of a single element of the given type in bytes
+///
+/// @param `type` The element type
+/// @return `size_t` The size of one element of the given type
+FCLIB_API size_t fclib_arr_type_size(const fclib_arr_type_t type);
+
+/// @function `arr_get_len`
+/// @brief Returns the total number of elements in the array, e.g. the product
+/// of the lengths of all dimensions
+///
+/// @param `arr` The array to get the element count of
+/// @return `size_t` The number of elements stored in the array
+FCLIB_API size_t fclib_arr_get_len(const fclib_arr_t *arr);
+
+/// @function `arr_get_data`
+/// @brief Returns a pointer to the first element of the array, e.g. the first
+/// byte after the dimension lengths
+///
+/// @param `arr` The array to get the data of
+/// @return `char *` Pointer to the first element of the array
+FCLIB_API char *fclib_arr_get_data(fclib_arr_t *arr);
+
+/// @function `arr_reshape`
+/// @brief Changes the shape of the array in place without copying its
+/// elements one by one, the elements keep their column-major order. If the
+/// dimensionality stays the same only the dimension lengths are rewritten.
+/// Otherwise the data block is moved once with a single `memmove` to make room
+/// for the new dimension lengths, growing the allocation with one `realloc`
+/// if the array gets more dimensions. Like `realloc`, the array may move, so
+/// only the returned pointer is valid afterwards. `lengths` must not point
+/// into the array itself
+///
+/// @param `arr` The array to reshape
+/// @param `element_size` The size of each element in bytes
+/// @param `dimensionality` The new number of dimensions, at least 1
+/// @param `lengths` The new lengths of all dimensions
+/// @return `arr_t *` The reshaped array, or NULL if the element count would
+/// change or the array could not be grown, in which case `arr` is unchanged
+FCLIB_API fclib_arr_t *fclib_arr_reshape( //
+    fclib_arr_t *arr,                     //
+    const size_t element_size,            //
+    const size_t dimensionality,          //
+    const size_t *lengths                 //
+);
+
+/// @function `arr_flatten`
+/// @brief Reshapes the array in place into a one-dimensional array of all its
+/// elements in column-major order, see `arr_reshape`
+///
+/// @param `arr` The array to flatten
+/// @param `element_size` The size of each element in bytes
+/// @return `arr_t *` The flattened array, which may have moved
+FCLIB_API fclib_arr_t *fclib_arr_flatten( //
+    fclib_arr_t *arr,                     //
+    const size_t element_size             //
+);
+
+/// @function `arr_squeeze`
+/// @brief Removes all dimensions of length 1 from the array in place, see
+/// `arr_reshape`. An array containing a single element becomes a
+/// one-dimensional array of length 1
+///
+/// @param `arr` The array to squeeze
+/// @param `element_size` The size of each element in bytes
+/// @return `arr_t *` The squeezed array, which may have moved
+FCLIB_API fclib_arr_t *fclib_arr_squeeze( //
+    fclib_arr_t *arr,                     //
+    const size_t element_size             //
+);
+
+/// @function `arr_concat`
+/// @brief Concatenates `count` arrays along the dimension `axis` into a new
+/// array, e.g. concatenating matrices along axis 0 appends rows and along
+/// axis 1 appends columns. All arrays must have the same dimensionality and
+/// the same lengths in all other dimensions. The result is allocated once and
+/// filled with one `memcpy` per contiguous run, large results are copied by
+/// multiple threads
+///
+/// @param `arrays` The arrays to concatenate
+/// @param `count` The number of arrays, at least 1
+/// @param `element_size` The size of each element in bytes
+/// @param `axis` The dimension to concatenate along
+/// @return `arr_t *` The concatenated array, or NULL if the shapes do not
+/// match or `axis` does not exist
+FCLIB_API fclib_arr_t *fclib_arr_concat( //
+    const fclib_arr_t *const *arrays,    //
+    const size_t count,                  //
+    const size_t element_size,           //
+    const size_t axis                    //
+);
+
+/// @function `arr_stack`
+/// @brief Stacks `count` arrays of the same shape along a new dimension, which
+/// is inserted at position `axis` and has length `count`. Stacking vectors of
+/// length n along axis 1 results in an n x `count` matrix with one vector per
+/// column, stacking them along axis 0 in a `count` x n matrix with one vector
+/// per row. Copies just like `arr_concat`
+///
+/// @param `arrays` The arrays to stack
+/// @param `count` The number of arrays, at least 1
+/// @param `element_size` The size of each element in bytes
+/// @param `axis` The position of the new dimension, at most the dimensionality
+/// of the arrays
+/// @return `arr_t *` The stacked array, or NULL if the shapes do not match or
+/// `axis` is out of range
+FCLIB_API fclib_arr_t *fclib_arr_stack( //
+    const fclib_arr_t *const *arrays,   //
+    const size_t count,                 //
+    const size_t element_size,          //
+    const size_t axis                   //
+);
+
+/// @function `arr_clone`
+/// @brief Deep copies the array and all arrays nested in it into a single
+/// allocation. `complexity` is the nesting depth like for `arr_free`, so an
+/// array of arrays of strings has complexity 2. The total size is computed
+/// first, then every nested array is copied right behind its parent. NULL
+/// elements stay NULL. The clone must be freed with `arr_free_clone`
+///
+/// @param `arr` The array to clone
+/// @param `complexity` The complexity of the array, e.g. how many more arrays
+/// it contains
+/// @param `element_size` The size of the elements of the innermost arrays in
+/// bytes, or 0 if the innermost values are strings
+/// @return `arr_t *` The cloned array, or NULL if the allocation failed
+FCLIB_API fclib_arr_t *fclib_arr_clone( //
+    const fclib_arr_t *arr,             //
+    const size_t complexity,            //
+    const size_t element_size           //
+);
+
+/// @function `arr_free_clone`
+/// @brief Frees an array created by `arr_clone` with a single `free` of its
+/// allocation. Nested arrays which have been replaced by arrays from outside
+/// of the clone since are freed with `arr_free` like usual, while nested
+/// arrays of the clone itself must never be freed on their own
+///
+/// @param `arr` The cloned array to free
+/// @param `complexity` The complexity the array was cloned with
+FCLIB_API void fclib_arr_free_clone( //
+    fclib_arr_t *arr,                //
+    const size_t complexity          //
+);
+
+/// @function `arr_cow_create`
+/// @brief Creates a copy-on-write array, which can be shared in O(1) with
+/// `arr_cow_share` instead of being copied. It is a regular array with a
+/// reference count in front of it, so all reading functions work on it as
+/// usual, but it must only be written through the `arr_cow_*` functions and
+/// released with `arr_cow_release`. Copy-on-write arrays are meant for plain
+/// elements, nested arrays would be shared by all copies
+///
+/// @param `dimensionality` The number of dimensions of the rectangular array
+/// @param `element_size` The number of bytes every element in the array is
+/// taking up
+/// @param `lengths` The lengths of all dimensions
+/// @return `arr_t *` The created array with a reference count of 1, or NULL
+/// if the allocation failed
+FCLIB_API fclib_arr_t *fclib_arr_cow_create( //
+    const size_t dimensionality,             //
+    const size_t element_size,               //
+    const size_t *lengths                    //
+);
+
+/// @function `arr_cow_from`
+/// @brief Turns a regular array into a copy-on-write array by growing its
+/// allocation once and moving it behind the reference count. Like `realloc`,
+/// the array may move, so only the returned pointer is valid afterwards
+///
+/// @param `arr` The regular array to convert, which is taken over
+/// @param `element_size` The size of each element in bytes
+/// @return `arr_t *` The copy-on-write array with a reference count of 1, or
+/// NULL if the allocation could not be grown, in which case `arr` is unchanged
+FCLIB_API fclib_arr_t *fclib_arr_cow_from( //
+    fclib_arr_t *arr,                      //
+    const size_t element_size              //
+);
+
+/// @function `arr_cow_share`
+/// @brief Shares the copy-on-write array, which is what assigning it by value
+/// lowers to. Only the reference count is incremented
+///
+/// @param `arr` The copy-on-write array to share
+/// @return `arr_t *` The same array, which now has one more reference
+FCLIB_API fclib_arr_t *fclib_arr_cow_share(fclib_arr_t *arr);
+
+/// @function `arr_cow_release`
+/// @brief Drops one reference to the copy-on-write array, the array is freed
+/// once the last reference has been dropped
+///
+/// @param `arr` The copy-on-write array to release
+FCLIB_API void fclib_arr_cow_release(fclib_arr_t *arr);
+
+/// @function `arr_cow_refs`
+/// @brief Returns the current number of references to the copy-on-write
+/// array
+///
+/// @param `arr` The copy-on-write array
+/// @return `size_t` The number of references
+FCLIB_API size_t fclib_arr_cow_refs(const fclib_arr_t *arr);
+
+/// @function `arr_cow_unique`
+/// @brief Makes sure the given reference is the only one to its array, so it
+/// may be written to directly. If the array is shared it is copied first, the
+/// reference is replaced by the copy and the shared array loses a reference
+///
+/// @param `arr` The reference to the copy-on-write array
+/// @param `element_size` The size of each element in bytes
+/// @return `arr_t *` The unshared array, which is also stored in `arr`, or
+/// NULL if the copy could not be allocated
+FCLIB_API fclib_arr_t *fclib_arr_cow_unique( //
+    fclib_arr_t **arr,                       //
+    const size_t element_size                //
+);
+
+/// @function `arr_cow_assign_at`
+/// @brief Assigns the value to the element at the given indices like
+/// `arr_assign_at`, copying the array first if it is shared
+///
+/// @param `arr` The reference to the copy-on-write array
+/// @param `element_size` The size of each element in bytes
+/// @param `indices` The position of the element to access
+/// @param `value` The value to assign
+/// @return `bool` Whether the value was assigned, false if the copy could not
+/// be allocated
+FCLIB_API bool fclib_arr_cow_assign_at( //
+    fclib_arr_t **arr,                  //
+    const size_t element_size,          //
+    const size_t *indices,              //
+    const void *value                   //
+);
+
+/// @function `arr_cow_assign_val_at`
+/// @brief Assigns the value to the element at the given indices like
+/// `arr_assign_val_at`, copying the array first if it is shared
+///
+/// @param `arr` The reference to the copy-on-write array
+/// @param `element_size` The size of each element in bytes
+/// @param `indices` The position of the element to access
+/// @param `value` The value to assign
+/// @return `bool` Whether the value was assigned, false if the copy could not
+/// be allocated
+FCLIB_API bool fclib_arr_cow_assign_val_at( //
+    fclib_arr_t **arr,                      //
+    const size_t element_size,              //
+    const size_t *indices,                  //
+    const size_t value                      //
+);
+
+/// @function `arr_cow_fill_val`
+/// @brief Fills the array with the value like `arr_fill_val`. If the array is
+/// shared, a new array of the same shape is filled instead, as none of the
+/// old elements survive the fill anyway
+///
+/// @param `arr` The reference to the copy-on-write array
+/// @param `element_size` The size of each element in bytes
+/// @param `value` The value container which contains the value to copy
+/// @return `bool` Whether the array was filled, false if the new array could
+/// not be allocated
+FCLIB_API bool fclib_arr_cow_fill_val( //
+    fclib_arr_t **arr,                 //
+    const size_t element_size,         //
+    const size_t value                 //
+);
+
+/// @function `arr_cow_fill_inline`
+/// @brief Fills the array with the value like `arr_fill_inline`, see
+/// `arr_cow_fill_val`
+///
+/// @param `arr` The reference to the copy-on-write array
+/// @param `element_size` The size of each element in bytes
+/// @param `value` The value containing the element to copy
+/// @return `bool` Whether the array was filled, false if the new array could
+/// not be allocated
+FCLIB_API bool fclib_arr_cow_fill_inline( //
+    fclib_arr_t **arr,                    //
+    const size_t element_size,            //
+    const void *value                     //
+);
+
+/// @typedef `arr_view_t`
+/// @brief A strided view into the elements of an array, which does not own
+/// them. The element at the indices (i0, i1, ...) lives at `data` plus
+/// (i0 * stride0 + i1 * stride1 + ...) * `element_size`. The `len` dimension
+/// lengths are stored at the start of `shape`, followed by the `len` strides
+/// in elements. A view is a single allocation, free it with `free`
+typedef struct fclib_arr_view_t {
+    char *data;
+    size_t element_size;
+    size_t len;
+    size_t shape[];
+} fclib_arr_view_t;
+
+/// @function `arr_view`
+/// @brief Creates a view of all elements of the array
+///
+/// @param `arr` The array to view, which must outlive the view
+/// @param `element_size` The size of each element in bytes
+/// @return `arr_view_t *` The view of the whole array
+FCLIB_API fclib_arr_view_t *fclib_arr_view( //
+    fclib_arr_t *arr,                       //
+    const size_t element_size               //
+);
+
+/// @function `arr_view_slice`
+/// @brief Creates a view of a region of the given view without copying any
+/// elements. The `ranges` are encoded like for `arr_get_slice`: every
+/// dimension has a pair of [from, to), and a pair with from == to selects the
+/// single index `from` and drops the dimension from the view
+///
+/// @param `view` The view to slice
+/// @param `ranges` The ranges of the slicing, two values per dimension
+/// @return `arr_view_t *` The view of the region, or NULL if a range is out of
+/// bounds
+FCLIB_API fclib_arr_view_t *fclib_arr_view_slice( //
+    const fclib_arr_view_t *view,                 //
+    const size_t *ranges                          //
+);
+
+/// @function `arr_view_reshape`
+/// @brief Creates a view with a different shape of the same elements, in
+/// column-major order, without copying any elements. This is only possible if
+/// every group of old dimensions which is merged into new ones is laid out
+/// contiguously relative to each other, which is always the case for views of
+/// whole arrays
+///
+/// @param `view` The view to reshape
+/// @param `dimensionality` The new number of dimensions, at least 1
+/// @param `lengths` The new lengths of all dimensions
+/// @return `arr_view_t *` The reshaped view, or NULL if the element count
+/// would change or the strides of `view` do not allow the new shape, in which
+/// case `arr_view_copy` followed by `arr_reshape` is needed
+FCLIB_API fclib_arr_view_t *fclib_arr_view_reshape( //
+    const fclib_arr_view_t *view,                   //
+    const size_t dimensionality,                    //
+    const size_t *lengths                           //
+);
+
+/// @function `arr_view_flatten`
+/// @brief Creates a one-dimensional view of all elements of the view in
+/// column-major order, see `arr_view_reshape`
+///
+/// @param `view` The view to flatten
+/// @return `arr_view_t *` The flat view, or NULL if the elements of `view` are
+/// not evenly spaced in memory
+FCLIB_API fclib_arr_view_t *fclib_arr_view_flatten( //
+    const fclib_arr_view_t *view                    //
+);
+
+/// @function `arr_view_squeeze`
+/// @brief Creates a view without the dimensions of length 1 of the view, which
+/// is always possible
+///
+/// @param `view` The view to squeeze
+/// @return `arr_view_t *` The squeezed view
+FCLIB_API fclib_arr_view_t *fclib_arr_view_squeeze( //
+    const fclib_arr_view_t *view                    //
+);
+
+/// @function `arr_view_access`
+/// @brief Returns a pointer to the element at the given indices of the view
+///
+/// @param `view` The view to access
+/// @param `indices` The position of the element to access
+/// @return `char *` Pointer to the element, or NULL if out of bounds
+FCLIB_API char *fclib_arr_view_access( //
+    const fclib_arr_view_t *view,      //
+    const size_t *indices              //
+);
+
+/// @function `arr_set_slice`
+/// @brief Writes the elements of `src` into a region of `dest`, the write
+/// counterpart of `arr_get_slice`. The `ranges` are encoded like for
+/// `arr_get_slice`, and `src` must have the shape `arr_get_slice` would return
+/// for them, dimensions of length 1 aside. Contiguous runs of the region are
+/// written with a single `memcpy` each. `src` must not overlap the region
+///
+/// @param `dest` The array to write into
+/// @param `element_size` The size of each element in bytes
+/// @param `ranges` The ranges of the region, two values per dimension
+/// @param `src` The array holding the elements to write
+/// @return `bool` Whether the region was written, false if a range is out of
+/// bounds or the shapes do not match
+FCLIB_API bool fclib_arr_set_slice( //
+    fclib_arr_t *dest,              //
+    const size_t element_size,      //
+    const size_t *ranges,           //
+    const fclib_arr_t *src          //
+);
+
+/// @function `arr_set_slice_view`
+/// @brief Writes the elements of the view `src` into a region of `dest`, see
+/// `arr_set_slice`. This allows copying a strided region of one array into a
+/// region of another one without materializing it first
+///
+/// @param `dest` The array to write into
+/// @param `ranges` The ranges of the region, two values per dimension
+/// @param `src` The view holding the elements to write, with the element size
+/// of `dest`
+/// @return `bool` Whether the region was written, false if a range is out of
+/// bounds or the shapes do not match
+FCLIB_API bool fclib_arr_set_slice_view( //
+    fclib_arr_t *dest,                   //
+    const size_t *ranges,                //
+    const fclib_arr_view_t *src          //
+);
+
+/// @function `arr_fill_slice`
+/// @brief Fills a region of `dest` with copies of the given value. The
+/// `ranges` are encoded like for `arr_get_slice`. Values whose bytes are all
+/// equal (like zero) are written with one `memset` per contiguous run
+///
+/// @param `dest` The array to fill a region of
+/// @param `element_size` The size of each element in bytes
+/// @param `ranges` The ranges of the region, two values per dimension
+/// @param `value` Pointer to the value to copy into each element
+/// @return `bool` Whether the region was filled, false if a range is out of
+/// bounds
+FCLIB_API bool fclib_arr_fill_slice( //
+    fclib_arr_t *dest,               //
+    const size_t element_size,       //
+    const size_t *ranges,            //
+    const void *value                //
+);
+
+/// @function `arr_view_copy`
+/// @brief Copies the elements of the view into a new, contiguous array with
+/// the shape of the view. Contiguous runs of the view are copied with a single
+/// `memcpy` each
+///
+/// @param `view` The view to copy
+/// @return `arr_t *` The new array
+FCLIB_API fclib_arr_t *fclib_arr_view_copy(const fclib_arr_view_t *view);
+
+#endif // endof FCLIB_MINIMAL
+
 // #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
 #ifdef FCLIB_STRIP_PREFIXES
 // Inline-wrappers that forward to the non-stripped function. This is needed
@@ -312,6 +778,192 @@ FCLIB_API static inline void arr_assign_val_at( //
 ) {
     fclib_arr_assign_val_at(arr, element_size, indices, value);
 }
+
+// FCLIB_MINIMAL STRIPPED START
+#ifndef FCLIB_MINIMAL
+typedef fclib_arr_type_t arr_type_t;
+
+FCLIB_API static inline size_t arr_type_size(const arr_type_t type) {
+    return fclib_arr_type_size(type);
+}
+FCLIB_API static inline size_t arr_get_len(const arr_t *arr) {
+    return fclib_arr_get_len(arr);
+}
+FCLIB_API static inline char *arr_get_data(arr_t *arr) {
+    return fclib_arr_get_data(arr);
+}
+FCLIB_API static inline arr_t *arr_reshape( //
+    arr_t *arr,                             //
+    const size_t element_size,              //
+    const size_t dimensionality,            //
+    const size_t *lengths                   //
+) {
+    return fclib_arr_reshape(arr, element_size, dimensionality, lengths);
+}
+FCLIB_API static inline arr_t *arr_flatten( //
+    arr_t *arr,                             //
+    const size_t element_size               //
+) {
+    return fclib_arr_flatten(arr, element_size);
+}
+FCLIB_API static inline arr_t *arr_squeeze( //
+    arr_t *arr,                             //
+    const size_t element_size               //
+) {
+    return fclib_arr_squeeze(arr, element_size);
+}
+
+FCLIB_API static inline arr_t *arr_concat( //
+    const arr_t *const *arrays,            //
+    const size_t count,                    //
+    const size_t element_size,             //
+    const size_t axis                      //
+) {
+    return fclib_arr_concat(arrays, count, element_size, axis);
+}
+FCLIB_API static inline arr_t *arr_stack( //
+    const arr_t *const *arrays,           //
+    const size_t count,                   //
+    const size_t element_size,            //
+    const size_t axis                     //
+) {
+    return fclib_arr_stack(arrays, count, element_size, axis);
+}
+
+FCLIB_API static inline arr_t *arr_clone( //
+    const arr_t *arr,                     //
+    const size_t complexity,              //
+    const size_t element_size             //
+) {
+    return fclib_arr_clone(arr, complexity, element_size);
+}
+FCLIB_API static inline void arr_free_clone( //
+    arr_t *arr,                              //
+    const size_t complexity                  //
+) {
+    fclib_arr_free_clone(arr, complexity);
+}
+
+FCLIB_API static inline arr_t *arr_cow_create( //
+    const size_t dimensionality,               //
+    const size_t element_size,                 //
+    const size_t *lengths                      //
+) {
+    return fclib_arr_cow_create(dimensionality, element_size, lengths);
+}
+FCLIB_API static inline arr_t *arr_cow_from( //
+    arr_t *arr,                              //
+    const size_t element_size                //
+) {
+    return fclib_arr_cow_from(arr, element_size);
+}
+FCLIB_API static inline arr_t *arr_cow_share(arr_t *arr) {
+    return fclib_arr_cow_share(arr);
+}
+FCLIB_API static inline void arr_cow_release(arr_t *arr) {
+    fclib_arr_cow_release(arr);
+}
+FCLIB_API static inline size_t arr_cow_refs(const arr_t *arr) {
+    return fclib_arr_cow_refs(arr);
+}
+FCLIB_API static inline arr_t *arr_cow_unique( //
+    arr_t **arr,                               //
+    const size_t element_size                  //
+) {
+    return fclib_arr_cow_unique(arr, element_size);
+}
+FCLIB_API static inline bool arr_cow_assign_at( //
+    arr_t **arr,                                //
+    const size_t element_size,                  //
+    const size_t *indices,                      //
+    const void *value                           //
+) {
+    return fclib_arr_cow_assign_at(arr, element_size, indices, value);
+}
+FCLIB_API static inline bool arr_cow_assign_val_at( //
+    arr_t **arr,                                    //
+    const size_t element_size,                      //
+    const size_t *indices,                          //
+    const size_t value                              //
+) {
+    return fclib_arr_cow_assign_val_at(arr, element_size, indices, value);
+}
+FCLIB_API static inline bool arr_cow_fill_val( //
+    arr_t **arr,                               //
+    const size_t element_size,                 //
+    const size_t value                         //
+) {
+    return fclib_arr_cow_fill_val(arr, element_size, value);
+}
+FCLIB_API static inline bool arr_cow_fill_inline( //
+    arr_t **arr,                                  //
+    const size_t element_size,                    //
+    const void *value                             //
+) {
+    return fclib_arr_cow_fill_inline(arr, element_size, value);
+}
+
+typedef fclib_arr_view_t arr_view_t;
+
+FCLIB_API static inline arr_view_t *arr_view( //
+    arr_t *arr,                               //
+    const size_t element_size                 //
+) {
+    return fclib_arr_view(arr, element_size);
+}
+FCLIB_API static inline arr_view_t *arr_view_slice( //
+    const arr_view_t *view,                         //
+    const size_t *ranges                            //
+) {
+    return fclib_arr_view_slice(view, ranges);
+}
+FCLIB_API static inline arr_view_t *arr_view_reshape( //
+    const arr_view_t *view,                           //
+    const size_t dimensionality,                      //
+    const size_t *lengths                             //
+) {
+    return fclib_arr_view_reshape(view, dimensionality, lengths);
+}
+FCLIB_API static inline arr_view_t *arr_view_flatten(const arr_view_t *view) {
+    return fclib_arr_view_flatten(view);
+}
+FCLIB_API static inline arr_view_t *arr_view_squeeze(const arr_view_t *view) {
+    return fclib_arr_view_squeeze(view);
+}
+FCLIB_API static inline char *arr_view_access( //
+    const arr_view_t *view,                    //
+    const size_t *indices                      //
+) {
+    return fclib_arr_view_access(view, indices);
+}
+FCLIB_API static inline arr_t *arr_view_copy(const arr_view_t *view) {
+    return fclib_arr_view_copy(view);
+}
+FCLIB_API static inline bool arr_set_slice( //
+    arr_t *dest,                            //
+    const size_t element_size,              //
+    const size_t *ranges,                   //
+    const arr_t *src                        //
+) {
+    return fclib_arr_set_slice(dest, element_size, ranges, src);
+}
+FCLIB_API static inline bool arr_set_slice_view( //
+    arr_t *dest,                                 //
+    const size_t *ranges,                        //
+    const arr_view_t *src                        //
+) {
+    return fclib_arr_set_slice_view(dest, ranges, src);
+}
+FCLIB_API static inline bool arr_fill_slice( //
+    arr_t *dest,                             //
+    const size_t element_size,               //
+    const size_t *ranges,                    //
+    const void *value                        //
+) {
+    return fclib_arr_fill_slice(dest, element_size, ranges, value);
+}
+
+#endif // endof FCLIB_MINIMAL
 #endif // endof FCLIB_STRIP_PREFIXES
 
 #ifdef __cplusplus
@@ -757,4 +1409,1098 @@ FCLIB_API void fclib_arr_assign_val_at( //
     memcpy(element, &value, element_size);
 }
 
+// FCLIB_MINIMAL START IMPLEMENTATION
+#ifndef FCLIB_MINIMAL
+
+FCLIB_API size_t fclib_arr_type_size(const fclib_arr_type_t type) {
+    switch (type) {
+        case FCLIB_ARR_TYPE_I8:
+        case FCLIB_ARR_TYPE_U8:
+            return 1;
+        case FCLIB_ARR_TYPE_I16:
+        case FCLIB_ARR_TYPE_U16:
+            return 2;
+        case FCLIB_ARR_TYPE_I32:
+        case FCLIB_ARR_TYPE_U32:
+        case FCLIB_ARR_TYPE_F32:
+            return 4;
+        case FCLIB_ARR_TYPE_I64:
+        case FCLIB_ARR_TYPE_U64:
+        case FCLIB_ARR_TYPE_F64:
+            return 8;
+    }
+    return 0;
+}
+
+FCLIB_API size_t fclib_arr_get_len(const fclib_arr_t *arr) {
+    const size_t dimensionality = arr->len;
+    const size_t *const dim_lengths = FCLIB_ALIGNCAST(const size_t, arr->value);
+    size_t total_elements = 1;
+    for (size_t i = 0; i < dimensionality; i++) {
+        total_elements *= dim_lengths[i];
+    }
+    return total_elements;
+}
+
+FCLIB_API char *fclib_arr_get_data(fclib_arr_t *arr) {
+    return arr->value + arr->len * sizeof(size_t);
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_reshape( //
+    fclib_arr_t *arr,                     //
+    const size_t element_size,            //
+    const size_t dimensionality,          //
+    const size_t *lengths                 //
+) {
+    if (dimensionality == 0) {
+        return NULL;
+    }
+    const size_t total_elements = fclib_arr_get_len(arr);
+    size_t new_total = 1;
+    for (size_t i = 0; i < dimensionality; i++) {
+        new_total *= lengths[i];
+    }
+    if (new_total != total_elements) {
+        return NULL;
+    }
+    const size_t data_size = total_elements * element_size;
+    if (dimensionality > arr->len) {
+        // Grow the allocation first, the data is moved up afterwards
+        fclib_arr_t *grown = (fclib_arr_t *)realloc(arr,
+            sizeof(fclib_arr_t) + dimensionality * sizeof(size_t) + data_size);
+        if (grown == NULL) {
+            return NULL;
+        }
+        arr = grown;
+    }
+    if (dimensionality != arr->len) {
+        memmove(arr->value + dimensionality * sizeof(size_t),
+            arr->value + arr->len * sizeof(size_t), data_size);
+        arr->len = dimensionality;
+    }
+    memcpy(arr->value, lengths, dimensionality * sizeof(size_t));
+    return arr;
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_flatten( //
+    fclib_arr_t *arr,                     //
+    const size_t element_size             //
+) {
+    const size_t total_elements = fclib_arr_get_len(arr);
+    return fclib_arr_reshape(arr, element_size, 1, &total_elements);
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_squeeze( //
+    fclib_arr_t *arr,                     //
+    const size_t element_size             //
+) {
+    const size_t dimensionality = arr->len;
+    size_t *lengths = (size_t *)malloc(dimensionality * sizeof(size_t));
+    if (lengths == NULL) {
+        return NULL;
+    }
+    const size_t *const dim_lengths = FCLIB_ALIGNCAST(const size_t, arr->value);
+    size_t new_dimensionality = 0;
+    for (size_t i = 0; i < dimensionality; i++) {
+        if (dim_lengths[i] != 1) {
+            lengths[new_dimensionality] = dim_lengths[i];
+            new_dimensionality++;
+        }
+    }
+    if (new_dimensionality == 0) {
+        lengths[0] = 1;
+        new_dimensionality = 1;
+    }
+    fclib_arr_t *result = fclib_arr_reshape( //
+        arr, element_size, new_dimensionality, lengths);
+    free(lengths);
+    return result;
+}
+
+// Joined arrays are copied in chunks of this many bytes, and only results of
+// at least `FCLIB_ARR_JOIN_GRAIN` chunks per thread are copied in parallel
+#define FCLIB_ARR_JOIN_CHUNK (64 * 1024)
+#define FCLIB_ARR_JOIN_GRAIN 16
+
+// The result of a join consists of blocks, each holding one contiguous run of
+// every source array after another. `offsets` holds the `count + 1` start
+// offsets of the runs within a block in bytes, the last one being the size of
+// a whole block. `short_run` is the size of all runs if they are all equally
+// short, 0 otherwise
+typedef struct fclib_arr_join_t {
+    const fclib_arr_t *const *arrays;
+    size_t count;
+    const size_t *offsets;
+    size_t total;
+    size_t short_run;
+    char *dest;
+} fclib_arr_join_t;
+
+// Interleaves runs of `run` bytes of all arrays, starting at the run `k` of
+// the block `block`. Inlined with a constant `run`, the copies compile to
+// plain loads and stores
+static inline void fclib_arr_join_interleave( //
+    const fclib_arr_join_t *join,             //
+    size_t pos,                               //
+    const size_t stop,                        //
+    size_t block,                             //
+    size_t k,                                 //
+    const size_t run                          //
+) {
+    for (; pos < stop; pos += run) {
+        const fclib_arr_t *src = join->arrays[k];
+        memcpy(join->dest + pos,
+            src->value + src->len * sizeof(size_t) + block * run, run);
+        if (++k == join->count) {
+            k = 0;
+            block++;
+        }
+    }
+}
+
+// Copies the bytes [begin, end) of the result, in whole chunks
+static void fclib_arr_join_range( //
+    void *context,                //
+    const size_t begin,           //
+    const size_t end              //
+) {
+    const fclib_arr_join_t *join = (const fclib_arr_join_t *)context;
+    const size_t block_size = join->offsets[join->count];
+    size_t pos = begin * FCLIB_ARR_JOIN_CHUNK;
+    const size_t stop = end * FCLIB_ARR_JOIN_CHUNK < join->total
+        ? end * FCLIB_ARR_JOIN_CHUNK
+        : join->total;
+    if (pos >= stop) {
+        return;
+    }
+    size_t block = pos / block_size;
+    size_t within = pos % block_size;
+    if (join->short_run != 0) {
+        // Chunks always start at a run boundary, as the run size divides them
+        const size_t k = within / join->short_run;
+        switch (join->short_run) {
+            case 4:
+                fclib_arr_join_interleave(join, pos, stop, block, k, 4);
+                return;
+            case 8:
+                fclib_arr_join_interleave(join, pos, stop, block, k, 8);
+                return;
+            default:
+                fclib_arr_join_interleave(
+                    join, pos, stop, block, k, join->short_run);
+                return;
+        }
+    }
+    // Find the run the range starts in, empty runs are skipped over
+    size_t k = 0;
+    while (join->offsets[k + 1] <= within) {
+        k++;
+    }
+    while (pos < stop) {
+        const size_t run_size = join->offsets[k + 1] - join->offsets[k];
+        const size_t skip = within - join->offsets[k];
+        size_t n = run_size - skip;
+        if (n > stop - pos) {
+            n = stop - pos;
+        }
+        const fclib_arr_t *src = join->arrays[k];
+        memcpy(join->dest + pos,
+            src->value + src->len * sizeof(size_t) + block * run_size + skip,
+            n);
+        pos += n;
+        within += n;
+        // Advance to the next non-empty run, possibly in the next block
+        while (within >= join->offsets[k + 1] && pos < stop) {
+            k++;
+            if (k == join->count) {
+                k = 0;
+                block++;
+                within = 0;
+            }
+        }
+    }
+}
+
+// Joins the arrays into `result`, where every source array contributes runs
+// of `inner` times its entry in `extents` elements to every block
+static bool fclib_arr_join(           //
+    fclib_arr_t *result,              //
+    const fclib_arr_t *const *arrays, //
+    const size_t count,               //
+    const size_t element_size,        //
+    const size_t inner,               //
+    const size_t *extents             //
+) {
+    size_t *offsets = (size_t *)malloc((count + 1) * sizeof(size_t));
+    if (offsets == NULL) {
+        return false;
+    }
+    offsets[0] = 0;
+    for (size_t k = 0; k < count; k++) {
+        offsets[k + 1] = offsets[k] + inner * extents[k] * element_size;
+    }
+    fclib_arr_join_t join;
+    join.arrays = arrays;
+    join.count = count;
+    join.offsets = offsets;
+    join.total = fclib_arr_get_len(result) * element_size;
+    join.short_run = 0;
+    const size_t first_run = inner * extents[0] * element_size;
+    if (first_run != 0 && first_run <= 16 &&
+        FCLIB_ARR_JOIN_CHUNK % first_run == 0) {
+        join.short_run = first_run;
+        for (size_t k = 1; k < count; k++) {
+            if (extents[k] != extents[0]) {
+                join.short_run = 0;
+            }
+        }
+    }
+    join.dest = fclib_arr_get_data(result);
+    if (join.total > 0) {
+        const size_t chunks = (join.total + FCLIB_ARR_JOIN_CHUNK - 1) / //
+            FCLIB_ARR_JOIN_CHUNK;
+        fclib_parallel_for(
+            chunks, FCLIB_ARR_JOIN_GRAIN, fclib_arr_join_range, &join);
+    }
+    free(offsets);
+    return true;
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_concat( //
+    const fclib_arr_t *const *arrays,    //
+    const size_t count,                  //
+    const size_t element_size,           //
+    const size_t axis                    //
+) {
+    if (count == 0 || axis >= arrays[0]->len) {
+        return NULL;
+    }
+    const size_t dimensionality = arrays[0]->len;
+    const size_t *first = FCLIB_ALIGNCAST(const size_t, arrays[0]->value);
+    size_t *lengths = (size_t *)malloc( //
+        (dimensionality + count) * sizeof(size_t));
+    if (lengths == NULL) {
+        return NULL;
+    }
+    size_t *extents = lengths + dimensionality;
+    memcpy(lengths, first, dimensionality * sizeof(size_t));
+    lengths[axis] = 0;
+    for (size_t k = 0; k < count; k++) {
+        const size_t *dims = FCLIB_ALIGNCAST(const size_t, arrays[k]->value);
+        bool matches = arrays[k]->len == dimensionality;
+        for (size_t i = 0; matches && i < dimensionality; i++) {
+            matches = i == axis || dims[i] == first[i];
+        }
+        if (!matches) {
+            free(lengths);
+            return NULL;
+        }
+        extents[k] = dims[axis];
+        lengths[axis] += dims[axis];
+    }
+    size_t inner = 1;
+    for (size_t i = 0; i < axis; i++) {
+        inner *= first[i];
+    }
+    fclib_arr_t *result = fclib_arr_create( //
+        dimensionality, element_size, lengths);
+    if (!fclib_arr_join(result, arrays, count, element_size, inner, extents)) {
+        free(result);
+        result = NULL;
+    }
+    free(lengths);
+    return result;
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_stack( //
+    const fclib_arr_t *const *arrays,   //
+    const size_t count,                 //
+    const size_t element_size,          //
+    const size_t axis                   //
+) {
+    if (count == 0 || axis > arrays[0]->len) {
+        return NULL;
+    }
+    const size_t dimensionality = arrays[0]->len;
+    for (size_t k = 1; k < count; k++) {
+        if (arrays[k]->len != dimensionality ||
+            memcmp(arrays[k]->value, arrays[0]->value,
+                dimensionality * sizeof(size_t)) != 0) {
+            return NULL;
+        }
+    }
+    const size_t *first = FCLIB_ALIGNCAST(const size_t, arrays[0]->value);
+    size_t *lengths = (size_t *)malloc( //
+        (dimensionality + 1 + count) * sizeof(size_t));
+    if (lengths == NULL) {
+        return NULL;
+    }
+    // Every array is one slice of length 1 along the new dimension
+    size_t *extents = lengths + dimensionality + 1;
+    size_t inner = 1;
+    for (size_t i = 0; i < axis; i++) {
+        lengths[i] = first[i];
+        inner *= first[i];
+    }
+    lengths[axis] = count;
+    for (size_t i = axis; i < dimensionality; i++) {
+        lengths[i + 1] = first[i];
+    }
+    for (size_t k = 0; k < count; k++) {
+        extents[k] = 1;
+    }
+    fclib_arr_t *result = fclib_arr_create( //
+        dimensionality + 1, element_size, lengths);
+    if (!fclib_arr_join(result, arrays, count, element_size, inner, extents)) {
+        free(result);
+        result = NULL;
+    }
+    free(lengths);
+    return result;
+}
+
+// A clone is a single allocation starting with this header, followed by the
+// cloned array and all its nested arrays. Every part is padded to the
+// alignment of `max_align_t`, just like separate allocations would be
+typedef struct fclib_arr_slab_t {
+    size_t size;
+} fclib_arr_slab_t;
+
+static size_t fclib_arr_slab_round(const size_t size) {
+    const size_t align = _Alignof(max_align_t);
+    return (size + align - 1) / align * align;
+}
+
+// Returns the size of the array itself in bytes, without its nested arrays
+static size_t fclib_arr_clone_node_size( //
+    const fclib_arr_t *arr,              //
+    const size_t complexity,             //
+    const size_t element_size            //
+) {
+    if (complexity == 0 && element_size == 0) {
+        // A string with its null terminator
+        return sizeof(fclib_str_t) + arr->len + 1;
+    }
+    const size_t size = complexity == 0 ? element_size : sizeof(fclib_arr_t *);
+    return sizeof(fclib_arr_t) + arr->len * sizeof(size_t) +
+        fclib_arr_get_len(arr) * size;
+}
+
+// Returns the size of the array and all its nested arrays in the slab
+static size_t fclib_arr_clone_size( //
+    const fclib_arr_t *arr,         //
+    const size_t complexity,        //
+    const size_t element_size       //
+) {
+    size_t total = fclib_arr_slab_round( //
+        fclib_arr_clone_node_size(arr, complexity, element_size));
+    if (complexity == 0) {
+        return total;
+    }
+    const size_t length = fclib_arr_get_len(arr);
+    fclib_arr_t *const *fields = (fclib_arr_t *const *)(const void *)( //
+        arr->value + arr->len * sizeof(size_t));
+    for (size_t i = 0; i < length; i++) {
+        if (fields[i] != NULL) {
+            total += fclib_arr_clone_size( //
+                fields[i], complexity - 1, element_size);
+        }
+    }
+    return total;
+}
+
+// Copies the array to the cursor and its nested arrays right behind it
+static fclib_arr_t *fclib_arr_clone_into( //
+    const fclib_arr_t *arr,               //
+    const size_t complexity,              //
+    const size_t element_size,            //
+    char **cursor                         //
+) {
+    const size_t node_size = fclib_arr_clone_node_size( //
+        arr, complexity, element_size);
+    fclib_arr_t *copy = (fclib_arr_t *)(void *)*cursor;
+    *cursor += fclib_arr_slab_round(node_size);
+    memcpy(copy, arr, node_size);
+    if (complexity == 0) {
+        return copy;
+    }
+    const size_t length = fclib_arr_get_len(copy);
+    fclib_arr_t **fields = (fclib_arr_t **)(void *)( //
+        copy->value + copy->len * sizeof(size_t));
+    for (size_t i = 0; i < length; i++) {
+        if (fields[i] != NULL) {
+            fields[i] = fclib_arr_clone_into( //
+                fields[i], complexity - 1, element_size, cursor);
+        }
+    }
+    return copy;
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_clone( //
+    const fclib_arr_t *arr,             //
+    const size_t complexity,            //
+    const size_t element_size           //
+) {
+    const size_t header = fclib_arr_slab_round(sizeof(fclib_arr_slab_t));
+    const size_t size = header + //
+        fclib_arr_clone_size(arr, complexity, element_size);
+    char *slab = (char *)malloc(size);
+    if (slab == NULL) {
+        return NULL;
+    }
+    ((fclib_arr_slab_t *)(void *)slab)->size = size;
+    char *cursor = slab + header;
+    return fclib_arr_clone_into(arr, complexity, element_size, &cursor);
+}
+
+// Frees all nested arrays of `arr` which lie outside of the slab [begin, end)
+static void fclib_arr_free_foreign( //
+    fclib_arr_t *arr,               //
+    const size_t complexity,        //
+    const uintptr_t begin,          //
+    const uintptr_t end             //
+) {
+    if (complexity == 0) {
+        return;
+    }
+    const size_t length = fclib_arr_get_len(arr);
+    fclib_arr_t **fields = (fclib_arr_t **)(void *)( //
+        arr->value + arr->len * sizeof(size_t));
+    for (size_t i = 0; i < length; i++) {
+        const uintptr_t address = (uintptr_t)fields[i];
+        if (fields[i] == NULL) {
+            continue;
+        }
+        if (address >= begin && address < end) {
+            fclib_arr_free_foreign(fields[i], complexity - 1, begin, end);
+        } else {
+            fclib_arr_free(fields[i], complexity - 1);
+        }
+    }
+}
+
+FCLIB_API void fclib_arr_free_clone( //
+    fclib_arr_t *arr,                //
+    const size_t complexity          //
+) {
+    const size_t header = fclib_arr_slab_round(sizeof(fclib_arr_slab_t));
+    char *slab = (char *)arr - header;
+    const size_t size = ((const fclib_arr_slab_t *)(void *)slab)->size;
+    fclib_arr_free_foreign( //
+        arr, complexity, (uintptr_t)slab, (uintptr_t)slab + size);
+    free(slab);
+}
+
+// A copy-on-write array is a regular array behind this header, which is
+// padded to the alignment of `max_align_t` like the slab header of clones
+typedef struct fclib_arr_cow_t {
+    atomic_size_t refs;
+} fclib_arr_cow_t;
+
+static fclib_arr_cow_t *fclib_arr_cow_header(const fclib_arr_t *arr) {
+    const size_t header = fclib_arr_slab_round(sizeof(fclib_arr_cow_t));
+    return (fclib_arr_cow_t *)(void *)((char *)(uintptr_t)arr - header);
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_cow_create( //
+    const size_t dimensionality,             //
+    const size_t element_size,               //
+    const size_t *lengths                    //
+) {
+    size_t arr_len = 1;
+    for (size_t i = 0; i < dimensionality; i++) {
+        arr_len *= lengths[i];
+    }
+    const size_t header = fclib_arr_slab_round(sizeof(fclib_arr_cow_t));
+    char *block = (char *)malloc(header + sizeof(fclib_arr_t) +
+        dimensionality * sizeof(size_t) + arr_len * element_size);
+    if (block == NULL) {
+        return NULL;
+    }
+    atomic_init(&((fclib_arr_cow_t *)(void *)block)->refs, 1);
+    fclib_arr_t *arr = (fclib_arr_t *)(void *)(block + header);
+    arr->len = dimensionality;
+    memcpy(arr->value, lengths, dimensionality * sizeof(size_t));
+    return arr;
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_cow_from( //
+    fclib_arr_t *arr,                      //
+    const size_t element_size              //
+) {
+    const size_t header = fclib_arr_slab_round(sizeof(fclib_arr_cow_t));
+    const size_t size = sizeof(fclib_arr_t) + arr->len * sizeof(size_t) +
+        fclib_arr_get_len(arr) * element_size;
+    char *block = (char *)realloc(arr, header + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    memmove(block + header, block, size);
+    atomic_init(&((fclib_arr_cow_t *)(void *)block)->refs, 1);
+    return (fclib_arr_t *)(void *)(block + header);
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_cow_share(fclib_arr_t *arr) {
+    atomic_fetch_add_explicit( //
+        &fclib_arr_cow_header(arr)->refs, 1, memory_order_relaxed);
+    return arr;
+}
+
+FCLIB_API void fclib_arr_cow_release(fclib_arr_t *arr) {
+    fclib_arr_cow_t *cow = fclib_arr_cow_header(arr);
+    // The release ordering makes all writes of other owners visible before
+    // the last owner frees the array
+    if (atomic_fetch_sub_explicit(&cow->refs, 1, memory_order_acq_rel) == 1) {
+        free(cow);
+    }
+}
+
+FCLIB_API size_t fclib_arr_cow_refs(const fclib_arr_t *arr) {
+    return atomic_load_explicit( //
+        &fclib_arr_cow_header(arr)->refs, memory_order_acquire);
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_cow_unique( //
+    fclib_arr_t **arr,                       //
+    const size_t element_size                //
+) {
+    fclib_arr_t *shared = *arr;
+    if (fclib_arr_cow_refs(shared) == 1) {
+        return shared;
+    }
+    const size_t *const dim_lengths = FCLIB_ALIGNCAST( //
+        const size_t, shared->value);
+    fclib_arr_t *copy = fclib_arr_cow_create( //
+        shared->len, element_size, dim_lengths);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(fclib_arr_get_data(copy), fclib_arr_get_data(shared),
+        fclib_arr_get_len(shared) * element_size);
+    fclib_arr_cow_release(shared);
+    *arr = copy;
+    return copy;
+}
+
+// Makes the reference unique for a write which overwrites every element, so
+// a shared array is replaced by a new one without copying its elements
+static fclib_arr_t *fclib_arr_cow_overwrite( //
+    fclib_arr_t **arr,                       //
+    const size_t element_size                //
+) {
+    fclib_arr_t *shared = *arr;
+    if (fclib_arr_cow_refs(shared) == 1) {
+        return shared;
+    }
+    const size_t *const dim_lengths = FCLIB_ALIGNCAST( //
+        const size_t, shared->value);
+    fclib_arr_t *fresh = fclib_arr_cow_create( //
+        shared->len, element_size, dim_lengths);
+    if (fresh == NULL) {
+        return NULL;
+    }
+    fclib_arr_cow_release(shared);
+    *arr = fresh;
+    return fresh;
+}
+
+FCLIB_API bool fclib_arr_cow_assign_at( //
+    fclib_arr_t **arr,                  //
+    const size_t element_size,          //
+    const size_t *indices,              //
+    const void *value                   //
+) {
+    fclib_arr_t *unique = fclib_arr_cow_unique(arr, element_size);
+    if (unique == NULL) {
+        return false;
+    }
+    fclib_arr_assign_at(unique, element_size, indices, value);
+    return true;
+}
+
+FCLIB_API bool fclib_arr_cow_assign_val_at( //
+    fclib_arr_t **arr,                      //
+    const size_t element_size,              //
+    const size_t *indices,                  //
+    const size_t value                      //
+) {
+    fclib_arr_t *unique = fclib_arr_cow_unique(arr, element_size);
+    if (unique == NULL) {
+        return false;
+    }
+    fclib_arr_assign_val_at(unique, element_size, indices, value);
+    return true;
+}
+
+FCLIB_API bool fclib_arr_cow_fill_val( //
+    fclib_arr_t **arr,                 //
+    const size_t element_size,         //
+    const size_t value                 //
+) {
+    fclib_arr_t *unique = fclib_arr_cow_overwrite(arr, element_size);
+    if (unique == NULL) {
+        return false;
+    }
+    fclib_arr_fill_val(unique, element_size, value);
+    return true;
+}
+
+FCLIB_API bool fclib_arr_cow_fill_inline( //
+    fclib_arr_t **arr,                    //
+    const size_t element_size,            //
+    const void *value                     //
+) {
+    fclib_arr_t *unique = fclib_arr_cow_overwrite(arr, element_size);
+    if (unique == NULL) {
+        return false;
+    }
+    fclib_arr_fill_inline(unique, element_size, value);
+    return true;
+}
+
+// Allocates a view with room for the lengths and strides of `dimensionality`
+// dimensions
+static fclib_arr_view_t *fclib_arr_view_alloc( //
+    char *data,                                //
+    const size_t element_size,                 //
+    const size_t dimensionality                //
+) {
+    fclib_arr_view_t *view = (fclib_arr_view_t *)malloc( //
+        sizeof(fclib_arr_view_t) + 2 * dimensionality * sizeof(size_t));
+    if (view == NULL) {
+        return NULL;
+    }
+    view->data = data;
+    view->element_size = element_size;
+    view->len = dimensionality;
+    return view;
+}
+
+FCLIB_API fclib_arr_view_t *fclib_arr_view( //
+    fclib_arr_t *arr,                       //
+    const size_t element_size               //
+) {
+    const size_t dimensionality = arr->len;
+    fclib_arr_view_t *view = fclib_arr_view_alloc( //
+        fclib_arr_get_data(arr), element_size, dimensionality);
+    if (view == NULL) {
+        return NULL;
+    }
+    const size_t *const dim_lengths = FCLIB_ALIGNCAST(const size_t, arr->value);
+    size_t stride = 1;
+    for (size_t i = 0; i < dimensionality; i++) {
+        view->shape[i] = dim_lengths[i];
+        view->shape[dimensionality + i] = stride;
+        stride *= dim_lengths[i];
+    }
+    return view;
+}
+
+FCLIB_API fclib_arr_view_t *fclib_arr_view_slice( //
+    const fclib_arr_view_t *view,                 //
+    const size_t *ranges                          //
+) {
+    const size_t dimensionality = view->len;
+    const size_t *strides = view->shape + dimensionality;
+    size_t new_dimensionality = 0;
+    size_t offset = 0;
+    for (size_t i = 0; i < dimensionality; i++) {
+        const size_t from = ranges[i * 2];
+        const size_t to = ranges[i * 2 + 1];
+        if (from == to) {
+            // A single index
+            if (from >= view->shape[i]) {
+                return NULL;
+            }
+        } else if (from > to || to > view->shape[i]) {
+            return NULL;
+        } else {
+            new_dimensionality++;
+        }
+        offset += from * strides[i];
+    }
+    // Selecting a single element still results in a one-dimensional view
+    const size_t kept = new_dimensionality == 0 ? 1 : new_dimensionality;
+    fclib_arr_view_t *slice = fclib_arr_view_alloc( //
+        view->data + offset * view->element_size, view->element_size, kept);
+    if (slice == NULL) {
+        return NULL;
+    }
+    slice->shape[0] = 1;
+    slice->shape[kept] = 1;
+    size_t index = 0;
+    for (size_t i = 0; i < dimensionality; i++) {
+        const size_t from = ranges[i * 2];
+        const size_t to = ranges[i * 2 + 1];
+        if (from != to) {
+            slice->shape[index] = to - from;
+            slice->shape[kept + index] = strides[i];
+            index++;
+        }
+    }
+    return slice;
+}
+
+FCLIB_API fclib_arr_view_t *fclib_arr_view_reshape( //
+    const fclib_arr_view_t *view,                   //
+    const size_t dimensionality,                    //
+    const size_t *lengths                           //
+) {
+    if (dimensionality == 0) {
+        return NULL;
+    }
+    size_t total_elements = 1;
+    size_t new_total = 1;
+    for (size_t i = 0; i < view->len; i++) {
+        total_elements *= view->shape[i];
+    }
+    for (size_t i = 0; i < dimensionality; i++) {
+        new_total *= lengths[i];
+    }
+    if (new_total != total_elements) {
+        return NULL;
+    }
+    fclib_arr_view_t *result = fclib_arr_view_alloc( //
+        view->data, view->element_size, dimensionality);
+    if (result == NULL) {
+        return NULL;
+    }
+    memcpy(result->shape, lengths, dimensionality * sizeof(size_t));
+    size_t *new_strides = result->shape + dimensionality;
+    if (total_elements == 0) {
+        // Nothing can be accessed, so any strides will do
+        for (size_t i = 0; i < dimensionality; i++) {
+            new_strides[i] = 1;
+        }
+        return result;
+    }
+    // The dimensions of length 1 of the view can be ignored, then groups of
+    // old and new dimensions with the same number of elements are matched up
+    // from the stride-1 end. A group of old dimensions can only be merged or
+    // split if its dimensions are contiguous relative to each other
+    const size_t *old_lengths = view->shape;
+    const size_t *old_strides = view->shape + view->len;
+    size_t *dims = (size_t *)malloc(2 * view->len * sizeof(size_t));
+    if (dims == NULL) {
+        free(result);
+        return NULL;
+    }
+    size_t *strides = dims + view->len;
+    size_t old_dimensionality = 0;
+    for (size_t i = 0; i < view->len; i++) {
+        if (old_lengths[i] != 1) {
+            dims[old_dimensionality] = old_lengths[i];
+            strides[old_dimensionality] = old_strides[i];
+            old_dimensionality++;
+        }
+    }
+    size_t oi = 0;
+    size_t oj = 1;
+    size_t ni = 0;
+    size_t nj = 1;
+    while (ni < dimensionality && oi < old_dimensionality) {
+        size_t new_count = lengths[ni];
+        size_t old_count = dims[oi];
+        while (new_count != old_count) {
+            if (new_count < old_count) {
+                new_count *= lengths[nj++];
+            } else {
+                old_count *= dims[oj++];
+            }
+        }
+        for (size_t k = oi; k + 1 < oj; k++) {
+            if (strides[k + 1] != dims[k] * strides[k]) {
+                free(dims);
+                free(result);
+                return NULL;
+            }
+        }
+        new_strides[ni] = strides[oi];
+        for (size_t k = ni + 1; k < nj; k++) {
+            new_strides[k] = new_strides[k - 1] * lengths[k - 1];
+        }
+        ni = nj++;
+        oi = oj++;
+    }
+    // Trailing dimensions of length 1 are never stepped along
+    const size_t last_stride = ni > 0 ? new_strides[ni - 1] * lengths[ni - 1]
+                                      : 1;
+    for (size_t k = ni; k < dimensionality; k++) {
+        new_strides[k] = last_stride;
+    }
+    free(dims);
+    return result;
+}
+
+FCLIB_API fclib_arr_view_t *fclib_arr_view_flatten( //
+    const fclib_arr_view_t *view                    //
+) {
+    size_t total_elements = 1;
+    for (size_t i = 0; i < view->len; i++) {
+        total_elements *= view->shape[i];
+    }
+    return fclib_arr_view_reshape(view, 1, &total_elements);
+}
+
+FCLIB_API fclib_arr_view_t *fclib_arr_view_squeeze( //
+    const fclib_arr_view_t *view                    //
+) {
+    size_t new_dimensionality = 0;
+    for (size_t i = 0; i < view->len; i++) {
+        if (view->shape[i] != 1) {
+            new_dimensionality++;
+        }
+    }
+    const size_t kept = new_dimensionality == 0 ? 1 : new_dimensionality;
+    fclib_arr_view_t *result = fclib_arr_view_alloc( //
+        view->data, view->element_size, kept);
+    if (result == NULL) {
+        return NULL;
+    }
+    result->shape[0] = 1;
+    result->shape[kept] = 1;
+    size_t index = 0;
+    for (size_t i = 0; i < view->len; i++) {
+        if (view->shape[i] != 1) {
+            result->shape[index] = view->shape[i];
+            result->shape[kept + index] = view->shape[view->len + i];
+            index++;
+        }
+    }
+    return result;
+}
+
+FCLIB_API char *fclib_arr_view_access( //
+    const fclib_arr_view_t *view,      //
+    const size_t *indices              //
+) {
+    size_t offset = 0;
+    for (size_t i = 0; i < view->len; i++) {
+        if (indices[i] >= view->shape[i]) {
+            // Out of bounds access
+            return NULL;
+        }
+        offset += indices[i] * view->shape[view->len + i];
+    }
+    return view->data + offset * view->element_size;
+}
+
+FCLIB_API fclib_arr_t *fclib_arr_view_copy(const fclib_arr_view_t *view) {
+    const size_t dimensionality = view->len;
+    const size_t element_size = view->element_size;
+    const size_t *strides = view->shape + dimensionality;
+    fclib_arr_t *result = fclib_arr_create( //
+        dimensionality, element_size, view->shape);
+    const size_t total_elements = fclib_arr_get_len(result);
+    if (total_elements == 0) {
+        return result;
+    }
+    // The leading dimensions which are contiguous in the view form one run
+    size_t run = 1;
+    size_t merged = 0;
+    while (merged < dimensionality && strides[merged] == run) {
+        run *= view->shape[merged];
+        merged++;
+    }
+    size_t *current_indices = (size_t *)calloc( //
+        dimensionality + 1, sizeof(size_t));
+    char *dest = fclib_arr_get_data(result);
+    size_t offset = 0;
+    for (size_t done = 0; done < total_elements; done += run) {
+        memcpy(dest + done * element_size, view->data + offset * element_size,
+            run * element_size);
+        for (size_t i = merged; i < dimensionality; i++) {
+            offset += strides[i];
+            if (++current_indices[i] < view->shape[i]) {
+                break;
+            }
+            offset -= strides[i] * view->shape[i];
+            current_indices[i] = 0;
+        }
+    }
+    free(current_indices);
+    return result;
+}
+
+// Creates the squeezed view of the region `ranges` of `arr`
+static fclib_arr_view_t *fclib_arr_view_region( //
+    fclib_arr_t *arr,                           //
+    const size_t element_size,                  //
+    const size_t *ranges                        //
+) {
+    fclib_arr_view_t *whole = fclib_arr_view(arr, element_size);
+    if (whole == NULL) {
+        return NULL;
+    }
+    fclib_arr_view_t *slice = fclib_arr_view_slice(whole, ranges);
+    free(whole);
+    if (slice == NULL) {
+        return NULL;
+    }
+    fclib_arr_view_t *region = fclib_arr_view_squeeze(slice);
+    free(slice);
+    return region;
+}
+
+// Copies all elements of `src` into `dest`. Both are squeezed views of the
+// same shape, the leading dimensions in which both are contiguous are copied
+// as one run
+static void fclib_arr_view_assign( //
+    const fclib_arr_view_t *dest,  //
+    const fclib_arr_view_t *src    //
+) {
+    const size_t dimensionality = dest->len;
+    const size_t element_size = dest->element_size;
+    const size_t *dest_strides = dest->shape + dimensionality;
+    const size_t *src_strides = src->shape + dimensionality;
+    size_t total_elements = 1;
+    for (size_t i = 0; i < dimensionality; i++) {
+        total_elements *= dest->shape[i];
+    }
+    if (total_elements == 0) {
+        return;
+    }
+    size_t run = 1;
+    size_t merged = 0;
+    while (merged < dimensionality && dest_strides[merged] == run &&
+        src_strides[merged] == run) {
+        run *= dest->shape[merged];
+        merged++;
+    }
+    size_t *current_indices = (size_t *)calloc( //
+        dimensionality + 1, sizeof(size_t));
+    size_t dest_offset = 0;
+    size_t src_offset = 0;
+    for (size_t done = 0; done < total_elements; done += run) {
+        memcpy(dest->data + dest_offset * element_size,
+            src->data + src_offset * element_size, run * element_size);
+        for (size_t i = merged; i < dimensionality; i++) {
+            dest_offset += dest_strides[i];
+            src_offset += src_strides[i];
+            if (++current_indices[i] < dest->shape[i]) {
+                break;
+            }
+            dest_offset -= dest_strides[i] * dest->shape[i];
+            src_offset -= src_strides[i] * dest->shape[i];
+            current_indices[i] = 0;
+        }
+    }
+    free(current_indices);
+}
+
+FCLIB_API bool fclib_arr_set_slice( //
+    fclib_arr_t *dest,              //
+    const size_t element_size,      //
+    const size_t *ranges,           //
+    const fclib_arr_t *src          //
+) {
+    // The source is only read, the view just is not const-qualified
+    fclib_arr_view_t *whole = fclib_arr_view( //
+        (fclib_arr_t *)(uintptr_t)src, element_size);
+    if (whole == NULL) {
+        return false;
+    }
+    const bool result = fclib_arr_set_slice_view(dest, ranges, whole);
+    free(whole);
+    return result;
+}
+
+FCLIB_API bool fclib_arr_set_slice_view( //
+    fclib_arr_t *dest,                   //
+    const size_t *ranges,                //
+    const fclib_arr_view_t *src          //
+) {
+    fclib_arr_view_t *region = fclib_arr_view_region( //
+        dest, src->element_size, ranges);
+    if (region == NULL) {
+        return false;
+    }
+    fclib_arr_view_t *source = fclib_arr_view_squeeze(src);
+    if (source == NULL) {
+        free(region);
+        return false;
+    }
+    const bool matches = source->len == region->len &&
+        memcmp(source->shape, region->shape, region->len * sizeof(size_t)) ==
+            0;
+    if (matches) {
+        fclib_arr_view_assign(region, source);
+    }
+    free(source);
+    free(region);
+    return matches;
+}
+
+FCLIB_API bool fclib_arr_fill_slice( //
+    fclib_arr_t *dest,               //
+    const size_t element_size,       //
+    const size_t *ranges,            //
+    const void *value                //
+) {
+    fclib_arr_view_t *region = fclib_arr_view_region( //
+        dest, element_size, ranges);
+    if (region == NULL) {
+        return false;
+    }
+    const size_t dimensionality = region->len;
+    const size_t *strides = region->shape + dimensionality;
+    size_t total_elements = 1;
+    for (size_t i = 0; i < dimensionality; i++) {
+        total_elements *= region->shape[i];
+    }
+    if (total_elements == 0) {
+        free(region);
+        return true;
+    }
+    size_t run = 1;
+    size_t merged = 0;
+    while (merged < dimensionality && strides[merged] == run) {
+        run *= region->shape[merged];
+        merged++;
+    }
+    const size_t run_size = run * element_size;
+    // A value made of a single repeated byte can be written with memset,
+    // otherwise the first run is filled by doubling and copied to all others
+    const unsigned char *bytes = (const unsigned char *)value;
+    bool uniform = true;
+    for (size_t i = 1; i < element_size && uniform; i++) {
+        uniform = bytes[i] == bytes[0];
+    }
+    char *first_run = region->data;
+    if (!uniform) {
+        memcpy(first_run, value, element_size);
+        size_t filled = element_size;
+        while (filled < run_size) {
+            const size_t to_copy = filled <= run_size - filled
+                ? filled
+                : run_size - filled;
+            memcpy(first_run + filled, first_run, to_copy);
+            filled += to_copy;
+        }
+    }
+    size_t *current_indices = (size_t *)calloc( //
+        dimensionality + 1, sizeof(size_t));
+    size_t offset = 0;
+    for (size_t done = 0; done < total_elements; done += run) {
+        char *target = region->data + offset * element_size;
+        if (uniform) {
+            memset(target, bytes[0], run_size);
+        } else if (done != 0) {
+            memcpy(target, first_run, run_size);
+        }
+        for (size_t i = merged; i < dimensionality; i++) {
+            offset += strides[i];
+            if (++current_indices[i] < region->shape[i]) {
+                break;
+            }
+            offset -= strides[i] * region->shape[i];
+            current_indices[i] = 0;
+        }
+    }
+    free(current_indices);
+    free(region);
+    return true;
+}
+
+#endif // endof FCLIB_MINIMAL
 #endif // endof FCLIB_IMPLEMENTATION
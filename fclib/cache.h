@@ -0,0 +1,633 @@
+#pragma once
+
+// The cache needs the POSIX.1-2008 file APIs (nanosecond timestamps, futimens)
+// and system.h, which both need _GNU_SOURCE. This only takes effect when this
+// header is included before any system header, otherwise compile with
+// -D_GNU_SOURCE, which is checked below
+#if !defined(__WIN32__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "checksum.h"
+#include "encoding.h"
+#include "str.h"
+#include "system.h"
+
+#ifdef FCLIB_MINIMAL
+#error "cache.h builds on checksum.h, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __WIN32__
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// glibc settles which APIs it declares at the first system header, so the
+// _GNU_SOURCE above comes too late if another header was included before
+#if defined(__GLIBC__) && !defined(__USE_GNU)
+#error "cache.h needs _GNU_SOURCE, compile with -D_GNU_SOURCE"
+#endif
+
+/// @typedef `file_fingerprint_t`
+/// @brief The identity of an input file of a cached command. The content hash
+/// is only recomputed when the size, modification time, change time or inode
+/// of the file differ from the remembered ones.
+typedef struct fclib_file_fingerprint_t {
+    fclib_str_t *path;
+    uint64_t path_hash;
+    uint64_t size;
+    int64_t mtime_ns;
+    int64_t ctime_ns;
+    uint64_t inode;
+    uint64_t content_hash;
+    bool exists;
+} fclib_file_fingerprint_t;
+
+/// @typedef `command_cache_t`
+/// @brief A content addressed, on-disk cache of command results. Every entry is
+/// a file in `dir` named after the hash of everything the command depends on.
+/// Entries which have not been used for the longest time are evicted once the
+/// total size of all entries exceeds `max_bytes`. Multiple processes may share
+/// the same cache directory.
+typedef struct fclib_command_cache_t {
+    fclib_str_t *dir;
+    size_t max_bytes;
+    size_t total_bytes;
+    size_t hits;
+    size_t misses;
+    // Open addressing table of the fingerprints of all input files seen so far
+    fclib_file_fingerprint_t *fingerprints;
+    size_t fingerprint_count;
+    size_t fingerprint_cap;
+} fclib_command_cache_t;
+
+/// @function `command_cache_init`
+/// @brief Opens the cache in the given directory, creating the directory (and
+/// its parents) if needed. If the directory can not be created the `dir` field
+/// of the returned cache is NULL and all commands run uncached.
+///
+/// @param `dir` The directory to keep the cache entries in
+/// @param `max_bytes` The total size of all entries before the least recently
+/// used ones are evicted, 0 for no limit
+/// @return `command_cache_t` The opened cache
+FCLIB_API fclib_command_cache_t fclib_command_cache_init( //
+    const fclib_str_t *dir,                               //
+    const size_t max_bytes                                //
+);
+
+/// @function `command_cache_run`
+/// @brief Returns the result of the given command from the cache, or runs it
+/// with `system_command` and stores its result if it has not been run with the
+/// same inputs before. The cache key is the hash of the command, the current
+/// working directory, the values of the given environment variables and the
+/// content of the given input files. Commands which could not be spawned are
+/// not cached.
+///
+/// @param `cache` The cache to use
+/// @param `command` The command to execute
+/// @param `env_names` A 1D array of `str_t *` names of the environment
+/// variables the command depends on, or NULL
+/// @param `input_files` A 1D array of `str_t *` paths of the files the command
+/// reads, or NULL
+/// @return `command_result_t` The result of the command, exactly as
+/// `system_command` would have returned it. The resource usage of results
+/// served from the cache is all zero.
+FCLIB_API fclib_command_result_t fclib_command_cache_run( //
+    fclib_command_cache_t *cache,                         //
+    fclib_str_t *const command,                           //
+    const fclib_arr_t *env_names,                         //
+    const fclib_arr_t *input_files                        //
+);
+
+/// @function `command_cache_evict`
+/// @brief Removes the least recently used entries until the total size of all
+/// entries is at most `max_bytes`. This happens automatically whenever a new
+/// entry pushes the cache over its limit.
+///
+/// @param `cache` The cache to evict entries from
+/// @param `max_bytes` The size the cache should shrink to
+FCLIB_API void fclib_command_cache_evict( //
+    fclib_command_cache_t *cache,         //
+    const size_t max_bytes                //
+);
+
+/// @function `command_cache_free`
+/// @brief Frees the in-memory state of the cache, the entries on disk are kept
+///
+/// @param `cache` The cache to free
+FCLIB_API void fclib_command_cache_free(fclib_command_cache_t *cache);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_file_fingerprint_t file_fingerprint_t;
+typedef fclib_command_cache_t command_cache_t;
+
+FCLIB_API static inline command_cache_t command_cache_init( //
+    const fclib_str_t *dir,                                 //
+    const size_t max_bytes                                  //
+) {
+    return fclib_command_cache_init(dir, max_bytes);
+}
+FCLIB_API static inline fclib_command_result_t command_cache_run( //
+    command_cache_t *cache,                                       //
+    fclib_str_t *const command,                                   //
+    const fclib_arr_t *env_names,                                 //
+    const fclib_arr_t *input_files                                //
+) {
+    return fclib_command_cache_run(cache, command, env_names, input_files);
+}
+FCLIB_API static inline void command_cache_evict( //
+    command_cache_t *cache,                       //
+    const size_t max_bytes                        //
+) {
+    fclib_command_cache_evict(cache, max_bytes);
+}
+FCLIB_API static inline void command_cache_free(command_cache_t *cache) {
+    fclib_command_cache_free(cache);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+// Entry layout: magic, format version, exit code, terminating signal, status
+// flags, output length, output bytes and a CRC32C of everything before it
+#define FCLIB_CACHE_MAGIC 0x434C4346u
+#define FCLIB_CACHE_VERSION 2u
+#define FCLIB_CACHE_HEADER_SIZE 28
+#define FCLIB_CACHE_KEY_LEN 32
+
+#ifndef __WIN32__
+
+// Returns the path of the file `name` inside the cache directory
+static fclib_str_t *fclib_command_cache_path( //
+    const fclib_command_cache_t *cache,       //
+    const char *name                          //
+) {
+    fclib_str_builder_t path = fclib_str_builder_init(cache->dir->len + 64);
+    fclib_str_builder_append(&path, cache->dir);
+    fclib_str_builder_append_char(&path, '/');
+    fclib_str_builder_append_lit(&path, name, strlen(name));
+    return fclib_str_builder_finish(&path);
+}
+
+static bool fclib_command_cache_is_entry(const char *name) {
+    size_t len = 0;
+    for (; name[len] != '\0'; len++) {
+        const char c = name[len];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+            return false;
+        }
+    }
+    return len == FCLIB_CACHE_KEY_LEN;
+}
+
+static bool fclib_command_cache_write_all( //
+    const int fd,                          //
+    const char *data,                      //
+    size_t len                             //
+) {
+    while (len > 0) {
+        const ssize_t written = write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+// Looks up the fingerprint slot of the given path, which is either the slot
+// already holding it or the empty slot it belongs into
+static fclib_file_fingerprint_t *fclib_command_cache_slot( //
+    fclib_command_cache_t *cache,                          //
+    const fclib_str_t *path,                               //
+    const uint64_t path_hash                               //
+) {
+    const size_t mask = cache->fingerprint_cap - 1;
+    size_t index = (size_t)path_hash & mask;
+    while (true) {
+        fclib_file_fingerprint_t *slot = &cache->fingerprints[index];
+        if (slot->path == NULL ||
+            (slot->path_hash == path_hash && slot->path->len == path->len &&
+                memcmp(slot->path->value, path->value, path->len) == 0)) {
+            return slot;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+// Returns the fingerprint of the given file, hashing its content only if the
+// file changed since it was last seen
+static const fclib_file_fingerprint_t *fclib_command_cache_fingerprint( //
+    fclib_command_cache_t *cache,                                       //
+    const fclib_str_t *path                                             //
+) {
+    // Keep the table at most half full
+    if ((cache->fingerprint_count + 1) * 2 > cache->fingerprint_cap) {
+        const size_t old_cap = cache->fingerprint_cap;
+        fclib_file_fingerprint_t *old = cache->fingerprints;
+        cache->fingerprint_cap = old_cap == 0 ? 64 : old_cap * 2;
+        cache->fingerprints = (fclib_file_fingerprint_t *)calloc( //
+            cache->fingerprint_cap, sizeof(fclib_file_fingerprint_t));
+        for (size_t i = 0; i < old_cap; i++) {
+            if (old[i].path == NULL) {
+                continue;
+            }
+            fclib_file_fingerprint_t *slot = fclib_command_cache_slot( //
+                cache, old[i].path, old[i].path_hash);
+            *slot = old[i];
+        }
+        free(old);
+    }
+    const uint64_t path_hash = fclib_xxh64(path->value, path->len, 0);
+    fclib_file_fingerprint_t *slot = fclib_command_cache_slot( //
+        cache, path, path_hash);
+    if (slot->path == NULL) {
+        slot->path = fclib_str_init(path->value, path->len);
+        slot->path_hash = path_hash;
+        slot->exists = false;
+        cache->fingerprint_count++;
+    }
+    struct stat file_stat;
+    if (stat(path->value, &file_stat) != 0) {
+        slot->exists = false;
+        return slot;
+    }
+    const int64_t mtime_ns = (int64_t)file_stat.st_mtim.tv_sec * 1000000000 +
+        file_stat.st_mtim.tv_nsec;
+    const int64_t ctime_ns = (int64_t)file_stat.st_ctim.tv_sec * 1000000000 +
+        file_stat.st_ctim.tv_nsec;
+    if (slot->exists && slot->size == (uint64_t)file_stat.st_size &&
+        slot->mtime_ns == mtime_ns && slot->ctime_ns == ctime_ns &&
+        slot->inode == (uint64_t)file_stat.st_ino) {
+        return slot;
+    }
+    fclib_checksum_t checksum = fclib_checksum_init(FCLIB_CHECKSUM_XXH64, 0);
+    slot->exists = fclib_checksum_update_file(&checksum, path);
+    slot->content_hash = fclib_checksum_digest(&checksum);
+    slot->size = (uint64_t)file_stat.st_size;
+    slot->mtime_ns = mtime_ns;
+    slot->ctime_ns = ctime_ns;
+    slot->inode = (uint64_t)file_stat.st_ino;
+    return slot;
+}
+
+// Computes the 128 bit key of a command invocation as 32 hex characters
+static void fclib_command_cache_key(   //
+    fclib_command_cache_t *cache,      //
+    const fclib_str_t *command,        //
+    const fclib_arr_t *env_names,      //
+    const fclib_arr_t *input_files,    //
+    char key[FCLIB_CACHE_KEY_LEN + 1]  //
+) {
+    // Every part is length-prefixed, so no two different invocations can
+    // serialize to the same bytes
+    fclib_str_builder_t material = fclib_str_builder_init(256);
+    fclib_str_builder_append_lit(&material, "fclib-command-cache-v1", 22);
+    fclib_str_builder_append_u64(&material, command->len);
+    fclib_str_builder_append_char(&material, ':');
+    fclib_str_builder_append(&material, command);
+    fclib_str_t *cwd = fclib_system_get_cwd();
+    fclib_str_builder_append_u64(&material, cwd->len);
+    fclib_str_builder_append_char(&material, ':');
+    fclib_str_builder_append(&material, cwd);
+    free(cwd);
+    if (env_names != NULL) {
+        const size_t count = fclib_arr_get_len(env_names);
+        fclib_str_t *const *names = (fclib_str_t *const *)(const void *)(
+            env_names->value + env_names->len * sizeof(size_t));
+        for (size_t i = 0; i < count; i++) {
+            const char *value = getenv(names[i]->value);
+            fclib_str_builder_append_u64(&material, names[i]->len);
+            fclib_str_builder_append_char(&material, ':');
+            fclib_str_builder_append(&material, names[i]);
+            if (value == NULL) {
+                // Unset and empty variables are different inputs
+                fclib_str_builder_append_char(&material, '!');
+                continue;
+            }
+            const size_t value_len = strlen(value);
+            fclib_str_builder_append_u64(&material, value_len);
+            fclib_str_builder_append_char(&material, ':');
+            fclib_str_builder_append_lit(&material, value, value_len);
+        }
+    }
+    if (input_files != NULL) {
+        const size_t count = fclib_arr_get_len(input_files);
+        fclib_str_t *const *paths = (fclib_str_t *const *)(const void *)(
+            input_files->value + input_files->len * sizeof(size_t));
+        for (size_t i = 0; i < count; i++) {
+            const fclib_file_fingerprint_t *fingerprint =
+                fclib_command_cache_fingerprint(cache, paths[i]);
+            fclib_str_builder_append_u64(&material, paths[i]->len);
+            fclib_str_builder_append_char(&material, ':');
+            fclib_str_builder_append(&material, paths[i]);
+            if (!fingerprint->exists) {
+                fclib_str_builder_append_char(&material, '!');
+                continue;
+            }
+            fclib_str_builder_append_u64(&material, fingerprint->content_hash);
+            fclib_str_builder_append_char(&material, ':');
+        }
+    }
+    const fclib_str_t *data = material.str;
+    uint64_t hash[2];
+    hash[0] = fclib_xxh64(data->value, data->len, 0);
+    hash[1] = fclib_xxh64(data->value, data->len, hash[0]);
+    fclib_hex_encode_to(key, (const char *)hash, sizeof(hash));
+    key[FCLIB_CACHE_KEY_LEN] = '\0';
+    fclib_str_builder_free(&material);
+}
+
+// Reads the entry with the given key and marks it as recently used
+static bool fclib_command_cache_load( //
+    fclib_command_cache_t *cache,     //
+    const char *key,                  //
+    fclib_command_result_t *result    //
+) {
+    fclib_str_t *path = fclib_command_cache_path(cache, key);
+    const int fd = open(path->value, O_RDONLY);
+    free(path);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 ||
+        (size_t)file_stat.st_size < FCLIB_CACHE_HEADER_SIZE + 4) {
+        close(fd);
+        return false;
+    }
+    const size_t size = (size_t)file_stat.st_size;
+    char *data = (char *)malloc(size);
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t got = read(fd, data + done, size - done);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        done += (size_t)got;
+    }
+    // The modification time doubles as the last use time for the eviction
+    if (done == size) {
+        futimens(fd, NULL);
+    }
+    close(fd);
+    uint32_t magic;
+    uint32_t version;
+    int32_t exit_code;
+    int32_t term_signal;
+    uint32_t flags;
+    uint64_t output_len;
+    uint32_t stored_crc;
+    memcpy(&magic, data, 4);
+    memcpy(&version, data + 4, 4);
+    memcpy(&exit_code, data + 8, 4);
+    memcpy(&term_signal, data + 12, 4);
+    memcpy(&flags, data + 16, 4);
+    memcpy(&output_len, data + 20, 8);
+    memcpy(&stored_crc, data + size - 4, 4);
+    if (done != size || magic != FCLIB_CACHE_MAGIC ||
+        version != FCLIB_CACHE_VERSION ||
+        output_len != size - FCLIB_CACHE_HEADER_SIZE - 4 ||
+        fclib_crc32c(0, data, size - 4) != stored_crc) {
+        free(data);
+        return false;
+    }
+    result->exit_code = exit_code;
+    result->term_signal = term_signal;
+    result->exited = (flags & 1) != 0;
+    result->core_dumped = (flags & 2) != 0;
+    result->output = fclib_str_init( //
+        data + FCLIB_CACHE_HEADER_SIZE, (size_t)output_len);
+    free(data);
+    return true;
+}
+
+// Writes the entry to a temporary file first and renames it into place, so
+// concurrent readers never see a partially written entry
+static void fclib_command_cache_store(      //
+    fclib_command_cache_t *cache,           //
+    const char *key,                        //
+    const fclib_command_result_t *result    //
+) {
+    const size_t size = FCLIB_CACHE_HEADER_SIZE + result->output->len + 4;
+    char *data = (char *)malloc(size);
+    const uint32_t magic = FCLIB_CACHE_MAGIC;
+    const uint32_t version = FCLIB_CACHE_VERSION;
+    const int32_t exit_code = result->exit_code;
+    const int32_t term_signal = result->term_signal;
+    const uint32_t flags = (result->exited ? 1u : 0u) |
+        (result->core_dumped ? 2u : 0u);
+    const uint64_t output_len = result->output->len;
+    memcpy(data, &magic, 4);
+    memcpy(data + 4, &version, 4);
+    memcpy(data + 8, &exit_code, 4);
+    memcpy(data + 12, &term_signal, 4);
+    memcpy(data + 16, &flags, 4);
+    memcpy(data + 20, &output_len, 8);
+    memcpy(data + FCLIB_CACHE_HEADER_SIZE, result->output->value,
+        result->output->len);
+    const uint32_t crc = fclib_crc32c(0, data, size - 4);
+    memcpy(data + size - 4, &crc, 4);
+
+    char tmp_name[FCLIB_CACHE_KEY_LEN + 32];
+    snprintf(tmp_name, sizeof(tmp_name), "%s.tmp%ld", key, (long)getpid());
+    fclib_str_t *tmp_path = fclib_command_cache_path(cache, tmp_name);
+    fclib_str_t *path = fclib_command_cache_path(cache, key);
+    const int fd = open(tmp_path->value, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        const bool written = fclib_command_cache_write_all(fd, data, size);
+        if (close(fd) == 0 && written &&
+            rename(tmp_path->value, path->value) == 0) {
+            cache->total_bytes += size;
+        } else {
+            unlink(tmp_path->value);
+        }
+    }
+    free(tmp_path);
+    free(path);
+    free(data);
+    if (cache->max_bytes != 0 && cache->total_bytes > cache->max_bytes) {
+        // Evict a bit more than needed so not every store triggers a scan
+        fclib_command_cache_evict(cache, cache->max_bytes / 10 * 9);
+    }
+}
+
+typedef struct fclib_cache_entry_info_t {
+    char name[FCLIB_CACHE_KEY_LEN + 1];
+    int64_t mtime_ns;
+    size_t size;
+} fclib_cache_entry_info_t;
+
+static int fclib_cache_entry_compare(const void *a, const void *b) {
+    const fclib_cache_entry_info_t *lhs = (const fclib_cache_entry_info_t *)a;
+    const fclib_cache_entry_info_t *rhs = (const fclib_cache_entry_info_t *)b;
+    return (lhs->mtime_ns > rhs->mtime_ns) - (lhs->mtime_ns < rhs->mtime_ns);
+}
+
+#endif // endof __WIN32__
+
+FCLIB_API fclib_command_cache_t fclib_command_cache_init( //
+    const fclib_str_t *dir,                               //
+    const size_t max_bytes                                //
+) {
+    fclib_command_cache_t cache;
+    memset(&cache, 0, sizeof(cache));
+    cache.max_bytes = max_bytes;
+#ifndef __WIN32__
+    if (dir->len == 0) {
+        return cache;
+    }
+    // Create all missing directories along the path
+    fclib_str_t *path = fclib_str_init(dir->value, dir->len);
+    for (size_t i = 1; i <= path->len; i++) {
+        if (i < path->len && path->value[i] != '/') {
+            continue;
+        }
+        path->value[i] = '\0';
+        mkdir(path->value, 0755);
+        if (i < path->len) {
+            path->value[i] = '/';
+        }
+    }
+    struct stat dir_stat;
+    if (stat(path->value, &dir_stat) != 0 || !S_ISDIR(dir_stat.st_mode)) {
+        free(path);
+        return cache;
+    }
+    cache.dir = path;
+    // Scanning with an infinite limit only sums up the size of all entries
+    fclib_command_cache_evict(&cache, SIZE_MAX);
+#else
+    (void)dir;
+#endif
+    return cache;
+}
+
+FCLIB_API fclib_command_result_t fclib_command_cache_run( //
+    fclib_command_cache_t *cache,                         //
+    fclib_str_t *const command,                           //
+    const fclib_arr_t *env_names,                         //
+    const fclib_arr_t *input_files                        //
+) {
+#ifndef __WIN32__
+    if (cache->dir != NULL && command->len > 0) {
+        char key[FCLIB_CACHE_KEY_LEN + 1];
+        fclib_command_cache_key(cache, command, env_names, input_files, key);
+        fclib_command_result_t result;
+        memset(&result, 0, sizeof(result));
+        if (fclib_command_cache_load(cache, key, &result)) {
+            cache->hits++;
+            return result;
+        }
+        cache->misses++;
+        result = fclib_system_command(command);
+        if (result.output != NULL) {
+            fclib_command_cache_store(cache, key, &result);
+        }
+        return result;
+    }
+#else
+    (void)env_names;
+    (void)input_files;
+#endif
+    cache->misses++;
+    return fclib_system_command(command);
+}
+
+FCLIB_API void fclib_command_cache_evict( //
+    fclib_command_cache_t *cache,         //
+    const size_t max_bytes                //
+) {
+#ifndef __WIN32__
+    if (cache->dir == NULL) {
+        return;
+    }
+    DIR *dir = opendir(cache->dir->value);
+    if (dir == NULL) {
+        return;
+    }
+    fclib_cache_entry_info_t *entries = NULL;
+    size_t count = 0;
+    size_t cap = 0;
+    size_t total = 0;
+    const int dir_fd = dirfd(dir);
+    struct dirent *dir_entry;
+    while ((dir_entry = readdir(dir)) != NULL) {
+        struct stat file_stat;
+        if (!fclib_command_cache_is_entry(dir_entry->d_name) ||
+            fstatat(dir_fd, dir_entry->d_name, &file_stat, 0) != 0 ||
+            !S_ISREG(file_stat.st_mode)) {
+            continue;
+        }
+        if (count == cap) {
+            cap = cap == 0 ? 64 : cap * 2;
+            entries = (fclib_cache_entry_info_t *)realloc( //
+                entries, cap * sizeof(fclib_cache_entry_info_t));
+        }
+        fclib_cache_entry_info_t *info = &entries[count++];
+        memcpy(info->name, dir_entry->d_name, FCLIB_CACHE_KEY_LEN + 1);
+        info->mtime_ns = (int64_t)file_stat.st_mtim.tv_sec * 1000000000 +
+            file_stat.st_mtim.tv_nsec;
+        info->size = (size_t)file_stat.st_size;
+        total += info->size;
+    }
+    if (total > max_bytes) {
+        qsort(entries, count, sizeof(fclib_cache_entry_info_t),
+            fclib_cache_entry_compare);
+        for (size_t i = 0; i < count && total > max_bytes; i++) {
+            if (unlinkat(dir_fd, entries[i].name, 0) == 0) {
+                total -= entries[i].size;
+            }
+        }
+    }
+    closedir(dir);
+    free(entries);
+    cache->total_bytes = total;
+#else
+    (void)cache;
+    (void)max_bytes;
+#endif
+}
+
+FCLIB_API void fclib_command_cache_free(fclib_command_cache_t *cache) {
+    for (size_t i = 0; i < cache->fingerprint_cap; i++) {
+        free(cache->fingerprints[i].path);
+    }
+    free(cache->fingerprints);
+    free(cache->dir);
+    memset(cache, 0, sizeof(*cache));
+}
+
+#endif // endof FCLIB_IMPLEMENTATION
@@ -0,0 +1,886 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "cpu.h"
+#include "str.h"
+
+#ifdef FCLIB_MINIMAL
+#error "checksum.h builds on string views, which are not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// @enum `checksum_kind_t`
+/// @brief The checksum algorithms the streaming `checksum_t` state supports
+typedef enum fclib_checksum_kind_t {
+    FCLIB_CHECKSUM_CRC32C,
+    FCLIB_CHECKSUM_ADLER32,
+    FCLIB_CHECKSUM_XXH32,
+    FCLIB_CHECKSUM_XXH64,
+} fclib_checksum_kind_t;
+
+/// @typedef `checksum_t`
+/// @brief The incremental state of a checksum computation. Data can be fed to
+/// it in pieces of any size and the result is the same as if all data had been
+/// checksummed at once. The state is a plain value and can be copied freely.
+typedef struct fclib_checksum_t {
+    fclib_checksum_kind_t kind;
+    uint64_t seed;
+    uint64_t total_len;
+    // CRC32C and Adler-32 only use the first accumulator, xxHash uses all four
+    // lanes and buffers input until it has a full stripe
+    uint64_t acc[4];
+    unsigned char buffer[32];
+    size_t buffered;
+} fclib_checksum_t;
+
+/// @function `crc32c`
+/// @brief Continues the CRC32C (Castagnoli) checksum `crc` over `len` bytes of
+/// `data`. Start with a `crc` of 0. Uses the SSE4.2 `crc32` instruction on
+/// three interleaved streams when the CPU supports it and a slicing-by-8 table
+/// implementation otherwise.
+///
+/// @param `crc` The checksum of all previous data, 0 for the first call
+/// @param `data` The data to checksum
+/// @param `len` The number of bytes to checksum
+/// @return `uint32_t` The checksum of all data so far
+FCLIB_API uint32_t fclib_crc32c( //
+    const uint32_t crc,          //
+    const void *data,            //
+    const size_t len             //
+);
+
+/// @function `adler32`
+/// @brief Continues the Adler-32 checksum `adler` over `len` bytes of `data`.
+/// Start with an `adler` of 1.
+///
+/// @param `adler` The checksum of all previous data, 1 for the first call
+/// @param `data` The data to checksum
+/// @param `len` The number of bytes to checksum
+/// @return `uint32_t` The checksum of all data so far
+FCLIB_API uint32_t fclib_adler32( //
+    const uint32_t adler,         //
+    const void *data,             //
+    const size_t len              //
+);
+
+/// @function `xxh32`
+/// @brief Computes the 32 bit xxHash of `len` bytes of `data`
+///
+/// @param `data` The data to hash
+/// @param `len` The number of bytes to hash
+/// @param `seed` The seed of the hash
+/// @return `uint32_t` The hash of the data
+FCLIB_API uint32_t fclib_xxh32( //
+    const void *data,           //
+    const size_t len,           //
+    const uint32_t seed         //
+);
+
+/// @function `xxh64`
+/// @brief Computes the 64 bit xxHash of `len` bytes of `data`
+///
+/// @param `data` The data to hash
+/// @param `len` The number of bytes to hash
+/// @param `seed` The seed of the hash
+/// @return `uint64_t` The hash of the data
+FCLIB_API uint64_t fclib_xxh64( //
+    const void *data,           //
+    const size_t len,           //
+    const uint64_t seed         //
+);
+
+/// @function `checksum_init`
+/// @brief Creates a new incremental checksum state of the given kind. The seed
+/// is only used by the xxHash algorithms
+///
+/// @param `kind` The checksum algorithm to use
+/// @param `seed` The seed for xxHash, ignored by the other algorithms
+/// @return `checksum_t` The new checksum state
+FCLIB_API fclib_checksum_t fclib_checksum_init( //
+    const fclib_checksum_kind_t kind,           //
+    const uint64_t seed                         //
+);
+
+/// @function `checksum_update`
+/// @brief Feeds `len` bytes of `data` into the checksum
+///
+/// @param `checksum` The checksum state to update
+/// @param `data` The data to feed
+/// @param `len` The number of bytes to feed
+FCLIB_API void fclib_checksum_update( //
+    fclib_checksum_t *checksum,       //
+    const void *data,                 //
+    const size_t len                  //
+);
+
+/// @function `checksum_update_str`
+/// @brief Feeds the content of the given string into the checksum
+///
+/// @param `checksum` The checksum state to update
+/// @param `str` The string whose content to feed
+FCLIB_API void fclib_checksum_update_str( //
+    fclib_checksum_t *checksum,           //
+    const fclib_str_t *str                //
+);
+
+/// @function `checksum_update_view`
+/// @brief Feeds the data the view points to into the checksum
+///
+/// @param `checksum` The checksum state to update
+/// @param `view` The view whose data to feed
+FCLIB_API void fclib_checksum_update_view( //
+    fclib_checksum_t *checksum,            //
+    const fclib_str_view_t view            //
+);
+
+/// @function `checksum_update_arr`
+/// @brief Feeds the data region of the array (all elements, without the
+/// dimension lengths) into the checksum
+///
+/// @param `checksum` The checksum state to update
+/// @param `arr` The array whose data to feed
+/// @param `element_size` The size of each element in bytes
+FCLIB_API void fclib_checksum_update_arr( //
+    fclib_checksum_t *checksum,           //
+    const fclib_arr_t *arr,               //
+    const size_t element_size             //
+);
+
+/// @function `checksum_update_file`
+/// @brief Feeds the whole content of the file at `path` into the checksum. The
+/// file is memory mapped, so it is checksummed without being copied.
+///
+/// @param `checksum` The checksum state to update
+/// @param `path` The path of the file to checksum
+/// @return `bool` Whether the file could be opened and read
+FCLIB_API bool fclib_checksum_update_file( //
+    fclib_checksum_t *checksum,            //
+    const fclib_str_t *path                //
+);
+
+/// @function `checksum_digest`
+/// @brief Returns the checksum of all data fed so far. The state is not
+/// modified, so more data can be fed after calling this function. 32 bit
+/// checksums are returned in the low bits.
+///
+/// @param `checksum` The checksum state
+/// @return `uint64_t` The checksum of all data fed so far
+FCLIB_API uint64_t fclib_checksum_digest(const fclib_checksum_t *checksum);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_checksum_kind_t checksum_kind_t;
+typedef fclib_checksum_t checksum_t;
+
+FCLIB_API static inline uint32_t crc32c( //
+    const uint32_t crc,                  //
+    const void *data,                    //
+    const size_t len                     //
+) {
+    return fclib_crc32c(crc, data, len);
+}
+FCLIB_API static inline uint32_t adler32( //
+    const uint32_t adler,                 //
+    const void *data,                     //
+    const size_t len                      //
+) {
+    return fclib_adler32(adler, data, len);
+}
+FCLIB_API static inline uint32_t xxh32( //
+    const void *data,                   //
+    const size_t len,                   //
+    const uint32_t seed                 //
+) {
+    return fclib_xxh32(data, len, seed);
+}
+FCLIB_API static inline uint64_t xxh64( //
+    const void *data,                   //
+    const size_t len,                   //
+    const uint64_t seed                 //
+) {
+    return fclib_xxh64(data, len, seed);
+}
+FCLIB_API static inline checksum_t checksum_init( //
+    const checksum_kind_t kind,                   //
+    const uint64_t seed                           //
+) {
+    return fclib_checksum_init(kind, seed);
+}
+FCLIB_API static inline void checksum_update( //
+    checksum_t *checksum,                     //
+    const void *data,                         //
+    const size_t len                          //
+) {
+    fclib_checksum_update(checksum, data, len);
+}
+FCLIB_API static inline void checksum_update_str( //
+    checksum_t *checksum,                         //
+    const fclib_str_t *str                        //
+) {
+    fclib_checksum_update_str(checksum, str);
+}
+FCLIB_API static inline void checksum_update_view( //
+    checksum_t *checksum,                          //
+    const fclib_str_view_t view                    //
+) {
+    fclib_checksum_update_view(checksum, view);
+}
+FCLIB_API static inline void checksum_update_arr( //
+    checksum_t *checksum,                         //
+    const fclib_arr_t *arr,                       //
+    const size_t element_size                     //
+) {
+    fclib_checksum_update_arr(checksum, arr, element_size);
+}
+FCLIB_API static inline bool checksum_update_file( //
+    checksum_t *checksum,                          //
+    const fclib_str_t *path                        //
+) {
+    return fclib_checksum_update_file(checksum, path);
+}
+FCLIB_API static inline uint64_t checksum_digest(const checksum_t *checksum) {
+    return fclib_checksum_digest(checksum);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+// The reflected CRC-32C (Castagnoli) polynomial
+#define FCLIB_CRC32C_POLY 0x82F63B78u
+// The stream lengths of the interleaved hardware CRC. Three streams hide the
+// three cycle latency of the `crc32` instruction
+#define FCLIB_CRC32C_LONG 8192
+#define FCLIB_CRC32C_SHORT 256
+
+// Slicing-by-8 tables for the software CRC and the tables to shift a CRC over
+// FCLIB_CRC32C_LONG / FCLIB_CRC32C_SHORT zero bytes, which is how the three
+// interleaved hardware streams are combined. All of them are built once, on
+// first use
+static uint32_t fclib_crc32c_table[8][256];
+static uint32_t fclib_crc32c_long_shift[4][256];
+static uint32_t fclib_crc32c_short_shift[4][256];
+static atomic_int fclib_crc32c_tables_state = 0;
+
+// Multiplies the GF(2) matrix `mat` with the vector `vec`
+static uint32_t fclib_gf2_matrix_times(const uint32_t *mat, uint32_t vec) {
+    uint32_t sum = 0;
+    while (vec) {
+        if (vec & 1) {
+            sum ^= *mat;
+        }
+        vec >>= 1;
+        mat++;
+    }
+    return sum;
+}
+
+static void fclib_gf2_matrix_square(uint32_t *square, const uint32_t *mat) {
+    for (size_t n = 0; n < 32; n++) {
+        square[n] = fclib_gf2_matrix_times(mat, mat[n]);
+    }
+}
+
+// Builds the tables which apply `len` zero bytes to a CRC, byte by byte on the
+// operand. `len` needs to be a power of two
+static void fclib_crc32c_build_shift(uint32_t shift[4][256], size_t len) {
+    uint32_t even[32];
+    uint32_t odd[32];
+    // The operator for a single zero bit
+    odd[0] = FCLIB_CRC32C_POLY;
+    uint32_t row = 1;
+    for (size_t n = 1; n < 32; n++) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    // Two and four zero bits
+    fclib_gf2_matrix_square(even, odd);
+    fclib_gf2_matrix_square(odd, even);
+    // Every further square doubles the number of zero bits, starting at one
+    // zero byte, until `len` has been shifted down to zero
+    uint32_t *op = even;
+    do {
+        fclib_gf2_matrix_square(even, odd);
+        op = even;
+        len >>= 1;
+        if (len == 0) {
+            break;
+        }
+        fclib_gf2_matrix_square(odd, even);
+        op = odd;
+        len >>= 1;
+    } while (len);
+    for (uint32_t n = 0; n < 256; n++) {
+        shift[0][n] = fclib_gf2_matrix_times(op, n);
+        shift[1][n] = fclib_gf2_matrix_times(op, n << 8);
+        shift[2][n] = fclib_gf2_matrix_times(op, n << 16);
+        shift[3][n] = fclib_gf2_matrix_times(op, n << 24);
+    }
+}
+
+static void fclib_crc32c_init_tables(void) {
+    // 0 = not built, 1 = being built, 2 = ready
+    const memory_order acquire = memory_order_acquire;
+    if (atomic_load_explicit(&fclib_crc32c_tables_state, acquire) == 2) {
+        return;
+    }
+    int expected = 0;
+    if (!atomic_compare_exchange_strong(&fclib_crc32c_tables_state, &expected,
+            1)) {
+        // Another thread builds the tables right now
+        while (atomic_load_explicit(&fclib_crc32c_tables_state, acquire) != 2) {
+        }
+        return;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = n;
+        for (size_t k = 0; k < 8; k++) {
+            crc = crc & 1 ? (crc >> 1) ^ FCLIB_CRC32C_POLY : crc >> 1;
+        }
+        fclib_crc32c_table[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = fclib_crc32c_table[0][n];
+        for (size_t k = 1; k < 8; k++) {
+            crc = fclib_crc32c_table[0][crc & 0xFF] ^ (crc >> 8);
+            fclib_crc32c_table[k][n] = crc;
+        }
+    }
+    fclib_crc32c_build_shift(fclib_crc32c_long_shift, FCLIB_CRC32C_LONG);
+    fclib_crc32c_build_shift(fclib_crc32c_short_shift, FCLIB_CRC32C_SHORT);
+    atomic_store_explicit(&fclib_crc32c_tables_state, 2, memory_order_release);
+}
+
+static uint32_t fclib_crc32c_sw( //
+    uint32_t crc,                //
+    const unsigned char *next,   //
+    size_t len                   //
+) {
+    uint32_t state = ~crc;
+    while (len > 0 && ((uintptr_t)next & 7) != 0) {
+        state = fclib_crc32c_table[0][(state ^ *next++) & 0xFF] ^ (state >> 8);
+        len--;
+    }
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, next, sizeof(word));
+        word ^= state;
+        state = fclib_crc32c_table[7][word & 0xFF] ^
+            fclib_crc32c_table[6][(word >> 8) & 0xFF] ^
+            fclib_crc32c_table[5][(word >> 16) & 0xFF] ^
+            fclib_crc32c_table[4][(word >> 24) & 0xFF] ^
+            fclib_crc32c_table[3][(word >> 32) & 0xFF] ^
+            fclib_crc32c_table[2][(word >> 40) & 0xFF] ^
+            fclib_crc32c_table[1][(word >> 48) & 0xFF] ^
+            fclib_crc32c_table[0][word >> 56];
+        next += 8;
+        len -= 8;
+    }
+    while (len > 0) {
+        state = fclib_crc32c_table[0][(state ^ *next++) & 0xFF] ^ (state >> 8);
+        len--;
+    }
+    return ~state;
+}
+
+#if FCLIB_X86_SIMD && defined(__x86_64__)
+// Applies the zero-byte shift operator of the given table to `crc`
+static uint32_t fclib_crc32c_shift( //
+    const uint32_t shift[4][256],   //
+    const uint32_t crc              //
+) {
+    return shift[0][crc & 0xFF] ^ shift[1][(crc >> 8) & 0xFF] ^
+        shift[2][(crc >> 16) & 0xFF] ^ shift[3][crc >> 24];
+}
+
+FCLIB_TARGET("sse4.2")
+static uint32_t fclib_crc32c_hw( //
+    uint32_t crc,                //
+    const unsigned char *next,   //
+    size_t len                   //
+) {
+    uint64_t crc0 = ~crc;
+    while (len > 0 && ((uintptr_t)next & 7) != 0) {
+        crc0 = _mm_crc32_u8((uint32_t)crc0, *next++);
+        len--;
+    }
+    // Three streams are checksummed in parallel, the latter two starting from
+    // zero. Shifting a CRC over the length of the following stream and XOR-ing
+    // the following CRC onto it yields the CRC of the concatenation
+    const size_t block_sizes[2] = {FCLIB_CRC32C_LONG, FCLIB_CRC32C_SHORT};
+    for (size_t b = 0; b < 2; b++) {
+        const size_t block = block_sizes[b];
+        const uint32_t(*shift)[256] = b == 0 ? fclib_crc32c_long_shift //
+                                             : fclib_crc32c_short_shift;
+        while (len >= block * 3) {
+            uint64_t crc1 = 0;
+            uint64_t crc2 = 0;
+            const unsigned char *const end = next + block;
+            do {
+                uint64_t word0;
+                uint64_t word1;
+                uint64_t word2;
+                memcpy(&word0, next, sizeof(word0));
+                memcpy(&word1, next + block, sizeof(word1));
+                memcpy(&word2, next + 2 * block, sizeof(word2));
+                crc0 = _mm_crc32_u64(crc0, word0);
+                crc1 = _mm_crc32_u64(crc1, word1);
+                crc2 = _mm_crc32_u64(crc2, word2);
+                next += 8;
+            } while (next < end);
+            crc0 = fclib_crc32c_shift(shift, (uint32_t)crc0) ^ crc1;
+            crc0 = fclib_crc32c_shift(shift, (uint32_t)crc0) ^ crc2;
+            next += 2 * block;
+            len -= 3 * block;
+        }
+    }
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, next, sizeof(word));
+        crc0 = _mm_crc32_u64(crc0, word);
+        next += 8;
+        len -= 8;
+    }
+    while (len > 0) {
+        crc0 = _mm_crc32_u8((uint32_t)crc0, *next++);
+        len--;
+    }
+    return ~(uint32_t)crc0;
+}
+#endif
+
+static uint32_t fclib_rotl32(const uint32_t x, const int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+static uint64_t fclib_rotl64(const uint64_t x, const int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint32_t fclib_read32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t fclib_read64(const unsigned char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+#define FCLIB_XXH32_P1 0x9E3779B1u
+#define FCLIB_XXH32_P2 0x85EBCA77u
+#define FCLIB_XXH32_P3 0xC2B2AE3Du
+#define FCLIB_XXH32_P4 0x27D4EB2Fu
+#define FCLIB_XXH32_P5 0x165667B1u
+#define FCLIB_XXH64_P1 0x9E3779B185EBCA87ull
+#define FCLIB_XXH64_P2 0xC2B2AE3D27D4EB4Full
+#define FCLIB_XXH64_P3 0x165667B19E3779F9ull
+#define FCLIB_XXH64_P4 0x85EBCA77C2B2AE63ull
+#define FCLIB_XXH64_P5 0x27D4EB2F165667C5ull
+
+static uint32_t fclib_xxh32_round(const uint32_t acc, const uint32_t input) {
+    return fclib_rotl32(acc + input * FCLIB_XXH32_P2, 13) * FCLIB_XXH32_P1;
+}
+
+static uint64_t fclib_xxh64_round(const uint64_t acc, const uint64_t input) {
+    return fclib_rotl64(acc + input * FCLIB_XXH64_P2, 31) * FCLIB_XXH64_P1;
+}
+
+static uint64_t fclib_xxh64_merge(const uint64_t acc, const uint64_t lane) {
+    return (acc ^ fclib_xxh64_round(0, lane)) * FCLIB_XXH64_P1 + FCLIB_XXH64_P4;
+}
+
+// Initializes the four xxHash lanes from the seed
+static void fclib_xxh_init_lanes(     //
+    uint64_t lanes[4],                //
+    const fclib_checksum_kind_t kind, //
+    const uint64_t seed               //
+) {
+    if (kind == FCLIB_CHECKSUM_XXH32) {
+        const uint32_t seed32 = (uint32_t)seed;
+        lanes[0] = (uint32_t)(seed32 + FCLIB_XXH32_P1 + FCLIB_XXH32_P2);
+        lanes[1] = (uint32_t)(seed32 + FCLIB_XXH32_P2);
+        lanes[2] = seed32;
+        lanes[3] = (uint32_t)(seed32 - FCLIB_XXH32_P1);
+        return;
+    }
+    lanes[0] = seed + FCLIB_XXH64_P1 + FCLIB_XXH64_P2;
+    lanes[1] = seed + FCLIB_XXH64_P2;
+    lanes[2] = seed;
+    lanes[3] = seed - FCLIB_XXH64_P1;
+}
+
+// Consumes as many full stripes (16 bytes for XXH32, 32 bytes for XXH64) of
+// `p` as possible and returns the number of bytes consumed
+static size_t fclib_xxh_stripes(      //
+    uint64_t lanes[4],                //
+    const fclib_checksum_kind_t kind, //
+    const unsigned char *p,           //
+    const size_t len                  //
+) {
+    size_t pos = 0;
+    if (kind == FCLIB_CHECKSUM_XXH32) {
+        uint32_t v1 = (uint32_t)lanes[0];
+        uint32_t v2 = (uint32_t)lanes[1];
+        uint32_t v3 = (uint32_t)lanes[2];
+        uint32_t v4 = (uint32_t)lanes[3];
+        for (; len - pos >= 16; pos += 16) {
+            v1 = fclib_xxh32_round(v1, fclib_read32(p + pos));
+            v2 = fclib_xxh32_round(v2, fclib_read32(p + pos + 4));
+            v3 = fclib_xxh32_round(v3, fclib_read32(p + pos + 8));
+            v4 = fclib_xxh32_round(v4, fclib_read32(p + pos + 12));
+        }
+        lanes[0] = v1;
+        lanes[1] = v2;
+        lanes[2] = v3;
+        lanes[3] = v4;
+        return pos;
+    }
+    uint64_t v1 = lanes[0];
+    uint64_t v2 = lanes[1];
+    uint64_t v3 = lanes[2];
+    uint64_t v4 = lanes[3];
+    for (; len - pos >= 32; pos += 32) {
+        v1 = fclib_xxh64_round(v1, fclib_read64(p + pos));
+        v2 = fclib_xxh64_round(v2, fclib_read64(p + pos + 8));
+        v3 = fclib_xxh64_round(v3, fclib_read64(p + pos + 16));
+        v4 = fclib_xxh64_round(v4, fclib_read64(p + pos + 24));
+    }
+    lanes[0] = v1;
+    lanes[1] = v2;
+    lanes[2] = v3;
+    lanes[3] = v4;
+    return pos;
+}
+
+// Produces the final hash from the lanes, the unconsumed tail (shorter than a
+// stripe) and the total length
+static uint64_t fclib_xxh_finish(     //
+    const uint64_t lanes[4],          //
+    const fclib_checksum_kind_t kind, //
+    const uint64_t seed,              //
+    const unsigned char *tail,        //
+    const size_t tail_len,            //
+    const uint64_t total_len          //
+) {
+    size_t pos = 0;
+    if (kind == FCLIB_CHECKSUM_XXH32) {
+        uint32_t h;
+        if (total_len >= 16) {
+            h = fclib_rotl32((uint32_t)lanes[0], 1) +
+                fclib_rotl32((uint32_t)lanes[1], 7) +
+                fclib_rotl32((uint32_t)lanes[2], 12) +
+                fclib_rotl32((uint32_t)lanes[3], 18);
+        } else {
+            h = (uint32_t)seed + FCLIB_XXH32_P5;
+        }
+        h += (uint32_t)total_len;
+        for (; tail_len - pos >= 4; pos += 4) {
+            h += fclib_read32(tail + pos) * FCLIB_XXH32_P3;
+            h = fclib_rotl32(h, 17) * FCLIB_XXH32_P4;
+        }
+        for (; pos < tail_len; pos++) {
+            h += tail[pos] * FCLIB_XXH32_P5;
+            h = fclib_rotl32(h, 11) * FCLIB_XXH32_P1;
+        }
+        h ^= h >> 15;
+        h *= FCLIB_XXH32_P2;
+        h ^= h >> 13;
+        h *= FCLIB_XXH32_P3;
+        h ^= h >> 16;
+        return h;
+    }
+    uint64_t h;
+    if (total_len >= 32) {
+        h = fclib_rotl64(lanes[0], 1) + fclib_rotl64(lanes[1], 7) +
+            fclib_rotl64(lanes[2], 12) + fclib_rotl64(lanes[3], 18);
+        for (size_t i = 0; i < 4; i++) {
+            h = fclib_xxh64_merge(h, lanes[i]);
+        }
+    } else {
+        h = seed + FCLIB_XXH64_P5;
+    }
+    h += total_len;
+    for (; tail_len - pos >= 8; pos += 8) {
+        h ^= fclib_xxh64_round(0, fclib_read64(tail + pos));
+        h = fclib_rotl64(h, 27) * FCLIB_XXH64_P1 + FCLIB_XXH64_P4;
+    }
+    if (tail_len - pos >= 4) {
+        h ^= (uint64_t)fclib_read32(tail + pos) * FCLIB_XXH64_P1;
+        h = fclib_rotl64(h, 23) * FCLIB_XXH64_P2 + FCLIB_XXH64_P3;
+        pos += 4;
+    }
+    for (; pos < tail_len; pos++) {
+        h ^= tail[pos] * FCLIB_XXH64_P5;
+        h = fclib_rotl64(h, 11) * FCLIB_XXH64_P1;
+    }
+    h ^= h >> 33;
+    h *= FCLIB_XXH64_P2;
+    h ^= h >> 29;
+    h *= FCLIB_XXH64_P3;
+    h ^= h >> 32;
+    return h;
+}
+
+FCLIB_API uint32_t fclib_crc32c( //
+    const uint32_t crc,          //
+    const void *data,            //
+    const size_t len             //
+) {
+    fclib_crc32c_init_tables();
+#if FCLIB_X86_SIMD && defined(__x86_64__)
+    if (fclib_cpu_has_sse42()) {
+        return fclib_crc32c_hw(crc, (const unsigned char *)data, len);
+    }
+#endif
+    return fclib_crc32c_sw(crc, (const unsigned char *)data, len);
+}
+
+FCLIB_API uint32_t fclib_adler32( //
+    const uint32_t adler,         //
+    const void *data,             //
+    const size_t len              //
+) {
+    // The largest number of bytes which can be summed up before the sums have
+    // to be reduced modulo 65521 to not overflow 32 bits
+    const size_t NMAX = 5552;
+    const uint32_t BASE = 65521;
+    const unsigned char *p = (const unsigned char *)data;
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    size_t rest = len;
+    while (rest > 0) {
+        size_t chunk = rest < NMAX ? rest : NMAX;
+        rest -= chunk;
+        for (; chunk >= 8; chunk -= 8) {
+            a += p[0];
+            b += a;
+            a += p[1];
+            b += a;
+            a += p[2];
+            b += a;
+            a += p[3];
+            b += a;
+            a += p[4];
+            b += a;
+            a += p[5];
+            b += a;
+            a += p[6];
+            b += a;
+            a += p[7];
+            b += a;
+            p += 8;
+        }
+        for (; chunk > 0; chunk--) {
+            a += *p++;
+            b += a;
+        }
+        a %= BASE;
+        b %= BASE;
+    }
+    return b << 16 | a;
+}
+
+FCLIB_API uint32_t fclib_xxh32( //
+    const void *data,           //
+    const size_t len,           //
+    const uint32_t seed         //
+) {
+    const unsigned char *const p = (const unsigned char *)data;
+    uint64_t lanes[4];
+    fclib_xxh_init_lanes(lanes, FCLIB_CHECKSUM_XXH32, seed);
+    const size_t consumed = fclib_xxh_stripes( //
+        lanes, FCLIB_CHECKSUM_XXH32, p, len);
+    return (uint32_t)fclib_xxh_finish(lanes, FCLIB_CHECKSUM_XXH32, seed,
+        p + consumed, len - consumed, len);
+}
+
+FCLIB_API uint64_t fclib_xxh64( //
+    const void *data,           //
+    const size_t len,           //
+    const uint64_t seed         //
+) {
+    const unsigned char *const p = (const unsigned char *)data;
+    uint64_t lanes[4];
+    fclib_xxh_init_lanes(lanes, FCLIB_CHECKSUM_XXH64, seed);
+    const size_t consumed = fclib_xxh_stripes( //
+        lanes, FCLIB_CHECKSUM_XXH64, p, len);
+    return fclib_xxh_finish(lanes, FCLIB_CHECKSUM_XXH64, seed, p + consumed,
+        len - consumed, len);
+}
+
+FCLIB_API fclib_checksum_t fclib_checksum_init( //
+    const fclib_checksum_kind_t kind,           //
+    const uint64_t seed                         //
+) {
+    fclib_checksum_t checksum;
+    memset(&checksum, 0, sizeof(checksum));
+    checksum.kind = kind;
+    checksum.seed = seed;
+    switch (kind) {
+        case FCLIB_CHECKSUM_CRC32C:
+            checksum.acc[0] = 0;
+            break;
+        case FCLIB_CHECKSUM_ADLER32:
+            checksum.acc[0] = 1;
+            break;
+        case FCLIB_CHECKSUM_XXH32:
+        case FCLIB_CHECKSUM_XXH64:
+            fclib_xxh_init_lanes(checksum.acc, kind, seed);
+            break;
+    }
+    return checksum;
+}
+
+FCLIB_API void fclib_checksum_update( //
+    fclib_checksum_t *checksum,       //
+    const void *data,                 //
+    const size_t len                  //
+) {
+    const unsigned char *p = (const unsigned char *)data;
+    checksum->total_len += len;
+    switch (checksum->kind) {
+        case FCLIB_CHECKSUM_CRC32C:
+            checksum->acc[0] = fclib_crc32c( //
+                (uint32_t)checksum->acc[0], data, len);
+            return;
+        case FCLIB_CHECKSUM_ADLER32:
+            checksum->acc[0] = fclib_adler32( //
+                (uint32_t)checksum->acc[0], data, len);
+            return;
+        case FCLIB_CHECKSUM_XXH32:
+        case FCLIB_CHECKSUM_XXH64:
+            break;
+    }
+    const size_t stripe = checksum->kind == FCLIB_CHECKSUM_XXH32 ? 16 : 32;
+    size_t rest = len;
+    // Complete a partially buffered stripe first
+    if (checksum->buffered > 0) {
+        const size_t missing = stripe - checksum->buffered;
+        const size_t take = rest < missing ? rest : missing;
+        memcpy(checksum->buffer + checksum->buffered, p, take);
+        checksum->buffered += take;
+        p += take;
+        rest -= take;
+        if (checksum->buffered < stripe) {
+            return;
+        }
+        fclib_xxh_stripes(checksum->acc, checksum->kind, checksum->buffer, //
+            stripe);
+        checksum->buffered = 0;
+    }
+    const size_t consumed = fclib_xxh_stripes( //
+        checksum->acc, checksum->kind, p, rest);
+    memcpy(checksum->buffer, p + consumed, rest - consumed);
+    checksum->buffered = rest - consumed;
+}
+
+FCLIB_API void fclib_checksum_update_str( //
+    fclib_checksum_t *checksum,           //
+    const fclib_str_t *str                //
+) {
+    fclib_checksum_update(checksum, str->value, str->len);
+}
+
+FCLIB_API void fclib_checksum_update_view( //
+    fclib_checksum_t *checksum,            //
+    const fclib_str_view_t view            //
+) {
+    fclib_checksum_update(checksum, view.value, view.len);
+}
+
+FCLIB_API void fclib_checksum_update_arr( //
+    fclib_checksum_t *checksum,           //
+    const fclib_arr_t *arr,               //
+    const size_t element_size             //
+) {
+    const char *const data = arr->value + arr->len * sizeof(size_t);
+    fclib_checksum_update( //
+        checksum, data, fclib_arr_get_len(arr) * element_size);
+}
+
+FCLIB_API bool fclib_checksum_update_file( //
+    fclib_checksum_t *checksum,            //
+    const fclib_str_t *path                //
+) {
+#ifdef __WIN32__
+    FILE *file = fopen(path->value, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    char buffer[65536];
+    size_t bytes_read;
+    while ((bytes_read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        fclib_checksum_update(checksum, buffer, bytes_read);
+    }
+    const bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+#else
+    const int fd = open(path->value, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return false;
+    }
+    const size_t size = (size_t)file_stat.st_size;
+    if (size == 0) {
+        close(fd);
+        return true;
+    }
+    void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    fclib_checksum_update(checksum, mapped, size);
+    munmap(mapped, size);
+    return true;
+#endif
+}
+
+FCLIB_API uint64_t fclib_checksum_digest(const fclib_checksum_t *checksum) {
+    switch (checksum->kind) {
+        case FCLIB_CHECKSUM_CRC32C:
+        case FCLIB_CHECKSUM_ADLER32:
+            return checksum->acc[0];
+        case FCLIB_CHECKSUM_XXH32:
+        case FCLIB_CHECKSUM_XXH64:
+            break;
+    }
+    return fclib_xxh_finish(checksum->acc, checksum->kind, checksum->seed,
+        checksum->buffer, checksum->buffered, checksum->total_len);
+}
+
+#endif // endof FCLIB_IMPLEMENTATION
@@ -0,0 +1,1125 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "checksum.h"
+#include "str.h"
+
+#ifdef FCLIB_MINIMAL
+#error "compress.h builds on checksum.h, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @function `lz4_compress_bound`
+/// @brief Returns the largest size an LZ4 block of `len` input bytes can
+/// compress to, which is the capacity `lz4_compress_block` needs to never fail
+///
+/// @param `len` The number of input bytes
+/// @return `size_t` The worst case compressed size
+FCLIB_API size_t fclib_lz4_compress_bound(const size_t len);
+
+/// @function `lz4_compress_block`
+/// @brief Compresses `len` bytes of `src` into a single raw LZ4 block, as
+/// specified by the LZ4 block format. The block does not store the size of the
+/// original data, so the caller has to keep track of it.
+///
+/// @param `dest` The buffer to write the compressed block to
+/// @param `dest_cap` The capacity of `dest` in bytes
+/// @param `src` The data to compress
+/// @param `len` The number of bytes to compress, at most 0x7E000000
+/// @return `size_t` The size of the compressed block, or 0 if `dest` is too
+/// small or `len` is too large
+FCLIB_API size_t fclib_lz4_compress_block( //
+    void *dest,                            //
+    const size_t dest_cap,                 //
+    const void *src,                       //
+    const size_t len                       //
+);
+
+/// @function `lz4_decompress_block`
+/// @brief Decompresses a single raw LZ4 block. Malformed input is rejected and
+/// never causes reads or writes outside of the given buffers.
+///
+/// @param `dest` The buffer to decompress into
+/// @param `dest_cap` The capacity of `dest` in bytes
+/// @param `src` The compressed block
+/// @param `len` The size of the compressed block in bytes
+/// @param `written` Is set to the number of decompressed bytes
+/// @return `bool` Whether the block was valid and fit into `dest`
+FCLIB_API bool fclib_lz4_decompress_block( //
+    void *dest,                            //
+    const size_t dest_cap,                 //
+    const void *src,                       //
+    const size_t len,                      //
+    size_t *written                        //
+);
+
+/// @function `lz4_compress`
+/// @brief Compresses `len` bytes of `src` into a complete LZ4 frame, which
+/// stores the content size and a content checksum and can be read by the `lz4`
+/// command line tool
+///
+/// @param `src` The data to compress
+/// @param `len` The number of bytes to compress
+/// @return `str_t *` The compressed frame
+FCLIB_API fclib_str_t *fclib_lz4_compress(const void *src, const size_t len);
+
+/// @function `lz4_compress_str`
+/// @brief Compresses the content of the given string into an LZ4 frame
+///
+/// @param `str` The string to compress
+/// @return `str_t *` The compressed frame
+FCLIB_API fclib_str_t *fclib_lz4_compress_str(const fclib_str_t *str);
+
+/// @function `lz4_compress_arr`
+/// @brief Compresses the whole array (its dimensionality, the dimension lengths
+/// and all elements) into an LZ4 frame, so it can be restored with
+/// `lz4_decompress_arr`. Only arrays of plain values can be compressed, the
+/// targets of pointer elements are not followed.
+///
+/// @param `arr` The array to compress
+/// @param `element_size` The size of each element in bytes
+/// @return `str_t *` The compressed frame
+FCLIB_API fclib_str_t *fclib_lz4_compress_arr( //
+    const fclib_arr_t *arr,                    //
+    const size_t element_size                  //
+);
+
+/// @function `lz4_decompress`
+/// @brief Decompresses all LZ4 frames contained in `src` into a new string.
+/// Frames written by other LZ4 implementations are supported too, including
+/// linked blocks and block checksums.
+///
+/// @param `src` The compressed frames
+/// @param `len` The size of the compressed data in bytes
+/// @return `str_t *` The decompressed data, or NULL if the data is malformed,
+/// truncated or fails its checksums
+FCLIB_API fclib_str_t *fclib_lz4_decompress(const void *src, const size_t len);
+
+/// @function `lz4_decompress_arr`
+/// @brief Restores an array which was compressed with `lz4_compress_arr`
+///
+/// @param `frame` The compressed frame
+/// @param `element_size` The size of each element in bytes
+/// @return `arr_t *` The restored array, or NULL if the frame is malformed or
+/// does not contain an array with elements of the given size
+FCLIB_API fclib_arr_t *fclib_lz4_decompress_arr( //
+    const fclib_str_t *frame,                    //
+    const size_t element_size                    //
+);
+
+/// @typedef `lz4_encoder_t`
+/// @brief A streaming LZ4 frame encoder. Data written to it is cut into
+/// independent 64 KiB blocks which are appended to the output builder as soon
+/// as they are complete. The caller may take the bytes out of the builder (and
+/// reset its length) between writes.
+typedef struct fclib_lz4_encoder_t {
+    fclib_str_builder_t *out;
+    fclib_checksum_t content_checksum;
+    bool has_content_checksum;
+    char *block;
+    size_t block_len;
+} fclib_lz4_encoder_t;
+
+/// @enum `lz4_status_t`
+/// @brief The state of a streaming LZ4 decoder after it has consumed input
+typedef enum fclib_lz4_status_t {
+    // The decoder is in the middle of a frame and needs more input
+    FCLIB_LZ4_NEED_INPUT,
+    // All frames fed so far are complete
+    FCLIB_LZ4_DONE,
+    // The input is malformed, the decoder can not be used any more
+    FCLIB_LZ4_ERROR,
+} fclib_lz4_status_t;
+
+/// @typedef `lz4_decoder_t`
+/// @brief A streaming LZ4 frame decoder. Compressed input can be fed in pieces
+/// of any size, the decompressed data is appended to the output builder block
+/// by block.
+typedef struct fclib_lz4_decoder_t {
+    fclib_str_builder_t *out;
+    fclib_lz4_status_t status;
+    int stage;
+    unsigned char descriptor[16];
+    size_t block_max;
+    size_t block_size;
+    uint64_t skip;
+    uint64_t content_size;
+    uint64_t produced;
+    fclib_checksum_t content_checksum;
+    // Input which has been fed but does not form a complete unit yet
+    char *pending;
+    size_t pending_len;
+    size_t pending_cap;
+    // The last 64 KiB of output followed by space for one block, only used for
+    // frames with linked blocks
+    char *window;
+    size_t history_len;
+} fclib_lz4_decoder_t;
+
+/// @function `lz4_encoder_init`
+/// @brief Creates a new streaming encoder and writes the frame header to `out`
+///
+/// @param `out` The builder to append the compressed frame to
+/// @param `content_checksum` Whether to append a checksum of the content
+/// @return `lz4_encoder_t` The new encoder
+FCLIB_API fclib_lz4_encoder_t fclib_lz4_encoder_init( //
+    fclib_str_builder_t *out,                         //
+    const bool content_checksum                       //
+);
+
+/// @function `lz4_encoder_write`
+/// @brief Feeds `len` bytes of `data` into the encoder
+///
+/// @param `encoder` The encoder to feed
+/// @param `data` The data to compress
+/// @param `len` The number of bytes to compress
+FCLIB_API void fclib_lz4_encoder_write( //
+    fclib_lz4_encoder_t *encoder,       //
+    const void *data,                   //
+    const size_t len                    //
+);
+
+/// @function `lz4_encoder_finish`
+/// @brief Compresses all buffered data, writes the end of the frame and frees
+/// the encoder. The output builder stays owned by the caller.
+///
+/// @param `encoder` The encoder to finish
+FCLIB_API void fclib_lz4_encoder_finish(fclib_lz4_encoder_t *encoder);
+
+/// @function `lz4_decoder_init`
+/// @brief Creates a new streaming decoder
+///
+/// @param `out` The builder to append the decompressed data to
+/// @return `lz4_decoder_t` The new decoder
+FCLIB_API fclib_lz4_decoder_t fclib_lz4_decoder_init(fclib_str_builder_t *out);
+
+/// @function `lz4_decoder_write`
+/// @brief Feeds `len` bytes of compressed data into the decoder
+///
+/// @param `decoder` The decoder to feed
+/// @param `data` The compressed data
+/// @param `len` The number of bytes to feed
+/// @return `lz4_status_t` The state of the decoder after consuming the input
+FCLIB_API fclib_lz4_status_t fclib_lz4_decoder_write( //
+    fclib_lz4_decoder_t *decoder,                     //
+    const void *data,                                 //
+    const size_t len                                  //
+);
+
+/// @function `lz4_decoder_free`
+/// @brief Frees the internal buffers of the decoder. The output builder stays
+/// owned by the caller.
+///
+/// @param `decoder` The decoder to free
+FCLIB_API void fclib_lz4_decoder_free(fclib_lz4_decoder_t *decoder);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_lz4_encoder_t lz4_encoder_t;
+typedef fclib_lz4_status_t lz4_status_t;
+typedef fclib_lz4_decoder_t lz4_decoder_t;
+
+FCLIB_API static inline size_t lz4_compress_bound(const size_t len) {
+    return fclib_lz4_compress_bound(len);
+}
+FCLIB_API static inline size_t lz4_compress_block( //
+    void *dest,                                    //
+    const size_t dest_cap,                         //
+    const void *src,                               //
+    const size_t len                               //
+) {
+    return fclib_lz4_compress_block(dest, dest_cap, src, len);
+}
+FCLIB_API static inline bool lz4_decompress_block( //
+    void *dest,                                    //
+    const size_t dest_cap,                         //
+    const void *src,                               //
+    const size_t len,                              //
+    size_t *written                                //
+) {
+    return fclib_lz4_decompress_block(dest, dest_cap, src, len, written);
+}
+FCLIB_API static inline fclib_str_t *lz4_compress( //
+    const void *src,                               //
+    const size_t len                               //
+) {
+    return fclib_lz4_compress(src, len);
+}
+FCLIB_API static inline fclib_str_t *lz4_compress_str(const fclib_str_t *str) {
+    return fclib_lz4_compress_str(str);
+}
+FCLIB_API static inline fclib_str_t *lz4_compress_arr( //
+    const fclib_arr_t *arr,                            //
+    const size_t element_size                          //
+) {
+    return fclib_lz4_compress_arr(arr, element_size);
+}
+FCLIB_API static inline fclib_str_t *lz4_decompress( //
+    const void *src,                                 //
+    const size_t len                                 //
+) {
+    return fclib_lz4_decompress(src, len);
+}
+FCLIB_API static inline fclib_arr_t *lz4_decompress_arr( //
+    const fclib_str_t *frame,                            //
+    const size_t element_size                            //
+) {
+    return fclib_lz4_decompress_arr(frame, element_size);
+}
+FCLIB_API static inline lz4_encoder_t lz4_encoder_init( //
+    fclib_str_builder_t *out,                           //
+    const bool content_checksum                         //
+) {
+    return fclib_lz4_encoder_init(out, content_checksum);
+}
+FCLIB_API static inline void lz4_encoder_write( //
+    lz4_encoder_t *encoder,                     //
+    const void *data,                           //
+    const size_t len                            //
+) {
+    fclib_lz4_encoder_write(encoder, data, len);
+}
+FCLIB_API static inline void lz4_encoder_finish(lz4_encoder_t *encoder) {
+    fclib_lz4_encoder_finish(encoder);
+}
+FCLIB_API static inline lz4_decoder_t lz4_decoder_init( //
+    fclib_str_builder_t *out                            //
+) {
+    return fclib_lz4_decoder_init(out);
+}
+FCLIB_API static inline lz4_status_t lz4_decoder_write( //
+    lz4_decoder_t *decoder,                             //
+    const void *data,                                   //
+    const size_t len                                    //
+) {
+    return fclib_lz4_decoder_write(decoder, data, len);
+}
+FCLIB_API static inline void lz4_decoder_free(lz4_decoder_t *decoder) {
+    fclib_lz4_decoder_free(decoder);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+#define FCLIB_LZ4_MAGIC 0x184D2204u
+#define FCLIB_LZ4_MAX_INPUT 0x7E000000u
+#define FCLIB_LZ4_MAX_OFFSET 65535
+#define FCLIB_LZ4_MIN_MATCH 4
+// The last match has to start at least 12 bytes before the end of a block and
+// the last 5 bytes of a block are always literals
+#define FCLIB_LZ4_MF_LIMIT 12
+#define FCLIB_LZ4_LAST_LITERALS 5
+#define FCLIB_LZ4_HASH_LOG 12
+#define FCLIB_LZ4_BLOCK_SIZE 65536
+#define FCLIB_LZ4_WINDOW 65536
+
+enum {
+    FCLIB_LZ4_STAGE_MAGIC,
+    FCLIB_LZ4_STAGE_DESCRIPTOR,
+    FCLIB_LZ4_STAGE_DESCRIPTOR_REST,
+    FCLIB_LZ4_STAGE_BLOCK_SIZE,
+    FCLIB_LZ4_STAGE_BLOCK,
+    FCLIB_LZ4_STAGE_CONTENT_CHECKSUM,
+    FCLIB_LZ4_STAGE_SKIP_SIZE,
+    FCLIB_LZ4_STAGE_SKIP,
+};
+
+static uint32_t fclib_lz4_read32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t fclib_lz4_read64(const unsigned char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static void fclib_lz4_write32(unsigned char *p, const uint32_t value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+static uint32_t fclib_lz4_hash(const uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - FCLIB_LZ4_HASH_LOG);
+}
+
+// Writes a length which did not fit into its 4 bit token field as a run of
+// 255 bytes followed by the remainder
+static unsigned char *fclib_lz4_write_length(unsigned char *op, size_t len) {
+    for (; len >= 255; len -= 255) {
+        *op++ = 255;
+    }
+    *op++ = (unsigned char)len;
+    return op;
+}
+
+FCLIB_API size_t fclib_lz4_compress_bound(const size_t len) {
+    return len + len / 255 + 16;
+}
+
+FCLIB_API size_t fclib_lz4_compress_block( //
+    void *dest,                            //
+    const size_t dest_cap,                 //
+    const void *src,                       //
+    const size_t len                       //
+) {
+    if (len > FCLIB_LZ4_MAX_INPUT) {
+        return 0;
+    }
+    const unsigned char *const base = (const unsigned char *)src;
+    const unsigned char *const iend = base + len;
+    const unsigned char *anchor = base;
+    unsigned char *op = (unsigned char *)dest;
+    unsigned char *const oend = op + dest_cap;
+    if (len >= FCLIB_LZ4_MF_LIMIT + 1) {
+        const unsigned char *const mflimit = iend - FCLIB_LZ4_MF_LIMIT;
+        const unsigned char *const matchlimit = iend - FCLIB_LZ4_LAST_LITERALS;
+        // The positions of the last occurrence of each hashed 4 byte sequence
+        uint32_t table[1 << FCLIB_LZ4_HASH_LOG];
+        memset(table, 0, sizeof(table));
+        const unsigned char *ip = base + 1;
+        while (true) {
+            // Search for a match, skipping ahead faster the longer no match was
+            // found so incompressible data is passed over quickly
+            const unsigned char *match;
+            size_t searches = 1 << 6;
+            while (true) {
+                if (ip > mflimit) {
+                    goto last_literals;
+                }
+                const uint32_t sequence = fclib_lz4_read32(ip);
+                const uint32_t h = fclib_lz4_hash(sequence);
+                match = base + table[h];
+                table[h] = (uint32_t)(ip - base);
+                if (match < ip && ip - match <= FCLIB_LZ4_MAX_OFFSET &&
+                    fclib_lz4_read32(match) == sequence) {
+                    break;
+                }
+                ip += searches++ >> 6;
+            }
+            // Extend the match backwards into the pending literals
+            while (ip > anchor && match > base && ip[-1] == match[-1]) {
+                ip--;
+                match--;
+            }
+            // Extend the match forwards, 8 bytes at a time
+            const unsigned char *p = ip + FCLIB_LZ4_MIN_MATCH;
+            const unsigned char *m = match + FCLIB_LZ4_MIN_MATCH;
+            while (p + 8 <= matchlimit) {
+                const uint64_t diff = fclib_lz4_read64(p) ^ fclib_lz4_read64(m);
+                if (diff != 0) {
+                    p += (size_t)__builtin_ctzll(diff) >> 3;
+                    goto match_end;
+                }
+                p += 8;
+                m += 8;
+            }
+            while (p < matchlimit && *p == *m) {
+                p++;
+                m++;
+            }
+        match_end:;
+            const size_t literals = (size_t)(ip - anchor);
+            const size_t match_len = (size_t)(p - ip) - FCLIB_LZ4_MIN_MATCH;
+            const size_t needed = 1 + literals / 255 + 1 + literals + 2 +
+                match_len / 255 + 1;
+            if (needed > (size_t)(oend - op)) {
+                return 0;
+            }
+            unsigned char *const token = op++;
+            *token = (unsigned char)((literals < 15 ? literals : 15) << 4);
+            if (literals >= 15) {
+                op = fclib_lz4_write_length(op, literals - 15);
+            }
+            memcpy(op, anchor, literals);
+            op += literals;
+            const size_t offset = (size_t)(ip - match);
+            *op++ = (unsigned char)offset;
+            *op++ = (unsigned char)(offset >> 8);
+            *token |= (unsigned char)(match_len < 15 ? match_len : 15);
+            if (match_len >= 15) {
+                op = fclib_lz4_write_length(op, match_len - 15);
+            }
+            ip = p;
+            anchor = ip;
+            if (ip > mflimit) {
+                break;
+            }
+            // Remember a position inside the match, which improves the ratio
+            // for repetitive data at almost no cost
+            table[fclib_lz4_hash(fclib_lz4_read32(ip - 2))] =
+                (uint32_t)(ip - 2 - base);
+        }
+    }
+last_literals:;
+    const size_t literals = (size_t)(iend - anchor);
+    if (1 + literals / 255 + 1 + literals > (size_t)(oend - op)) {
+        return 0;
+    }
+    *op++ = (unsigned char)((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) {
+        op = fclib_lz4_write_length(op, literals - 15);
+    }
+    memcpy(op, anchor, literals);
+    op += literals;
+    return (size_t)(op - (unsigned char *)dest);
+}
+
+// Decompresses a block to `dest`, where matches may reach back to `lowest`,
+// which lies at or before `dest`. This is how linked frame blocks refer to the
+// output of the previous blocks
+static bool fclib_lz4_decompress_with_prefix( //
+    unsigned char *lowest,                    //
+    unsigned char *dest,                      //
+    const size_t dest_cap,                    //
+    const unsigned char *ip,                  //
+    const size_t len,                         //
+    size_t *written                           //
+) {
+    const unsigned char *const iend = ip + len;
+    unsigned char *op = dest;
+    unsigned char *const oend = dest + dest_cap;
+    while (true) {
+        if (ip >= iend) {
+            return false;
+        }
+        const unsigned token = *ip++;
+        size_t literals = token >> 4;
+        // Most sequences have less than 15 literals and a match shorter than
+        // 19 bytes. With enough room in both buffers they are copied with a
+        // fixed number of unconditional 16, 8 and 2 byte copies
+        if (literals < 15 && (token & 15) < 15 && iend - ip >= 32 &&
+            oend - op >= 32) {
+            memcpy(op, ip, 16);
+            op += literals;
+            ip += literals;
+            const size_t offset = (size_t)ip[0] | (size_t)ip[1] << 8;
+            ip += 2;
+            if (offset >= 8 && offset <= (size_t)(op - lowest)) {
+                const unsigned char *const match = op - offset;
+                memcpy(op, match, 8);
+                memcpy(op + 8, match + 8, 8);
+                memcpy(op + 16, match + 16, 2);
+                op += (token & 15) + FCLIB_LZ4_MIN_MATCH;
+                continue;
+            }
+            // Rare short or invalid offsets take the general path
+            ip -= 2;
+            literals = 0;
+        }
+        // The fast path copies a fixed 16 bytes, which covers every short
+        // literal run whenever both buffers have enough room left
+        if (literals < 15 && iend - ip >= 16 && oend - op >= 16) {
+            memcpy(op, ip, 16);
+        } else {
+            if (literals == 15) {
+                unsigned s;
+                do {
+                    if (ip >= iend) {
+                        return false;
+                    }
+                    s = *ip++;
+                    literals += s;
+                } while (s == 255);
+            }
+            if (literals > (size_t)(iend - ip) ||
+                literals > (size_t)(oend - op)) {
+                return false;
+            }
+            memcpy(op, ip, literals);
+        }
+        op += literals;
+        ip += literals;
+        if (ip == iend) {
+            // The last sequence of a block only consists of literals
+            break;
+        }
+        if (iend - ip < 2) {
+            return false;
+        }
+        const size_t offset = (size_t)ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - lowest)) {
+            return false;
+        }
+        size_t match_len = token & 15;
+        if (match_len == 15) {
+            unsigned s;
+            do {
+                if (ip >= iend) {
+                    return false;
+                }
+                s = *ip++;
+                match_len += s;
+            } while (s == 255);
+        }
+        match_len += FCLIB_LZ4_MIN_MATCH;
+        if (match_len > (size_t)(oend - op)) {
+            return false;
+        }
+        const unsigned char *match = op - offset;
+        unsigned char *const match_end = op + match_len;
+        if (offset >= 16 && (size_t)(oend - match_end) >= 16) {
+            // Chunks of 16 bytes never overlap their own source, and the
+            // overshoot past the match end stays within the buffer
+            do {
+                memcpy(op, match, 16);
+                op += 16;
+                match += 16;
+            } while (op < match_end);
+        } else if (offset >= 8 && (size_t)(oend - match_end) >= 8) {
+            do {
+                memcpy(op, match, 8);
+                op += 8;
+                match += 8;
+            } while (op < match_end);
+        } else if (offset == 1) {
+            memset(op, *match, match_len);
+        } else {
+            while (op < match_end) {
+                *op++ = *match++;
+            }
+        }
+        op = match_end;
+    }
+    *written = (size_t)(op - dest);
+    return true;
+}
+
+FCLIB_API bool fclib_lz4_decompress_block( //
+    void *dest,                            //
+    const size_t dest_cap,                 //
+    const void *src,                       //
+    const size_t len,                      //
+    size_t *written                        //
+) {
+    return fclib_lz4_decompress_with_prefix((unsigned char *)dest,
+        (unsigned char *)dest, dest_cap, (const unsigned char *)src, len,
+        written);
+}
+
+// Writes a frame header with independent 64 KiB blocks
+static void fclib_lz4_write_header( //
+    fclib_str_builder_t *out,       //
+    const bool content_checksum,    //
+    const bool has_content_size,    //
+    const uint64_t content_size     //
+) {
+    unsigned char *const header =
+        (unsigned char *)fclib_str_builder_reserve(out, 15);
+    fclib_lz4_write32(header, FCLIB_LZ4_MAGIC);
+    // Version 01, independent blocks
+    header[4] = 0x60;
+    if (content_checksum) {
+        header[4] |= 0x04;
+    }
+    // 64 KiB maximum block size
+    header[5] = 0x40;
+    size_t len = 6;
+    if (has_content_size) {
+        header[4] |= 0x08;
+        for (size_t i = 0; i < 8; i++) {
+            header[len++] = (unsigned char)(content_size >> (8 * i));
+        }
+    }
+    header[len] = (unsigned char)(fclib_xxh32(header + 4, len - 4, 0) >> 8);
+    fclib_str_builder_advance(out, len + 1);
+}
+
+// Appends one data block to the frame, stored uncompressed if compression does
+// not make it smaller
+static void fclib_lz4_write_block( //
+    fclib_str_builder_t *out,      //
+    const void *data,              //
+    const size_t len               //
+) {
+    const size_t bound = fclib_lz4_compress_bound(len);
+    unsigned char *const block =
+        (unsigned char *)fclib_str_builder_reserve(out, 4 + bound);
+    const size_t compressed = fclib_lz4_compress_block( //
+        block + 4, len, data, len);
+    if (compressed == 0) {
+        fclib_lz4_write32(block, (uint32_t)len | 0x80000000u);
+        memcpy(block + 4, data, len);
+        fclib_str_builder_advance(out, 4 + len);
+        return;
+    }
+    fclib_lz4_write32(block, (uint32_t)compressed);
+    fclib_str_builder_advance(out, 4 + compressed);
+}
+
+static void fclib_lz4_write_end(   //
+    fclib_str_builder_t *out,      //
+    const bool content_checksum,   //
+    const uint32_t checksum_value  //
+) {
+    unsigned char *const end =
+        (unsigned char *)fclib_str_builder_reserve(out, 8);
+    fclib_lz4_write32(end, 0);
+    if (!content_checksum) {
+        fclib_str_builder_advance(out, 4);
+        return;
+    }
+    fclib_lz4_write32(end + 4, checksum_value);
+    fclib_str_builder_advance(out, 8);
+}
+
+FCLIB_API fclib_str_t *fclib_lz4_compress(const void *src, const size_t len) {
+    fclib_str_builder_t out = fclib_str_builder_init( //
+        fclib_lz4_compress_bound(len) / 2 + 32);
+    fclib_lz4_write_header(&out, true, true, len);
+    const char *const data = (const char *)src;
+    for (size_t pos = 0; pos < len; pos += FCLIB_LZ4_BLOCK_SIZE) {
+        const size_t rest = len - pos;
+        fclib_lz4_write_block(&out, data + pos,
+            rest < FCLIB_LZ4_BLOCK_SIZE ? rest : FCLIB_LZ4_BLOCK_SIZE);
+    }
+    fclib_lz4_write_end(&out, true, fclib_xxh32(src, len, 0));
+    return fclib_str_builder_finish(&out);
+}
+
+FCLIB_API fclib_str_t *fclib_lz4_compress_str(const fclib_str_t *str) {
+    return fclib_lz4_compress(str->value, str->len);
+}
+
+FCLIB_API fclib_str_t *fclib_lz4_compress_arr( //
+    const fclib_arr_t *arr,                    //
+    const size_t element_size                  //
+) {
+    const size_t size = sizeof(fclib_arr_t) + arr->len * sizeof(size_t) +
+        fclib_arr_get_len(arr) * element_size;
+    return fclib_lz4_compress(arr, size);
+}
+
+FCLIB_API fclib_str_t *fclib_lz4_decompress(const void *src, const size_t len) {
+    // The frame header usually announces the content size, which the decoder
+    // reserves once it is known
+    fclib_str_builder_t out = fclib_str_builder_init(64);
+    fclib_lz4_decoder_t decoder = fclib_lz4_decoder_init(&out);
+    const fclib_lz4_status_t status = fclib_lz4_decoder_write( //
+        &decoder, src, len);
+    fclib_lz4_decoder_free(&decoder);
+    if (status != FCLIB_LZ4_DONE) {
+        fclib_str_builder_free(&out);
+        return NULL;
+    }
+    return fclib_str_builder_finish(&out);
+}
+
+FCLIB_API fclib_arr_t *fclib_lz4_decompress_arr( //
+    const fclib_str_t *frame,                    //
+    const size_t element_size                    //
+) {
+    fclib_str_t *data = fclib_lz4_decompress(frame->value, frame->len);
+    if (data == NULL) {
+        return NULL;
+    }
+    // Check that the dimension lengths describe exactly the decompressed size
+    // before handing out the data as an array
+    size_t dimensionality;
+    bool valid = data->len >= sizeof(fclib_arr_t);
+    if (valid) {
+        memcpy(&dimensionality, data->value, sizeof(size_t));
+        valid = dimensionality <=
+            (data->len - sizeof(fclib_arr_t)) / sizeof(size_t);
+    }
+    if (valid) {
+        const size_t header_size =
+            sizeof(fclib_arr_t) + dimensionality * sizeof(size_t);
+        size_t elements = 1;
+        for (size_t i = 0; i < dimensionality && valid; i++) {
+            size_t dim_len;
+            memcpy(&dim_len, data->value + (i + 1) * sizeof(size_t),
+                sizeof(size_t));
+            valid = dim_len == 0 || elements <= SIZE_MAX / dim_len;
+            elements *= dim_len;
+        }
+        valid = valid && element_size != 0 &&
+            elements <= (data->len - header_size) / element_size &&
+            header_size + elements * element_size == data->len;
+    }
+    if (!valid) {
+        free(data);
+        return NULL;
+    }
+    // The decompressed bytes already have the exact memory layout of the
+    // array, they only need to be moved to the start of the allocation
+    const size_t size = data->len;
+    memmove(data, data->value, size);
+    return (fclib_arr_t *)data;
+}
+
+FCLIB_API fclib_lz4_encoder_t fclib_lz4_encoder_init( //
+    fclib_str_builder_t *out,                         //
+    const bool content_checksum                       //
+) {
+    fclib_lz4_encoder_t encoder;
+    encoder.out = out;
+    encoder.content_checksum = fclib_checksum_init(FCLIB_CHECKSUM_XXH32, 0);
+    encoder.has_content_checksum = content_checksum;
+    encoder.block = (char *)malloc(FCLIB_LZ4_BLOCK_SIZE);
+    encoder.block_len = 0;
+    fclib_lz4_write_header(out, content_checksum, false, 0);
+    return encoder;
+}
+
+FCLIB_API void fclib_lz4_encoder_write( //
+    fclib_lz4_encoder_t *encoder,       //
+    const void *data,                   //
+    const size_t len                    //
+) {
+    if (encoder->has_content_checksum) {
+        fclib_checksum_update(&encoder->content_checksum, data, len);
+    }
+    const char *p = (const char *)data;
+    size_t rest = len;
+    if (encoder->block_len > 0) {
+        const size_t missing = FCLIB_LZ4_BLOCK_SIZE - encoder->block_len;
+        const size_t take = rest < missing ? rest : missing;
+        memcpy(encoder->block + encoder->block_len, p, take);
+        encoder->block_len += take;
+        p += take;
+        rest -= take;
+        if (encoder->block_len < FCLIB_LZ4_BLOCK_SIZE) {
+            return;
+        }
+        fclib_lz4_write_block(encoder->out, encoder->block, encoder->block_len);
+        encoder->block_len = 0;
+    }
+    // Full blocks are compressed straight from the caller's data
+    for (; rest >= FCLIB_LZ4_BLOCK_SIZE; rest -= FCLIB_LZ4_BLOCK_SIZE) {
+        fclib_lz4_write_block(encoder->out, p, FCLIB_LZ4_BLOCK_SIZE);
+        p += FCLIB_LZ4_BLOCK_SIZE;
+    }
+    memcpy(encoder->block, p, rest);
+    encoder->block_len = rest;
+}
+
+FCLIB_API void fclib_lz4_encoder_finish(fclib_lz4_encoder_t *encoder) {
+    if (encoder->block_len > 0) {
+        fclib_lz4_write_block(encoder->out, encoder->block, encoder->block_len);
+    }
+    fclib_lz4_write_end(encoder->out, encoder->has_content_checksum,
+        (uint32_t)fclib_checksum_digest(&encoder->content_checksum));
+    free(encoder->block);
+    encoder->block = NULL;
+    encoder->block_len = 0;
+}
+
+FCLIB_API fclib_lz4_decoder_t fclib_lz4_decoder_init( //
+    fclib_str_builder_t *out                          //
+) {
+    fclib_lz4_decoder_t decoder;
+    memset(&decoder, 0, sizeof(decoder));
+    decoder.out = out;
+    decoder.status = FCLIB_LZ4_DONE;
+    decoder.stage = FCLIB_LZ4_STAGE_MAGIC;
+    return decoder;
+}
+
+// Returns a pointer to the next `need` bytes of input, taken straight from the
+// fed data when possible. Returns NULL if less than `need` bytes are available
+// yet, in which case the available bytes are kept until the next write
+static const unsigned char *fclib_lz4_decoder_take( //
+    fclib_lz4_decoder_t *decoder,                   //
+    const unsigned char **data,                     //
+    size_t *len,                                    //
+    const size_t need                               //
+) {
+    if (decoder->pending_len == 0 && *len >= need) {
+        const unsigned char *const result = *data;
+        *data += need;
+        *len -= need;
+        return result;
+    }
+    if (decoder->pending_cap < need) {
+        decoder->pending = (char *)realloc(decoder->pending, need);
+        decoder->pending_cap = need;
+    }
+    const size_t missing = need - decoder->pending_len;
+    const size_t take = *len < missing ? *len : missing;
+    memcpy(decoder->pending + decoder->pending_len, *data, take);
+    decoder->pending_len += take;
+    *data += take;
+    *len -= take;
+    if (decoder->pending_len < need) {
+        return NULL;
+    }
+    decoder->pending_len = 0;
+    return (const unsigned char *)decoder->pending;
+}
+
+// Decompresses one block of the current frame and appends it to the output
+static bool fclib_lz4_decoder_block(  //
+    fclib_lz4_decoder_t *decoder,     //
+    const unsigned char *block,       //
+    const size_t size,                //
+    const bool compressed             //
+) {
+    const unsigned char flags = decoder->descriptor[0];
+    if (flags & 0x10) {
+        // Block checksum
+        if (fclib_xxh32(block, size, 0) != fclib_lz4_read32(block + size)) {
+            return false;
+        }
+    }
+    const char *decoded;
+    size_t decoded_len;
+    if (!compressed) {
+        if (size > decoder->block_max) {
+            return false;
+        }
+        decoded_len = size;
+        char *const dest = fclib_str_builder_reserve(decoder->out, size);
+        memcpy(dest, block, size);
+        fclib_str_builder_advance(decoder->out, size);
+        decoded = dest;
+    } else if (flags & 0x20) {
+        // Independent blocks are decompressed straight into the output
+        unsigned char *const dest = (unsigned char *)fclib_str_builder_reserve(
+            decoder->out, decoder->block_max);
+        if (!fclib_lz4_decompress_with_prefix(dest, dest, decoder->block_max,
+                block, size, &decoded_len)) {
+            return false;
+        }
+        fclib_str_builder_advance(decoder->out, decoded_len);
+        decoded = (const char *)dest;
+    } else {
+        // Linked blocks may refer to the last 64 KiB of the previous output,
+        // so they are decompressed behind a copy of it
+        unsigned char *const window = (unsigned char *)decoder->window;
+        unsigned char *const dest = window + decoder->history_len;
+        if (!fclib_lz4_decompress_with_prefix(window, dest, decoder->block_max,
+                block, size, &decoded_len)) {
+            return false;
+        }
+        fclib_str_builder_append_lit( //
+            decoder->out, (const char *)dest, decoded_len);
+        decoded = (const char *)dest;
+    }
+    // Hash the block before the history update below moves the window over
+    // the start of large linked blocks
+    if (flags & 0x04) {
+        fclib_checksum_update(&decoder->content_checksum, decoded, decoded_len);
+    }
+    if (!(flags & 0x20)) {
+        // Keep the history up to date for linked blocks, also across stored
+        // blocks
+        const size_t total = decoder->history_len + decoded_len;
+        if (decoded != decoder->window + decoder->history_len) {
+            memcpy(decoder->window + decoder->history_len, decoded,
+                decoded_len);
+        }
+        const size_t keep = total < FCLIB_LZ4_WINDOW ? total : FCLIB_LZ4_WINDOW;
+        memmove(decoder->window, decoder->window + total - keep, keep);
+        decoder->history_len = keep;
+    }
+    decoder->produced += decoded_len;
+    return true;
+}
+
+FCLIB_API fclib_lz4_status_t fclib_lz4_decoder_write( //
+    fclib_lz4_decoder_t *decoder,                     //
+    const void *data,                                 //
+    const size_t len                                  //
+) {
+    if (decoder->status == FCLIB_LZ4_ERROR) {
+        return FCLIB_LZ4_ERROR;
+    }
+    const unsigned char *p = (const unsigned char *)data;
+    size_t rest = len;
+    while (rest > 0) {
+        decoder->status = FCLIB_LZ4_NEED_INPUT;
+        const unsigned char *in;
+        switch (decoder->stage) {
+            case FCLIB_LZ4_STAGE_MAGIC: {
+                in = fclib_lz4_decoder_take(decoder, &p, &rest, 4);
+                if (in == NULL) {
+                    break;
+                }
+                const uint32_t magic = fclib_lz4_read32(in);
+                if ((magic & 0xFFFFFFF0u) == 0x184D2A50u) {
+                    // Skippable frame
+                    decoder->stage = FCLIB_LZ4_STAGE_SKIP_SIZE;
+                } else if (magic == FCLIB_LZ4_MAGIC) {
+                    decoder->stage = FCLIB_LZ4_STAGE_DESCRIPTOR;
+                } else {
+                    decoder->status = FCLIB_LZ4_ERROR;
+                    return FCLIB_LZ4_ERROR;
+                }
+                break;
+            }
+            case FCLIB_LZ4_STAGE_DESCRIPTOR: {
+                in = fclib_lz4_decoder_take(decoder, &p, &rest, 2);
+                if (in == NULL) {
+                    break;
+                }
+                const unsigned char flags = in[0];
+                const unsigned char block_descriptor = in[1];
+                const unsigned block_id = (block_descriptor >> 4) & 7;
+                // Only version 01 exists, dictionaries are not supported
+                if ((flags >> 6) != 1 || (flags & 0x03) != 0 ||
+                    (block_descriptor & 0x8F) != 0 || block_id < 4) {
+                    decoder->status = FCLIB_LZ4_ERROR;
+                    return FCLIB_LZ4_ERROR;
+                }
+                decoder->descriptor[0] = flags;
+                decoder->descriptor[1] = block_descriptor;
+                decoder->block_max = (size_t)1 << (8 + 2 * block_id);
+                decoder->stage = FCLIB_LZ4_STAGE_DESCRIPTOR_REST;
+                break;
+            }
+            case FCLIB_LZ4_STAGE_DESCRIPTOR_REST: {
+                const unsigned char flags = decoder->descriptor[0];
+                const size_t need = (flags & 0x08 ? 8 : 0) + 1;
+                in = fclib_lz4_decoder_take(decoder, &p, &rest, need);
+                if (in == NULL) {
+                    break;
+                }
+                memcpy(decoder->descriptor + 2, in, need - 1);
+                const uint32_t hash = fclib_xxh32( //
+                    decoder->descriptor, need + 1, 0);
+                if (((hash >> 8) & 0xFF) != in[need - 1]) {
+                    decoder->status = FCLIB_LZ4_ERROR;
+                    return FCLIB_LZ4_ERROR;
+                }
+                decoder->content_size = flags & 0x08 ? fclib_lz4_read64(in) : 0;
+                decoder->produced = 0;
+                // Reserve the announced size up front so the output is not
+                // copied while it grows. The header is not trusted beyond
+                // 1 GiB, larger outputs still grow geometrically
+                if (decoder->content_size <= ((uint64_t)1 << 30)) {
+                    fclib_str_builder_reserve(
+                        decoder->out, (size_t)decoder->content_size);
+                }
+                decoder->content_checksum = fclib_checksum_init( //
+                    FCLIB_CHECKSUM_XXH32, 0);
+                if (!(flags & 0x20)) {
+                    decoder->window = (char *)realloc(decoder->window,
+                        FCLIB_LZ4_WINDOW + decoder->block_max);
+                    decoder->history_len = 0;
+                }
+                decoder->stage = FCLIB_LZ4_STAGE_BLOCK_SIZE;
+                break;
+            }
+            case FCLIB_LZ4_STAGE_BLOCK_SIZE: {
+                in = fclib_lz4_decoder_take(decoder, &p, &rest, 4);
+                if (in == NULL) {
+                    break;
+                }
+                const uint32_t size = fclib_lz4_read32(in);
+                if (size != 0) {
+                    decoder->block_size = size;
+                    decoder->stage = FCLIB_LZ4_STAGE_BLOCK;
+                    break;
+                }
+                // The end mark, which is followed by the optional checksum
+                if (decoder->descriptor[0] & 0x08 &&
+                    decoder->produced != decoder->content_size) {
+                    decoder->status = FCLIB_LZ4_ERROR;
+                    return FCLIB_LZ4_ERROR;
+                }
+                if (decoder->descriptor[0] & 0x04) {
+                    decoder->stage = FCLIB_LZ4_STAGE_CONTENT_CHECKSUM;
+                } else {
+                    decoder->stage = FCLIB_LZ4_STAGE_MAGIC;
+                    decoder->status = FCLIB_LZ4_DONE;
+                }
+                break;
+            }
+            case FCLIB_LZ4_STAGE_BLOCK: {
+                const size_t size = decoder->block_size & 0x7FFFFFFFu;
+                if (size > decoder->block_max + 16) {
+                    decoder->status = FCLIB_LZ4_ERROR;
+                    return FCLIB_LZ4_ERROR;
+                }
+                const bool block_checksum = decoder->descriptor[0] & 0x10;
+                const size_t need = size + (block_checksum ? 4 : 0);
+                in = fclib_lz4_decoder_take(decoder, &p, &rest, need);
+                if (in == NULL) {
+                    break;
+                }
+                const bool compressed = !(decoder->block_size & 0x80000000u);
+                if (!fclib_lz4_decoder_block(decoder, in, size, compressed)) {
+                    decoder->status = FCLIB_LZ4_ERROR;
+                    return FCLIB_LZ4_ERROR;
+                }
+                decoder->stage = FCLIB_LZ4_STAGE_BLOCK_SIZE;
+                break;
+            }
+            case FCLIB_LZ4_STAGE_CONTENT_CHECKSUM: {
+                in = fclib_lz4_decoder_take(decoder, &p, &rest, 4);
+                if (in == NULL) {
+                    break;
+                }
+                if (fclib_lz4_read32(in) !=
+                    fclib_checksum_digest(&decoder->content_checksum)) {
+                    decoder->status = FCLIB_LZ4_ERROR;
+                    return FCLIB_LZ4_ERROR;
+                }
+                decoder->stage = FCLIB_LZ4_STAGE_MAGIC;
+                decoder->status = FCLIB_LZ4_DONE;
+                break;
+            }
+            case FCLIB_LZ4_STAGE_SKIP_SIZE: {
+                in = fclib_lz4_decoder_take(decoder, &p, &rest, 4);
+                if (in == NULL) {
+                    break;
+                }
+                decoder->skip = fclib_lz4_read32(in);
+                decoder->stage = FCLIB_LZ4_STAGE_SKIP;
+                if (decoder->skip == 0) {
+                    decoder->stage = FCLIB_LZ4_STAGE_MAGIC;
+                    decoder->status = FCLIB_LZ4_DONE;
+                }
+                break;
+            }
+            case FCLIB_LZ4_STAGE_SKIP: {
+                const size_t take = rest < decoder->skip ? rest : decoder->skip;
+                p += take;
+                rest -= take;
+                decoder->skip -= take;
+                if (decoder->skip == 0) {
+                    decoder->stage = FCLIB_LZ4_STAGE_MAGIC;
+                    decoder->status = FCLIB_LZ4_DONE;
+                }
+                break;
+            }
+        }
+    }
+    return decoder->status;
+}
+
+FCLIB_API void fclib_lz4_decoder_free(fclib_lz4_decoder_t *decoder) {
+    free(decoder->pending);
+    free(decoder->window);
+    decoder->pending = NULL;
+    decoder->pending_len = 0;
+    decoder->pending_cap = 0;
+    decoder->window = NULL;
+}
+
+#endif // endof FCLIB_IMPLEMENTATION
@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+// FCLIB_X86_SIMD controls whether the x86 SIMD kernels of fclib are compiled.
+// The kernels are compiled with per-function target attributes, so the whole
+// library can still be built for the x86-64 baseline and the fastest kernel is
+// selected at runtime. Defining FCLIB_NO_SIMD forces the portable fallbacks.
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__GNUC__) || defined(__clang__)) && !defined(FCLIB_NO_SIMD)
+#define FCLIB_X86_SIMD 1
+#include <immintrin.h>
+#define FCLIB_TARGET(features) __attribute__((target(features)))
+#else
+#define FCLIB_X86_SIMD 0
+#define FCLIB_TARGET(features)
+#endif
+
+/// @function `cpu_has_sse42`
+/// @brief Returns whether the CPU supports SSE4.2 (which includes the `crc32`
+/// instruction)
+///
+/// @return `bool` Whether SSE4.2 is available
+FCLIB_API bool fclib_cpu_has_sse42(void);
+
+/// @function `cpu_has_avx2`
+/// @brief Returns whether the CPU supports AVX2
+///
+/// @return `bool` Whether AVX2 is available
+FCLIB_API bool fclib_cpu_has_avx2(void);
+
+/// @function `cpu_has_fma`
+/// @brief Returns whether the CPU supports both AVX2 and FMA3
+///
+/// @return `bool` Whether AVX2 and FMA3 are available
+FCLIB_API bool fclib_cpu_has_fma(void);
+
+/// @function `cpu_has_avx512`
+/// @brief Returns whether the CPU supports the AVX-512 F, BW, DQ and VL
+/// subsets, which is the common baseline of all AVX-512 capable CPUs
+///
+/// @return `bool` Whether the AVX-512 baseline is available
+FCLIB_API bool fclib_cpu_has_avx512(void);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+FCLIB_API static inline bool cpu_has_sse42(void) {
+    return fclib_cpu_has_sse42();
+}
+FCLIB_API static inline bool cpu_has_avx2(void) {
+    return fclib_cpu_has_avx2();
+}
+FCLIB_API static inline bool cpu_has_fma(void) {
+    return fclib_cpu_has_fma();
+}
+FCLIB_API static inline bool cpu_has_avx512(void) {
+    return fclib_cpu_has_avx512();
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+FCLIB_API bool fclib_cpu_has_sse42(void) {
+#if FCLIB_X86_SIMD
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+}
+
+FCLIB_API bool fclib_cpu_has_avx2(void) {
+#if FCLIB_X86_SIMD
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+FCLIB_API bool fclib_cpu_has_fma(void) {
+#if FCLIB_X86_SIMD
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+FCLIB_API bool fclib_cpu_has_avx512(void) {
+#if FCLIB_X86_SIMD
+    return __builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512vl");
+#else
+    return false;
+#endif
+}
+
+#endif // endof FCLIB_IMPLEMENTATION
@@ -0,0 +1,915 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "cpu.h"
+#include "str.h"
+
+#ifdef FCLIB_MINIMAL
+#error "encoding.h builds on string views, which are not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// @enum `base64_variant_t`
+/// @brief The Base64 flavours of RFC 4648. The standard variant uses `+` and
+/// `/` and pads its output with `=`, the URL-safe variant uses `-` and `_` and
+/// is written without padding. Both decoders accept padded and unpadded input.
+typedef enum fclib_base64_variant_t {
+    FCLIB_BASE64_STANDARD,
+    FCLIB_BASE64_URL,
+} fclib_base64_variant_t;
+
+/// @function `base64_encoded_len`
+/// @brief Returns the exact number of characters encoding `len` bytes produces
+///
+/// @param `len` The number of bytes to encode
+/// @param `variant` The Base64 variant to encode with
+/// @return `size_t` The length of the encoded text
+FCLIB_API size_t fclib_base64_encoded_len( //
+    const size_t len,                      //
+    const fclib_base64_variant_t variant   //
+);
+
+/// @function `base64_decoded_len`
+/// @brief Returns the exact number of bytes decoding the given text produces,
+/// provided that the text is valid Base64
+///
+/// @param `src` The encoded text
+/// @param `len` The length of the encoded text
+/// @return `size_t` The number of decoded bytes
+FCLIB_API size_t fclib_base64_decoded_len(const char *src, const size_t len);
+
+/// @function `base64_encode_to`
+/// @brief Encodes `len` bytes of `src` into `dest`, which needs to hold at
+/// least `base64_encoded_len` characters. Uses AVX2 to encode 24 bytes per step
+/// when the CPU supports it.
+///
+/// @param `dest` The buffer to write the encoded text to
+/// @param `src` The bytes to encode
+/// @param `len` The number of bytes to encode
+/// @param `variant` The Base64 variant to encode with
+/// @return `size_t` The number of characters written
+FCLIB_API size_t fclib_base64_encode_to( //
+    char *dest,                          //
+    const char *src,                     //
+    const size_t len,                    //
+    const fclib_base64_variant_t variant //
+);
+
+/// @function `base64_decode_to`
+/// @brief Decodes `len` characters of `src` into `dest`, which needs to hold at
+/// least `base64_decoded_len` bytes. Uses AVX2 to decode 32 characters per step
+/// when the CPU supports it.
+///
+/// @param `dest` The buffer to write the decoded bytes to
+/// @param `src` The text to decode
+/// @param `len` The length of the text to decode
+/// @param `variant` The Base64 variant to decode
+/// @param `written` Set to the number of decoded bytes on success
+/// @return `bool` Whether the text was valid Base64 of the given variant
+FCLIB_API bool fclib_base64_decode_to(    //
+    char *dest,                           //
+    const char *src,                      //
+    const size_t len,                     //
+    const fclib_base64_variant_t variant, //
+    size_t *written                       //
+);
+
+/// @function `base64_encode`
+/// @brief Encodes `len` bytes of `src` into a newly created string
+///
+/// @param `src` The bytes to encode
+/// @param `len` The number of bytes to encode
+/// @param `variant` The Base64 variant to encode with
+/// @return `str_t *` The encoded text
+FCLIB_API fclib_str_t *fclib_base64_encode( //
+    const char *src,                        //
+    const size_t len,                       //
+    const fclib_base64_variant_t variant    //
+);
+
+/// @function `base64_encode_view`
+/// @brief Encodes the bytes the view points to into a newly created string
+///
+/// @param `src` The view of the bytes to encode
+/// @param `variant` The Base64 variant to encode with
+/// @return `str_t *` The encoded text
+FCLIB_API fclib_str_t *fclib_base64_encode_view( //
+    const fclib_str_view_t src,                  //
+    const fclib_base64_variant_t variant         //
+);
+
+/// @function `base64_encode_arr`
+/// @brief Encodes the data region of the given array (all elements, without
+/// the dimension lengths) into a newly created string
+///
+/// @param `arr` The array whose data to encode
+/// @param `element_size` The size of each element in bytes
+/// @param `variant` The Base64 variant to encode with
+/// @return `str_t *` The encoded text
+FCLIB_API fclib_str_t *fclib_base64_encode_arr( //
+    const fclib_arr_t *arr,                     //
+    const size_t element_size,                  //
+    const fclib_base64_variant_t variant        //
+);
+
+/// @function `base64_decode`
+/// @brief Decodes the given text into a newly created one-dimensional byte
+/// array
+///
+/// @param `src` The text to decode
+/// @param `len` The length of the text to decode
+/// @param `variant` The Base64 variant to decode
+/// @return `arr_t *` The decoded bytes, or `NULL` if the text is not valid
+FCLIB_API fclib_arr_t *fclib_base64_decode( //
+    const char *src,                        //
+    const size_t len,                       //
+    const fclib_base64_variant_t variant    //
+);
+
+/// @function `base64_decode_str`
+/// @brief Decodes the given string into a newly created one-dimensional byte
+/// array
+///
+/// @param `src` The string to decode
+/// @param `variant` The Base64 variant to decode
+/// @return `arr_t *` The decoded bytes, or `NULL` if the text is not valid
+FCLIB_API fclib_arr_t *fclib_base64_decode_str( //
+    const fclib_str_t *src,                     //
+    const fclib_base64_variant_t variant        //
+);
+
+/// @function `hex_encoded_len`
+/// @brief Returns the exact number of characters hex encoding `len` bytes
+/// produces
+///
+/// @param `len` The number of bytes to encode
+/// @return `size_t` The length of the encoded text
+FCLIB_API size_t fclib_hex_encoded_len(const size_t len);
+
+/// @function `hex_decoded_len`
+/// @brief Returns the exact number of bytes decoding `len` hex characters
+/// produces
+///
+/// @param `len` The length of the encoded text
+/// @return `size_t` The number of decoded bytes
+FCLIB_API size_t fclib_hex_decoded_len(const size_t len);
+
+/// @function `hex_encode_to`
+/// @brief Encodes `len` bytes of `src` as lowercase hex into `dest`, which
+/// needs to hold at least `hex_encoded_len` characters
+///
+/// @param `dest` The buffer to write the encoded text to
+/// @param `src` The bytes to encode
+/// @param `len` The number of bytes to encode
+/// @return `size_t` The number of characters written
+FCLIB_API size_t fclib_hex_encode_to( //
+    char *dest,                       //
+    const char *src,                  //
+    const size_t len                  //
+);
+
+/// @function `hex_decode_to`
+/// @brief Decodes `len` hex characters (upper or lower case) of `src` into
+/// `dest`, which needs to hold at least `hex_decoded_len` bytes
+///
+/// @param `dest` The buffer to write the decoded bytes to
+/// @param `src` The text to decode
+/// @param `len` The length of the text to decode
+/// @return `bool` Whether the text was valid hex
+FCLIB_API bool fclib_hex_decode_to( //
+    char *dest,                     //
+    const char *src,                //
+    const size_t len                //
+);
+
+/// @function `hex_encode`
+/// @brief Encodes `len` bytes of `src` as lowercase hex into a new string
+///
+/// @param `src` The bytes to encode
+/// @param `len` The number of bytes to encode
+/// @return `str_t *` The encoded text
+FCLIB_API fclib_str_t *fclib_hex_encode(const char *src, const size_t len);
+
+/// @function `hex_encode_view`
+/// @brief Encodes the bytes the view points to as lowercase hex into a new
+/// string
+///
+/// @param `src` The view of the bytes to encode
+/// @return `str_t *` The encoded text
+FCLIB_API fclib_str_t *fclib_hex_encode_view(const fclib_str_view_t src);
+
+/// @function `hex_encode_arr`
+/// @brief Encodes the data region of the given array as lowercase hex into a
+/// new string
+///
+/// @param `arr` The array whose data to encode
+/// @param `element_size` The size of each element in bytes
+/// @return `str_t *` The encoded text
+FCLIB_API fclib_str_t *fclib_hex_encode_arr( //
+    const fclib_arr_t *arr,                  //
+    const size_t element_size                //
+);
+
+/// @function `hex_decode`
+/// @brief Decodes the given hex text into a newly created one-dimensional byte
+/// array
+///
+/// @param `src` The text to decode
+/// @param `len` The length of the text to decode
+/// @return `arr_t *` The decoded bytes, or `NULL` if the text is not valid
+FCLIB_API fclib_arr_t *fclib_hex_decode(const char *src, const size_t len);
+
+/// @function `hex_decode_str`
+/// @brief Decodes the given hex string into a newly created one-dimensional
+/// byte array
+///
+/// @param `src` The string to decode
+/// @return `arr_t *` The decoded bytes, or `NULL` if the text is not valid
+FCLIB_API fclib_arr_t *fclib_hex_decode_str(const fclib_str_t *src);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_base64_variant_t base64_variant_t;
+
+FCLIB_API static inline size_t base64_encoded_len( //
+    const size_t len,                              //
+    const base64_variant_t variant                 //
+) {
+    return fclib_base64_encoded_len(len, variant);
+}
+FCLIB_API static inline size_t base64_decoded_len( //
+    const char *src,                               //
+    const size_t len                               //
+) {
+    return fclib_base64_decoded_len(src, len);
+}
+FCLIB_API static inline size_t base64_encode_to( //
+    char *dest,                                  //
+    const char *src,                             //
+    const size_t len,                            //
+    const base64_variant_t variant               //
+) {
+    return fclib_base64_encode_to(dest, src, len, variant);
+}
+FCLIB_API static inline bool base64_decode_to( //
+    char *dest,                                //
+    const char *src,                           //
+    const size_t len,                          //
+    const base64_variant_t variant,            //
+    size_t *written                            //
+) {
+    return fclib_base64_decode_to(dest, src, len, variant, written);
+}
+FCLIB_API static inline fclib_str_t *base64_encode( //
+    const char *src,                                //
+    const size_t len,                               //
+    const base64_variant_t variant                  //
+) {
+    return fclib_base64_encode(src, len, variant);
+}
+FCLIB_API static inline fclib_str_t *base64_encode_view( //
+    const fclib_str_view_t src,                          //
+    const base64_variant_t variant                       //
+) {
+    return fclib_base64_encode_view(src, variant);
+}
+FCLIB_API static inline fclib_str_t *base64_encode_arr( //
+    const fclib_arr_t *arr,                             //
+    const size_t element_size,                          //
+    const base64_variant_t variant                      //
+) {
+    return fclib_base64_encode_arr(arr, element_size, variant);
+}
+FCLIB_API static inline fclib_arr_t *base64_decode( //
+    const char *src,                                //
+    const size_t len,                               //
+    const base64_variant_t variant                  //
+) {
+    return fclib_base64_decode(src, len, variant);
+}
+FCLIB_API static inline fclib_arr_t *base64_decode_str( //
+    const fclib_str_t *src,                             //
+    const base64_variant_t variant                      //
+) {
+    return fclib_base64_decode_str(src, variant);
+}
+FCLIB_API static inline size_t hex_encoded_len(const size_t len) {
+    return fclib_hex_encoded_len(len);
+}
+FCLIB_API static inline size_t hex_decoded_len(const size_t len) {
+    return fclib_hex_decoded_len(len);
+}
+FCLIB_API static inline size_t hex_encode_to( //
+    char *dest,                               //
+    const char *src,                          //
+    const size_t len                          //
+) {
+    return fclib_hex_encode_to(dest, src, len);
+}
+FCLIB_API static inline bool hex_decode_to( //
+    char *dest,                             //
+    const char *src,                        //
+    const size_t len                        //
+) {
+    return fclib_hex_decode_to(dest, src, len);
+}
+FCLIB_API static inline fclib_str_t *hex_encode( //
+    const char *src,                             //
+    const size_t len                             //
+) {
+    return fclib_hex_encode(src, len);
+}
+FCLIB_API static inline fclib_str_t *hex_encode_view( //
+    const fclib_str_view_t src                        //
+) {
+    return fclib_hex_encode_view(src);
+}
+FCLIB_API static inline fclib_str_t *hex_encode_arr( //
+    const fclib_arr_t *arr,                          //
+    const size_t element_size                        //
+) {
+    return fclib_hex_encode_arr(arr, element_size);
+}
+FCLIB_API static inline fclib_arr_t *hex_decode( //
+    const char *src,                             //
+    const size_t len                             //
+) {
+    return fclib_hex_decode(src, len);
+}
+FCLIB_API static inline fclib_arr_t *hex_decode_str(const fclib_str_t *src) {
+    return fclib_hex_decode_str(src);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+static const char fclib_base64_alphabet_standard[65] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char fclib_base64_alphabet_url[65] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+static const char fclib_hex_digits[17] = "0123456789abcdef";
+
+// Map every character to its 6 bit value in the given Base64 variant, or to
+// 0xFF if it is not part of the alphabet. Random text makes the branches of a
+// range check mispredict all the time, the tables do not branch at all
+static const unsigned char fclib_base64_values_standard[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24,
+    0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
+    0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+static const unsigned char fclib_base64_values_url[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24,
+    0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
+    0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+// Maps a hex character of either case to its 4 bit value, or to 0xFF
+static const unsigned char fclib_hex_values[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+static unsigned char fclib_base64_value( //
+    const unsigned char c,               //
+    const fclib_base64_variant_t variant //
+) {
+    if (variant == FCLIB_BASE64_STANDARD) {
+        return fclib_base64_values_standard[c];
+    }
+    return fclib_base64_values_url[c];
+}
+
+static unsigned char fclib_hex_value(const unsigned char c) {
+    return fclib_hex_values[c];
+}
+
+#if FCLIB_X86_SIMD
+// AVX2 Base64 kernels after Muła and Lemire, "Faster Base64 Encoding and
+// Decoding using AVX2 Instructions". Both process as many full blocks as they
+// can and return how much input they consumed, the rest is done by the scalar
+// code.
+
+FCLIB_TARGET("avx2")
+static size_t fclib_base64_encode_avx2( //
+    char *dest,                         //
+    const char *src,                    //
+    const size_t len,                   //
+    const bool url                      //
+) {
+    // Offsets from the 6 bit values to the characters of each alphabet range,
+    // indexed by the range the value lies in
+    const __m256i offsets = url
+        ? _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17,
+              32, 0, 0, 65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32,
+              0, 0)
+        : _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19,
+              -16, 0, 0, 65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19,
+              -16, 0, 0);
+    const __m256i spread = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3,
+        4, 1, 2, 0, 1, 14, 15, 13, 14, 11, 12, 10, 11, 8, 9, 7, 8, 5, 6, 4, 5);
+    size_t pos = 0;
+    size_t out = 0;
+    // Every step reads 28 bytes and consumes 24 of them
+    while (len - pos >= 28) {
+        // The low lane holds bytes 0..11 at offset 4, the high lane holds
+        // bytes 12..23 at offset 0, so each lane has its 12 bytes in reach
+        const __m128i lo = _mm_loadu_si128( //
+            (const __m128i *)(const void *)(src + pos));
+        const __m128i hi = _mm_loadu_si128( //
+            (const __m128i *)(const void *)(src + pos + 12));
+        __m256i in = _mm256_inserti128_si256( //
+            _mm256_castsi128_si256(_mm_slli_si128(lo, 4)), hi, 1);
+        in = _mm256_shuffle_epi8(in, spread);
+        // Move the four 6 bit fields of every 3 byte group into their own byte
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00));
+        const __m256i t1 = _mm256_mulhi_epu16( //
+            t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0));
+        const __m256i t3 = _mm256_mullo_epi16( //
+            t2, _mm256_set1_epi32(0x01000010));
+        const __m256i values = _mm256_or_si256(t1, t3);
+        // Range 0 (A-Z) has index 0, all others are the value minus 51, plus
+        // one for every value above 25
+        __m256i ranges = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+        ranges = _mm256_sub_epi8(ranges, //
+            _mm256_cmpgt_epi8(values, _mm256_set1_epi8(25)));
+        const __m256i chars = _mm256_add_epi8( //
+            values, _mm256_shuffle_epi8(offsets, ranges));
+        _mm256_storeu_si256((__m256i *)(void *)(dest + out), chars);
+        pos += 24;
+        out += 32;
+    }
+    return pos;
+}
+
+FCLIB_TARGET("avx2")
+static size_t fclib_base64_decode_avx2( //
+    char *dest,                         //
+    const char *src,                    //
+    const size_t len,                   //
+    const bool url                      //
+) {
+    const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11,
+        0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B,
+        0x1B, 0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08,
+        0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0,
+        0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+    const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13,
+        12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1,
+        -1);
+    size_t pos = 0;
+    size_t out = 0;
+    // Every step stores 32 bytes of which only 24 are valid, so stop early
+    // enough for the overhanging store to stay within the decoded length
+    while (len - pos >= 45) {
+        __m256i str = _mm256_loadu_si256( //
+            (const __m256i *)(const void *)(src + pos));
+        if (url) {
+            // The URL alphabet is mapped onto the standard one, after making
+            // sure that the input does not contain the standard characters
+            const __m256i is_plus = _mm256_cmpeq_epi8( //
+                str, _mm256_set1_epi8('+'));
+            const __m256i is_slash = _mm256_cmpeq_epi8(str, mask_2f);
+            if (!_mm256_testz_si256(_mm256_or_si256(is_plus, is_slash),
+                    _mm256_set1_epi8(-1))) {
+                break;
+            }
+            const __m256i is_minus = _mm256_cmpeq_epi8( //
+                str, _mm256_set1_epi8('-'));
+            const __m256i is_underscore = _mm256_cmpeq_epi8( //
+                str, _mm256_set1_epi8('_'));
+            str = _mm256_blendv_epi8(str, _mm256_set1_epi8('+'), is_minus);
+            str = _mm256_blendv_epi8(str, mask_2f, is_underscore);
+        }
+        const __m256i hi_nibbles = _mm256_and_si256( //
+            _mm256_srli_epi32(str, 4), mask_2f);
+        const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+        const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+        if (!_mm256_testz_si256(lo, hi)) {
+            // Invalid character (or padding), let the scalar code handle it
+            break;
+        }
+        const __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+        const __m256i roll = _mm256_shuffle_epi8( //
+            lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+        str = _mm256_add_epi8(str, roll);
+        // Merge the 6 bit values into 3 byte groups and pack them together
+        const __m256i merged = _mm256_maddubs_epi16( //
+            str, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_madd_epi16( //
+            merged, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_shuffle_epi8(packed, pack);
+        packed = _mm256_permutevar8x32_epi32( //
+            packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256((__m256i *)(void *)(dest + out), packed);
+        pos += 32;
+        out += 24;
+    }
+    return pos;
+}
+
+FCLIB_TARGET("avx2")
+static size_t fclib_hex_encode_avx2( //
+    char *dest,                      //
+    const char *src,                 //
+    const size_t len                 //
+) {
+    const __m256i digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6',
+        '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', '0', '1', '2', '3', '4',
+        '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m256i low_nibble = _mm256_set1_epi16(0x0F);
+    size_t pos = 0;
+    for (; len - pos >= 16; pos += 16) {
+        const __m256i bytes = _mm256_cvtepu8_epi16( //
+            _mm_loadu_si128((const __m128i *)(const void *)(src + pos)));
+        // Every 16 bit lane becomes (low nibble << 8) | high nibble, so that
+        // the high nibble ends up first in memory
+        const __m256i nibbles = _mm256_or_si256(_mm256_srli_epi16(bytes, 4),
+            _mm256_slli_epi16(_mm256_and_si256(bytes, low_nibble), 8));
+        _mm256_storeu_si256((__m256i *)(void *)(dest + pos * 2),
+            _mm256_shuffle_epi8(digits, nibbles));
+    }
+    return pos;
+}
+
+FCLIB_TARGET("avx2")
+static size_t fclib_hex_decode_avx2( //
+    char *dest,                      //
+    const char *src,                 //
+    const size_t len                 //
+) {
+    size_t pos = 0;
+    for (; len - pos >= 32; pos += 32) {
+        const __m256i chars = _mm256_loadu_si256( //
+            (const __m256i *)(const void *)(src + pos));
+        const __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+        const __m256i is_digit = _mm256_and_si256(
+            _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chars));
+        const __m256i is_letter = _mm256_and_si256(
+            _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+        if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)) != -1) {
+            break;
+        }
+        const __m256i values = _mm256_blendv_epi8(
+            _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10)),
+            _mm256_sub_epi8(chars, _mm256_set1_epi8('0')), is_digit);
+        // high * 16 + low for every pair of nibbles
+        const __m256i pairs = _mm256_maddubs_epi16( //
+            values, _mm256_set1_epi16(0x0110));
+        const __m256i packed = _mm256_permute4x64_epi64( //
+            _mm256_packus_epi16(pairs, pairs), 0x08);
+        _mm_storeu_si128((__m128i *)(void *)(dest + pos / 2),
+            _mm256_castsi256_si128(packed));
+    }
+    return pos;
+}
+#endif
+
+FCLIB_API size_t fclib_base64_encoded_len( //
+    const size_t len,                      //
+    const fclib_base64_variant_t variant   //
+) {
+    if (variant == FCLIB_BASE64_STANDARD) {
+        return (len + 2) / 3 * 4;
+    }
+    return len / 3 * 4 + (len % 3 == 0 ? 0 : len % 3 + 1);
+}
+
+FCLIB_API size_t fclib_base64_decoded_len(const char *src, const size_t len) {
+    size_t chars = len;
+    if (len % 4 == 0) {
+        for (size_t i = 0; i < 2 && chars > 0 && src[chars - 1] == '='; i++) {
+            chars--;
+        }
+    }
+    return chars / 4 * 3 + (chars % 4 == 0 ? 0 : chars % 4 - 1);
+}
+
+FCLIB_API size_t fclib_base64_encode_to( //
+    char *dest,                          //
+    const char *src,                     //
+    const size_t len,                    //
+    const fclib_base64_variant_t variant //
+) {
+    const char *const alphabet = variant == FCLIB_BASE64_STANDARD
+        ? fclib_base64_alphabet_standard
+        : fclib_base64_alphabet_url;
+    const unsigned char *const bytes = (const unsigned char *)src;
+    size_t pos = 0;
+#if FCLIB_X86_SIMD
+    if (len >= 28 && fclib_cpu_has_avx2()) {
+        pos = fclib_base64_encode_avx2( //
+            dest, src, len, variant == FCLIB_BASE64_URL);
+    }
+#endif
+    size_t out = pos / 3 * 4;
+    for (; len - pos >= 3; pos += 3) {
+        const uint32_t group = (uint32_t)bytes[pos] << 16 |
+            (uint32_t)bytes[pos + 1] << 8 | bytes[pos + 2];
+        dest[out++] = alphabet[group >> 18];
+        dest[out++] = alphabet[(group >> 12) & 0x3F];
+        dest[out++] = alphabet[(group >> 6) & 0x3F];
+        dest[out++] = alphabet[group & 0x3F];
+    }
+    const size_t rest = len - pos;
+    if (rest > 0) {
+        const uint32_t group = (uint32_t)bytes[pos] << 16 |
+            (rest == 2 ? (uint32_t)bytes[pos + 1] << 8 : 0);
+        dest[out++] = alphabet[group >> 18];
+        dest[out++] = alphabet[(group >> 12) & 0x3F];
+        if (rest == 2) {
+            dest[out++] = alphabet[(group >> 6) & 0x3F];
+        }
+        if (variant == FCLIB_BASE64_STANDARD) {
+            dest[out++] = '=';
+            if (rest == 1) {
+                dest[out++] = '=';
+            }
+        }
+    }
+    return out;
+}
+
+FCLIB_API bool fclib_base64_decode_to(    //
+    char *dest,                           //
+    const char *src,                      //
+    const size_t len,                     //
+    const fclib_base64_variant_t variant, //
+    size_t *written                       //
+) {
+    // Padding is only allowed to complete the last group of four
+    size_t chars = len;
+    if (len % 4 == 0) {
+        for (size_t i = 0; i < 2 && chars > 0 && src[chars - 1] == '='; i++) {
+            chars--;
+        }
+    }
+    if (chars % 4 == 1) {
+        return false;
+    }
+    size_t pos = 0;
+#if FCLIB_X86_SIMD
+    if (chars >= 45 && fclib_cpu_has_avx2()) {
+        pos = fclib_base64_decode_avx2( //
+            dest, src, chars, variant == FCLIB_BASE64_URL);
+    }
+#endif
+    size_t out = pos / 4 * 3;
+    const unsigned char *const text = (const unsigned char *)src;
+    for (; chars - pos >= 4; pos += 4) {
+        const unsigned char a = fclib_base64_value(text[pos], variant);
+        const unsigned char b = fclib_base64_value(text[pos + 1], variant);
+        const unsigned char c = fclib_base64_value(text[pos + 2], variant);
+        const unsigned char d = fclib_base64_value(text[pos + 3], variant);
+        if ((a | b | c | d) & 0x80) {
+            return false;
+        }
+        const uint32_t group = (uint32_t)a << 18 | (uint32_t)b << 12 |
+            (uint32_t)c << 6 | d;
+        dest[out++] = (char)(group >> 16);
+        dest[out++] = (char)(group >> 8);
+        dest[out++] = (char)group;
+    }
+    const size_t rest = chars - pos;
+    if (rest > 0) {
+        const unsigned char a = fclib_base64_value(text[pos], variant);
+        const unsigned char b = fclib_base64_value(text[pos + 1], variant);
+        const unsigned char c =
+            rest == 3 ? fclib_base64_value(text[pos + 2], variant) : 0;
+        if ((a | b | c) & 0x80) {
+            return false;
+        }
+        const uint32_t group = (uint32_t)a << 18 | (uint32_t)b << 12 |
+            (uint32_t)c << 6;
+        dest[out++] = (char)(group >> 16);
+        if (rest == 3) {
+            dest[out++] = (char)(group >> 8);
+        }
+    }
+    *written = out;
+    return true;
+}
+
+FCLIB_API fclib_str_t *fclib_base64_encode( //
+    const char *src,                        //
+    const size_t len,                       //
+    const fclib_base64_variant_t variant    //
+) {
+    fclib_str_t *result = fclib_str_create( //
+        fclib_base64_encoded_len(len, variant));
+    fclib_base64_encode_to(result->value, src, len, variant);
+    return result;
+}
+
+FCLIB_API fclib_str_t *fclib_base64_encode_view( //
+    const fclib_str_view_t src,                  //
+    const fclib_base64_variant_t variant         //
+) {
+    return fclib_base64_encode(src.value, src.len, variant);
+}
+
+FCLIB_API fclib_str_t *fclib_base64_encode_arr( //
+    const fclib_arr_t *arr,                     //
+    const size_t element_size,                  //
+    const fclib_base64_variant_t variant        //
+) {
+    const char *const data = arr->value + arr->len * sizeof(size_t);
+    return fclib_base64_encode( //
+        data, fclib_arr_get_len(arr) * element_size, variant);
+}
+
+FCLIB_API fclib_arr_t *fclib_base64_decode( //
+    const char *src,                        //
+    const size_t len,                       //
+    const fclib_base64_variant_t variant    //
+) {
+    const size_t decoded_len = fclib_base64_decoded_len(src, len);
+    fclib_arr_t *result = fclib_arr_create(1, 1, &decoded_len);
+    size_t written;
+    if (!fclib_base64_decode_to(fclib_arr_get_data(result), src, len, variant,
+            &written)) {
+        free(result);
+        return NULL;
+    }
+    return result;
+}
+
+FCLIB_API fclib_arr_t *fclib_base64_decode_str( //
+    const fclib_str_t *src,                     //
+    const fclib_base64_variant_t variant        //
+) {
+    return fclib_base64_decode(src->value, src->len, variant);
+}
+
+FCLIB_API size_t fclib_hex_encoded_len(const size_t len) {
+    return len * 2;
+}
+
+FCLIB_API size_t fclib_hex_decoded_len(const size_t len) {
+    return len / 2;
+}
+
+FCLIB_API size_t fclib_hex_encode_to( //
+    char *dest,                       //
+    const char *src,                  //
+    const size_t len                  //
+) {
+    size_t pos = 0;
+#if FCLIB_X86_SIMD
+    if (len >= 16 && fclib_cpu_has_avx2()) {
+        pos = fclib_hex_encode_avx2(dest, src, len);
+    }
+#endif
+    const unsigned char *const bytes = (const unsigned char *)src;
+    for (; pos < len; pos++) {
+        dest[pos * 2] = fclib_hex_digits[bytes[pos] >> 4];
+        dest[pos * 2 + 1] = fclib_hex_digits[bytes[pos] & 0xF];
+    }
+    return len * 2;
+}
+
+FCLIB_API bool fclib_hex_decode_to( //
+    char *dest,                     //
+    const char *src,                //
+    const size_t len                //
+) {
+    if (len % 2 != 0) {
+        return false;
+    }
+    size_t pos = 0;
+#if FCLIB_X86_SIMD
+    if (len >= 32 && fclib_cpu_has_avx2()) {
+        pos = fclib_hex_decode_avx2(dest, src, len);
+    }
+#endif
+    const unsigned char *const text = (const unsigned char *)src;
+    for (; pos < len; pos += 2) {
+        const unsigned char hi = fclib_hex_value(text[pos]);
+        const unsigned char lo = fclib_hex_value(text[pos + 1]);
+        if ((hi | lo) & 0x80) {
+            return false;
+        }
+        dest[pos / 2] = (char)(hi << 4 | lo);
+    }
+    return true;
+}
+
+FCLIB_API fclib_str_t *fclib_hex_encode(const char *src, const size_t len) {
+    fclib_str_t *result = fclib_str_create(fclib_hex_encoded_len(len));
+    fclib_hex_encode_to(result->value, src, len);
+    return result;
+}
+
+FCLIB_API fclib_str_t *fclib_hex_encode_view(const fclib_str_view_t src) {
+    return fclib_hex_encode(src.value, src.len);
+}
+
+FCLIB_API fclib_str_t *fclib_hex_encode_arr( //
+    const fclib_arr_t *arr,                  //
+    const size_t element_size                //
+) {
+    const char *const data = arr->value + arr->len * sizeof(size_t);
+    return fclib_hex_encode(data, fclib_arr_get_len(arr) * element_size);
+}
+
+FCLIB_API fclib_arr_t *fclib_hex_decode(const char *src, const size_t len) {
+    const size_t decoded_len = fclib_hex_decoded_len(len);
+    fclib_arr_t *result = fclib_arr_create(1, 1, &decoded_len);
+    if (!fclib_hex_decode_to(fclib_arr_get_data(result), src, len)) {
+        free(result);
+        return NULL;
+    }
+    return result;
+}
+
+FCLIB_API fclib_arr_t *fclib_hex_decode_str(const fclib_str_t *src) {
+    return fclib_hex_decode(src->value, src->len);
+}
+
+#endif // endof FCLIB_IMPLEMENTATION
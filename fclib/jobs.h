@@ -0,0 +1,613 @@
+#pragma once
+
+// The jobserver needs the POSIX.1-2008 APIs (mkfifo, setenv) and system.h,
+// which both need _GNU_SOURCE. This only takes effect when this header is
+// included before any system header, otherwise compile with -D_GNU_SOURCE,
+// which is checked below
+#if !defined(__WIN32__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "str.h"
+#include "system.h"
+
+#ifdef FCLIB_MINIMAL
+#error "jobs.h builds on system_command_ex, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __WIN32__
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// glibc settles which APIs it declares at the first system header, so the
+// _GNU_SOURCE above comes too late if another header was included before
+#if defined(__GLIBC__) && !defined(__USE_GNU)
+#error "jobs.h needs _GNU_SOURCE, compile with -D_GNU_SOURCE"
+#endif
+
+/// @typedef `jobserver_t`
+/// @brief A GNU make jobserver, which limits how many jobs all cooperating
+/// processes run at once. Every process may always run one job, each further
+/// job needs a token read from the jobserver, which is written back once the
+/// job has finished. `read_fd` and `write_fd` are -1 if there is no jobserver.
+/// `fifo_path` is the path of the named pipe holding the tokens, or NULL for
+/// the anonymous pipes of older make versions. An owned jobserver has been
+/// created by this process and holds `slots` jobs in total.
+typedef struct fclib_jobserver_t {
+    int read_fd;
+    int write_fd;
+    fclib_str_t *fifo_path;
+    bool owned;
+    size_t slots;
+} fclib_jobserver_t;
+
+/// @function `jobserver_connect`
+/// @brief Connects to the jobserver of the make which runs this process, as
+/// announced through `--jobserver-auth` (or `--jobserver-fds`) in the
+/// `MAKEFLAGS` environment variable. Both the `fifo:PATH` form of make 4.4 and
+/// the `R,W` pipe form of older versions are understood. If make runs without
+/// a jobserver, the jobserver stays unconnected and false is returned.
+///
+/// @param `jobserver` The jobserver to connect
+/// @return `bool` Whether a jobserver has been connected
+FCLIB_API bool fclib_jobserver_connect(fclib_jobserver_t *jobserver);
+
+/// @function `jobserver_create`
+/// @brief Creates a new jobserver for `slots` concurrent jobs, backed by a
+/// named pipe in the temporary directory. Call `jobserver_export` to make
+/// nested tools like make join it.
+///
+/// @param `jobserver` The jobserver to create
+/// @param `slots` The total number of jobs which may run at once
+/// @return `bool` Whether the jobserver could be created
+FCLIB_API bool fclib_jobserver_create( //
+    fclib_jobserver_t *jobserver,      //
+    const size_t slots                 //
+);
+
+/// @function `jobserver_export`
+/// @brief Sets `MAKEFLAGS` to announce the owned jobserver, so every command
+/// spawned from now on joins it instead of running its own jobs on top. The
+/// jobserver is announced in the `R,W` descriptor form every make version
+/// understands, so its descriptor is inherited by spawned commands from then
+/// on. This includes commands run through the spawn server, which receives
+/// the descriptor along with every command even if it was started before the
+/// jobserver existed.
+///
+/// @param `jobserver` The owned jobserver to announce
+/// @return `bool` Whether the jobserver has been announced
+FCLIB_API bool fclib_jobserver_export(const fclib_jobserver_t *jobserver);
+
+/// @function `jobserver_acquire`
+/// @brief Blocks until a token is available and takes it. The token has to be
+/// given back with `jobserver_release` once the job is done. Without a
+/// jobserver this returns immediately.
+///
+/// @param `jobserver` The jobserver to take the token from
+/// @param `token` Where to store the token
+/// @return `bool` Whether a token has been taken
+FCLIB_API bool fclib_jobserver_acquire( //
+    const fclib_jobserver_t *jobserver, //
+    char *token                         //
+);
+
+/// @function `jobserver_release`
+/// @brief Gives a token taken with `jobserver_acquire` back to the jobserver
+///
+/// @param `jobserver` The jobserver the token has been taken from
+/// @param `token` The token to give back
+FCLIB_API void fclib_jobserver_release( //
+    const fclib_jobserver_t *jobserver, //
+    const char token                    //
+);
+
+/// @function `jobserver_free`
+/// @brief Disconnects from the jobserver. An owned jobserver is removed, so it
+/// may only be freed once all commands which joined it have finished.
+///
+/// @param `jobserver` The jobserver to free
+FCLIB_API void fclib_jobserver_free(fclib_jobserver_t *jobserver);
+
+/// @function `jobs_run`
+/// @brief Runs all commands like `system_command_ex` with up to `jobs` of them
+/// at once and stores the result of each command at the same index of
+/// `results`. With a jobserver, every command but one at a time waits for a
+/// token before it is spawned, so all processes sharing the jobserver
+/// together stay within its limit. Workers still waiting for a token stop as
+/// soon as every command has been taken.
+///
+/// @param `commands` The commands to run, an array of `str_t *`
+/// @param `jobs` The maximum number of concurrent commands, 0 for the number
+/// of online CPUs
+/// @param `options` The limits to apply to each command, NULL for the default
+/// options
+/// @param `jobserver` The jobserver gating the commands, NULL for none
+/// @param `results` Where to store the results, one for each command
+FCLIB_API void fclib_jobs_run(              //
+    const fclib_arr_t *commands,            //
+    const size_t jobs,                      //
+    const fclib_command_options_t *options, //
+    const fclib_jobserver_t *jobserver,     //
+    fclib_command_result_t *results         //
+);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_jobserver_t jobserver_t;
+
+FCLIB_API static inline bool jobserver_connect(jobserver_t *jobserver) {
+    return fclib_jobserver_connect(jobserver);
+}
+
+FCLIB_API static inline bool jobserver_create( //
+    jobserver_t *jobserver,                    //
+    const size_t slots                         //
+) {
+    return fclib_jobserver_create(jobserver, slots);
+}
+
+FCLIB_API static inline bool jobserver_export(const jobserver_t *jobserver) {
+    return fclib_jobserver_export(jobserver);
+}
+
+FCLIB_API static inline bool jobserver_acquire( //
+    const jobserver_t *jobserver,               //
+    char *token                                 //
+) {
+    return fclib_jobserver_acquire(jobserver, token);
+}
+
+FCLIB_API static inline void jobserver_release( //
+    const jobserver_t *jobserver,               //
+    const char token                            //
+) {
+    fclib_jobserver_release(jobserver, token);
+}
+
+FCLIB_API static inline void jobserver_free(jobserver_t *jobserver) {
+    fclib_jobserver_free(jobserver);
+}
+
+FCLIB_API static inline void jobs_run(      //
+    const fclib_arr_t *commands,            //
+    const size_t jobs,                      //
+    const fclib_command_options_t *options, //
+    const jobserver_t *jobserver,           //
+    fclib_command_result_t *results         //
+) {
+    fclib_jobs_run(commands, jobs, options, jobserver, results);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+#ifndef __WIN32__
+// Parses a non-negative file descriptor number, returns -1 if there is none
+static int fclib_jobserver_parse_fd(const char **cursor) {
+    const char *c = *cursor;
+    if (*c < '0' || *c > '9') {
+        return -1;
+    }
+    int fd = 0;
+    while (*c >= '0' && *c <= '9' && fd < 1000000) {
+        fd = fd * 10 + (*c - '0');
+        c++;
+    }
+    *cursor = c;
+    return fd;
+}
+
+// Shared state of the workers of `jobs_run`
+typedef struct fclib_jobs_state_t {
+    fclib_str_t *const *command_list;
+    const fclib_command_options_t *options;
+    const fclib_jobserver_t *jobserver;
+    fclib_command_result_t *results;
+    size_t count;
+    atomic_size_t next;
+    // A non-blocking descriptor of our own to read tokens from, or -1 if the
+    // commands are not gated by a jobserver
+    int token_fd;
+    // The pipe whose write end is closed once every command has been taken,
+    // which wakes up all workers still waiting for a token
+    int done_fds[2];
+} fclib_jobs_state_t;
+
+typedef struct fclib_jobs_worker_t {
+    fclib_jobs_state_t *state;
+    // Whether the worker runs its jobs in the implicit slot every process has
+    bool implicit;
+} fclib_jobs_worker_t;
+
+// Opens a new non-blocking descriptor for reading the tokens of the
+// jobserver. It has its own file status flags, so the descriptor make shares
+// with other processes keeps its blocking mode. Returns -1 on failure
+static int fclib_jobs_open_tokens(const fclib_jobserver_t *jobserver) {
+    if (jobserver->fifo_path != NULL) {
+        return open(jobserver->fifo_path->value,
+            O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    }
+#ifdef __linux__
+    // Opening a pipe through /proc creates a new open file description of it
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", jobserver->read_fd);
+    return open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+#else
+    return -1;
+#endif
+}
+
+// Waits for a token like `jobserver_acquire`, but gives up once all commands
+// have been taken. A token which another process grabs first between the poll
+// and the read makes the read fail with EAGAIN instead of blocking
+static bool fclib_jobs_acquire(      //
+    const fclib_jobs_state_t *state, //
+    char *token                      //
+) {
+    while (true) {
+        const ssize_t got = read(state->token_fd, token, 1);
+        if (got == 1) {
+            return true;
+        }
+        if (got == 0 || (errno != EAGAIN && errno != EINTR)) {
+            // ErrJobs.TokenUnavailable
+            return false;
+        }
+        struct pollfd poll_fds[2] = {
+            {state->token_fd, POLLIN, 0}, {state->done_fds[0], POLLIN, 0}};
+        if (poll(poll_fds, 2, -1) > 0 && poll_fds[1].revents != 0) {
+            return false;
+        }
+    }
+}
+
+static void *fclib_jobs_worker(void *arg) {
+    const fclib_jobs_worker_t *worker = (const fclib_jobs_worker_t *)arg;
+    fclib_jobs_state_t *state = worker->state;
+    const bool gated = !worker->implicit && state->token_fd >= 0;
+    while (atomic_load(&state->next) < state->count) {
+        // Take the token before the command, so workers waiting for a token
+        // do not hold back commands another worker could run already
+        char token = '+';
+        if (gated && !fclib_jobs_acquire(state, &token)) {
+            // No commands are left, or the other workers run them
+            break;
+        }
+        const size_t i = atomic_fetch_add(&state->next, 1);
+        if (i + 1 == state->count && state->done_fds[1] >= 0) {
+            // The last command has been taken, nobody needs a token anymore
+            close(state->done_fds[1]);
+        }
+        if (i < state->count) {
+            state->results[i] = fclib_system_command_ex( //
+                state->command_list[i], state->options);
+        }
+        if (gated) {
+            fclib_jobserver_release(state->jobserver, token);
+        }
+    }
+    return NULL;
+}
+#endif
+
+FCLIB_API bool fclib_jobserver_connect(fclib_jobserver_t *jobserver) {
+    memset(jobserver, 0, sizeof(*jobserver));
+    jobserver->read_fd = -1;
+    jobserver->write_fd = -1;
+#ifdef __WIN32__
+    // Make uses named semaphores on Windows, which are not supported yet
+    return false;
+#else
+    const char *makeflags = getenv("MAKEFLAGS");
+    if (makeflags == NULL) {
+        return false;
+    }
+    // Make may announce the jobserver several times, the last one counts
+    const char *auth = NULL;
+    const char *keys[2] = {"--jobserver-auth=", "--jobserver-fds="};
+    for (size_t k = 0; k < 2; k++) {
+        for (const char *found = strstr(makeflags, keys[k]); found != NULL;
+            found = strstr(found + 1, keys[k])) {
+            if (auth == NULL || found > auth) {
+                auth = found + strlen(keys[k]);
+            }
+        }
+    }
+    if (auth == NULL) {
+        return false;
+    }
+    if (strncmp(auth, "fifo:", 5) == 0) {
+        const char *path = auth + 5;
+        const size_t len = strcspn(path, " ");
+        jobserver->fifo_path = fclib_str_init(path, len);
+        const int fd = open(jobserver->fifo_path->value, O_RDWR | O_CLOEXEC);
+        if (fd < 0) {
+            // ErrJobs.ConnectFailed
+            free(jobserver->fifo_path);
+            jobserver->fifo_path = NULL;
+            return false;
+        }
+        jobserver->read_fd = fd;
+        jobserver->write_fd = fd;
+        return true;
+    }
+    const char *cursor = auth;
+    const int read_fd = fclib_jobserver_parse_fd(&cursor);
+    if (read_fd < 0 || *cursor != ',') {
+        return false;
+    }
+    cursor++;
+    const int write_fd = fclib_jobserver_parse_fd(&cursor);
+    // Make only passes the pipes on to commands it considers recursive makes,
+    // for all others the descriptors are closed or belong to something else
+    if (write_fd < 0 || fcntl(read_fd, F_GETFD) < 0 ||
+        fcntl(write_fd, F_GETFD) < 0) {
+        return false;
+    }
+    jobserver->read_fd = read_fd;
+    jobserver->write_fd = write_fd;
+    return true;
+#endif
+}
+
+FCLIB_API bool fclib_jobserver_create( //
+    fclib_jobserver_t *jobserver,      //
+    const size_t slots                 //
+) {
+    memset(jobserver, 0, sizeof(*jobserver));
+    jobserver->read_fd = -1;
+    jobserver->write_fd = -1;
+#ifdef __WIN32__
+    (void)slots;
+    return false;
+#else
+    if (slots == 0) {
+        return false;
+    }
+    static atomic_uint counter;
+    const char *tmp = getenv("TMPDIR");
+    if (tmp == NULL || tmp[0] == '\0') {
+        tmp = "/tmp";
+    }
+    fclib_str_builder_t builder = fclib_str_builder_init(64);
+    fclib_str_builder_append_lit(&builder, tmp, strlen(tmp));
+    fclib_str_builder_append_lit(&builder, "/fclib-jobserver-", 17);
+    fclib_str_builder_append_u64(&builder, (uint64_t)getpid());
+    fclib_str_builder_append_char(&builder, '-');
+    fclib_str_builder_append_u64(&builder, atomic_fetch_add(&counter, 1));
+    fclib_str_t *path = fclib_str_builder_finish(&builder);
+    if (mkfifo(path->value, 0600) != 0) {
+        // ErrJobs.CreateFailed
+        free(path);
+        return false;
+    }
+    // Opening for reading and writing never blocks and keeps the fifo alive
+    // while no other process has it open
+    const int fd = open(path->value, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        unlink(path->value);
+        free(path);
+        return false;
+    }
+    // This process has the implicit slot, all others are tokens in the fifo.
+    // A pipe buffer holds far more tokens than there are cores
+    for (size_t i = 1; i < slots; i++) {
+        const char token = '+';
+        if (write(fd, &token, 1) != 1) {
+            close(fd);
+            unlink(path->value);
+            free(path);
+            return false;
+        }
+    }
+    jobserver->read_fd = fd;
+    jobserver->write_fd = fd;
+    jobserver->fifo_path = path;
+    jobserver->owned = true;
+    jobserver->slots = slots;
+    return true;
+#endif
+}
+
+FCLIB_API bool fclib_jobserver_export(const fclib_jobserver_t *jobserver) {
+#ifdef __WIN32__
+    (void)jobserver;
+    return false;
+#else
+    if (!jobserver->owned) {
+        return false;
+    }
+    fclib_str_builder_t flags = fclib_str_builder_init(64);
+    fclib_str_builder_append_lit(&flags, "-j", 2);
+    fclib_str_builder_append_u64(&flags, jobserver->slots);
+    fclib_str_builder_append_lit(&flags, " --jobserver-auth=", 18);
+    fclib_str_builder_append_u64(&flags, (uint64_t)jobserver->read_fd);
+    fclib_str_builder_append_char(&flags, ',');
+    fclib_str_builder_append_u64(&flags, (uint64_t)jobserver->write_fd);
+    // Make only learned the fifo form in 4.4, descriptors work everywhere
+    if (fcntl(jobserver->read_fd, F_SETFD, 0) != 0) {
+        fclib_str_builder_free(&flags);
+        return false;
+    }
+    fclib_str_t *value = fclib_str_builder_finish(&flags);
+    const bool exported = setenv("MAKEFLAGS", value->value, 1) == 0;
+    free(value);
+    return exported;
+#endif
+}
+
+FCLIB_API bool fclib_jobserver_acquire( //
+    const fclib_jobserver_t *jobserver, //
+    char *token                         //
+) {
+    *token = '+';
+#ifdef __WIN32__
+    (void)jobserver;
+    return true;
+#else
+    if (jobserver->read_fd < 0) {
+        return true;
+    }
+    while (true) {
+        const ssize_t got = read(jobserver->read_fd, token, 1);
+        if (got == 1) {
+            return true;
+        }
+        if (got == 0) {
+            // ErrJobs.JobserverClosed
+            return false;
+        }
+        if (errno == EAGAIN) {
+            // Make may hand out the pipe in non-blocking mode
+            struct pollfd poll_fd = {jobserver->read_fd, POLLIN, 0};
+            poll(&poll_fd, 1, -1);
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+#endif
+}
+
+FCLIB_API void fclib_jobserver_release( //
+    const fclib_jobserver_t *jobserver, //
+    const char token                    //
+) {
+#ifdef __WIN32__
+    (void)jobserver;
+    (void)token;
+#else
+    if (jobserver->write_fd < 0) {
+        return;
+    }
+    // A lost token would permanently lower the limit of every process, so
+    // keep trying until it is back
+    while (write(jobserver->write_fd, &token, 1) < 0 &&
+        (errno == EINTR || errno == EAGAIN)) {
+    }
+#endif
+}
+
+FCLIB_API void fclib_jobserver_free(fclib_jobserver_t *jobserver) {
+#ifndef __WIN32__
+    if (jobserver->read_fd >= 0 && jobserver->fifo_path != NULL) {
+        // Connected fifos use a single descriptor, pipes of make are not ours
+        close(jobserver->read_fd);
+    }
+    if (jobserver->owned) {
+        unlink(jobserver->fifo_path->value);
+    }
+#endif
+    free(jobserver->fifo_path);
+    memset(jobserver, 0, sizeof(*jobserver));
+    jobserver->read_fd = -1;
+    jobserver->write_fd = -1;
+}
+
+FCLIB_API void fclib_jobs_run(              //
+    const fclib_arr_t *commands,            //
+    const size_t jobs,                      //
+    const fclib_command_options_t *options, //
+    const fclib_jobserver_t *jobserver,     //
+    fclib_command_result_t *results         //
+) {
+    const size_t count = fclib_arr_get_len(commands);
+    fclib_str_t *const *command_list = (fclib_str_t *const *)(const void *)(
+        commands->value + commands->len * sizeof(size_t));
+#ifdef __WIN32__
+    // Commands run one after another on Windows
+    (void)jobs;
+    (void)jobserver;
+    for (size_t i = 0; i < count; i++) {
+        results[i] = fclib_system_command_ex(command_list[i], options);
+    }
+#else
+    size_t workers = jobs;
+    if (workers == 0) {
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (workers > count) {
+        workers = count;
+    }
+    if (workers == 0) {
+        return;
+    }
+    fclib_jobs_state_t state;
+    state.command_list = command_list;
+    state.options = options;
+    state.jobserver = jobserver;
+    state.results = results;
+    state.count = count;
+    atomic_init(&state.next, 0);
+    state.token_fd = -1;
+    state.done_fds[0] = -1;
+    state.done_fds[1] = -1;
+    if (jobserver != NULL && jobserver->read_fd >= 0 && workers > 1) {
+        state.token_fd = fclib_jobs_open_tokens(jobserver);
+        if (state.token_fd < 0 || pipe2(state.done_fds, O_CLOEXEC) != 0) {
+            // Without a way to stop waiting for tokens, all commands run in
+            // the implicit slot
+            workers = 1;
+        }
+    }
+    fclib_jobs_worker_t *worker_list = (fclib_jobs_worker_t *)malloc( //
+        workers * sizeof(fclib_jobs_worker_t));
+    pthread_t *threads = (pthread_t *)malloc(workers * sizeof(pthread_t));
+    // The calling thread is the first worker, it runs in the implicit slot
+    size_t started = 1;
+    for (size_t i = 0; i < workers; i++) {
+        worker_list[i].state = &state;
+        worker_list[i].implicit = i == 0;
+    }
+    for (size_t i = 1; i < workers; i++) {
+        if (pthread_create(&threads[i], NULL, fclib_jobs_worker,
+                &worker_list[i]) != 0) {
+            // Fewer workers still run all commands
+            break;
+        }
+        started++;
+    }
+    fclib_jobs_worker(&worker_list[0]);
+    for (size_t i = 1; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    free(worker_list);
+    if (state.token_fd >= 0) {
+        close(state.token_fd);
+    }
+    if (state.done_fds[0] >= 0) {
+        close(state.done_fds[0]);
+    }
+#endif
+}
+
+#endif // endof FCLIB_IMPLEMENTATION
@@ -0,0 +1,807 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "str.h"
+
+#ifdef FCLIB_MINIMAL
+#error "json.h builds on the string builder, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// @macro `FCLIB_JSON_MAX_DEPTH`
+/// @brief The maximum nesting depth of objects and arrays a JSON writer can
+/// produce. Needs to be a multiple of 64
+#ifndef FCLIB_JSON_MAX_DEPTH
+#define FCLIB_JSON_MAX_DEPTH 256
+#endif
+
+/// @typedef `json_writer_t`
+/// @brief A streaming JSON writer which serializes directly into a string
+/// builder. Values are written in document order and the writer takes care of
+/// all the commas and colons in between them. Multiple values written at the
+/// top level are separated by newlines, which makes the writer usable for
+/// producing JSON Lines output too.
+typedef struct fclib_json_writer_t {
+    fclib_str_builder_t out;
+    size_t depth;
+    // One bit per nesting level, set as soon as the level contains a value so
+    // that the next value knows it needs to be preceded by a separator
+    uint64_t has_value[FCLIB_JSON_MAX_DEPTH / 64];
+    bool after_key;
+} fclib_json_writer_t;
+
+/// @function `json_writer_init`
+/// @brief Creates a new JSON writer whose output buffer can hold at least
+/// `initial_capacity` bytes before it needs to grow
+///
+/// @param `initial_capacity` The number of bytes to reserve up front
+/// @return `json_writer_t` The new JSON writer
+FCLIB_API fclib_json_writer_t fclib_json_writer_init( //
+    const size_t initial_capacity                     //
+);
+
+/// @function `json_writer_finish`
+/// @brief Finishes the writer and returns the produced JSON. All objects and
+/// arrays need to be closed at this point. The writer must not be used again
+/// unless it is re-initialized.
+///
+/// @param `writer` The writer to finish
+/// @return `str_t *` The produced JSON text, owned by the caller
+FCLIB_API fclib_str_t *fclib_json_writer_finish(fclib_json_writer_t *writer);
+
+/// @function `json_writer_free`
+/// @brief Frees the writer together with everything written so far
+///
+/// @param `writer` The writer to free
+FCLIB_API void fclib_json_writer_free(fclib_json_writer_t *writer);
+
+/// @function `json_begin_object`
+/// @brief Opens a new object (`{`) at the current position
+///
+/// @param `writer` The writer to write to
+FCLIB_API void fclib_json_begin_object(fclib_json_writer_t *writer);
+
+/// @function `json_end_object`
+/// @brief Closes the innermost open object (`}`)
+///
+/// @param `writer` The writer to write to
+FCLIB_API void fclib_json_end_object(fclib_json_writer_t *writer);
+
+/// @function `json_begin_array`
+/// @brief Opens a new array (`[`) at the current position
+///
+/// @param `writer` The writer to write to
+FCLIB_API void fclib_json_begin_array(fclib_json_writer_t *writer);
+
+/// @function `json_end_array`
+/// @brief Closes the innermost open array (`]`)
+///
+/// @param `writer` The writer to write to
+FCLIB_API void fclib_json_end_array(fclib_json_writer_t *writer);
+
+/// @function `json_key_lit`
+/// @brief Writes the key of the next object member. The next written value
+/// becomes the value of that member.
+///
+/// @param `writer` The writer to write to
+/// @param `key` The key data, it will be escaped if needed
+/// @param `len` The length of the key data
+FCLIB_API void fclib_json_key_lit( //
+    fclib_json_writer_t *writer,   //
+    const char *key,               //
+    const size_t len               //
+);
+
+/// @function `json_key`
+/// @brief Writes the key of the next object member from a string
+///
+/// @param `writer` The writer to write to
+/// @param `key` The key, it will be escaped if needed
+FCLIB_API void fclib_json_key(   //
+    fclib_json_writer_t *writer, //
+    const fclib_str_t *key       //
+);
+
+/// @function `json_write_str_lit`
+/// @brief Writes a string value, escaping quotes, backslashes and control
+/// characters. The input is scanned 16 bytes at a time and runs which do not
+/// need escaping are copied in bulk. Bytes above 0x7F are passed through
+/// unchanged, so the input is expected to be valid UTF-8.
+///
+/// @param `writer` The writer to write to
+/// @param `value` The string data to write
+/// @param `len` The length of the string data
+FCLIB_API void fclib_json_write_str_lit( //
+    fclib_json_writer_t *writer,         //
+    const char *value,                   //
+    const size_t len                     //
+);
+
+/// @function `json_write_str`
+/// @brief Writes a string value, see `json_write_str_lit`
+///
+/// @param `writer` The writer to write to
+/// @param `value` The string to write
+FCLIB_API void fclib_json_write_str( //
+    fclib_json_writer_t *writer,     //
+    const fclib_str_t *value         //
+);
+
+/// @function `json_write_str_view`
+/// @brief Writes a string value, see `json_write_str_lit`
+///
+/// @param `writer` The writer to write to
+/// @param `value` The string view to write
+FCLIB_API void fclib_json_write_str_view( //
+    fclib_json_writer_t *writer,          //
+    const fclib_str_view_t value          //
+);
+
+/// @function `json_write_i64`
+/// @brief Writes a signed integer value
+///
+/// @param `writer` The writer to write to
+/// @param `value` The value to write
+FCLIB_API void fclib_json_write_i64( //
+    fclib_json_writer_t *writer,     //
+    const int64_t value              //
+);
+
+/// @function `json_write_u64`
+/// @brief Writes an unsigned integer value
+///
+/// @param `writer` The writer to write to
+/// @param `value` The value to write
+FCLIB_API void fclib_json_write_u64( //
+    fclib_json_writer_t *writer,     //
+    const uint64_t value             //
+);
+
+/// @function `json_write_f64`
+/// @brief Writes a floating point value formatted by `str_format_f64`. JSON
+/// has no representation for NaN and infinities, they are written as `null`.
+///
+/// @param `writer` The writer to write to
+/// @param `value` The value to write
+FCLIB_API void fclib_json_write_f64( //
+    fclib_json_writer_t *writer,     //
+    const double value               //
+);
+
+/// @function `json_write_bool`
+/// @brief Writes a `true` or `false` value
+///
+/// @param `writer` The writer to write to
+/// @param `value` The value to write
+FCLIB_API void fclib_json_write_bool( //
+    fclib_json_writer_t *writer,      //
+    const bool value                  //
+);
+
+/// @function `json_write_null`
+/// @brief Writes a `null` value
+///
+/// @param `writer` The writer to write to
+FCLIB_API void fclib_json_write_null(fclib_json_writer_t *writer);
+
+/// @function `json_write_raw`
+/// @brief Writes already serialized JSON as the next value. The data is copied
+/// as-is without any validation.
+///
+/// @param `writer` The writer to write to
+/// @param `json` The serialized JSON value
+/// @param `len` The length of the serialized value
+FCLIB_API void fclib_json_write_raw( //
+    fclib_json_writer_t *writer,     //
+    const char *json,                //
+    const size_t len                 //
+);
+
+/// @function `json_write_arr`
+/// @brief Writes a numeric array as (nested) JSON arrays. A one-dimensional
+/// array becomes a flat JSON array, a multi-dimensional array becomes nested
+/// arrays where `json[i][j]` corresponds to `arr[i, j]`. The elements are
+/// formatted straight into the output buffer without any intermediate strings.
+///
+/// @param `writer` The writer to write to
+/// @param `arr` The array to serialize
+/// @param `type` The type of the elements stored in the array
+/// @return `bool` False if nothing was written because the array has more
+/// dimensions than the writer has nesting levels left
+FCLIB_API bool fclib_json_write_arr( //
+    fclib_json_writer_t *writer,     //
+    const fclib_arr_t *arr,          //
+    const fclib_arr_type_t type      //
+);
+
+/// @function `json_write_arr_str`
+/// @brief Writes an array of strings (an array with elements of type `str_t *`)
+/// as (nested) JSON arrays of strings. `NULL` elements are written as `null`.
+///
+/// @param `writer` The writer to write to
+/// @param `arr` The array of strings to serialize
+/// @return `bool` False if nothing was written because the array has more
+/// dimensions than the writer has nesting levels left
+FCLIB_API bool fclib_json_write_arr_str( //
+    fclib_json_writer_t *writer,         //
+    const fclib_arr_t *arr               //
+);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_json_writer_t json_writer_t;
+
+FCLIB_API static inline json_writer_t json_writer_init( //
+    const size_t initial_capacity                       //
+) {
+    return fclib_json_writer_init(initial_capacity);
+}
+FCLIB_API static inline fclib_str_t *json_writer_finish(json_writer_t *writer) {
+    return fclib_json_writer_finish(writer);
+}
+FCLIB_API static inline void json_writer_free(json_writer_t *writer) {
+    fclib_json_writer_free(writer);
+}
+FCLIB_API static inline void json_begin_object(json_writer_t *writer) {
+    fclib_json_begin_object(writer);
+}
+FCLIB_API static inline void json_end_object(json_writer_t *writer) {
+    fclib_json_end_object(writer);
+}
+FCLIB_API static inline void json_begin_array(json_writer_t *writer) {
+    fclib_json_begin_array(writer);
+}
+FCLIB_API static inline void json_end_array(json_writer_t *writer) {
+    fclib_json_end_array(writer);
+}
+FCLIB_API static inline void json_key_lit( //
+    json_writer_t *writer,                 //
+    const char *key,                       //
+    const size_t len                       //
+) {
+    fclib_json_key_lit(writer, key, len);
+}
+FCLIB_API static inline void json_key( //
+    json_writer_t *writer,             //
+    const fclib_str_t *key             //
+) {
+    fclib_json_key(writer, key);
+}
+FCLIB_API static inline void json_write_str_lit( //
+    json_writer_t *writer,                       //
+    const char *value,                           //
+    const size_t len                             //
+) {
+    fclib_json_write_str_lit(writer, value, len);
+}
+FCLIB_API static inline void json_write_str( //
+    json_writer_t *writer,                   //
+    const fclib_str_t *value                 //
+) {
+    fclib_json_write_str(writer, value);
+}
+FCLIB_API static inline void json_write_str_view( //
+    json_writer_t *writer,                        //
+    const fclib_str_view_t value                  //
+) {
+    fclib_json_write_str_view(writer, value);
+}
+FCLIB_API static inline void json_write_i64( //
+    json_writer_t *writer,                   //
+    const int64_t value                      //
+) {
+    fclib_json_write_i64(writer, value);
+}
+FCLIB_API static inline void json_write_u64( //
+    json_writer_t *writer,                   //
+    const uint64_t value                     //
+) {
+    fclib_json_write_u64(writer, value);
+}
+FCLIB_API static inline void json_write_f64( //
+    json_writer_t *writer,                   //
+    const double value                       //
+) {
+    fclib_json_write_f64(writer, value);
+}
+FCLIB_API static inline void json_write_bool( //
+    json_writer_t *writer,                    //
+    const bool value                          //
+) {
+    fclib_json_write_bool(writer, value);
+}
+FCLIB_API static inline void json_write_null(json_writer_t *writer) {
+    fclib_json_write_null(writer);
+}
+FCLIB_API static inline void json_write_raw( //
+    json_writer_t *writer,                   //
+    const char *json,                        //
+    const size_t len                         //
+) {
+    fclib_json_write_raw(writer, json, len);
+}
+FCLIB_API static inline bool json_write_arr( //
+    json_writer_t *writer,                   //
+    const fclib_arr_t *arr,                  //
+    const fclib_arr_type_t type              //
+) {
+    return fclib_json_write_arr(writer, arr, type);
+}
+FCLIB_API static inline bool json_write_arr_str( //
+    json_writer_t *writer,                       //
+    const fclib_arr_t *arr                       //
+) {
+    return fclib_json_write_arr_str(writer, arr);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+// Writes the separator which needs to precede the next value, if any
+static void fclib_json_before_value(fclib_json_writer_t *writer) {
+    if (writer->after_key) {
+        writer->after_key = false;
+        return;
+    }
+    const size_t depth = writer->depth;
+    const uint64_t bit = (uint64_t)1 << (depth % 64);
+    if (writer->has_value[depth / 64] & bit) {
+        fclib_str_builder_append_char(&writer->out, depth == 0 ? '\n' : ',');
+    } else {
+        writer->has_value[depth / 64] |= bit;
+    }
+}
+
+// Returns the number of leading bytes of `src` which can be copied to the
+// output without any escaping
+static size_t fclib_json_scan_plain(const char *src, const size_t len) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_max = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= len; i += 16) {
+        const __m128i chunk = _mm_loadu_si128( //
+            (const __m128i *)(const void *)(src + i));
+        // max(c, 0x1F) == 0x1F exactly when c is a control character
+        const __m128i is_control = _mm_cmpeq_epi8( //
+            _mm_max_epu8(chunk, control_max), control_max);
+        const __m128i needs_escape = _mm_or_si128(is_control,
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                _mm_cmpeq_epi8(chunk, backslash)));
+        const int mask = _mm_movemask_epi8(needs_escape);
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz((unsigned int)mask);
+        }
+    }
+#endif
+    for (; i < len; i++) {
+        const unsigned char c = (unsigned char)src[i];
+        if (c < 0x20 || c == '"' || c == '\\') {
+            return i;
+        }
+    }
+    return len;
+}
+
+static void fclib_json_write_escaped( //
+    fclib_str_builder_t *out,         //
+    const char *value,                //
+    const size_t len                  //
+) {
+    static const char hex_digits[] = "0123456789abcdef";
+    // The input is processed in blocks so that the worst-case reservation of
+    // six output bytes per input byte stays small for huge strings
+    const size_t BLOCK_SIZE = 4096;
+    fclib_str_builder_append_char(out, '"');
+    size_t pos = 0;
+    while (pos < len) {
+        const size_t block_len =
+            len - pos < BLOCK_SIZE ? len - pos : BLOCK_SIZE;
+        char *const dest_start = fclib_str_builder_reserve(out, block_len * 6);
+        char *dest = dest_start;
+        const char *src = value + pos;
+        const char *const src_end = src + block_len;
+        while (src < src_end) {
+            const size_t run =
+                fclib_json_scan_plain(src, (size_t)(src_end - src));
+            memcpy(dest, src, run);
+            dest += run;
+            src += run;
+            if (src == src_end) {
+                break;
+            }
+            const unsigned char c = (unsigned char)*src++;
+            *dest++ = '\\';
+            switch (c) {
+                case '"':
+                    *dest++ = '"';
+                    break;
+                case '\\':
+                    *dest++ = '\\';
+                    break;
+                case '\b':
+                    *dest++ = 'b';
+                    break;
+                case '\f':
+                    *dest++ = 'f';
+                    break;
+                case '\n':
+                    *dest++ = 'n';
+                    break;
+                case '\r':
+                    *dest++ = 'r';
+                    break;
+                case '\t':
+                    *dest++ = 't';
+                    break;
+                default:
+                    memcpy(dest, "u00", 3);
+                    dest[3] = hex_digits[c >> 4];
+                    dest[4] = hex_digits[c & 0xF];
+                    dest += 5;
+                    break;
+            }
+        }
+        fclib_str_builder_advance(out, (size_t)(dest - dest_start));
+        pos += block_len;
+    }
+    fclib_str_builder_append_char(out, '"');
+}
+
+// Formats a single array element of the given type to `dest` and returns the
+// number of characters written. At most 32 characters are written
+static size_t fclib_json_format_element( //
+    char *dest,                          //
+    const char *element,                 //
+    const fclib_arr_type_t type          //
+) {
+    switch (type) {
+        case FCLIB_ARR_TYPE_I8: {
+            int8_t value;
+            memcpy(&value, element, sizeof(value));
+            return fclib_str_format_i64(dest, value);
+        }
+        case FCLIB_ARR_TYPE_I16: {
+            int16_t value;
+            memcpy(&value, element, sizeof(value));
+            return fclib_str_format_i64(dest, value);
+        }
+        case FCLIB_ARR_TYPE_I32: {
+            int32_t value;
+            memcpy(&value, element, sizeof(value));
+            return fclib_str_format_i64(dest, value);
+        }
+        case FCLIB_ARR_TYPE_I64: {
+            int64_t value;
+            memcpy(&value, element, sizeof(value));
+            return fclib_str_format_i64(dest, value);
+        }
+        case FCLIB_ARR_TYPE_U8: {
+            uint8_t value;
+            memcpy(&value, element, sizeof(value));
+            return fclib_str_format_u64(dest, value);
+        }
+        case FCLIB_ARR_TYPE_U16: {
+            uint16_t value;
+            memcpy(&value, element, sizeof(value));
+            return fclib_str_format_u64(dest, value);
+        }
+        case FCLIB_ARR_TYPE_U32: {
+            uint32_t value;
+            memcpy(&value, element, sizeof(value));
+            return fclib_str_format_u64(dest, value);
+        }
+        case FCLIB_ARR_TYPE_U64: {
+            uint64_t value;
+            memcpy(&value, element, sizeof(value));
+            return fclib_str_format_u64(dest, value);
+        }
+        case FCLIB_ARR_TYPE_F32: {
+            float value;
+            memcpy(&value, element, sizeof(value));
+            if (!isfinite(value)) {
+                memcpy(dest, "null", 4);
+                return 4;
+            }
+            return fclib_str_format_f32(dest, value);
+        }
+        case FCLIB_ARR_TYPE_F64: {
+            double value;
+            memcpy(&value, element, sizeof(value));
+            if (!isfinite(value)) {
+                memcpy(dest, "null", 4);
+                return 4;
+            }
+            return fclib_str_format_f64(dest, value);
+        }
+    }
+    return 0;
+}
+
+// Writes the innermost dimension of a numeric array. The output is reserved in
+// chunks of elements so that the buffer is checked once per chunk instead of
+// once per element
+static void fclib_json_write_numbers( //
+    fclib_str_builder_t *out,         //
+    const char *data,                 //
+    const size_t stride,              //
+    const size_t count,               //
+    const fclib_arr_type_t type       //
+) {
+    const size_t CHUNK_SIZE = 64;
+    // 32 characters for the number itself plus one for the comma
+    const size_t MAX_ELEMENT_LEN = 33;
+    fclib_str_builder_append_char(out, '[');
+    for (size_t start = 0; start < count; start += CHUNK_SIZE) {
+        const size_t end =
+            count - start < CHUNK_SIZE ? count : start + CHUNK_SIZE;
+        char *const dest_start = fclib_str_builder_reserve( //
+            out, (end - start) * MAX_ELEMENT_LEN);
+        char *dest = dest_start;
+        for (size_t i = start; i < end; i++) {
+            if (i > 0) {
+                *dest++ = ',';
+            }
+            dest += fclib_json_format_element(dest, data + i * stride, type);
+        }
+        fclib_str_builder_advance(out, (size_t)(dest - dest_start));
+    }
+    fclib_str_builder_append_char(out, ']');
+}
+
+// Recursively writes dimension `dim` of an array. Dimension 0 is the outermost
+// JSON array, so that `json[i][j]` corresponds to `arr[i, j]`
+static void fclib_json_write_arr_dim( //
+    fclib_json_writer_t *writer,      //
+    const char *data,                 //
+    const size_t *dim_lengths,        //
+    const size_t *strides,            //
+    const size_t dimensionality,      //
+    const size_t dim,                 //
+    const int type                    // -1 for string arrays
+) {
+    if (dim + 1 == dimensionality && type >= 0) {
+        fclib_json_before_value(writer);
+        fclib_json_write_numbers(&writer->out, data, strides[dim],
+            dim_lengths[dim], (fclib_arr_type_t)type);
+        return;
+    }
+    fclib_json_begin_array(writer);
+    for (size_t i = 0; i < dim_lengths[dim]; i++) {
+        const char *element = data + i * strides[dim];
+        if (dim + 1 < dimensionality) {
+            fclib_json_write_arr_dim(writer, element, dim_lengths, strides,
+                dimensionality, dim + 1, type);
+            continue;
+        }
+        const fclib_str_t *string;
+        memcpy(&string, element, sizeof(string));
+        if (string == NULL) {
+            fclib_json_write_null(writer);
+        } else {
+            fclib_json_write_str(writer, string);
+        }
+    }
+    fclib_json_end_array(writer);
+}
+
+static bool fclib_json_write_arr_any( //
+    fclib_json_writer_t *writer,      //
+    const fclib_arr_t *arr,           //
+    const size_t element_size,        //
+    const int type                    //
+) {
+    const size_t dimensionality = arr->len;
+    const size_t *const dim_lengths = FCLIB_ALIGNCAST(const size_t, arr->value);
+    const char *const data = (const char *)(dim_lengths + dimensionality);
+    // Every dimension opens one nesting level, so arrays which would nest
+    // deeper than the writer can track are rejected up front. This also bounds
+    // the number of strides below
+    if (writer->depth + dimensionality >= FCLIB_JSON_MAX_DEPTH) {
+        // ErrJson.TooDeep
+        return false;
+    }
+    if (dimensionality == 0) {
+        fclib_json_begin_array(writer);
+        fclib_json_end_array(writer);
+        return true;
+    }
+    // The array is laid out column-major, e.g. the first index is contiguous
+    size_t strides[FCLIB_JSON_MAX_DEPTH];
+    size_t stride = element_size;
+    for (size_t i = 0; i < dimensionality; i++) {
+        strides[i] = stride;
+        stride *= dim_lengths[i];
+    }
+    fclib_json_write_arr_dim(                                       //
+        writer, data, dim_lengths, strides, dimensionality, 0, type //
+    );
+    return true;
+}
+
+FCLIB_API fclib_json_writer_t fclib_json_writer_init( //
+    const size_t initial_capacity                     //
+) {
+    fclib_json_writer_t writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.out = fclib_str_builder_init(initial_capacity);
+    return writer;
+}
+
+FCLIB_API fclib_str_t *fclib_json_writer_finish(fclib_json_writer_t *writer) {
+    assert(writer->depth == 0 && !writer->after_key);
+    return fclib_str_builder_finish(&writer->out);
+}
+
+FCLIB_API void fclib_json_writer_free(fclib_json_writer_t *writer) {
+    fclib_str_builder_free(&writer->out);
+}
+
+FCLIB_API void fclib_json_begin_object(fclib_json_writer_t *writer) {
+    fclib_json_before_value(writer);
+    fclib_str_builder_append_char(&writer->out, '{');
+    writer->depth++;
+    assert(writer->depth < FCLIB_JSON_MAX_DEPTH);
+    writer->has_value[writer->depth / 64] &=
+        ~((uint64_t)1 << (writer->depth % 64));
+}
+
+FCLIB_API void fclib_json_end_object(fclib_json_writer_t *writer) {
+    assert(writer->depth > 0 && !writer->after_key);
+    writer->depth--;
+    fclib_str_builder_append_char(&writer->out, '}');
+}
+
+FCLIB_API void fclib_json_begin_array(fclib_json_writer_t *writer) {
+    fclib_json_before_value(writer);
+    fclib_str_builder_append_char(&writer->out, '[');
+    writer->depth++;
+    assert(writer->depth < FCLIB_JSON_MAX_DEPTH);
+    writer->has_value[writer->depth / 64] &=
+        ~((uint64_t)1 << (writer->depth % 64));
+}
+
+FCLIB_API void fclib_json_end_array(fclib_json_writer_t *writer) {
+    assert(writer->depth > 0 && !writer->after_key);
+    writer->depth--;
+    fclib_str_builder_append_char(&writer->out, ']');
+}
+
+FCLIB_API void fclib_json_key_lit( //
+    fclib_json_writer_t *writer,   //
+    const char *key,               //
+    const size_t len               //
+) {
+    assert(writer->depth > 0 && !writer->after_key);
+    fclib_json_before_value(writer);
+    fclib_json_write_escaped(&writer->out, key, len);
+    fclib_str_builder_append_char(&writer->out, ':');
+    writer->after_key = true;
+}
+
+FCLIB_API void fclib_json_key(   //
+    fclib_json_writer_t *writer, //
+    const fclib_str_t *key       //
+) {
+    fclib_json_key_lit(writer, key->value, key->len);
+}
+
+FCLIB_API void fclib_json_write_str_lit( //
+    fclib_json_writer_t *writer,         //
+    const char *value,                   //
+    const size_t len                     //
+) {
+    fclib_json_before_value(writer);
+    fclib_json_write_escaped(&writer->out, value, len);
+}
+
+FCLIB_API void fclib_json_write_str( //
+    fclib_json_writer_t *writer,     //
+    const fclib_str_t *value         //
+) {
+    fclib_json_write_str_lit(writer, value->value, value->len);
+}
+
+FCLIB_API void fclib_json_write_str_view( //
+    fclib_json_writer_t *writer,          //
+    const fclib_str_view_t value          //
+) {
+    fclib_json_write_str_lit(writer, value.value, value.len);
+}
+
+FCLIB_API void fclib_json_write_i64( //
+    fclib_json_writer_t *writer,     //
+    const int64_t value              //
+) {
+    fclib_json_before_value(writer);
+    fclib_str_builder_append_i64(&writer->out, value);
+}
+
+FCLIB_API void fclib_json_write_u64( //
+    fclib_json_writer_t *writer,     //
+    const uint64_t value             //
+) {
+    fclib_json_before_value(writer);
+    fclib_str_builder_append_u64(&writer->out, value);
+}
+
+FCLIB_API void fclib_json_write_f64( //
+    fclib_json_writer_t *writer,     //
+    const double value               //
+) {
+    fclib_json_before_value(writer);
+    if (!isfinite(value)) {
+        fclib_str_builder_append_lit(&writer->out, "null", 4);
+        return;
+    }
+    fclib_str_builder_append_f64(&writer->out, value);
+}
+
+FCLIB_API void fclib_json_write_bool( //
+    fclib_json_writer_t *writer,      //
+    const bool value                  //
+) {
+    fclib_json_before_value(writer);
+    if (value) {
+        fclib_str_builder_append_lit(&writer->out, "true", 4);
+    } else {
+        fclib_str_builder_append_lit(&writer->out, "false", 5);
+    }
+}
+
+FCLIB_API void fclib_json_write_null(fclib_json_writer_t *writer) {
+    fclib_json_before_value(writer);
+    fclib_str_builder_append_lit(&writer->out, "null", 4);
+}
+
+FCLIB_API void fclib_json_write_raw( //
+    fclib_json_writer_t *writer,     //
+    const char *json,                //
+    const size_t len                 //
+) {
+    fclib_json_before_value(writer);
+    fclib_str_builder_append_lit(&writer->out, json, len);
+}
+
+FCLIB_API bool fclib_json_write_arr( //
+    fclib_json_writer_t *writer,     //
+    const fclib_arr_t *arr,          //
+    const fclib_arr_type_t type      //
+) {
+    return fclib_json_write_arr_any(                      //
+        writer, arr, fclib_arr_type_size(type), (int)type //
+    );
+}
+
+FCLIB_API bool fclib_json_write_arr_str( //
+    fclib_json_writer_t *writer,         //
+    const fclib_arr_t *arr               //
+) {
+    return fclib_json_write_arr_any(writer, arr, sizeof(fclib_str_t *), -1);
+}
+
+#endif // endof FCLIB_IMPLEMENTATION
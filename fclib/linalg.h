@@ -0,0 +1,1297 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "cpu.h"
+#include "parallel.h"
+
+#ifdef FCLIB_MINIMAL
+#error "linalg.h builds on arr_type_t, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @function `linalg_matmul`
+/// @brief Multiplies the two-dimensional arrays `a` (m x k) and `b` (k x n)
+/// and returns the product as a new m x n array. Like `arr_access`, the first
+/// dimension is the row index and the stride-1 direction, so every column of
+/// a matrix is contiguous in memory. Only `FCLIB_ARR_TYPE_F32` and
+/// `FCLIB_ARR_TYPE_F64` arrays are supported.
+///
+/// The product is computed in cache-sized blocks by a register-tiled
+/// micro-kernel, which uses the AVX-512 or AVX2 FMA units of the CPU when
+/// available. Large products are split across `parallel_get_threads` threads.
+///
+/// @param `a` The left matrix with m rows and k columns
+/// @param `b` The right matrix with k rows and n columns
+/// @param `type` The element type of both matrices
+/// @return `arr_t *` The m x n product, or NULL if the arrays are not
+/// two-dimensional, their shapes do not match or the type is not supported
+FCLIB_API fclib_arr_t *fclib_linalg_matmul( //
+    const fclib_arr_t *a,                   //
+    const fclib_arr_t *b,                   //
+    const fclib_arr_type_t type             //
+);
+
+/// @function `linalg_matmul_into`
+/// @brief Multiplies the two-dimensional arrays `a` (m x k) and `b` (k x n)
+/// into the existing m x n array `c`, either overwriting it (c = a * b) or
+/// adding to it (c += a * b). `c` must not overlap `a` or `b`.
+///
+/// @param `c` The m x n result matrix
+/// @param `a` The left matrix with m rows and k columns
+/// @param `b` The right matrix with k rows and n columns
+/// @param `type` The element type of all three matrices
+/// @param `accumulate` Whether to add the product to `c` instead of
+/// overwriting it
+/// @return `bool` Whether the product was computed, false if the arrays are
+/// not two-dimensional, their shapes do not match or the type is not supported
+FCLIB_API bool fclib_linalg_matmul_into( //
+    fclib_arr_t *c,                      //
+    const fclib_arr_t *a,                //
+    const fclib_arr_t *b,                //
+    const fclib_arr_type_t type,         //
+    const bool accumulate                //
+);
+
+/// @enum `linalg_op_t`
+/// @brief The arithmetic operations of `linalg_reduce` and `linalg_broadcast`.
+/// Integer arithmetic wraps around on overflow and integer division by zero
+/// results in 0. Reductions only support `ADD`, `MUL`, `MIN` and `MAX`
+typedef enum fclib_linalg_op_t {
+    FCLIB_LINALG_ADD,
+    FCLIB_LINALG_SUB,
+    FCLIB_LINALG_MUL,
+    FCLIB_LINALG_DIV,
+    FCLIB_LINALG_MIN,
+    FCLIB_LINALG_MAX,
+} fclib_linalg_op_t;
+
+/// @function `linalg_reduce`
+/// @brief Reduces the array along the dimension `axis` with the given
+/// operation, e.g. the column sums of an m x n matrix are its reduction along
+/// axis 0 and its row sums the reduction along axis 1. The result keeps the
+/// dimensionality of `arr`, with the length of `axis` set to 1, so it can be
+/// broadcast against `arr` again. Reducing an empty axis results in 0 for `ADD`
+/// and 1 for `MUL`.
+///
+/// @param `arr` The array to reduce
+/// @param `type` The element type of the array
+/// @param `axis` The dimension to reduce along
+/// @param `op` The reduction, one of `ADD`, `MUL`, `MIN` or `MAX`
+/// @return `arr_t *` The reduced array, or NULL if `axis` does not exist, the
+/// operation is not a reduction or `MIN` or `MAX` are applied to an empty axis
+FCLIB_API fclib_arr_t *fclib_linalg_reduce( //
+    const fclib_arr_t *arr,                 //
+    const fclib_arr_type_t type,            //
+    const size_t axis,                      //
+    const fclib_linalg_op_t op              //
+);
+
+/// @function `linalg_broadcast`
+/// @brief Applies the operation element-wise to `a` and `b`, broadcasting them
+/// against each other like NumPy does: the shapes are aligned at their last
+/// dimension, the missing dimensions of the array with less dimensions count
+/// as length 1, and a dimension of length 1 is stretched to the length of the
+/// other array. So adding a vector of n elements to an m x n matrix adds the
+/// i-th element of the vector to the i-th column of the matrix.
+///
+/// @param `a` The left operand
+/// @param `b` The right operand
+/// @param `type` The element type of both arrays
+/// @param `op` The operation to apply
+/// @return `arr_t *` The result with the broadcast shape of `a` and `b`, or
+/// NULL if the shapes cannot be broadcast against each other
+FCLIB_API fclib_arr_t *fclib_linalg_broadcast( //
+    const fclib_arr_t *a,                      //
+    const fclib_arr_t *b,                      //
+    const fclib_arr_type_t type,               //
+    const fclib_linalg_op_t op                 //
+);
+
+/// @function `linalg_broadcast_into`
+/// @brief Applies the operation element-wise to `a` and `b` like
+/// `linalg_broadcast`, but writes the result into the existing array `c`,
+/// which must have exactly the broadcast shape. `c` may be `a` or `b` itself,
+/// which makes `linalg_broadcast_into(a, a, b, ...)` an in-place update.
+///
+/// @param `c` The array to write the result to
+/// @param `a` The left operand
+/// @param `b` The right operand
+/// @param `type` The element type of all three arrays
+/// @param `op` The operation to apply
+/// @return `bool` Whether the result was written, false if the shapes cannot
+/// be broadcast against each other or `c` does not have the broadcast shape
+FCLIB_API bool fclib_linalg_broadcast_into( //
+    fclib_arr_t *c,                         //
+    const fclib_arr_t *a,                   //
+    const fclib_arr_t *b,                   //
+    const fclib_arr_type_t type,            //
+    const fclib_linalg_op_t op              //
+);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+FCLIB_API static inline arr_t *linalg_matmul( //
+    const arr_t *a,                           //
+    const arr_t *b,                           //
+    const arr_type_t type                     //
+) {
+    return fclib_linalg_matmul(a, b, type);
+}
+FCLIB_API static inline bool linalg_matmul_into( //
+    arr_t *c,                                    //
+    const arr_t *a,                              //
+    const arr_t *b,                              //
+    const arr_type_t type,                       //
+    const bool accumulate                        //
+) {
+    return fclib_linalg_matmul_into(c, a, b, type, accumulate);
+}
+
+typedef fclib_linalg_op_t linalg_op_t;
+
+FCLIB_API static inline arr_t *linalg_reduce( //
+    const arr_t *arr,                         //
+    const arr_type_t type,                    //
+    const size_t axis,                        //
+    const linalg_op_t op                      //
+) {
+    return fclib_linalg_reduce(arr, type, axis, op);
+}
+FCLIB_API static inline arr_t *linalg_broadcast( //
+    const arr_t *a,                              //
+    const arr_t *b,                              //
+    const arr_type_t type,                       //
+    const linalg_op_t op                         //
+) {
+    return fclib_linalg_broadcast(a, b, type, op);
+}
+FCLIB_API static inline bool linalg_broadcast_into( //
+    arr_t *c,                                       //
+    const arr_t *a,                                 //
+    const arr_t *b,                                 //
+    const arr_type_t type,                          //
+    const linalg_op_t op                            //
+) {
+    return fclib_linalg_broadcast_into(c, a, b, type, op);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+// Products with fewer multiply-adds than this are computed by the unblocked
+// loop, as packing the operands would cost more than it saves
+#define FCLIB_LINALG_BLOCKED_MIN (32 * 32 * 32)
+// Products with fewer multiply-adds than this are not split across threads
+#define FCLIB_LINALG_PARALLEL_MIN (128 * 128 * 128)
+// The depth of a packed panel, and the byte budgets of the packed blocks of
+// `a` (which should stay in the L2 cache) and of `b` (which should stay in the
+// L3 cache)
+#define FCLIB_LINALG_KC 256
+#define FCLIB_LINALG_A_BLOCK (256 * 1024)
+#define FCLIB_LINALG_B_BLOCK (4 * 1024 * 1024)
+// The largest micro-tile of all kernels in elements, used for edge tiles
+#define FCLIB_LINALG_MAX_TILE (32 * 8)
+
+// A micro-kernel computes the `mr` x `nr` tile c (+)= a * b from a packed
+// `depth` x `mr` panel of `a` and a packed `depth` x `nr` panel of `b`
+typedef void (*fclib_linalg_kernel_t)( //
+    const size_t depth,                //
+    const void *a_panel,               //
+    const void *b_panel,               //
+    void *c_tile,                      //
+    const size_t ldc,                  //
+    const bool overwrite               //
+);
+
+typedef struct fclib_linalg_gemm_t {
+    fclib_linalg_kernel_t kernel;
+    size_t size;
+    size_t mr;
+    size_t nr;
+    size_t mc;
+    size_t kc;
+    size_t nc;
+} fclib_linalg_gemm_t;
+
+// A (sub-)product c (+)= a * b of column-major matrices, the leading
+// dimensions are the distances between two columns in elements
+typedef struct fclib_linalg_problem_t {
+    const fclib_linalg_gemm_t *gemm;
+    size_t m;
+    size_t n;
+    size_t k;
+    const char *a;
+    size_t lda;
+    const char *b;
+    size_t ldb;
+    char *c;
+    size_t ldc;
+    bool accumulate;
+} fclib_linalg_problem_t;
+
+static void fclib_linalg_kernel_f64( //
+    const size_t depth,              //
+    const void *a_panel,             //
+    const void *b_panel,             //
+    void *c_tile,                    //
+    const size_t ldc,                //
+    const bool overwrite             //
+) {
+    const double *a = (const double *)a_panel;
+    const double *b = (const double *)b_panel;
+    double *c = (double *)c_tile;
+    double acc[4][4] = {{0}};
+    for (size_t p = 0; p < depth; p++) {
+        for (size_t j = 0; j < 4; j++) {
+            for (size_t i = 0; i < 4; i++) {
+                acc[j][i] += a[i] * b[j];
+            }
+        }
+        a += 4;
+        b += 4;
+    }
+    for (size_t j = 0; j < 4; j++) {
+        for (size_t i = 0; i < 4; i++) {
+            c[i + j * ldc] = overwrite ? acc[j][i] : c[i + j * ldc] + acc[j][i];
+        }
+    }
+}
+
+static void fclib_linalg_kernel_f32( //
+    const size_t depth,              //
+    const void *a_panel,             //
+    const void *b_panel,             //
+    void *c_tile,                    //
+    const size_t ldc,                //
+    const bool overwrite             //
+) {
+    const float *a = (const float *)a_panel;
+    const float *b = (const float *)b_panel;
+    float *c = (float *)c_tile;
+    float acc[4][8] = {{0}};
+    for (size_t p = 0; p < depth; p++) {
+        for (size_t j = 0; j < 4; j++) {
+            for (size_t i = 0; i < 8; i++) {
+                acc[j][i] += a[i] * b[j];
+            }
+        }
+        a += 8;
+        b += 4;
+    }
+    for (size_t j = 0; j < 4; j++) {
+        for (size_t i = 0; i < 8; i++) {
+            c[i + j * ldc] = overwrite ? acc[j][i] : c[i + j * ldc] + acc[j][i];
+        }
+    }
+}
+
+#if FCLIB_X86_SIMD
+// The SIMD micro-kernels keep the whole tile in vector registers: every step
+// loads one column of the `a` panel and broadcasts the `b` values of the step
+// one after another, so each loaded value feeds `nr` (or `mr`) multiply-adds.
+// The AVX2 tiles use 12 of the 16 registers for accumulators, the AVX-512
+// tiles 16 of the 32.
+
+FCLIB_TARGET("avx2,fma")
+static void fclib_linalg_kernel_f64_avx2( //
+    const size_t depth,                   //
+    const void *a_panel,                  //
+    const void *b_panel,                  //
+    void *c_tile,                         //
+    const size_t ldc,                     //
+    const bool overwrite                  //
+) {
+    const double *a = (const double *)a_panel;
+    const double *b = (const double *)b_panel;
+    double *c = (double *)c_tile;
+    __m256d lo[6];
+    __m256d hi[6];
+#pragma GCC unroll 6
+    for (size_t j = 0; j < 6; j++) {
+        lo[j] = _mm256_setzero_pd();
+        hi[j] = _mm256_setzero_pd();
+    }
+    for (size_t p = 0; p < depth; p++) {
+        const __m256d a_lo = _mm256_loadu_pd(a);
+        const __m256d a_hi = _mm256_loadu_pd(a + 4);
+#pragma GCC unroll 6
+        for (size_t j = 0; j < 6; j++) {
+            const __m256d bj = _mm256_broadcast_sd(b + j);
+            lo[j] = _mm256_fmadd_pd(a_lo, bj, lo[j]);
+            hi[j] = _mm256_fmadd_pd(a_hi, bj, hi[j]);
+        }
+        a += 8;
+        b += 6;
+    }
+#pragma GCC unroll 6
+    for (size_t j = 0; j < 6; j++) {
+        double *column = c + j * ldc;
+        if (!overwrite) {
+            lo[j] = _mm256_add_pd(lo[j], _mm256_loadu_pd(column));
+            hi[j] = _mm256_add_pd(hi[j], _mm256_loadu_pd(column + 4));
+        }
+        _mm256_storeu_pd(column, lo[j]);
+        _mm256_storeu_pd(column + 4, hi[j]);
+    }
+}
+
+FCLIB_TARGET("avx2,fma")
+static void fclib_linalg_kernel_f32_avx2( //
+    const size_t depth,                   //
+    const void *a_panel,                  //
+    const void *b_panel,                  //
+    void *c_tile,                         //
+    const size_t ldc,                     //
+    const bool overwrite                  //
+) {
+    const float *a = (const float *)a_panel;
+    const float *b = (const float *)b_panel;
+    float *c = (float *)c_tile;
+    __m256 lo[6];
+    __m256 hi[6];
+#pragma GCC unroll 6
+    for (size_t j = 0; j < 6; j++) {
+        lo[j] = _mm256_setzero_ps();
+        hi[j] = _mm256_setzero_ps();
+    }
+    for (size_t p = 0; p < depth; p++) {
+        const __m256 a_lo = _mm256_loadu_ps(a);
+        const __m256 a_hi = _mm256_loadu_ps(a + 8);
+#pragma GCC unroll 6
+        for (size_t j = 0; j < 6; j++) {
+            const __m256 bj = _mm256_broadcast_ss(b + j);
+            lo[j] = _mm256_fmadd_ps(a_lo, bj, lo[j]);
+            hi[j] = _mm256_fmadd_ps(a_hi, bj, hi[j]);
+        }
+        a += 16;
+        b += 6;
+    }
+#pragma GCC unroll 6
+    for (size_t j = 0; j < 6; j++) {
+        float *column = c + j * ldc;
+        if (!overwrite) {
+            lo[j] = _mm256_add_ps(lo[j], _mm256_loadu_ps(column));
+            hi[j] = _mm256_add_ps(hi[j], _mm256_loadu_ps(column + 8));
+        }
+        _mm256_storeu_ps(column, lo[j]);
+        _mm256_storeu_ps(column + 8, hi[j]);
+    }
+}
+
+FCLIB_TARGET("avx512f")
+static void fclib_linalg_kernel_f64_avx512( //
+    const size_t depth,                     //
+    const void *a_panel,                    //
+    const void *b_panel,                    //
+    void *c_tile,                           //
+    const size_t ldc,                       //
+    const bool overwrite                    //
+) {
+    const double *a = (const double *)a_panel;
+    const double *b = (const double *)b_panel;
+    double *c = (double *)c_tile;
+    __m512d lo[8];
+    __m512d hi[8];
+#pragma GCC unroll 8
+    for (size_t j = 0; j < 8; j++) {
+        lo[j] = _mm512_setzero_pd();
+        hi[j] = _mm512_setzero_pd();
+    }
+    for (size_t p = 0; p < depth; p++) {
+        const __m512d a_lo = _mm512_loadu_pd(a);
+        const __m512d a_hi = _mm512_loadu_pd(a + 8);
+#pragma GCC unroll 8
+        for (size_t j = 0; j < 8; j++) {
+            const __m512d bj = _mm512_set1_pd(b[j]);
+            lo[j] = _mm512_fmadd_pd(a_lo, bj, lo[j]);
+            hi[j] = _mm512_fmadd_pd(a_hi, bj, hi[j]);
+        }
+        a += 16;
+        b += 8;
+    }
+#pragma GCC unroll 8
+    for (size_t j = 0; j < 8; j++) {
+        double *column = c + j * ldc;
+        if (!overwrite) {
+            lo[j] = _mm512_add_pd(lo[j], _mm512_loadu_pd(column));
+            hi[j] = _mm512_add_pd(hi[j], _mm512_loadu_pd(column + 8));
+        }
+        _mm512_storeu_pd(column, lo[j]);
+        _mm512_storeu_pd(column + 8, hi[j]);
+    }
+}
+
+FCLIB_TARGET("avx512f")
+static void fclib_linalg_kernel_f32_avx512( //
+    const size_t depth,                     //
+    const void *a_panel,                    //
+    const void *b_panel,                    //
+    void *c_tile,                           //
+    const size_t ldc,                       //
+    const bool overwrite                    //
+) {
+    const float *a = (const float *)a_panel;
+    const float *b = (const float *)b_panel;
+    float *c = (float *)c_tile;
+    __m512 lo[8];
+    __m512 hi[8];
+#pragma GCC unroll 8
+    for (size_t j = 0; j < 8; j++) {
+        lo[j] = _mm512_setzero_ps();
+        hi[j] = _mm512_setzero_ps();
+    }
+    for (size_t p = 0; p < depth; p++) {
+        const __m512 a_lo = _mm512_loadu_ps(a);
+        const __m512 a_hi = _mm512_loadu_ps(a + 16);
+#pragma GCC unroll 8
+        for (size_t j = 0; j < 8; j++) {
+            const __m512 bj = _mm512_set1_ps(b[j]);
+            lo[j] = _mm512_fmadd_ps(a_lo, bj, lo[j]);
+            hi[j] = _mm512_fmadd_ps(a_hi, bj, hi[j]);
+        }
+        a += 32;
+        b += 8;
+    }
+#pragma GCC unroll 8
+    for (size_t j = 0; j < 8; j++) {
+        float *column = c + j * ldc;
+        if (!overwrite) {
+            lo[j] = _mm512_add_ps(lo[j], _mm512_loadu_ps(column));
+            hi[j] = _mm512_add_ps(hi[j], _mm512_loadu_ps(column + 16));
+        }
+        _mm512_storeu_ps(column, lo[j]);
+        _mm512_storeu_ps(column + 16, hi[j]);
+    }
+}
+#endif
+
+// Selects the fastest micro-kernel for the element type and derives the block
+// sizes from its tile shape
+static void fclib_linalg_select( //
+    fclib_linalg_gemm_t *gemm,   //
+    const fclib_arr_type_t type  //
+) {
+    const bool f64 = type == FCLIB_ARR_TYPE_F64;
+    gemm->size = f64 ? sizeof(double) : sizeof(float);
+    gemm->kernel = f64 ? fclib_linalg_kernel_f64 : fclib_linalg_kernel_f32;
+    gemm->mr = f64 ? 4 : 8;
+    gemm->nr = 4;
+#if FCLIB_X86_SIMD
+    if (fclib_cpu_has_avx512()) {
+        gemm->kernel = f64 ? fclib_linalg_kernel_f64_avx512
+                           : fclib_linalg_kernel_f32_avx512;
+        gemm->mr = f64 ? 16 : 32;
+        gemm->nr = 8;
+    } else if (fclib_cpu_has_fma()) {
+        gemm->kernel = f64 ? fclib_linalg_kernel_f64_avx2
+                           : fclib_linalg_kernel_f32_avx2;
+        gemm->mr = f64 ? 8 : 16;
+        gemm->nr = 6;
+    }
+#endif
+    gemm->kc = FCLIB_LINALG_KC;
+    gemm->mc = FCLIB_LINALG_A_BLOCK / (gemm->kc * gemm->size);
+    gemm->mc -= gemm->mc % gemm->mr;
+    gemm->nc = FCLIB_LINALG_B_BLOCK / (gemm->kc * gemm->size);
+    gemm->nc -= gemm->nc % gemm->nr;
+}
+
+// The plain column-major loop, used for small products and as the fallback if
+// the packing buffers cannot be allocated. The innermost loop runs down a
+// column, so it is stride-1 in both `a` and `c`
+static void fclib_linalg_gemm_unblocked(const fclib_linalg_problem_t *p) {
+    const bool f64 = p->gemm->size == sizeof(double);
+    for (size_t j = 0; j < p->n; j++) {
+        char *c_column = p->c + j * p->ldc * p->gemm->size;
+        if (!p->accumulate) {
+            memset(c_column, 0, p->m * p->gemm->size);
+        }
+        for (size_t l = 0; l < p->k; l++) {
+            const size_t a_offset = l * p->lda * p->gemm->size;
+            const size_t b_offset = (l + j * p->ldb) * p->gemm->size;
+            if (f64) {
+                double *c = (double *)(void *)c_column;
+                const double *a = (const double *)(const void *)( //
+                    p->a + a_offset);
+                const double b = *(const double *)(const void *)( //
+                    p->b + b_offset);
+                for (size_t i = 0; i < p->m; i++) {
+                    c[i] += a[i] * b;
+                }
+            } else {
+                float *c = (float *)(void *)c_column;
+                const float *a = (const float *)(const void *)( //
+                    p->a + a_offset);
+                const float b = *(const float *)(const void *)( //
+                    p->b + b_offset);
+                for (size_t i = 0; i < p->m; i++) {
+                    c[i] += a[i] * b;
+                }
+            }
+        }
+    }
+}
+
+// Packs the `rows` x `depth` block of `a` into panels of `mr` rows, each panel
+// storing the `mr` values of one column after another. Missing rows of the
+// last panel are zero
+static void fclib_linalg_pack_a(     //
+    const fclib_linalg_gemm_t *gemm, //
+    char *dest,                      //
+    const char *a,                   //
+    const size_t lda,                //
+    const size_t rows,               //
+    const size_t depth               //
+) {
+    const size_t size = gemm->size;
+    for (size_t i = 0; i < rows; i += gemm->mr) {
+        const size_t height = rows - i < gemm->mr ? rows - i : gemm->mr;
+        for (size_t l = 0; l < depth; l++) {
+            memcpy(dest, a + (i + l * lda) * size, height * size);
+            memset(dest + height * size, 0, (gemm->mr - height) * size);
+            dest += gemm->mr * size;
+        }
+    }
+}
+
+// Packs the `depth` x `columns` block of `b` into panels of `nr` columns, each
+// panel storing the `nr` values of one row after another. Missing columns of
+// the last panel are zero
+static void fclib_linalg_pack_b(     //
+    const fclib_linalg_gemm_t *gemm, //
+    char *dest,                      //
+    const char *b,                   //
+    const size_t ldb,                //
+    const size_t depth,              //
+    const size_t columns             //
+) {
+    const size_t nr = gemm->nr;
+    for (size_t j = 0; j < columns; j += nr) {
+        const size_t width = columns - j < nr ? columns - j : nr;
+        if (gemm->size == sizeof(double)) {
+            double *panel = (double *)(void *)dest;
+            for (size_t jj = 0; jj < width; jj++) {
+                const double *column = (const double *)(const void *)( //
+                    b + (j + jj) * ldb * sizeof(double));
+                for (size_t l = 0; l < depth; l++) {
+                    panel[l * nr + jj] = column[l];
+                }
+            }
+            for (size_t jj = width; jj < nr; jj++) {
+                for (size_t l = 0; l < depth; l++) {
+                    panel[l * nr + jj] = 0.0;
+                }
+            }
+        } else {
+            float *panel = (float *)(void *)dest;
+            for (size_t jj = 0; jj < width; jj++) {
+                const float *column = (const float *)(const void *)( //
+                    b + (j + jj) * ldb * sizeof(float));
+                for (size_t l = 0; l < depth; l++) {
+                    panel[l * nr + jj] = column[l];
+                }
+            }
+            for (size_t jj = width; jj < nr; jj++) {
+                for (size_t l = 0; l < depth; l++) {
+                    panel[l * nr + jj] = 0.0f;
+                }
+            }
+        }
+        dest += depth * nr * gemm->size;
+    }
+}
+
+// Adds (or copies) the `rows` x `columns` part of an edge tile computed into
+// the scratch tile to `c`
+static void fclib_linalg_store_edge( //
+    const fclib_linalg_gemm_t *gemm, //
+    char *c,                         //
+    const size_t ldc,                //
+    const void *tile,                //
+    const size_t rows,               //
+    const size_t columns,            //
+    const bool overwrite             //
+) {
+    for (size_t j = 0; j < columns; j++) {
+        if (gemm->size == sizeof(double)) {
+            double *dest = (double *)(void *)(c + j * ldc * sizeof(double));
+            const double *src = (const double *)tile + j * gemm->mr;
+            for (size_t i = 0; i < rows; i++) {
+                dest[i] = overwrite ? src[i] : dest[i] + src[i];
+            }
+        } else {
+            float *dest = (float *)(void *)(c + j * ldc * sizeof(float));
+            const float *src = (const float *)tile + j * gemm->mr;
+            for (size_t i = 0; i < rows; i++) {
+                dest[i] = overwrite ? src[i] : dest[i] + src[i];
+            }
+        }
+    }
+}
+
+// Computes the product block by block: `b` is packed in blocks of `kc` rows
+// and `nc` columns, `a` in blocks of `mc` rows and `kc` columns, and every
+// pair of packed panels is handed to the micro-kernel
+static void fclib_linalg_gemm_blocked(const fclib_linalg_problem_t *p) {
+    const fclib_linalg_gemm_t *gemm = p->gemm;
+    const size_t size = gemm->size;
+    const size_t mr = gemm->mr;
+    const size_t nr = gemm->nr;
+    const size_t rows = p->m < gemm->mc ? p->m : gemm->mc;
+    const size_t columns = p->n < gemm->nc ? p->n : gemm->nc;
+    const size_t depth = p->k < gemm->kc ? p->k : gemm->kc;
+    char *a_pack = (char *)malloc( //
+        (rows + mr - 1) / mr * mr * depth * size);
+    char *b_pack = (char *)malloc( //
+        (columns + nr - 1) / nr * nr * depth * size);
+    if (a_pack == NULL || b_pack == NULL) {
+        free(a_pack);
+        free(b_pack);
+        fclib_linalg_gemm_unblocked(p);
+        return;
+    }
+    double tile[FCLIB_LINALG_MAX_TILE];
+    for (size_t jc = 0; jc < p->n; jc += gemm->nc) {
+        const size_t nc = p->n - jc < gemm->nc ? p->n - jc : gemm->nc;
+        for (size_t pc = 0; pc < p->k; pc += gemm->kc) {
+            const size_t kc = p->k - pc < gemm->kc ? p->k - pc : gemm->kc;
+            // The first block along the depth overwrites c unless accumulating
+            const bool overwrite = pc == 0 && !p->accumulate;
+            fclib_linalg_pack_b(gemm, b_pack,
+                p->b + (pc + jc * p->ldb) * size, p->ldb, kc, nc);
+            for (size_t ic = 0; ic < p->m; ic += gemm->mc) {
+                const size_t mc = p->m - ic < gemm->mc ? p->m - ic : gemm->mc;
+                fclib_linalg_pack_a(gemm, a_pack,
+                    p->a + (ic + pc * p->lda) * size, p->lda, mc, kc);
+                for (size_t jr = 0; jr < nc; jr += nr) {
+                    const size_t width = nc - jr < nr ? nc - jr : nr;
+                    const char *b_panel = b_pack + jr * kc * size;
+                    for (size_t ir = 0; ir < mc; ir += mr) {
+                        const size_t height = mc - ir < mr ? mc - ir : mr;
+                        const char *a_panel = a_pack + ir * kc * size;
+                        char *c = p->c + (ic + ir + (jc + jr) * p->ldc) * size;
+                        if (height == mr && width == nr) {
+                            gemm->kernel(
+                                kc, a_panel, b_panel, c, p->ldc, overwrite);
+                            continue;
+                        }
+                        gemm->kernel(kc, a_panel, b_panel, tile, mr, true);
+                        fclib_linalg_store_edge(gemm, c, p->ldc, tile, height,
+                            width, overwrite);
+                    }
+                }
+            }
+        }
+    }
+    free(a_pack);
+    free(b_pack);
+}
+
+// Every thread computes the product for its own range of micro-panels along
+// the larger dimension of c, so no two threads ever write the same element
+typedef struct fclib_linalg_split_t {
+    const fclib_linalg_problem_t *problem;
+    bool by_rows;
+} fclib_linalg_split_t;
+
+static void fclib_linalg_gemm_range( //
+    void *context,                   //
+    const size_t begin,              //
+    const size_t end                 //
+) {
+    const fclib_linalg_split_t *split = (const fclib_linalg_split_t *)context;
+    fclib_linalg_problem_t part = *split->problem;
+    const size_t size = part.gemm->size;
+    if (split->by_rows) {
+        const size_t first = begin * part.gemm->mr;
+        const size_t last = end * part.gemm->mr;
+        part.m = (last < part.m ? last : part.m) - first;
+        part.a += first * size;
+        part.c += first * size;
+    } else {
+        const size_t first = begin * part.gemm->nr;
+        const size_t last = end * part.gemm->nr;
+        part.n = (last < part.n ? last : part.n) - first;
+        part.b += first * part.ldb * size;
+        part.c += first * part.ldc * size;
+    }
+    fclib_linalg_gemm_blocked(&part);
+}
+
+static void fclib_linalg_gemm(const fclib_linalg_problem_t *p) {
+    const size_t work = p->m * p->n * p->k;
+    if (work < FCLIB_LINALG_BLOCKED_MIN) {
+        fclib_linalg_gemm_unblocked(p);
+        return;
+    }
+    if (work < FCLIB_LINALG_PARALLEL_MIN) {
+        fclib_linalg_gemm_blocked(p);
+        return;
+    }
+    fclib_linalg_split_t split;
+    split.problem = p;
+    split.by_rows = p->m > p->n;
+    const size_t unit = split.by_rows ? p->gemm->mr : p->gemm->nr;
+    const size_t panels = ((split.by_rows ? p->m : p->n) + unit - 1) / unit;
+    // A thread should at least get enough panels to fill a few micro-tiles
+    // along the other dimension, otherwise packing dominates
+    const size_t grain = (64 + unit - 1) / unit;
+    fclib_parallel_for(panels, grain, fclib_linalg_gemm_range, &split);
+}
+
+FCLIB_API fclib_arr_t *fclib_linalg_matmul( //
+    const fclib_arr_t *a,                   //
+    const fclib_arr_t *b,                   //
+    const fclib_arr_type_t type             //
+) {
+    if (a->len != 2 || b->len != 2) {
+        return NULL;
+    }
+    const size_t *a_dims = FCLIB_ALIGNCAST(const size_t, a->value);
+    const size_t *b_dims = FCLIB_ALIGNCAST(const size_t, b->value);
+    const size_t lengths[2] = {a_dims[0], b_dims[1]};
+    fclib_arr_t *c = fclib_arr_create(2, fclib_arr_type_size(type), lengths);
+    if (c == NULL) {
+        return NULL;
+    }
+    if (!fclib_linalg_matmul_into(c, a, b, type, false)) {
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+FCLIB_API bool fclib_linalg_matmul_into( //
+    fclib_arr_t *c,                      //
+    const fclib_arr_t *a,                //
+    const fclib_arr_t *b,                //
+    const fclib_arr_type_t type,         //
+    const bool accumulate                //
+) {
+    if (type != FCLIB_ARR_TYPE_F32 && type != FCLIB_ARR_TYPE_F64) {
+        return false;
+    }
+    if (a->len != 2 || b->len != 2 || c->len != 2) {
+        return false;
+    }
+    const size_t *a_dims = FCLIB_ALIGNCAST(const size_t, a->value);
+    const size_t *b_dims = FCLIB_ALIGNCAST(const size_t, b->value);
+    const size_t *c_dims = FCLIB_ALIGNCAST(const size_t, c->value);
+    if (a_dims[1] != b_dims[0] || c_dims[0] != a_dims[0] ||
+        c_dims[1] != b_dims[1]) {
+        return false;
+    }
+    fclib_linalg_gemm_t gemm;
+    fclib_linalg_select(&gemm, type);
+    fclib_linalg_problem_t problem;
+    problem.gemm = &gemm;
+    problem.m = a_dims[0];
+    problem.n = b_dims[1];
+    problem.k = a_dims[1];
+    problem.a = a->value + a->len * sizeof(size_t);
+    problem.lda = problem.m;
+    problem.b = b->value + b->len * sizeof(size_t);
+    problem.ldb = problem.k;
+    problem.c = c->value + c->len * sizeof(size_t);
+    problem.ldc = problem.m;
+    problem.accumulate = accumulate;
+    if (problem.m == 0 || problem.n == 0) {
+        return true;
+    }
+    fclib_linalg_gemm(&problem);
+    return true;
+}
+
+// The element-wise kernels work on blocks of this many elements, whose fixed
+// length lets the compiler turn every block into a few vector instructions
+#define FCLIB_LINALG_BLOCK 16
+// Reductions along an outer axis accumulate into tiles of at most this many
+// bytes of the result, so the tile stays in the L1 cache across all rows
+#define FCLIB_LINALG_TILE (16 * 1024)
+
+// Applies `expr` (in terms of the left value `l` and the right value `r`) to
+// `count` elements. An operand whose step is 0 is a single broadcast value,
+// it is expanded to a full block once so the block loop always reads
+// contiguous memory. Every block is computed before it is stored, so `dest`
+// may be one of the operands
+#define FCLIB_LINALG_APPLY(T, expr)                                            \
+    do {                                                                       \
+        T *d = (T *)dest;                                                      \
+        const T *x = (const T *)a;                                             \
+        const T *y = (const T *)b;                                             \
+        T a_fill[FCLIB_LINALG_BLOCK];                                          \
+        T b_fill[FCLIB_LINALG_BLOCK];                                          \
+        for (size_t j = 0; j < FCLIB_LINALG_BLOCK; j++) {                      \
+            a_fill[j] = x[0];                                                  \
+            b_fill[j] = y[0];                                                  \
+        }                                                                      \
+        size_t i = 0;                                                          \
+        for (; i + FCLIB_LINALG_BLOCK <= count; i += FCLIB_LINALG_BLOCK) {     \
+            const T *pa = a_step != 0 ? x + i : a_fill;                        \
+            const T *pb = b_step != 0 ? y + i : b_fill;                        \
+            T block[FCLIB_LINALG_BLOCK];                                       \
+            for (size_t j = 0; j < FCLIB_LINALG_BLOCK; j++) {                  \
+                const T l = pa[j];                                             \
+                const T r = pb[j];                                             \
+                block[j] = (expr);                                             \
+            }                                                                  \
+            memcpy(d + i, block, sizeof(block));                               \
+        }                                                                      \
+        for (; i < count; i++) {                                               \
+            const T l = x[i * a_step];                                         \
+            const T r = y[i * b_step];                                         \
+            d[i] = (expr);                                                     \
+        }                                                                      \
+    } while (0)
+
+// Folds `count` contiguous elements with `expr` (in terms of the accumulator
+// `l` and the next value `r`) into one value. Every lane of a block has its
+// own accumulator, which are combined at the end, so the block loop is free
+// of any dependency between its lanes
+#define FCLIB_LINALG_FOLD(T, init, expr)                                       \
+    do {                                                                       \
+        const T *x = (const T *)src;                                           \
+        T lanes[FCLIB_LINALG_BLOCK];                                           \
+        for (size_t j = 0; j < FCLIB_LINALG_BLOCK; j++) {                      \
+            lanes[j] = (init);                                                 \
+        }                                                                      \
+        size_t i = 0;                                                          \
+        for (; i + FCLIB_LINALG_BLOCK <= count; i += FCLIB_LINALG_BLOCK) {     \
+            for (size_t j = 0; j < FCLIB_LINALG_BLOCK; j++) {                  \
+                const T l = lanes[j];                                          \
+                const T r = x[i + j];                                          \
+                lanes[j] = (expr);                                             \
+            }                                                                  \
+        }                                                                      \
+        T acc = lanes[0];                                                      \
+        for (size_t j = 1; j < FCLIB_LINALG_BLOCK; j++) {                      \
+            const T l = acc;                                                   \
+            const T r = lanes[j];                                              \
+            acc = (expr);                                                      \
+        }                                                                      \
+        for (; i < count; i++) {                                               \
+            const T l = acc;                                                   \
+            const T r = x[i];                                                  \
+            acc = (expr);                                                      \
+        }                                                                      \
+        memcpy(result, &acc, sizeof(T));                                       \
+    } while (0)
+
+// Defines the element-wise and the fold kernel of one element type. The
+// arithmetic is done in `W`, which is an unsigned type for integers so that
+// overflows wrap around instead of being undefined, and `div` is the division
+// in terms of `l` and `r`
+#define FCLIB_LINALG_KERNELS(name, T, W, div, target)                          \
+    target static void fclib_linalg_apply_##name(                              \
+        const fclib_linalg_op_t op,                                            \
+        void *dest,                                                            \
+        const void *a,                                                         \
+        const size_t a_step,                                                   \
+        const void *b,                                                         \
+        const size_t b_step,                                                   \
+        const size_t count) {                                                  \
+        if (count == 0) {                                                      \
+            return;                                                            \
+        }                                                                      \
+        switch (op) {                                                          \
+            case FCLIB_LINALG_ADD:                                             \
+                FCLIB_LINALG_APPLY(T, (T)((W)l + (W)r));                       \
+                return;                                                        \
+            case FCLIB_LINALG_SUB:                                             \
+                FCLIB_LINALG_APPLY(T, (T)((W)l - (W)r));                       \
+                return;                                                        \
+            case FCLIB_LINALG_MUL:                                             \
+                FCLIB_LINALG_APPLY(T, (T)((W)l * (W)r));                       \
+                return;                                                        \
+            case FCLIB_LINALG_DIV:                                             \
+                FCLIB_LINALG_APPLY(T, div);                                    \
+                return;                                                        \
+            case FCLIB_LINALG_MIN:                                             \
+                FCLIB_LINALG_APPLY(T, r < l ? r : l);                          \
+                return;                                                        \
+            case FCLIB_LINALG_MAX:                                             \
+                FCLIB_LINALG_APPLY(T, r > l ? r : l);                          \
+                return;                                                        \
+        }                                                                      \
+    }                                                                          \
+    target static void fclib_linalg_fold_##name(                               \
+        const fclib_linalg_op_t op,                                            \
+        const void *src,                                                       \
+        const size_t count,                                                    \
+        void *result) {                                                        \
+        switch (op) {                                                          \
+            case FCLIB_LINALG_ADD:                                             \
+                FCLIB_LINALG_FOLD(T, (T)0, (T)((W)l + (W)r));                  \
+                return;                                                        \
+            case FCLIB_LINALG_MUL:                                             \
+                FCLIB_LINALG_FOLD(T, (T)1, (T)((W)l * (W)r));                  \
+                return;                                                        \
+            case FCLIB_LINALG_MIN:                                             \
+                FCLIB_LINALG_FOLD(T, x[0], r < l ? r : l);                     \
+                return;                                                        \
+            case FCLIB_LINALG_MAX:                                             \
+                FCLIB_LINALG_FOLD(T, x[0], r > l ? r : l);                     \
+                return;                                                        \
+            case FCLIB_LINALG_SUB:                                             \
+            case FCLIB_LINALG_DIV:                                             \
+                return;                                                        \
+        }                                                                      \
+    }
+
+#define FCLIB_LINALG_DIV_SIGNED(T, W)                                          \
+    (r == 0 ? (T)0 : r == -1 ? (T)(0 - (W)l) : (T)(l / r))
+#define FCLIB_LINALG_DIV_UNSIGNED(T) (r == 0 ? (T)0 : (T)(l / r))
+
+// Defines the kernels of all element types with the given name suffix and
+// target attribute
+#define FCLIB_LINALG_ALL_KERNELS(suffix, target)                               \
+    FCLIB_LINALG_KERNELS(i8##suffix, int8_t, unsigned,                         \
+        FCLIB_LINALG_DIV_SIGNED(int8_t, unsigned), target)                     \
+    FCLIB_LINALG_KERNELS(i16##suffix, int16_t, unsigned,                       \
+        FCLIB_LINALG_DIV_SIGNED(int16_t, unsigned), target)                    \
+    FCLIB_LINALG_KERNELS(i32##suffix, int32_t, uint32_t,                       \
+        FCLIB_LINALG_DIV_SIGNED(int32_t, uint32_t), target)                    \
+    FCLIB_LINALG_KERNELS(i64##suffix, int64_t, uint64_t,                       \
+        FCLIB_LINALG_DIV_SIGNED(int64_t, uint64_t), target)                    \
+    FCLIB_LINALG_KERNELS(u8##suffix, uint8_t, unsigned,                        \
+        FCLIB_LINALG_DIV_UNSIGNED(uint8_t), target)                            \
+    FCLIB_LINALG_KERNELS(u16##suffix, uint16_t, unsigned,                      \
+        FCLIB_LINALG_DIV_UNSIGNED(uint16_t), target)                           \
+    FCLIB_LINALG_KERNELS(u32##suffix, uint32_t, uint32_t,                      \
+        FCLIB_LINALG_DIV_UNSIGNED(uint32_t), target)                           \
+    FCLIB_LINALG_KERNELS(u64##suffix, uint64_t, uint64_t,                      \
+        FCLIB_LINALG_DIV_UNSIGNED(uint64_t), target)                           \
+    FCLIB_LINALG_KERNELS(f32##suffix, float, float, l / r, target)             \
+    FCLIB_LINALG_KERNELS(f64##suffix, double, double, l / r, target)
+
+typedef void (*fclib_linalg_apply_t)( //
+    const fclib_linalg_op_t op,       //
+    void *dest,                       //
+    const void *a,                    //
+    const size_t a_step,              //
+    const void *b,                    //
+    const size_t b_step,              //
+    const size_t count                //
+);
+
+typedef void (*fclib_linalg_fold_t)( //
+    const fclib_linalg_op_t op,      //
+    const void *src,                 //
+    const size_t count,              //
+    void *result                     //
+);
+
+typedef struct fclib_linalg_kernels_t {
+    fclib_linalg_apply_t apply;
+    fclib_linalg_fold_t fold;
+} fclib_linalg_kernels_t;
+
+// Both kernel tables are indexed by `fclib_arr_type_t`
+#define FCLIB_LINALG_TABLE(suffix)                                             \
+    {                                                                          \
+        {fclib_linalg_apply_i8##suffix, fclib_linalg_fold_i8##suffix},         \
+        {fclib_linalg_apply_i16##suffix, fclib_linalg_fold_i16##suffix},       \
+        {fclib_linalg_apply_i32##suffix, fclib_linalg_fold_i32##suffix},       \
+        {fclib_linalg_apply_i64##suffix, fclib_linalg_fold_i64##suffix},       \
+        {fclib_linalg_apply_u8##suffix, fclib_linalg_fold_u8##suffix},         \
+        {fclib_linalg_apply_u16##suffix, fclib_linalg_fold_u16##suffix},       \
+        {fclib_linalg_apply_u32##suffix, fclib_linalg_fold_u32##suffix},       \
+        {fclib_linalg_apply_u64##suffix, fclib_linalg_fold_u64##suffix},       \
+        {fclib_linalg_apply_f32##suffix, fclib_linalg_fold_f32##suffix},       \
+        {fclib_linalg_apply_f64##suffix, fclib_linalg_fold_f64##suffix},       \
+    }
+
+FCLIB_LINALG_ALL_KERNELS(, )
+static const fclib_linalg_kernels_t fclib_linalg_kernels_scalar[] = //
+    FCLIB_LINALG_TABLE();
+
+#if FCLIB_X86_SIMD
+// The same kernels compiled for AVX2, which doubles the vector width
+FCLIB_LINALG_ALL_KERNELS(_avx2, FCLIB_TARGET("avx2"))
+static const fclib_linalg_kernels_t fclib_linalg_kernels_avx2[] = //
+    FCLIB_LINALG_TABLE(_avx2);
+#endif
+
+static const fclib_linalg_kernels_t *fclib_linalg_kernels( //
+    const fclib_arr_type_t type                            //
+) {
+#if FCLIB_X86_SIMD
+    if (fclib_cpu_has_avx2()) {
+        return &fclib_linalg_kernels_avx2[type];
+    }
+#endif
+    return &fclib_linalg_kernels_scalar[type];
+}
+
+FCLIB_API fclib_arr_t *fclib_linalg_reduce( //
+    const fclib_arr_t *arr,                 //
+    const fclib_arr_type_t type,            //
+    const size_t axis,                      //
+    const fclib_linalg_op_t op              //
+) {
+    if (axis >= arr->len || op == FCLIB_LINALG_SUB || op == FCLIB_LINALG_DIV) {
+        return NULL;
+    }
+    const size_t *dims = FCLIB_ALIGNCAST(const size_t, arr->value);
+    // The array is viewed as `outer` blocks of `len` rows of `inner` elements,
+    // the rows of every block are reduced into one
+    size_t inner = 1;
+    size_t outer = 1;
+    for (size_t i = 0; i < axis; i++) {
+        inner *= dims[i];
+    }
+    for (size_t i = axis + 1; i < arr->len; i++) {
+        outer *= dims[i];
+    }
+    const size_t len = dims[axis];
+    if (len == 0 && (op == FCLIB_LINALG_MIN || op == FCLIB_LINALG_MAX)) {
+        return NULL;
+    }
+    size_t *lengths = (size_t *)malloc(arr->len * sizeof(size_t));
+    if (lengths == NULL) {
+        return NULL;
+    }
+    memcpy(lengths, dims, arr->len * sizeof(size_t));
+    lengths[axis] = 1;
+    const size_t size = fclib_arr_type_size(type);
+    fclib_arr_t *result = fclib_arr_create(arr->len, size, lengths);
+    free(lengths);
+    if (result == NULL) {
+        return NULL;
+    }
+    const fclib_linalg_kernels_t *kernels = fclib_linalg_kernels(type);
+    const char *src = arr->value + arr->len * sizeof(size_t);
+    char *dest = fclib_arr_get_data(result);
+    if (inner * outer == 0) {
+        return result;
+    }
+    if (len == 0) {
+        // Every element of the result is the identity of the operation
+        kernels->fold(op, src, 0, dest);
+        for (size_t i = 1; i < inner * outer; i++) {
+            memcpy(dest + i * size, dest, size);
+        }
+        return result;
+    }
+    if (inner == 1) {
+        // Reducing along the stride-1 direction folds contiguous runs
+        for (size_t o = 0; o < outer; o++) {
+            kernels->fold(op, src + o * len * size, len, dest + o * size);
+        }
+        return result;
+    }
+    // Otherwise whole rows are combined element-wise, which is stride-1 in
+    // both the rows and the result
+    const size_t tile = FCLIB_LINALG_TILE / size;
+    for (size_t o = 0; o < outer; o++) {
+        const char *block = src + o * len * inner * size;
+        char *out = dest + o * inner * size;
+        for (size_t t = 0; t < inner; t += tile) {
+            const size_t count = inner - t < tile ? inner - t : tile;
+            memcpy(out + t * size, block + t * size, count * size);
+            for (size_t r = 1; r < len; r++) {
+                kernels->apply(op, out + t * size, out + t * size, 1,
+                    block + (r * inner + t) * size, 1, count);
+            }
+        }
+    }
+    return result;
+}
+
+// Computes the broadcast shape of `a` and `b` into `lengths`, which has room
+// for the larger dimensionality of both, and the strides of both operands
+// along it, which are 0 along stretched dimensions
+static bool fclib_linalg_broadcast_shape( //
+    const fclib_arr_t *a,                 //
+    const fclib_arr_t *b,                 //
+    const size_t rank,                    //
+    size_t *lengths,                      //
+    size_t *a_strides,                    //
+    size_t *b_strides                     //
+) {
+    const size_t *a_dims = FCLIB_ALIGNCAST(const size_t, a->value);
+    const size_t *b_dims = FCLIB_ALIGNCAST(const size_t, b->value);
+    size_t a_stride = 1;
+    size_t b_stride = 1;
+    for (size_t i = 0; i < rank; i++) {
+        // The shapes are aligned at their last dimension
+        const size_t a_len = i >= rank - a->len ? a_dims[i - (rank - a->len)]
+                                                : 1;
+        const size_t b_len = i >= rank - b->len ? b_dims[i - (rank - b->len)]
+                                                : 1;
+        if (a_len != b_len && a_len != 1 && b_len != 1) {
+            return false;
+        }
+        lengths[i] = a_len == 1 ? b_len : a_len;
+        a_strides[i] = a_len == 1 ? 0 : a_stride;
+        b_strides[i] = b_len == 1 ? 0 : b_stride;
+        a_stride *= a_len;
+        b_stride *= b_len;
+    }
+    return true;
+}
+
+// Applies the operation over the broadcast shape. The leading dimensions in
+// which both operands are either contiguous or stretched are merged into one
+// run, which is handed to the element-wise kernel in one call, the remaining
+// dimensions are walked with an odometer
+static void fclib_linalg_broadcast_run( //
+    char *dest,                         //
+    const char *a,                      //
+    const char *b,                      //
+    const fclib_arr_type_t type,        //
+    const fclib_linalg_op_t op,         //
+    const size_t rank,                  //
+    const size_t *lengths,              //
+    const size_t *a_strides,            //
+    const size_t *b_strides,            //
+    size_t *counter                     //
+) {
+    size_t total = 1;
+    for (size_t i = 0; i < rank; i++) {
+        total *= lengths[i];
+    }
+    if (total == 0) {
+        return;
+    }
+    size_t run = 1;
+    size_t merged = 0;
+    // Whether the operands are contiguous (1) or stretched (0) along the run,
+    // 2 while undecided
+    size_t a_step = 2;
+    size_t b_step = 2;
+    for (; merged < rank; merged++) {
+        if (lengths[merged] == 1) {
+            continue;
+        }
+        const size_t a_here = a_strides[merged] == 0 ? 0 : 1;
+        const size_t b_here = b_strides[merged] == 0 ? 0 : 1;
+        if (a_step == 2) {
+            a_step = a_here;
+            b_step = b_here;
+        }
+        if (a_here != a_step || b_here != b_step ||
+            (a_here == 1 && a_strides[merged] != run) ||
+            (b_here == 1 && b_strides[merged] != run)) {
+            break;
+        }
+        run *= lengths[merged];
+    }
+    if (a_step == 2) {
+        a_step = 1;
+        b_step = 1;
+    }
+    const fclib_linalg_kernels_t *kernels = fclib_linalg_kernels(type);
+    const size_t size = fclib_arr_type_size(type);
+    for (size_t i = merged; i < rank; i++) {
+        counter[i] = 0;
+    }
+    size_t a_offset = 0;
+    size_t b_offset = 0;
+    for (size_t done = 0; done < total; done += run) {
+        kernels->apply(op, dest + done * size, a + a_offset * size, a_step,
+            b + b_offset * size, b_step, run);
+        // Advance the odometer over the remaining dimensions
+        for (size_t i = merged; i < rank; i++) {
+            a_offset += a_strides[i];
+            b_offset += b_strides[i];
+            if (++counter[i] < lengths[i]) {
+                break;
+            }
+            a_offset -= a_strides[i] * lengths[i];
+            b_offset -= b_strides[i] * lengths[i];
+            counter[i] = 0;
+        }
+    }
+}
+
+FCLIB_API fclib_arr_t *fclib_linalg_broadcast( //
+    const fclib_arr_t *a,                      //
+    const fclib_arr_t *b,                      //
+    const fclib_arr_type_t type,               //
+    const fclib_linalg_op_t op                 //
+) {
+    const size_t rank = a->len > b->len ? a->len : b->len;
+    size_t *shape = (size_t *)malloc((4 * rank + 1) * sizeof(size_t));
+    if (shape == NULL) {
+        return NULL;
+    }
+    size_t *a_strides = shape + rank;
+    size_t *b_strides = a_strides + rank;
+    size_t *counter = b_strides + rank;
+    if (!fclib_linalg_broadcast_shape(a, b, rank, shape, a_strides,
+            b_strides)) {
+        free(shape);
+        return NULL;
+    }
+    fclib_arr_t *c = fclib_arr_create(rank, fclib_arr_type_size(type), shape);
+    if (c != NULL) {
+        fclib_linalg_broadcast_run(fclib_arr_get_data(c),
+            a->value + a->len * sizeof(size_t),
+            b->value + b->len * sizeof(size_t), type, op, rank, shape,
+            a_strides, b_strides, counter);
+    }
+    free(shape);
+    return c;
+}
+
+FCLIB_API bool fclib_linalg_broadcast_into( //
+    fclib_arr_t *c,                         //
+    const fclib_arr_t *a,                   //
+    const fclib_arr_t *b,                   //
+    const fclib_arr_type_t type,            //
+    const fclib_linalg_op_t op              //
+) {
+    const size_t rank = a->len > b->len ? a->len : b->len;
+    if (c->len != rank) {
+        return false;
+    }
+    size_t *shape = (size_t *)malloc((4 * rank + 1) * sizeof(size_t));
+    if (shape == NULL) {
+        return false;
+    }
+    size_t *a_strides = shape + rank;
+    size_t *b_strides = a_strides + rank;
+    size_t *counter = b_strides + rank;
+    if (!fclib_linalg_broadcast_shape(a, b, rank, shape, a_strides,
+            b_strides) ||
+        memcmp(shape, c->value, rank * sizeof(size_t)) != 0) {
+        free(shape);
+        return false;
+    }
+    fclib_linalg_broadcast_run(fclib_arr_get_data(c),
+        a->value + a->len * sizeof(size_t), b->value + b->len * sizeof(size_t),
+        type, op, rank, shape, a_strides, b_strides, counter);
+    free(shape);
+    return true;
+}
+
+#undef FCLIB_LINALG_APPLY
+#undef FCLIB_LINALG_FOLD
+#undef FCLIB_LINALG_KERNELS
+#undef FCLIB_LINALG_DIV_SIGNED
+#undef FCLIB_LINALG_DIV_UNSIGNED
+#undef FCLIB_LINALG_ALL_KERNELS
+#undef FCLIB_LINALG_TABLE
+
+#endif // endof FCLIB_IMPLEMENTATION
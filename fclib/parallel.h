@@ -0,0 +1,196 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#ifndef __WIN32__
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#endif
+
+/// @typedef `parallel_fn_t`
+/// @brief A loop body of `parallel_for`, which processes the items in the
+/// half-open range [`begin`, `end`). The body is called concurrently from
+/// different threads with disjoint ranges, so it must only write to data
+/// belonging to its own range.
+typedef void (*fclib_parallel_fn_t)( //
+    void *context,                   //
+    const size_t begin,              //
+    const size_t end                 //
+);
+
+/// @function `parallel_get_threads`
+/// @brief Returns the number of threads the parallel kernels of fclib use at
+/// most. Unless set explicitly this is the number of online CPUs
+///
+/// @return `size_t` The maximum number of threads, always at least 1
+FCLIB_API size_t fclib_parallel_get_threads(void);
+
+/// @function `parallel_set_threads`
+/// @brief Sets the number of threads the parallel kernels of fclib use at
+/// most. Setting it to 1 makes all kernels run on the calling thread only,
+/// setting it to 0 restores the default of one thread per online CPU
+///
+/// @param `threads` The maximum number of threads, 0 for the default
+FCLIB_API void fclib_parallel_set_threads(const size_t threads);
+
+/// @function `parallel_for`
+/// @brief Splits the items [0, `count`) into contiguous ranges of at least
+/// `grain` items and runs `body` on all of them, one range per thread. The
+/// calling thread processes the first range itself and the function returns
+/// once all ranges are done. If only one range results, or no thread could be
+/// started, `body` is simply called on the calling thread.
+///
+/// @param `count` The number of items to process
+/// @param `grain` The minimum number of items worth a thread of its own
+/// @param `body` The loop body to run on every range
+/// @param `context` The context passed through to every call of `body`
+FCLIB_API void fclib_parallel_for( //
+    const size_t count,            //
+    const size_t grain,            //
+    fclib_parallel_fn_t body,      //
+    void *context                  //
+);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_parallel_fn_t parallel_fn_t;
+
+FCLIB_API static inline size_t parallel_get_threads(void) {
+    return fclib_parallel_get_threads();
+}
+FCLIB_API static inline void parallel_set_threads(const size_t threads) {
+    fclib_parallel_set_threads(threads);
+}
+FCLIB_API static inline void parallel_for( //
+    const size_t count,                    //
+    const size_t grain,                    //
+    parallel_fn_t body,                    //
+    void *context                          //
+) {
+    fclib_parallel_for(count, grain, body, context);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+#ifndef __WIN32__
+// The explicitly set thread count, 0 if the default is used
+static atomic_size_t fclib_parallel_threads;
+
+typedef struct fclib_parallel_range_t {
+    fclib_parallel_fn_t body;
+    void *context;
+    size_t begin;
+    size_t end;
+} fclib_parallel_range_t;
+
+static void *fclib_parallel_worker(void *arg) {
+    fclib_parallel_range_t *range = (fclib_parallel_range_t *)arg;
+    range->body(range->context, range->begin, range->end);
+    return NULL;
+}
+#endif
+
+FCLIB_API size_t fclib_parallel_get_threads(void) {
+#ifdef __WIN32__
+    // Parallel kernels run on the calling thread on Windows
+    return 1;
+#else
+    const size_t threads = atomic_load(&fclib_parallel_threads);
+    if (threads != 0) {
+        return threads;
+    }
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+#endif
+}
+
+FCLIB_API void fclib_parallel_set_threads(const size_t threads) {
+#ifdef __WIN32__
+    (void)threads;
+#else
+    atomic_store(&fclib_parallel_threads, threads);
+#endif
+}
+
+FCLIB_API void fclib_parallel_for( //
+    const size_t count,            //
+    const size_t grain,            //
+    fclib_parallel_fn_t body,      //
+    void *context                  //
+) {
+    if (count == 0) {
+        return;
+    }
+    size_t ranges = fclib_parallel_get_threads();
+    const size_t most = count / (grain == 0 ? 1 : grain);
+    if (ranges > most) {
+        ranges = most;
+    }
+    if (ranges <= 1) {
+        body(context, 0, count);
+        return;
+    }
+#ifndef __WIN32__
+    fclib_parallel_range_t *range_list = (fclib_parallel_range_t *)malloc( //
+        ranges * sizeof(fclib_parallel_range_t));
+    pthread_t *threads = (pthread_t *)malloc(ranges * sizeof(pthread_t));
+    if (range_list == NULL || threads == NULL) {
+        free(range_list);
+        free(threads);
+        body(context, 0, count);
+        return;
+    }
+    // The first `count % ranges` ranges get one item more than the others
+    const size_t share = count / ranges;
+    const size_t extra = count % ranges;
+    size_t begin = 0;
+    for (size_t i = 0; i < ranges; i++) {
+        const size_t end = begin + share + (i < extra ? 1 : 0);
+        range_list[i].body = body;
+        range_list[i].context = context;
+        range_list[i].begin = begin;
+        range_list[i].end = end;
+        begin = end;
+    }
+    // Ranges whose thread could not be started are run by the calling thread
+    bool *started = (bool *)calloc(ranges, sizeof(bool));
+    for (size_t i = 1; i < ranges && started != NULL; i++) {
+        started[i] = pthread_create(&threads[i], NULL, fclib_parallel_worker,
+                         &range_list[i]) == 0;
+    }
+    for (size_t i = 0; i < ranges; i++) {
+        if (i == 0 || started == NULL || !started[i]) {
+            body(context, range_list[i].begin, range_list[i].end);
+        }
+    }
+    for (size_t i = 1; i < ranges && started != NULL; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    free(started);
+    free(threads);
+    free(range_list);
+#endif
+}
+
+#endif // endof FCLIB_IMPLEMENTATION
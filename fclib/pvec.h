@@ -0,0 +1,728 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+
+#ifdef FCLIB_MINIMAL
+#error "pvec.h builds on arr_get_data, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @typedef `pvec_node_t`
+/// @brief A reference counted node of the tree of a persistent vector, which
+/// holds either 32 child nodes or 32 elements
+typedef struct fclib_pvec_node_t fclib_pvec_node_t;
+
+/// @typedef `pvec_t`
+/// @brief A persistent vector of fixed-size elements. Every version of the
+/// vector is immutable, an update returns a new version which shares all but
+/// the O(log32 n) changed nodes with the old one. The elements live in the
+/// leaves of a 32-way radix-balanced tree, except for the last up to 32
+/// elements, which are kept in the separate `tail` leaf so that pushing and
+/// popping at the end mostly only touches the tail.
+///
+/// A transient vector, created with `pvec_transient`, is a version which is
+/// owned by a single user and mutated in place by the `pvec_*_mut` functions.
+/// Nodes shared with other versions are copied on their first write, every
+/// later write to them is done in place, which makes batches of updates much
+/// cheaper than one new version per update.
+typedef struct fclib_pvec_t {
+    size_t len;
+    size_t element_size;
+    // The index bits below the root node, 5 for every level of the tree
+    size_t shift;
+    // NULL as long as all elements fit into the tail
+    fclib_pvec_node_t *root;
+    // NULL if the vector is empty
+    fclib_pvec_node_t *tail;
+    bool transient;
+} fclib_pvec_t;
+
+/// @function `pvec_create`
+/// @brief Creates an empty persistent vector
+///
+/// @param `element_size` The number of bytes every element is taking up
+/// @return `pvec_t *` The empty vector, or NULL if the allocation failed
+FCLIB_API fclib_pvec_t *fclib_pvec_create(const size_t element_size);
+
+/// @function `pvec_from_arr`
+/// @brief Creates a persistent vector from all elements of the array, in the
+/// order in which they are stored. The leaves are filled with whole blocks of
+/// 32 elements at once
+///
+/// @param `arr` The array to copy the elements from
+/// @param `element_size` The size of each element in bytes
+/// @return `pvec_t *` The vector, or NULL if an allocation failed
+FCLIB_API fclib_pvec_t *fclib_pvec_from_arr( //
+    fclib_arr_t *arr,                        //
+    const size_t element_size                //
+);
+
+/// @function `pvec_to_arr`
+/// @brief Copies all elements of the vector into a new one-dimensional array
+///
+/// @param `vec` The vector to copy
+/// @return `arr_t *` The array, or NULL if the allocation failed
+FCLIB_API fclib_arr_t *fclib_pvec_to_arr(const fclib_pvec_t *vec);
+
+/// @function `pvec_get`
+/// @brief Returns a pointer to the element at the given index. The element
+/// lives as long as the version it is read from and must not be written to
+///
+/// @param `vec` The vector to read from
+/// @param `index` The index of the element
+/// @return `const void *` The element, or NULL if the index is out of bounds
+FCLIB_API const void *fclib_pvec_get( //
+    const fclib_pvec_t *vec,          //
+    const size_t index                //
+);
+
+/// @function `pvec_set`
+/// @brief Returns a new version of the vector, in which the element at the
+/// given index is replaced by the value. Only the path to the element is
+/// copied, everything else is shared with `vec`
+///
+/// @param `vec` The version to update, which stays unchanged
+/// @param `index` The index of the element to replace
+/// @param `value` The new value of the element
+/// @return `pvec_t *` The new version, or NULL if the index is out of bounds
+/// or an allocation failed
+FCLIB_API fclib_pvec_t *fclib_pvec_set( //
+    const fclib_pvec_t *vec,            //
+    const size_t index,                 //
+    const void *value                   //
+);
+
+/// @function `pvec_push`
+/// @brief Returns a new version of the vector with the value appended to it
+///
+/// @param `vec` The version to append to, which stays unchanged
+/// @param `value` The value to append
+/// @return `pvec_t *` The new version, or NULL if an allocation failed
+FCLIB_API fclib_pvec_t *fclib_pvec_push( //
+    const fclib_pvec_t *vec,             //
+    const void *value                    //
+);
+
+/// @function `pvec_pop`
+/// @brief Returns a new version of the vector without its last element
+///
+/// @param `vec` The version to remove the last element from, which stays
+/// unchanged
+/// @return `pvec_t *` The new version, or NULL if the vector is empty or an
+/// allocation failed
+FCLIB_API fclib_pvec_t *fclib_pvec_pop(const fclib_pvec_t *vec);
+
+/// @function `pvec_transient`
+/// @brief Starts a batch of in-place updates on a version of the vector. The
+/// returned transient vector shares all nodes with `vec` until they are
+/// written to through the `pvec_*_mut` functions
+///
+/// @param `vec` The version to start from, which stays unchanged
+/// @return `pvec_t *` The transient vector, or NULL if the allocation failed
+FCLIB_API fclib_pvec_t *fclib_pvec_transient(const fclib_pvec_t *vec);
+
+/// @function `pvec_persistent`
+/// @brief Ends the batch of in-place updates on the transient vector, which
+/// turns it into a regular immutable version
+///
+/// @param `vec` The transient vector
+/// @return `pvec_t *` The same vector, which may no longer be mutated
+FCLIB_API fclib_pvec_t *fclib_pvec_persistent(fclib_pvec_t *vec);
+
+/// @function `pvec_set_mut`
+/// @brief Replaces the element at the given index of the transient vector
+///
+/// @param `vec` The transient vector to update
+/// @param `index` The index of the element to replace
+/// @param `value` The new value of the element
+/// @return `bool` Whether the element was replaced, false if the vector is
+/// not transient, the index is out of bounds or an allocation failed
+FCLIB_API bool fclib_pvec_set_mut( //
+    fclib_pvec_t *vec,             //
+    const size_t index,            //
+    const void *value              //
+);
+
+/// @function `pvec_push_mut`
+/// @brief Appends the value to the transient vector
+///
+/// @param `vec` The transient vector to append to
+/// @param `value` The value to append
+/// @return `bool` Whether the value was appended, false if the vector is not
+/// transient or an allocation failed
+FCLIB_API bool fclib_pvec_push_mut(fclib_pvec_t *vec, const void *value);
+
+/// @function `pvec_pop_mut`
+/// @brief Removes the last element of the transient vector
+///
+/// @param `vec` The transient vector to remove the last element from
+/// @return `bool` Whether the element was removed, false if the vector is not
+/// transient, is empty or an allocation failed
+FCLIB_API bool fclib_pvec_pop_mut(fclib_pvec_t *vec);
+
+/// @function `pvec_free`
+/// @brief Frees the version of the vector, together with all nodes which are
+/// not shared with any other version
+///
+/// @param `vec` The version to free
+FCLIB_API void fclib_pvec_free(fclib_pvec_t *vec);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_pvec_node_t pvec_node_t;
+typedef fclib_pvec_t pvec_t;
+
+FCLIB_API static inline pvec_t *pvec_create(const size_t element_size) {
+    return fclib_pvec_create(element_size);
+}
+FCLIB_API static inline pvec_t *pvec_from_arr( //
+    arr_t *arr,                                //
+    const size_t element_size                  //
+) {
+    return fclib_pvec_from_arr(arr, element_size);
+}
+FCLIB_API static inline arr_t *pvec_to_arr(const pvec_t *vec) {
+    return fclib_pvec_to_arr(vec);
+}
+FCLIB_API static inline const void *pvec_get( //
+    const pvec_t *vec,                        //
+    const size_t index                        //
+) {
+    return fclib_pvec_get(vec, index);
+}
+FCLIB_API static inline pvec_t *pvec_set( //
+    const pvec_t *vec,                    //
+    const size_t index,                   //
+    const void *value                     //
+) {
+    return fclib_pvec_set(vec, index, value);
+}
+FCLIB_API static inline pvec_t *pvec_push( //
+    const pvec_t *vec,                     //
+    const void *value                      //
+) {
+    return fclib_pvec_push(vec, value);
+}
+FCLIB_API static inline pvec_t *pvec_pop(const pvec_t *vec) {
+    return fclib_pvec_pop(vec);
+}
+FCLIB_API static inline pvec_t *pvec_transient(const pvec_t *vec) {
+    return fclib_pvec_transient(vec);
+}
+FCLIB_API static inline pvec_t *pvec_persistent(pvec_t *vec) {
+    return fclib_pvec_persistent(vec);
+}
+FCLIB_API static inline bool pvec_set_mut( //
+    pvec_t *vec,                           //
+    const size_t index,                    //
+    const void *value                      //
+) {
+    return fclib_pvec_set_mut(vec, index, value);
+}
+FCLIB_API static inline bool pvec_push_mut(pvec_t *vec, const void *value) {
+    return fclib_pvec_push_mut(vec, value);
+}
+FCLIB_API static inline bool pvec_pop_mut(pvec_t *vec) {
+    return fclib_pvec_pop_mut(vec);
+}
+FCLIB_API static inline void pvec_free(pvec_t *vec) {
+    fclib_pvec_free(vec);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+#define FCLIB_PVEC_BITS 5
+#define FCLIB_PVEC_WIDTH ((size_t)1 << FCLIB_PVEC_BITS)
+#define FCLIB_PVEC_MASK (FCLIB_PVEC_WIDTH - 1)
+
+// The 32 slots of a node follow its header, which is padded to the alignment
+// of `max_align_t` so that elements of any type are aligned in the leaves
+struct fclib_pvec_node_t {
+    atomic_size_t refs;
+};
+
+static size_t fclib_pvec_node_header(void) {
+    const size_t align = _Alignof(max_align_t);
+    return (sizeof(fclib_pvec_node_t) + align - 1) / align * align;
+}
+
+static fclib_pvec_node_t **fclib_pvec_children(fclib_pvec_node_t *node) {
+    return (fclib_pvec_node_t **)(void *)((char *)node +
+        fclib_pvec_node_header());
+}
+
+static char *fclib_pvec_elements(fclib_pvec_node_t *node) {
+    return (char *)node + fclib_pvec_node_header();
+}
+
+// Allocates a leaf if `level` is 0 and an internal node without any children
+// otherwise, the elements of a new leaf are uninitialized
+static fclib_pvec_node_t *fclib_pvec_node_alloc( //
+    const size_t level,                          //
+    const size_t element_size                    //
+) {
+    const size_t slot_size = level == 0 ? element_size : sizeof(void *);
+    fclib_pvec_node_t *node = (fclib_pvec_node_t *)malloc( //
+        fclib_pvec_node_header() + FCLIB_PVEC_WIDTH * slot_size);
+    if (node == NULL) {
+        return NULL;
+    }
+    atomic_init(&node->refs, 1);
+    if (level > 0) {
+        fclib_pvec_node_t **children = fclib_pvec_children(node);
+        for (size_t i = 0; i < FCLIB_PVEC_WIDTH; i++) {
+            children[i] = NULL;
+        }
+    }
+    return node;
+}
+
+static void fclib_pvec_node_retain(fclib_pvec_node_t *node) {
+    if (node != NULL) {
+        atomic_fetch_add_explicit(&node->refs, 1, memory_order_relaxed);
+    }
+}
+
+static void fclib_pvec_node_release( //
+    fclib_pvec_node_t *node,         //
+    const size_t level               //
+) {
+    if (node == NULL ||
+        atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    if (level > 0) {
+        fclib_pvec_node_t **children = fclib_pvec_children(node);
+        for (size_t i = 0; i < FCLIB_PVEC_WIDTH; i++) {
+            fclib_pvec_node_release(children[i], level - FCLIB_PVEC_BITS);
+        }
+    }
+    free(node);
+}
+
+// Makes the node in `slot` owned by its parent alone, so it may be written to
+// in place. A shared node is replaced by a copy, which shares its children
+static bool fclib_pvec_node_unique( //
+    fclib_pvec_node_t **slot,       //
+    const size_t level,             //
+    const size_t element_size       //
+) {
+    fclib_pvec_node_t *node = *slot;
+    if (atomic_load_explicit(&node->refs, memory_order_acquire) == 1) {
+        return true;
+    }
+    fclib_pvec_node_t *copy = fclib_pvec_node_alloc(level, element_size);
+    if (copy == NULL) {
+        return false;
+    }
+    const size_t slot_size = level == 0 ? element_size : sizeof(void *);
+    memcpy(fclib_pvec_elements(copy), fclib_pvec_elements(node),
+        FCLIB_PVEC_WIDTH * slot_size);
+    if (level > 0) {
+        fclib_pvec_node_t **children = fclib_pvec_children(copy);
+        for (size_t i = 0; i < FCLIB_PVEC_WIDTH; i++) {
+            fclib_pvec_node_retain(children[i]);
+        }
+    }
+    *slot = copy;
+    fclib_pvec_node_release(node, level);
+    return true;
+}
+
+// The index of the first element in the tail
+static size_t fclib_pvec_tail_offset(const size_t len) {
+    return len < FCLIB_PVEC_WIDTH ? 0 : (len - 1) & ~FCLIB_PVEC_MASK;
+}
+
+// Returns the leaf which holds the element at the index
+static fclib_pvec_node_t *fclib_pvec_leaf_for( //
+    const fclib_pvec_t *vec,                   //
+    const size_t index                         //
+) {
+    if (index >= fclib_pvec_tail_offset(vec->len)) {
+        return vec->tail;
+    }
+    fclib_pvec_node_t *node = vec->root;
+    for (size_t level = vec->shift; level > 0; level -= FCLIB_PVEC_BITS) {
+        node = fclib_pvec_children(node)[(index >> level) & FCLIB_PVEC_MASK];
+    }
+    return node;
+}
+
+// Builds the chain of single-child nodes from `level` down to the leaf
+static fclib_pvec_node_t *fclib_pvec_new_path( //
+    const size_t level,                        //
+    fclib_pvec_node_t *leaf                    //
+) {
+    if (level == 0) {
+        return leaf;
+    }
+    fclib_pvec_node_t *node = fclib_pvec_node_alloc(level, 0);
+    if (node == NULL) {
+        return NULL;
+    }
+    fclib_pvec_node_t *child = fclib_pvec_new_path( //
+        level - FCLIB_PVEC_BITS, leaf);
+    if (child == NULL) {
+        free(node);
+        return NULL;
+    }
+    fclib_pvec_children(node)[0] = child;
+    return node;
+}
+
+// Hangs the full leaf, whose last element has the given index, into the tree
+// below the node in `slot`
+static bool fclib_pvec_push_leaf( //
+    fclib_pvec_node_t **slot,     //
+    const size_t level,           //
+    const size_t index,           //
+    fclib_pvec_node_t *leaf,      //
+    const size_t element_size     //
+) {
+    if (*slot == NULL) {
+        *slot = fclib_pvec_node_alloc(level, element_size);
+        if (*slot == NULL) {
+            return false;
+        }
+    } else if (!fclib_pvec_node_unique(slot, level, element_size)) {
+        return false;
+    }
+    fclib_pvec_node_t **children = fclib_pvec_children(*slot);
+    const size_t sub = (index >> level) & FCLIB_PVEC_MASK;
+    if (level == FCLIB_PVEC_BITS) {
+        children[sub] = leaf;
+        return true;
+    }
+    if (children[sub] == NULL) {
+        children[sub] = fclib_pvec_new_path(level - FCLIB_PVEC_BITS, leaf);
+        return children[sub] != NULL;
+    }
+    return fclib_pvec_push_leaf( //
+        &children[sub], level - FCLIB_PVEC_BITS, index, leaf, element_size);
+}
+
+// Moves the full tail into the tree and replaces it with an empty leaf
+static bool fclib_pvec_flush_tail(fclib_pvec_t *vec) {
+    fclib_pvec_node_t *tail = fclib_pvec_node_alloc(0, vec->element_size);
+    if (tail == NULL) {
+        return false;
+    }
+    if ((vec->len >> FCLIB_PVEC_BITS) > ((size_t)1 << vec->shift)) {
+        // The tree is full, so it becomes the first child of a new root
+        fclib_pvec_node_t *root = fclib_pvec_node_alloc( //
+            vec->shift + FCLIB_PVEC_BITS, 0);
+        fclib_pvec_node_t *path = NULL;
+        if (root != NULL) {
+            path = fclib_pvec_new_path(vec->shift, vec->tail);
+        }
+        if (path == NULL) {
+            free(root);
+            free(tail);
+            return false;
+        }
+        fclib_pvec_children(root)[0] = vec->root;
+        fclib_pvec_children(root)[1] = path;
+        vec->root = root;
+        vec->shift += FCLIB_PVEC_BITS;
+    } else if (!fclib_pvec_push_leaf(&vec->root, vec->shift, vec->len - 1,
+                   vec->tail, vec->element_size)) {
+        free(tail);
+        return false;
+    }
+    vec->tail = tail;
+    return true;
+}
+
+// Removes the last leaf, which holds the element at the index, from the tree
+// below the node in `slot`. Nodes which become empty are removed as well
+static bool fclib_pvec_pop_leaf( //
+    fclib_pvec_node_t **slot,    //
+    const size_t level,          //
+    const size_t index,          //
+    const size_t element_size    //
+) {
+    if (!fclib_pvec_node_unique(slot, level, element_size)) {
+        return false;
+    }
+    fclib_pvec_node_t **children = fclib_pvec_children(*slot);
+    const size_t sub = (index >> level) & FCLIB_PVEC_MASK;
+    if (level > FCLIB_PVEC_BITS) {
+        if (!fclib_pvec_pop_leaf( //
+                &children[sub], level - FCLIB_PVEC_BITS, index, element_size)) {
+            return false;
+        }
+    } else {
+        fclib_pvec_node_release(children[sub], 0);
+        children[sub] = NULL;
+    }
+    if (sub == 0 && children[0] == NULL) {
+        fclib_pvec_node_release(*slot, level);
+        *slot = NULL;
+    }
+    return true;
+}
+
+FCLIB_API fclib_pvec_t *fclib_pvec_create(const size_t element_size) {
+    fclib_pvec_t *vec = (fclib_pvec_t *)malloc(sizeof(fclib_pvec_t));
+    if (vec == NULL) {
+        return NULL;
+    }
+    vec->len = 0;
+    vec->element_size = element_size;
+    vec->shift = FCLIB_PVEC_BITS;
+    vec->root = NULL;
+    vec->tail = NULL;
+    vec->transient = false;
+    return vec;
+}
+
+FCLIB_API fclib_pvec_t *fclib_pvec_from_arr( //
+    fclib_arr_t *arr,                        //
+    const size_t element_size                //
+) {
+    fclib_pvec_t *vec = fclib_pvec_create(element_size);
+    if (vec == NULL) {
+        return NULL;
+    }
+    const size_t len = fclib_arr_get_len(arr);
+    const char *data = fclib_arr_get_data(arr);
+    while (vec->len < len) {
+        // The tail is empty in every iteration, as only the last block of
+        // elements may not fill it completely
+        if (vec->tail == NULL) {
+            vec->tail = fclib_pvec_node_alloc(0, element_size);
+            if (vec->tail == NULL) {
+                fclib_pvec_free(vec);
+                return NULL;
+            }
+        } else if (!fclib_pvec_flush_tail(vec)) {
+            fclib_pvec_free(vec);
+            return NULL;
+        }
+        size_t block = len - vec->len;
+        if (block > FCLIB_PVEC_WIDTH) {
+            block = FCLIB_PVEC_WIDTH;
+        }
+        memcpy(fclib_pvec_elements(vec->tail), data + vec->len * element_size,
+            block * element_size);
+        vec->len += block;
+    }
+    return vec;
+}
+
+FCLIB_API fclib_arr_t *fclib_pvec_to_arr(const fclib_pvec_t *vec) {
+    const size_t element_size = vec->element_size;
+    fclib_arr_t *arr = fclib_arr_create(1, element_size, &vec->len);
+    if (arr == NULL) {
+        return NULL;
+    }
+    char *data = fclib_arr_get_data(arr);
+    const size_t tail_offset = fclib_pvec_tail_offset(vec->len);
+    for (size_t i = 0; i < tail_offset; i += FCLIB_PVEC_WIDTH) {
+        memcpy(data + i * element_size,
+            fclib_pvec_elements(fclib_pvec_leaf_for(vec, i)),
+            FCLIB_PVEC_WIDTH * element_size);
+    }
+    if (vec->len > tail_offset) {
+        memcpy(data + tail_offset * element_size,
+            fclib_pvec_elements(vec->tail),
+            (vec->len - tail_offset) * element_size);
+    }
+    return arr;
+}
+
+FCLIB_API const void *fclib_pvec_get( //
+    const fclib_pvec_t *vec,          //
+    const size_t index                //
+) {
+    if (index >= vec->len) {
+        return NULL;
+    }
+    return fclib_pvec_elements(fclib_pvec_leaf_for(vec, index)) +
+        (index & FCLIB_PVEC_MASK) * vec->element_size;
+}
+
+FCLIB_API fclib_pvec_t *fclib_pvec_set( //
+    const fclib_pvec_t *vec,            //
+    const size_t index,                 //
+    const void *value                   //
+) {
+    fclib_pvec_t *result = fclib_pvec_transient(vec);
+    if (result == NULL) {
+        return NULL;
+    }
+    if (!fclib_pvec_set_mut(result, index, value)) {
+        fclib_pvec_free(result);
+        return NULL;
+    }
+    return fclib_pvec_persistent(result);
+}
+
+FCLIB_API fclib_pvec_t *fclib_pvec_push( //
+    const fclib_pvec_t *vec,             //
+    const void *value                    //
+) {
+    fclib_pvec_t *result = fclib_pvec_transient(vec);
+    if (result == NULL) {
+        return NULL;
+    }
+    if (!fclib_pvec_push_mut(result, value)) {
+        fclib_pvec_free(result);
+        return NULL;
+    }
+    return fclib_pvec_persistent(result);
+}
+
+FCLIB_API fclib_pvec_t *fclib_pvec_pop(const fclib_pvec_t *vec) {
+    fclib_pvec_t *result = fclib_pvec_transient(vec);
+    if (result == NULL) {
+        return NULL;
+    }
+    if (!fclib_pvec_pop_mut(result)) {
+        fclib_pvec_free(result);
+        return NULL;
+    }
+    return fclib_pvec_persistent(result);
+}
+
+FCLIB_API fclib_pvec_t *fclib_pvec_transient(const fclib_pvec_t *vec) {
+    fclib_pvec_t *result = (fclib_pvec_t *)malloc(sizeof(fclib_pvec_t));
+    if (result == NULL) {
+        return NULL;
+    }
+    *result = *vec;
+    result->transient = true;
+    fclib_pvec_node_retain(result->root);
+    fclib_pvec_node_retain(result->tail);
+    return result;
+}
+
+FCLIB_API fclib_pvec_t *fclib_pvec_persistent(fclib_pvec_t *vec) {
+    vec->transient = false;
+    return vec;
+}
+
+FCLIB_API bool fclib_pvec_set_mut( //
+    fclib_pvec_t *vec,             //
+    const size_t index,            //
+    const void *value              //
+) {
+    if (!vec->transient || index >= vec->len) {
+        return false;
+    }
+    fclib_pvec_node_t **slot = &vec->tail;
+    if (index < fclib_pvec_tail_offset(vec->len)) {
+        slot = &vec->root;
+        for (size_t level = vec->shift; level > 0; level -= FCLIB_PVEC_BITS) {
+            if (!fclib_pvec_node_unique(slot, level, vec->element_size)) {
+                return false;
+            }
+            slot = &fclib_pvec_children(*slot)[(index >> level) &
+                FCLIB_PVEC_MASK];
+        }
+    }
+    if (!fclib_pvec_node_unique(slot, 0, vec->element_size)) {
+        return false;
+    }
+    memcpy(fclib_pvec_elements(*slot) +
+            (index & FCLIB_PVEC_MASK) * vec->element_size,
+        value, vec->element_size);
+    return true;
+}
+
+FCLIB_API bool fclib_pvec_push_mut(fclib_pvec_t *vec, const void *value) {
+    if (!vec->transient) {
+        return false;
+    }
+    const size_t tail_len = vec->len - fclib_pvec_tail_offset(vec->len);
+    if (vec->tail == NULL) {
+        vec->tail = fclib_pvec_node_alloc(0, vec->element_size);
+        if (vec->tail == NULL) {
+            return false;
+        }
+    } else if (tail_len == FCLIB_PVEC_WIDTH) {
+        if (!fclib_pvec_flush_tail(vec)) {
+            return false;
+        }
+    } else if (!fclib_pvec_node_unique(&vec->tail, 0, vec->element_size)) {
+        return false;
+    }
+    memcpy(fclib_pvec_elements(vec->tail) +
+            (vec->len & FCLIB_PVEC_MASK) * vec->element_size,
+        value, vec->element_size);
+    vec->len++;
+    return true;
+}
+
+FCLIB_API bool fclib_pvec_pop_mut(fclib_pvec_t *vec) {
+    if (!vec->transient || vec->len == 0) {
+        return false;
+    }
+    if (vec->len == 1) {
+        fclib_pvec_node_release(vec->tail, 0);
+        vec->tail = NULL;
+        vec->len = 0;
+        return true;
+    }
+    // Dropping an element of the tail only needs the length to shrink, the
+    // element is never read again and overwritten by the next push
+    if (vec->len - fclib_pvec_tail_offset(vec->len) > 1) {
+        vec->len--;
+        return true;
+    }
+    // The tail becomes empty, so the last leaf of the tree becomes the tail
+    fclib_pvec_node_t *leaf = fclib_pvec_leaf_for(vec, vec->len - 2);
+    fclib_pvec_node_retain(leaf);
+    if (!fclib_pvec_pop_leaf( //
+            &vec->root, vec->shift, vec->len - 2, vec->element_size)) {
+        fclib_pvec_node_release(leaf, 0);
+        return false;
+    }
+    fclib_pvec_node_release(vec->tail, 0);
+    vec->tail = leaf;
+    vec->len--;
+    // A root with a single child is replaced by that child
+    if (vec->root != NULL && vec->shift > FCLIB_PVEC_BITS &&
+        fclib_pvec_children(vec->root)[1] == NULL) {
+        fclib_pvec_node_t *child = fclib_pvec_children(vec->root)[0];
+        fclib_pvec_node_retain(child);
+        fclib_pvec_node_release(vec->root, vec->shift);
+        vec->root = child;
+        vec->shift -= FCLIB_PVEC_BITS;
+    }
+    return true;
+}
+
+FCLIB_API void fclib_pvec_free(fclib_pvec_t *vec) {
+    fclib_pvec_node_release(vec->root, vec->shift);
+    fclib_pvec_node_release(vec->tail, 0);
+    free(vec);
+}
+
+#undef FCLIB_PVEC_BITS
+#undef FCLIB_PVEC_WIDTH
+#undef FCLIB_PVEC_MASK
+
+#endif // endof FCLIB_IMPLEMENTATION
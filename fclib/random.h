@@ -0,0 +1,853 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "cpu.h"
+#include "parallel.h"
+
+#ifdef FCLIB_MINIMAL
+#error "random.h builds on arr_type_t, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @typedef `random_t`
+/// @brief A counter-based random number generator (Philox4x32-10). Every
+/// 128-bit block of random bits is a pure function of the key, the stream and
+/// the block counter, so jumping ahead is a simple addition and any part of
+/// the sequence can be generated independently of the others. The generator
+/// only advances `counter`. Different streams of the same key never overlap,
+/// which gives every thread or task its own sequence. The float fills call
+/// into the math library, so programs using this header need to link with
+/// `-lm`.
+typedef struct fclib_random_t {
+    uint32_t key[2];
+    uint64_t stream;
+    uint64_t counter;
+} fclib_random_t;
+
+/// @function `random_seed`
+/// @brief Initializes the generator with the seed and the stream, starting at
+/// the first block of the stream
+///
+/// @param `rng` The generator to initialize
+/// @param `seed` The seed which becomes the key of the generator
+/// @param `stream` The stream of the sequence, e.g. the index of a thread
+FCLIB_API void fclib_random_seed( //
+    fclib_random_t *rng,          //
+    const uint64_t seed,          //
+    const uint64_t stream         //
+);
+
+/// @function `random_skip`
+/// @brief Jumps ahead in the sequence of the generator in O(1), as if
+/// `blocks` 128-bit blocks had been generated
+///
+/// @param `rng` The generator to advance
+/// @param `blocks` The number of blocks to skip
+FCLIB_API void fclib_random_skip(fclib_random_t *rng, const uint64_t blocks);
+
+/// @function `random_u64`
+/// @brief Returns 64 uniformly distributed random bits, every call consumes
+/// one block
+///
+/// @param `rng` The generator to draw from
+/// @return `uint64_t` The random bits
+FCLIB_API uint64_t fclib_random_u64(fclib_random_t *rng);
+
+/// @function `random_below`
+/// @brief Returns a uniformly distributed random integer in [0, `bound`)
+/// without any bias, by rejecting the rare draws which would cause one
+///
+/// @param `rng` The generator to draw from
+/// @param `bound` The exclusive upper bound, must not be 0
+/// @return `uint64_t` The random integer
+FCLIB_API uint64_t fclib_random_below(  //
+    fclib_random_t *rng,                //
+    const uint64_t bound                //
+);
+
+/// @function `random_f64`
+/// @brief Returns a uniformly distributed random double in [0, 1)
+///
+/// @param `rng` The generator to draw from
+/// @return `double` The random double
+FCLIB_API double fclib_random_f64(fclib_random_t *rng);
+
+/// @function `random_fill_int`
+/// @brief Fills all elements of the integer array with uniformly distributed
+/// values in [`low`, `high`], which must be representable in its type. Every
+/// element is derived from 64 random bits, which keeps the bias of the range
+/// reduction below 2^-32 for all 32-bit ranges.
+///
+/// The blocks are generated with the AVX-512 or AVX2 units of the CPU when
+/// available, and large arrays are split across `parallel_get_threads`
+/// threads. Element i always comes from the same block, so the result only
+/// depends on the state of the generator, never on the thread count. The
+/// generator is advanced past all consumed blocks.
+///
+/// @param `rng` The generator to draw from
+/// @param `arr` The array to fill
+/// @param `type` The element type of the array, one of the integer types
+/// @param `low` The smallest value
+/// @param `high` The largest value
+/// @return `bool` Whether the array was filled, false if the type is not an
+/// integer type or `low` is greater than `high`
+FCLIB_API bool fclib_random_fill_int( //
+    fclib_random_t *rng,              //
+    fclib_arr_t *arr,                 //
+    const fclib_arr_type_t type,      //
+    const int64_t low,                //
+    const int64_t high                //
+);
+
+/// @function `random_fill_float`
+/// @brief Fills all elements of the float array with uniformly distributed
+/// values in [`low`, `high`), see `random_fill_int`. `F32` elements are
+/// derived from 32 random bits with a resolution of 2^-24, `F64` elements
+/// from 64 random bits with a resolution of 2^-53.
+///
+/// @param `rng` The generator to draw from
+/// @param `arr` The array to fill
+/// @param `type` The element type of the array, `F32` or `F64`
+/// @param `low` The smallest value
+/// @param `high` The exclusive upper bound
+/// @return `bool` Whether the array was filled, false if the type is not
+/// supported
+FCLIB_API bool fclib_random_fill_float( //
+    fclib_random_t *rng,                //
+    fclib_arr_t *arr,                   //
+    const fclib_arr_type_t type,        //
+    const double low,                   //
+    const double high                   //
+);
+
+/// @function `random_fill_normal`
+/// @brief Fills all elements of the float array with normally distributed
+/// values, using the Box-Muller transform on pairs of uniform values, see
+/// `random_fill_int`
+///
+/// @param `rng` The generator to draw from
+/// @param `arr` The array to fill
+/// @param `type` The element type of the array, `F32` or `F64`
+/// @param `mean` The mean of the distribution
+/// @param `stddev` The standard deviation of the distribution
+/// @return `bool` Whether the array was filled, false if the type is not
+/// supported
+FCLIB_API bool fclib_random_fill_normal( //
+    fclib_random_t *rng,                 //
+    fclib_arr_t *arr,                    //
+    const fclib_arr_type_t type,         //
+    const double mean,                   //
+    const double stddev                  //
+);
+
+/// @function `random_shuffle`
+/// @brief Shuffles all elements of the array in place with the Fisher-Yates
+/// algorithm, so every permutation is equally likely
+///
+/// @param `rng` The generator to draw from
+/// @param `arr` The array to shuffle
+/// @param `element_size` The size of each element in bytes
+FCLIB_API void fclib_random_shuffle( //
+    fclib_random_t *rng,             //
+    fclib_arr_t *arr,                //
+    const size_t element_size        //
+);
+
+/// @function `random_sample`
+/// @brief Draws `count` distinct elements of the array uniformly at random and
+/// returns them in random order. The indices are chosen with Floyd's
+/// algorithm, which takes O(`count`) time and memory independent of the size
+/// of the array
+///
+/// @param `rng` The generator to draw from
+/// @param `arr` The array to draw from
+/// @param `element_size` The size of each element in bytes
+/// @param `count` The number of elements to draw
+/// @return `arr_t *` The one-dimensional array of the drawn elements, or NULL
+/// if the array has fewer than `count` elements or an allocation failed
+FCLIB_API fclib_arr_t *fclib_random_sample( //
+    fclib_random_t *rng,                    //
+    fclib_arr_t *arr,                       //
+    const size_t element_size,              //
+    const size_t count                      //
+);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_random_t random_t;
+
+FCLIB_API static inline void random_seed( //
+    random_t *rng,                        //
+    const uint64_t seed,                  //
+    const uint64_t stream                 //
+) {
+    fclib_random_seed(rng, seed, stream);
+}
+FCLIB_API static inline void random_skip(random_t *rng, const uint64_t blocks) {
+    fclib_random_skip(rng, blocks);
+}
+FCLIB_API static inline uint64_t random_u64(random_t *rng) {
+    return fclib_random_u64(rng);
+}
+FCLIB_API static inline uint64_t random_below( //
+    random_t *rng,                             //
+    const uint64_t bound                       //
+) {
+    return fclib_random_below(rng, bound);
+}
+FCLIB_API static inline double random_f64(random_t *rng) {
+    return fclib_random_f64(rng);
+}
+FCLIB_API static inline bool random_fill_int( //
+    random_t *rng,                            //
+    arr_t *arr,                               //
+    const arr_type_t type,                    //
+    const int64_t low,                        //
+    const int64_t high                        //
+) {
+    return fclib_random_fill_int(rng, arr, type, low, high);
+}
+FCLIB_API static inline bool random_fill_float( //
+    random_t *rng,                              //
+    arr_t *arr,                                 //
+    const arr_type_t type,                      //
+    const double low,                           //
+    const double high                           //
+) {
+    return fclib_random_fill_float(rng, arr, type, low, high);
+}
+FCLIB_API static inline bool random_fill_normal( //
+    random_t *rng,                               //
+    arr_t *arr,                                  //
+    const arr_type_t type,                       //
+    const double mean,                           //
+    const double stddev                          //
+) {
+    return fclib_random_fill_normal(rng, arr, type, mean, stddev);
+}
+FCLIB_API static inline void random_shuffle( //
+    random_t *rng,                           //
+    arr_t *arr,                              //
+    const size_t element_size                //
+) {
+    fclib_random_shuffle(rng, arr, element_size);
+}
+FCLIB_API static inline arr_t *random_sample( //
+    random_t *rng,                            //
+    arr_t *arr,                               //
+    const size_t element_size,                //
+    const size_t count                        //
+) {
+    return fclib_random_sample(rng, arr, element_size, count);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+// The multipliers and key increments of Philox4x32
+#define FCLIB_RANDOM_M0 0xD2511F53u
+#define FCLIB_RANDOM_M1 0xCD9E8D57u
+#define FCLIB_RANDOM_W0 0x9E3779B9u
+#define FCLIB_RANDOM_W1 0xBB67AE85u
+#define FCLIB_RANDOM_ROUNDS 10
+// The number of blocks generated into the stack buffer at once, which is also
+// the unit of work when a fill is split across threads
+#define FCLIB_RANDOM_CHUNK 256
+
+// Generates the block at `counter` of the stream of the generator
+static void fclib_random_block( //
+    const fclib_random_t *rng,  //
+    const uint64_t counter,     //
+    uint32_t *out               //
+) {
+    uint32_t c0 = (uint32_t)counter;
+    uint32_t c1 = (uint32_t)(counter >> 32);
+    uint32_t c2 = (uint32_t)rng->stream;
+    uint32_t c3 = (uint32_t)(rng->stream >> 32);
+    uint32_t k0 = rng->key[0];
+    uint32_t k1 = rng->key[1];
+    for (int round = 0; round < FCLIB_RANDOM_ROUNDS; round++) {
+        const uint64_t p0 = (uint64_t)FCLIB_RANDOM_M0 * c0;
+        const uint64_t p1 = (uint64_t)FCLIB_RANDOM_M1 * c2;
+        c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        k0 += FCLIB_RANDOM_W0;
+        k1 += FCLIB_RANDOM_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+#if FCLIB_X86_SIMD
+// The SIMD generators run one block per 64-bit lane, with every 32-bit word
+// of the counter in the low half of the lane, so the 32 x 32 -> 64 bit
+// multiplications of a round map to single `mul_epu32` instructions. The
+// four word vectors are then interleaved into the block order in memory.
+
+FCLIB_TARGET("avx2")
+static size_t fclib_random_blocks_avx2( //
+    const fclib_random_t *rng,          //
+    const uint64_t counter,             //
+    uint32_t *out,                      //
+    const size_t blocks                 //
+) {
+    const __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+    const __m256i m0 = _mm256_set1_epi64x(FCLIB_RANDOM_M0);
+    const __m256i m1 = _mm256_set1_epi64x(FCLIB_RANDOM_M1);
+    const __m256i stream_low = _mm256_set1_epi64x( //
+        (long long)(rng->stream & 0xFFFFFFFF));
+    const __m256i stream_high = _mm256_set1_epi64x( //
+        (long long)(rng->stream >> 32));
+    size_t done = 0;
+    for (; done + 4 <= blocks; done += 4) {
+        const __m256i ctr = _mm256_add_epi64( //
+            _mm256_set1_epi64x((long long)(counter + done)), lanes);
+        __m256i c0 = _mm256_and_si256(ctr, mask);
+        __m256i c1 = _mm256_srli_epi64(ctr, 32);
+        __m256i c2 = stream_low;
+        __m256i c3 = stream_high;
+        uint32_t k0 = rng->key[0];
+        uint32_t k1 = rng->key[1];
+        for (int round = 0; round < FCLIB_RANDOM_ROUNDS; round++) {
+            const __m256i p0 = _mm256_mul_epu32(c0, m0);
+            const __m256i p1 = _mm256_mul_epu32(c2, m1);
+            const __m256i c0_high = _mm256_srli_epi64(p1, 32);
+            c0 = _mm256_xor_si256(
+                _mm256_xor_si256(c0_high, c1), _mm256_set1_epi64x(k0));
+            const __m256i c2_high = _mm256_srli_epi64(p0, 32);
+            c2 = _mm256_xor_si256(
+                _mm256_xor_si256(c2_high, c3), _mm256_set1_epi64x(k1));
+            c1 = _mm256_and_si256(p1, mask);
+            c3 = _mm256_and_si256(p0, mask);
+            k0 += FCLIB_RANDOM_W0;
+            k1 += FCLIB_RANDOM_W1;
+        }
+        const __m256i w01 = _mm256_or_si256(c0, _mm256_slli_epi64(c1, 32));
+        const __m256i w23 = _mm256_or_si256(c2, _mm256_slli_epi64(c3, 32));
+        const __m256i low = _mm256_unpacklo_epi64(w01, w23);
+        const __m256i high = _mm256_unpackhi_epi64(w01, w23);
+        _mm256_storeu_si256((__m256i *)(void *)(out + done * 4),
+            _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256((__m256i *)(void *)(out + done * 4 + 8),
+            _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    return done;
+}
+
+FCLIB_TARGET("avx512f")
+static size_t fclib_random_blocks_avx512( //
+    const fclib_random_t *rng,            //
+    const uint64_t counter,               //
+    uint32_t *out,                        //
+    const size_t blocks                   //
+) {
+    const __m512i mask = _mm512_set1_epi64(0xFFFFFFFF);
+    const __m512i lanes = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+    const __m512i m0 = _mm512_set1_epi64(FCLIB_RANDOM_M0);
+    const __m512i m1 = _mm512_set1_epi64(FCLIB_RANDOM_M1);
+    const __m512i stream_low = _mm512_set1_epi64( //
+        (long long)(rng->stream & 0xFFFFFFFF));
+    const __m512i stream_high = _mm512_set1_epi64( //
+        (long long)(rng->stream >> 32));
+    const __m512i first_half = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+    const __m512i second_half = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+    size_t done = 0;
+    for (; done + 8 <= blocks; done += 8) {
+        const __m512i ctr = _mm512_add_epi64( //
+            _mm512_set1_epi64((long long)(counter + done)), lanes);
+        __m512i c0 = _mm512_and_si512(ctr, mask);
+        __m512i c1 = _mm512_srli_epi64(ctr, 32);
+        __m512i c2 = stream_low;
+        __m512i c3 = stream_high;
+        uint32_t k0 = rng->key[0];
+        uint32_t k1 = rng->key[1];
+        for (int round = 0; round < FCLIB_RANDOM_ROUNDS; round++) {
+            const __m512i p0 = _mm512_mul_epu32(c0, m0);
+            const __m512i p1 = _mm512_mul_epu32(c2, m1);
+            const __m512i c0_high = _mm512_srli_epi64(p1, 32);
+            c0 = _mm512_xor_si512(
+                _mm512_xor_si512(c0_high, c1), _mm512_set1_epi64(k0));
+            const __m512i c2_high = _mm512_srli_epi64(p0, 32);
+            c2 = _mm512_xor_si512(
+                _mm512_xor_si512(c2_high, c3), _mm512_set1_epi64(k1));
+            c1 = _mm512_and_si512(p1, mask);
+            c3 = _mm512_and_si512(p0, mask);
+            k0 += FCLIB_RANDOM_W0;
+            k1 += FCLIB_RANDOM_W1;
+        }
+        const __m512i w01 = _mm512_or_si512(c0, _mm512_slli_epi64(c1, 32));
+        const __m512i w23 = _mm512_or_si512(c2, _mm512_slli_epi64(c3, 32));
+        _mm512_storeu_si512(out + done * 4,
+            _mm512_permutex2var_epi64(w01, first_half, w23));
+        _mm512_storeu_si512(out + done * 4 + 16,
+            _mm512_permutex2var_epi64(w01, second_half, w23));
+    }
+    return done;
+}
+#endif
+
+// Generates `blocks` consecutive blocks starting at `counter` into `out`
+static void fclib_random_blocks( //
+    const fclib_random_t *rng,   //
+    const uint64_t counter,      //
+    uint32_t *out,               //
+    const size_t blocks          //
+) {
+    size_t done = 0;
+#if FCLIB_X86_SIMD
+    if (fclib_cpu_has_avx512()) {
+        done = fclib_random_blocks_avx512(rng, counter, out, blocks);
+    } else if (fclib_cpu_has_avx2()) {
+        done = fclib_random_blocks_avx2(rng, counter, out, blocks);
+    }
+#endif
+    for (; done < blocks; done++) {
+        fclib_random_block(rng, counter + done, out + done * 4);
+    }
+}
+
+// Returns the high half of the 128-bit product of `a` and `b`, and stores
+// the low half in `low`
+static uint64_t fclib_random_mul( //
+    const uint64_t a,             //
+    const uint64_t b,             //
+    uint64_t *low                 //
+) {
+#ifdef __SIZEOF_INT128__
+    const unsigned __int128 product = (unsigned __int128)a * b;
+    *low = (uint64_t)product;
+    return (uint64_t)(product >> 64);
+#else
+    const uint64_t a_low = a & 0xFFFFFFFF;
+    const uint64_t a_high = a >> 32;
+    const uint64_t b_low = b & 0xFFFFFFFF;
+    const uint64_t b_high = b >> 32;
+    const uint64_t low_low = a_low * b_low;
+    const uint64_t high_low = a_high * b_low;
+    const uint64_t low_high = a_low * b_high;
+    const uint64_t middle = (low_low >> 32) + (high_low & 0xFFFFFFFF) +
+        (low_high & 0xFFFFFFFF);
+    *low = (middle << 32) | (low_low & 0xFFFFFFFF);
+    return a_high * b_high + (high_low >> 32) + (low_high >> 32) +
+        (middle >> 32);
+#endif
+}
+
+typedef enum fclib_random_kind_t {
+    FCLIB_RANDOM_INT,
+    FCLIB_RANDOM_UNIFORM,
+    FCLIB_RANDOM_NORMAL,
+} fclib_random_kind_t;
+
+typedef struct fclib_random_fill_t {
+    // The generator at the start of the fill
+    fclib_random_t rng;
+    fclib_random_kind_t kind;
+    fclib_arr_type_t type;
+    char *data;
+    size_t count;
+    // The number of elements derived from every block
+    size_t per_block;
+    // The offset and the number of values of integer fills, 0 for all 2^64
+    uint64_t low;
+    uint64_t range;
+    // The offset and scale of float fills
+    double shift;
+    double scale;
+    // The largest value of the element type a uniform fill may produce
+    double limit;
+} fclib_random_fill_t;
+
+// Stores the integer draws of one chunk, every element takes 64 random bits
+#define FCLIB_RANDOM_STORE_INTS(T)                                             \
+    for (size_t i = 0; i < count; i++) {                                       \
+        const uint64_t bits = (uint64_t)words[2 * i] |                         \
+            (uint64_t)words[2 * i + 1] << 32;                                  \
+        uint64_t offset = bits;                                                \
+        if (fill->range != 0) {                                                \
+            offset = fclib_random_mul(bits, fill->range, &discard);            \
+        }                                                                      \
+        ((T *)(void *)fill->data)[first + i] = (T)(fill->low + offset);        \
+    }
+
+// Converts the blocks of one chunk into the elements [`first`, `first` +
+// `count`) of the fill
+static void fclib_random_convert(    //
+    const fclib_random_fill_t *fill, //
+    const uint32_t *words,           //
+    const size_t first,              //
+    const size_t count               //
+) {
+    uint64_t discard;
+    const bool f32 = fill->type == FCLIB_ARR_TYPE_F32;
+    switch (fill->kind) {
+        case FCLIB_RANDOM_INT:
+            switch (fill->type) {
+                case FCLIB_ARR_TYPE_I8:
+                    FCLIB_RANDOM_STORE_INTS(int8_t)
+                    break;
+                case FCLIB_ARR_TYPE_I16:
+                    FCLIB_RANDOM_STORE_INTS(int16_t)
+                    break;
+                case FCLIB_ARR_TYPE_I32:
+                    FCLIB_RANDOM_STORE_INTS(int32_t)
+                    break;
+                case FCLIB_ARR_TYPE_I64:
+                    FCLIB_RANDOM_STORE_INTS(int64_t)
+                    break;
+                case FCLIB_ARR_TYPE_U8:
+                    FCLIB_RANDOM_STORE_INTS(uint8_t)
+                    break;
+                case FCLIB_ARR_TYPE_U16:
+                    FCLIB_RANDOM_STORE_INTS(uint16_t)
+                    break;
+                case FCLIB_ARR_TYPE_U32:
+                    FCLIB_RANDOM_STORE_INTS(uint32_t)
+                    break;
+                case FCLIB_ARR_TYPE_U64:
+                    FCLIB_RANDOM_STORE_INTS(uint64_t)
+                    break;
+                case FCLIB_ARR_TYPE_F32:
+                case FCLIB_ARR_TYPE_F64:
+                    break;
+            }
+            break;
+        case FCLIB_RANDOM_UNIFORM:
+            if (f32) {
+                float *data = (float *)(void *)fill->data + first;
+                const float shift = (float)fill->shift;
+                const float scale = (float)fill->scale;
+                const float limit = (float)fill->limit;
+                for (size_t i = 0; i < count; i++) {
+                    const float unit = (float)(words[i] >> 8) * 0x1p-24f;
+                    const float value = shift + scale * unit;
+                    data[i] = value < limit ? value : limit;
+                }
+            } else {
+                double *data = (double *)(void *)fill->data + first;
+                for (size_t i = 0; i < count; i++) {
+                    const uint64_t bits = (uint64_t)words[2 * i] |
+                        (uint64_t)words[2 * i + 1] << 32;
+                    const double unit = (double)(bits >> 11) * 0x1p-53;
+                    const double value = fill->shift + fill->scale * unit;
+                    data[i] = value < fill->limit ? value : fill->limit;
+                }
+            }
+            break;
+        case FCLIB_RANDOM_NORMAL:
+            // Every pair of uniform values becomes a pair of normal values,
+            // the first one of every pair is moved to (0, 1] for the logarithm
+            if (f32) {
+                float *data = (float *)(void *)fill->data + first;
+                const float mean = (float)fill->shift;
+                const float stddev = (float)fill->scale;
+                for (size_t i = 0; i < count; i += 2) {
+                    const float u1 = (float)((words[i] >> 8) + 1) * 0x1p-24f;
+                    const float u2 = (float)(words[i + 1] >> 8) * 0x1p-24f;
+                    const float radius = stddev * sqrtf(-2.0f * logf(u1));
+                    const float angle = 6.28318530717958647692f * u2;
+                    data[i] = mean + radius * cosf(angle);
+                    if (i + 1 < count) {
+                        data[i + 1] = mean + radius * sinf(angle);
+                    }
+                }
+            } else {
+                double *data = (double *)(void *)fill->data + first;
+                for (size_t i = 0; i < count; i += 2) {
+                    const uint64_t b1 = (uint64_t)words[2 * i] |
+                        (uint64_t)words[2 * i + 1] << 32;
+                    const uint64_t b2 = (uint64_t)words[2 * i + 2] |
+                        (uint64_t)words[2 * i + 3] << 32;
+                    const double u1 = (double)((b1 >> 11) + 1) * 0x1p-53;
+                    const double u2 = (double)(b2 >> 11) * 0x1p-53;
+                    const double radius = fill->scale * sqrt(-2.0 * log(u1));
+                    const double angle = 6.28318530717958647692 * u2;
+                    data[i] = fill->shift + radius * cos(angle);
+                    if (i + 1 < count) {
+                        data[i + 1] = fill->shift + radius * sin(angle);
+                    }
+                }
+            }
+            break;
+    }
+}
+
+#undef FCLIB_RANDOM_STORE_INTS
+
+static void fclib_random_fill_range( //
+    void *context,                   //
+    const size_t begin,              //
+    const size_t end                 //
+) {
+    const fclib_random_fill_t *fill = (const fclib_random_fill_t *)context;
+    uint32_t words[FCLIB_RANDOM_CHUNK * 4];
+    const size_t chunk_elements = FCLIB_RANDOM_CHUNK * fill->per_block;
+    for (size_t chunk = begin; chunk < end; chunk++) {
+        const size_t first = chunk * chunk_elements;
+        size_t count = fill->count - first;
+        if (count > chunk_elements) {
+            count = chunk_elements;
+        }
+        const size_t blocks = (count + fill->per_block - 1) / fill->per_block;
+        fclib_random_blocks(&fill->rng,
+            fill->rng.counter + (uint64_t)chunk * FCLIB_RANDOM_CHUNK, words,
+            blocks);
+        fclib_random_convert(fill, words, first, count);
+    }
+}
+
+// Runs the fill over all chunks and advances the generator past them
+static void fclib_random_run(  //
+    fclib_random_t *rng,       //
+    fclib_random_fill_t *fill  //
+) {
+    fill->rng = *rng;
+    const size_t chunk_elements = FCLIB_RANDOM_CHUNK * fill->per_block;
+    const size_t chunks = (fill->count + chunk_elements - 1) / chunk_elements;
+    // A thread should at least get 64 chunks, which are 16384 blocks
+    fclib_parallel_for(chunks, 64, fclib_random_fill_range, fill);
+    rng->counter += (fill->count + fill->per_block - 1) / fill->per_block;
+}
+
+FCLIB_API void fclib_random_seed( //
+    fclib_random_t *rng,          //
+    const uint64_t seed,          //
+    const uint64_t stream         //
+) {
+    rng->key[0] = (uint32_t)seed;
+    rng->key[1] = (uint32_t)(seed >> 32);
+    rng->stream = stream;
+    rng->counter = 0;
+}
+
+FCLIB_API void fclib_random_skip(fclib_random_t *rng, const uint64_t blocks) {
+    rng->counter += blocks;
+}
+
+FCLIB_API uint64_t fclib_random_u64(fclib_random_t *rng) {
+    uint32_t block[4];
+    fclib_random_block(rng, rng->counter++, block);
+    return (uint64_t)block[0] | (uint64_t)block[1] << 32;
+}
+
+FCLIB_API uint64_t fclib_random_below(  //
+    fclib_random_t *rng,                //
+    const uint64_t bound                //
+) {
+    // Lemire's multiply-shift reduction, a draw is only rejected if its low
+    // half falls into the `2^64 % bound` values which would be overrepresented
+    uint64_t low;
+    uint64_t high = fclib_random_mul(fclib_random_u64(rng), bound, &low);
+    if (low < bound) {
+        const uint64_t threshold = (0 - bound) % bound;
+        while (low < threshold) {
+            high = fclib_random_mul(fclib_random_u64(rng), bound, &low);
+        }
+    }
+    return high;
+}
+
+FCLIB_API double fclib_random_f64(fclib_random_t *rng) {
+    return (double)(fclib_random_u64(rng) >> 11) * 0x1p-53;
+}
+
+FCLIB_API bool fclib_random_fill_int( //
+    fclib_random_t *rng,              //
+    fclib_arr_t *arr,                 //
+    const fclib_arr_type_t type,      //
+    const int64_t low,                //
+    const int64_t high                //
+) {
+    if (type == FCLIB_ARR_TYPE_F32 || type == FCLIB_ARR_TYPE_F64 ||
+        low > high) {
+        return false;
+    }
+    fclib_random_fill_t fill;
+    fill.kind = FCLIB_RANDOM_INT;
+    fill.type = type;
+    fill.data = fclib_arr_get_data(arr);
+    fill.count = fclib_arr_get_len(arr);
+    fill.per_block = 2;
+    fill.low = (uint64_t)low;
+    // Wraps around to 0 for the full 64-bit range
+    fill.range = (uint64_t)high - (uint64_t)low + 1;
+    fclib_random_run(rng, &fill);
+    return true;
+}
+
+FCLIB_API bool fclib_random_fill_float( //
+    fclib_random_t *rng,                //
+    fclib_arr_t *arr,                   //
+    const fclib_arr_type_t type,        //
+    const double low,                   //
+    const double high                   //
+) {
+    if (type != FCLIB_ARR_TYPE_F32 && type != FCLIB_ARR_TYPE_F64) {
+        return false;
+    }
+    fclib_random_fill_t fill;
+    fill.kind = FCLIB_RANDOM_UNIFORM;
+    fill.type = type;
+    fill.data = fclib_arr_get_data(arr);
+    fill.count = fclib_arr_get_len(arr);
+    fill.per_block = type == FCLIB_ARR_TYPE_F32 ? 4 : 2;
+    fill.shift = low;
+    fill.scale = high - low;
+    // Rounding `low` + `scale` * `unit` can land exactly on `high`, so the
+    // values are clamped to the largest one of the element type below it
+    if (type == FCLIB_ARR_TYPE_F32) {
+        float limit = (float)high;
+        if ((double)limit >= high) {
+            limit = nextafterf(limit, -INFINITY);
+        }
+        fill.limit = (double)limit;
+    } else {
+        fill.limit = nextafter(high, -INFINITY);
+    }
+    if (fill.limit < low) {
+        fill.limit = low;
+    }
+    fclib_random_run(rng, &fill);
+    return true;
+}
+
+FCLIB_API bool fclib_random_fill_normal( //
+    fclib_random_t *rng,                 //
+    fclib_arr_t *arr,                    //
+    const fclib_arr_type_t type,         //
+    const double mean,                   //
+    const double stddev                  //
+) {
+    if (type != FCLIB_ARR_TYPE_F32 && type != FCLIB_ARR_TYPE_F64) {
+        return false;
+    }
+    fclib_random_fill_t fill;
+    fill.kind = FCLIB_RANDOM_NORMAL;
+    fill.type = type;
+    fill.data = fclib_arr_get_data(arr);
+    fill.count = fclib_arr_get_len(arr);
+    // Pairs never straddle two blocks, as both counts are even
+    fill.per_block = type == FCLIB_ARR_TYPE_F32 ? 4 : 2;
+    fill.shift = mean;
+    fill.scale = stddev;
+    fclib_random_run(rng, &fill);
+    return true;
+}
+
+// Swaps two elements of any size through a small buffer
+static void fclib_random_swap( //
+    char *a,                   //
+    char *b,                   //
+    size_t element_size        //
+) {
+    char buffer[64];
+    while (element_size > 0) {
+        const size_t part = element_size < sizeof(buffer) ? element_size
+                                                          : sizeof(buffer);
+        memcpy(buffer, a, part);
+        memcpy(a, b, part);
+        memcpy(b, buffer, part);
+        a += part;
+        b += part;
+        element_size -= part;
+    }
+}
+
+FCLIB_API void fclib_random_shuffle( //
+    fclib_random_t *rng,             //
+    fclib_arr_t *arr,                //
+    const size_t element_size        //
+) {
+    char *data = fclib_arr_get_data(arr);
+    for (size_t i = fclib_arr_get_len(arr); i > 1; i--) {
+        const size_t j = (size_t)fclib_random_below(rng, i);
+        if (j != i - 1) {
+            fclib_random_swap(data + j * element_size,
+                data + (i - 1) * element_size, element_size);
+        }
+    }
+}
+
+FCLIB_API fclib_arr_t *fclib_random_sample( //
+    fclib_random_t *rng,                    //
+    fclib_arr_t *arr,                       //
+    const size_t element_size,              //
+    const size_t count                      //
+) {
+    const size_t len = fclib_arr_get_len(arr);
+    if (count > len) {
+        return NULL;
+    }
+    fclib_arr_t *result = fclib_arr_create(1, element_size, &count);
+    // The chosen indices are kept in an open addressing set of at least twice
+    // the sample size, with every index stored plus one so 0 marks free slots
+    size_t slots = 16;
+    while (slots < count * 2) {
+        slots *= 2;
+    }
+    size_t *set = (size_t *)calloc(slots, sizeof(size_t));
+    if (result == NULL || set == NULL) {
+        free(result);
+        free(set);
+        return NULL;
+    }
+    const char *data = fclib_arr_get_data(arr);
+    char *dest = fclib_arr_get_data(result);
+    // Floyd's algorithm: for every j in [len - count, len) draw t from
+    // [0, j], taking j itself instead if t was already chosen
+    for (size_t j = len - count, n = 0; j < len; j++, n++) {
+        size_t pick = (size_t)fclib_random_below(rng, (uint64_t)j + 1);
+        for (int attempt = 0; attempt < 2; attempt++) {
+            size_t slot = (pick * 0x9E3779B97F4A7C15ull) & (slots - 1);
+            while (set[slot] != 0 && set[slot] != pick + 1) {
+                slot = (slot + 1) & (slots - 1);
+            }
+            if (set[slot] == 0) {
+                set[slot] = pick + 1;
+                break;
+            }
+            pick = j;
+        }
+        memcpy(dest + n * element_size, data + pick * element_size,
+            element_size);
+    }
+    free(set);
+    // Floyd's algorithm chooses a uniform set, but not a uniform order
+    fclib_random_shuffle(rng, result, element_size);
+    return result;
+}
+
+#undef FCLIB_RANDOM_M0
+#undef FCLIB_RANDOM_M1
+#undef FCLIB_RANDOM_W0
+#undef FCLIB_RANDOM_W1
+#undef FCLIB_RANDOM_ROUNDS
+#undef FCLIB_RANDOM_CHUNK
+
+#endif // endof FCLIB_IMPLEMENTATION
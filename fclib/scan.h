@@ -0,0 +1,607 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "cpu.h"
+#include "parallel.h"
+
+#ifdef FCLIB_MINIMAL
+#error "scan.h builds on arr_type_t, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @function `scan_sum`
+/// @brief Computes the prefix sums of all elements of the array in the order
+/// in which they are stored, see `scan_sum_into`
+///
+/// @param `arr` The array to scan
+/// @param `type` The element type of the array
+/// @param `inclusive` Whether element i of the result includes element i of
+/// `arr` (inclusive scan) or only the elements before it (exclusive scan)
+/// @return `arr_t *` The prefix sums in an array of the same shape, or NULL if
+/// the allocation failed
+FCLIB_API fclib_arr_t *fclib_scan_sum( //
+    const fclib_arr_t *arr,            //
+    const fclib_arr_type_t type,       //
+    const bool inclusive               //
+);
+
+/// @function `scan_sum_into`
+/// @brief Computes the prefix sums of all elements of `src` into `dest`,
+/// which may be `src` itself. Integer sums wrap around on overflow.
+///
+/// Large arrays are scanned in two passes over fixed-size chunks: the first
+/// pass sums every chunk, then the chunk sums are scanned, and the second
+/// pass scans every chunk starting at its offset. Both passes are split
+/// across `parallel_get_threads` threads. As the chunks do not depend on the
+/// thread count, float sums are rounded the same for any number of threads.
+///
+/// @param `dest` The array to write the prefix sums to
+/// @param `src` The array to scan
+/// @param `type` The element type of both arrays
+/// @param `inclusive` Whether to compute the inclusive or the exclusive scan
+/// @return `bool` Whether the scan was computed, false if the arrays have a
+/// different number of elements
+FCLIB_API bool fclib_scan_sum_into( //
+    fclib_arr_t *dest,              //
+    const fclib_arr_t *src,         //
+    const fclib_arr_type_t type,    //
+    const bool inclusive            //
+);
+
+/// @function `scan_filter`
+/// @brief Packs all elements of the array whose byte in `mask` is non-zero
+/// into a new one-dimensional array of exactly the number of kept elements,
+/// keeping their order. The mask holds one byte per element, e.g. a `bool` or
+/// `U8` array of the same shape.
+///
+/// The kept elements are counted in a first pass, so the result is allocated
+/// once at its exact size, and packed in a second pass. Both passes are split
+/// across `parallel_get_threads` threads for large arrays. Elements of 4 or 8
+/// bytes are packed 16 or 8 at a time with the AVX-512 compress instructions
+/// when available.
+///
+/// @param `arr` The array to filter
+/// @param `element_size` The size of each element in bytes
+/// @param `mask` The byte mask with one byte per element
+/// @return `arr_t *` The kept elements, or NULL if the mask has a different
+/// number of elements or the allocation failed
+FCLIB_API fclib_arr_t *fclib_scan_filter( //
+    fclib_arr_t *arr,                     //
+    const size_t element_size,            //
+    fclib_arr_t *mask                     //
+);
+
+/// @function `scan_partition`
+/// @brief Reorders all elements of the array into a new one-dimensional
+/// array, which starts with the elements whose byte in `mask` is non-zero
+/// followed by all other elements, both in their original order. See
+/// `scan_filter`
+///
+/// @param `arr` The array to partition
+/// @param `element_size` The size of each element in bytes
+/// @param `mask` The byte mask with one byte per element
+/// @param `split` Where to store the number of kept elements, which is the
+/// index of the first rejected element in the result
+/// @return `arr_t *` The partitioned elements, or NULL if the mask has a
+/// different number of elements or the allocation failed
+FCLIB_API fclib_arr_t *fclib_scan_partition( //
+    fclib_arr_t *arr,                        //
+    const size_t element_size,               //
+    fclib_arr_t *mask,                       //
+    size_t *split                            //
+);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+FCLIB_API static inline arr_t *scan_sum( //
+    const arr_t *arr,                    //
+    const arr_type_t type,               //
+    const bool inclusive                 //
+) {
+    return fclib_scan_sum(arr, type, inclusive);
+}
+FCLIB_API static inline bool scan_sum_into( //
+    arr_t *dest,                            //
+    const arr_t *src,                       //
+    const arr_type_t type,                  //
+    const bool inclusive                    //
+) {
+    return fclib_scan_sum_into(dest, src, type, inclusive);
+}
+FCLIB_API static inline arr_t *scan_filter( //
+    arr_t *arr,                             //
+    const size_t element_size,              //
+    arr_t *mask                             //
+) {
+    return fclib_scan_filter(arr, element_size, mask);
+}
+FCLIB_API static inline arr_t *scan_partition( //
+    arr_t *arr,                                //
+    const size_t element_size,                 //
+    arr_t *mask,                               //
+    size_t *split                              //
+) {
+    return fclib_scan_partition(arr, element_size, mask, split);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+// The number of elements of one chunk, which is the unit of work of both
+// passes. Chunks are fixed so the float rounding is independent of threads
+#define FCLIB_SCAN_CHUNK 16384
+// The number of chunks a thread should at least get
+#define FCLIB_SCAN_GRAIN 4
+
+// Sums `count` elements into `total`
+typedef void (*fclib_scan_sum_fn_t)( //
+    const void *src,                 //
+    const size_t count,              //
+    void *total                      //
+);
+
+// Scans `count` elements starting at the running sum `offset`, the source
+// and the destination may be the same
+typedef void (*fclib_scan_run_fn_t)( //
+    const void *src,                 //
+    void *dest,                      //
+    const size_t count,              //
+    const void *offset,              //
+    const bool inclusive             //
+);
+
+// Generates the sum and scan kernels for the element type T, whose sums are
+// computed in the type U so that signed overflow wraps around
+#define FCLIB_SCAN_KERNELS(T, U, NAME)                                         \
+    static void fclib_scan_sum_##NAME(                                         \
+        const void *src, const size_t count, void *total) {                    \
+        const T *values = (const T *)src;                                      \
+        U sum = 0;                                                             \
+        for (size_t i = 0; i < count; i++) {                                   \
+            sum += (U)values[i];                                               \
+        }                                                                      \
+        *(T *)total = (T)sum;                                                  \
+    }                                                                          \
+    static void fclib_scan_run_##NAME(const void *src, void *dest,             \
+        const size_t count, const void *offset, const bool inclusive) {        \
+        const T *values = (const T *)src;                                      \
+        T *sums = (T *)dest;                                                   \
+        T start;                                                               \
+        memcpy(&start, offset, sizeof(T));                                     \
+        U sum = (U)start;                                                      \
+        if (inclusive) {                                                       \
+            for (size_t i = 0; i < count; i++) {                               \
+                sum += (U)values[i];                                           \
+                sums[i] = (T)sum;                                              \
+            }                                                                  \
+        } else {                                                               \
+            for (size_t i = 0; i < count; i++) {                               \
+                const U value = (U)values[i];                                  \
+                sums[i] = (T)sum;                                              \
+                sum += value;                                                  \
+            }                                                                  \
+        }                                                                      \
+    }
+
+FCLIB_SCAN_KERNELS(int8_t, uint8_t, i8)
+FCLIB_SCAN_KERNELS(int16_t, uint16_t, i16)
+FCLIB_SCAN_KERNELS(int32_t, uint32_t, i32)
+FCLIB_SCAN_KERNELS(int64_t, uint64_t, i64)
+FCLIB_SCAN_KERNELS(uint8_t, uint8_t, u8)
+FCLIB_SCAN_KERNELS(uint16_t, uint16_t, u16)
+FCLIB_SCAN_KERNELS(uint32_t, uint32_t, u32)
+FCLIB_SCAN_KERNELS(uint64_t, uint64_t, u64)
+FCLIB_SCAN_KERNELS(float, float, f32)
+FCLIB_SCAN_KERNELS(double, double, f64)
+
+#undef FCLIB_SCAN_KERNELS
+
+// The kernels of all types in the order of `arr_type_t`
+static const fclib_scan_sum_fn_t fclib_scan_sums[] = {
+    fclib_scan_sum_i8,
+    fclib_scan_sum_i16,
+    fclib_scan_sum_i32,
+    fclib_scan_sum_i64,
+    fclib_scan_sum_u8,
+    fclib_scan_sum_u16,
+    fclib_scan_sum_u32,
+    fclib_scan_sum_u64,
+    fclib_scan_sum_f32,
+    fclib_scan_sum_f64,
+};
+static const fclib_scan_run_fn_t fclib_scan_runs[] = {
+    fclib_scan_run_i8,
+    fclib_scan_run_i16,
+    fclib_scan_run_i32,
+    fclib_scan_run_i64,
+    fclib_scan_run_u8,
+    fclib_scan_run_u16,
+    fclib_scan_run_u32,
+    fclib_scan_run_u64,
+    fclib_scan_run_f32,
+    fclib_scan_run_f64,
+};
+
+typedef struct fclib_scan_job_t {
+    fclib_arr_type_t type;
+    size_t size;
+    const char *src;
+    char *dest;
+    size_t count;
+    bool inclusive;
+    // The sum of every chunk after the first pass, the offset of every chunk
+    // after the chunk sums have been scanned
+    char *offsets;
+} fclib_scan_job_t;
+
+static void fclib_scan_sum_range( //
+    void *context,                //
+    const size_t begin,           //
+    const size_t end              //
+) {
+    const fclib_scan_job_t *job = (const fclib_scan_job_t *)context;
+    for (size_t chunk = begin; chunk < end; chunk++) {
+        const size_t first = chunk * FCLIB_SCAN_CHUNK;
+        size_t count = job->count - first;
+        if (count > FCLIB_SCAN_CHUNK) {
+            count = FCLIB_SCAN_CHUNK;
+        }
+        fclib_scan_sums[job->type](job->src + first * job->size, count,
+            job->offsets + chunk * job->size);
+    }
+}
+
+static void fclib_scan_run_range( //
+    void *context,                //
+    const size_t begin,           //
+    const size_t end              //
+) {
+    const fclib_scan_job_t *job = (const fclib_scan_job_t *)context;
+    for (size_t chunk = begin; chunk < end; chunk++) {
+        const size_t first = chunk * FCLIB_SCAN_CHUNK;
+        size_t count = job->count - first;
+        if (count > FCLIB_SCAN_CHUNK) {
+            count = FCLIB_SCAN_CHUNK;
+        }
+        fclib_scan_runs[job->type](job->src + first * job->size,
+            job->dest + first * job->size, count,
+            job->offsets + chunk * job->size, job->inclusive);
+    }
+}
+
+FCLIB_API fclib_arr_t *fclib_scan_sum( //
+    const fclib_arr_t *arr,            //
+    const fclib_arr_type_t type,       //
+    const bool inclusive               //
+) {
+    const size_t *dims = FCLIB_ALIGNCAST(const size_t, arr->value);
+    fclib_arr_t *result = fclib_arr_create( //
+        arr->len, fclib_arr_type_size(type), dims);
+    if (result == NULL) {
+        return NULL;
+    }
+    if (!fclib_scan_sum_into(result, arr, type, inclusive)) {
+        free(result);
+        return NULL;
+    }
+    return result;
+}
+
+FCLIB_API bool fclib_scan_sum_into( //
+    fclib_arr_t *dest,              //
+    const fclib_arr_t *src,         //
+    const fclib_arr_type_t type,    //
+    const bool inclusive            //
+) {
+    const size_t count = fclib_arr_get_len(src);
+    if (fclib_arr_get_len(dest) != count) {
+        return false;
+    }
+    fclib_scan_job_t job;
+    job.type = type;
+    job.size = fclib_arr_type_size(type);
+    job.src = src->value + src->len * sizeof(size_t);
+    job.dest = dest->value + dest->len * sizeof(size_t);
+    job.count = count;
+    job.inclusive = inclusive;
+    const size_t chunks = (count + FCLIB_SCAN_CHUNK - 1) / FCLIB_SCAN_CHUNK;
+    // A single chunk is scanned directly, starting at the zero offset
+    uint64_t zero = 0;
+    if (chunks <= 1) {
+        fclib_scan_runs[type](job.src, job.dest, count, &zero, inclusive);
+        return true;
+    }
+    job.offsets = (char *)malloc(chunks * job.size);
+    if (job.offsets == NULL) {
+        fclib_scan_runs[type](job.src, job.dest, count, &zero, inclusive);
+        return true;
+    }
+    fclib_parallel_for(chunks, FCLIB_SCAN_GRAIN, fclib_scan_sum_range, &job);
+    fclib_scan_runs[type](job.offsets, job.offsets, chunks, &zero, false);
+    fclib_parallel_for(chunks, FCLIB_SCAN_GRAIN, fclib_scan_run_range, &job);
+    free(job.offsets);
+    return true;
+}
+
+// Packs the kept elements of `count` elements into `kept` and, if it is not
+// NULL, the other elements into `rejected`. Returns the number of kept ones
+static inline size_t fclib_scan_compact_generic( //
+    const char *src,                             //
+    const uint8_t *mask,                         //
+    const size_t count,                          //
+    const size_t size,                           //
+    char *kept,                                  //
+    char *rejected                               //
+) {
+    size_t kept_count = 0;
+    size_t rejected_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (mask[i] != 0) {
+            memcpy(kept + kept_count++ * size, src + i * size, size);
+        } else if (rejected != NULL) {
+            memcpy(rejected + rejected_count++ * size, src + i * size, size);
+        }
+    }
+    return kept_count;
+}
+
+#if FCLIB_X86_SIMD
+// The AVX-512 compactions turn 16 (or 8) mask bytes into a bit mask, pack
+// the selected lanes to the front of a register with `compress` and store
+// only the packed lanes, so nothing is written past the kept elements
+
+FCLIB_TARGET("avx512f,avx512bw,avx512vl")
+static size_t fclib_scan_compact_avx512_32( //
+    const char *src,                        //
+    const uint8_t *mask,                    //
+    const size_t count,                     //
+    char *kept,                             //
+    char *rejected                          //
+) {
+    size_t kept_count = 0;
+    size_t rejected_count = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bytes = _mm_loadu_si128( //
+            (const __m128i *)(const void *)(mask + i));
+        const __mmask16 keep = _mm_cmpneq_epi8_mask( //
+            bytes, _mm_setzero_si128());
+        const __m512i values = _mm512_loadu_si512(src + i * 4);
+        const unsigned int keep_n = (unsigned int)__builtin_popcount(keep);
+        _mm512_mask_storeu_epi32(kept + kept_count * 4,
+            (__mmask16)((1u << keep_n) - 1),
+            _mm512_maskz_compress_epi32(keep, values));
+        kept_count += keep_n;
+        if (rejected != NULL) {
+            _mm512_mask_storeu_epi32(rejected + rejected_count * 4,
+                (__mmask16)((1u << (16 - keep_n)) - 1),
+                _mm512_maskz_compress_epi32((__mmask16)~keep, values));
+            rejected_count += 16 - keep_n;
+        }
+    }
+    return kept_count +
+        fclib_scan_compact_generic(src + i * 4, mask + i, count - i, 4,
+            kept + kept_count * 4,
+            rejected == NULL ? NULL : rejected + rejected_count * 4);
+}
+
+FCLIB_TARGET("avx512f,avx512bw,avx512vl")
+static size_t fclib_scan_compact_avx512_64( //
+    const char *src,                        //
+    const uint8_t *mask,                    //
+    const size_t count,                     //
+    char *kept,                             //
+    char *rejected                          //
+) {
+    size_t kept_count = 0;
+    size_t rejected_count = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i bytes = _mm_loadl_epi64( //
+            (const __m128i *)(const void *)(mask + i));
+        const __mmask8 keep = (__mmask8)_mm_cmpneq_epi8_mask( //
+            bytes, _mm_setzero_si128());
+        const __m512i values = _mm512_loadu_si512(src + i * 8);
+        const unsigned int keep_n = (unsigned int)__builtin_popcount(keep);
+        _mm512_mask_storeu_epi64(kept + kept_count * 8,
+            (__mmask8)((1u << keep_n) - 1),
+            _mm512_maskz_compress_epi64(keep, values));
+        kept_count += keep_n;
+        if (rejected != NULL) {
+            _mm512_mask_storeu_epi64(rejected + rejected_count * 8,
+                (__mmask8)((1u << (8 - keep_n)) - 1),
+                _mm512_maskz_compress_epi64((__mmask8)~keep, values));
+            rejected_count += 8 - keep_n;
+        }
+    }
+    return kept_count +
+        fclib_scan_compact_generic(src + i * 8, mask + i, count - i, 8,
+            kept + kept_count * 8,
+            rejected == NULL ? NULL : rejected + rejected_count * 8);
+}
+#endif
+
+// Selects the fastest compaction for the element size
+static size_t fclib_scan_compact( //
+    const char *src,              //
+    const uint8_t *mask,          //
+    const size_t count,           //
+    const size_t size,            //
+    char *kept,                   //
+    char *rejected                //
+) {
+#if FCLIB_X86_SIMD
+    if ((size == 4 || size == 8) && fclib_cpu_has_avx512()) {
+        return size == 4
+            ? fclib_scan_compact_avx512_32(src, mask, count, kept, rejected)
+            : fclib_scan_compact_avx512_64(src, mask, count, kept, rejected);
+    }
+#endif
+    // A constant size turns the copies into single moves once inlined
+    switch (size) {
+        case 1:
+            return fclib_scan_compact_generic( //
+                src, mask, count, 1, kept, rejected);
+        case 2:
+            return fclib_scan_compact_generic( //
+                src, mask, count, 2, kept, rejected);
+        case 4:
+            return fclib_scan_compact_generic( //
+                src, mask, count, 4, kept, rejected);
+        case 8:
+            return fclib_scan_compact_generic( //
+                src, mask, count, 8, kept, rejected);
+        default:
+            return fclib_scan_compact_generic( //
+                src, mask, count, size, kept, rejected);
+    }
+}
+
+typedef struct fclib_scan_pack_t {
+    const char *src;
+    const uint8_t *mask;
+    size_t count;
+    size_t size;
+    char *dest;
+    // The number of kept elements of all chunks, only used by partitions
+    size_t total;
+    bool partition;
+    // The number of kept elements of every chunk after the first pass, the
+    // number of kept elements before every chunk after they have been scanned
+    size_t *offsets;
+} fclib_scan_pack_t;
+
+static void fclib_scan_count_range( //
+    void *context,                  //
+    const size_t begin,             //
+    const size_t end                //
+) {
+    fclib_scan_pack_t *pack = (fclib_scan_pack_t *)context;
+    for (size_t chunk = begin; chunk < end; chunk++) {
+        const size_t first = chunk * FCLIB_SCAN_CHUNK;
+        size_t count = pack->count - first;
+        if (count > FCLIB_SCAN_CHUNK) {
+            count = FCLIB_SCAN_CHUNK;
+        }
+        // Summing the flags branch-free lets the compiler vectorize the loop
+        size_t kept = 0;
+        for (size_t i = 0; i < count; i++) {
+            kept += pack->mask[first + i] != 0;
+        }
+        pack->offsets[chunk] = kept;
+    }
+}
+
+static void fclib_scan_pack_range( //
+    void *context,                 //
+    const size_t begin,            //
+    const size_t end               //
+) {
+    const fclib_scan_pack_t *pack = (const fclib_scan_pack_t *)context;
+    const size_t size = pack->size;
+    for (size_t chunk = begin; chunk < end; chunk++) {
+        const size_t first = chunk * FCLIB_SCAN_CHUNK;
+        size_t count = pack->count - first;
+        if (count > FCLIB_SCAN_CHUNK) {
+            count = FCLIB_SCAN_CHUNK;
+        }
+        const size_t kept_before = pack->offsets[chunk];
+        char *rejected = NULL;
+        if (pack->partition) {
+            // All elements before the chunk which were not kept come first
+            rejected = pack->dest +
+                (pack->total + first - kept_before) * size;
+        }
+        fclib_scan_compact(pack->src + first * size, pack->mask + first,
+            count, size, pack->dest + kept_before * size, rejected);
+    }
+}
+
+// Filters or partitions the array, see `scan_filter` and `scan_partition`
+static fclib_arr_t *fclib_scan_pack( //
+    fclib_arr_t *arr,                //
+    const size_t element_size,       //
+    fclib_arr_t *mask,               //
+    const bool partition,            //
+    size_t *split                    //
+) {
+    const size_t count = fclib_arr_get_len(arr);
+    if (fclib_arr_get_len(mask) != count) {
+        return NULL;
+    }
+    fclib_scan_pack_t pack;
+    pack.src = fclib_arr_get_data(arr);
+    pack.mask = (const uint8_t *)fclib_arr_get_data(mask);
+    pack.count = count;
+    pack.size = element_size;
+    pack.partition = partition;
+    const size_t chunks = (count + FCLIB_SCAN_CHUNK - 1) / FCLIB_SCAN_CHUNK;
+    pack.offsets = (size_t *)malloc((chunks + 1) * sizeof(size_t));
+    if (pack.offsets == NULL) {
+        return NULL;
+    }
+    fclib_parallel_for( //
+        chunks, FCLIB_SCAN_GRAIN, fclib_scan_count_range, &pack);
+    size_t total = 0;
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        const size_t kept = pack.offsets[chunk];
+        pack.offsets[chunk] = total;
+        total += kept;
+    }
+    pack.total = total;
+    const size_t length = partition ? count : total;
+    fclib_arr_t *result = fclib_arr_create(1, element_size, &length);
+    if (result == NULL) {
+        free(pack.offsets);
+        return NULL;
+    }
+    pack.dest = fclib_arr_get_data(result);
+    fclib_parallel_for(chunks, FCLIB_SCAN_GRAIN, fclib_scan_pack_range, &pack);
+    free(pack.offsets);
+    if (split != NULL) {
+        *split = total;
+    }
+    return result;
+}
+
+FCLIB_API fclib_arr_t *fclib_scan_filter( //
+    fclib_arr_t *arr,                     //
+    const size_t element_size,            //
+    fclib_arr_t *mask                     //
+) {
+    return fclib_scan_pack(arr, element_size, mask, false, NULL);
+}
+
+FCLIB_API fclib_arr_t *fclib_scan_partition( //
+    fclib_arr_t *arr,                        //
+    const size_t element_size,               //
+    fclib_arr_t *mask,                       //
+    size_t *split                            //
+) {
+    return fclib_scan_pack(arr, element_size, mask, true, split);
+}
+
+#undef FCLIB_SCAN_CHUNK
+#undef FCLIB_SCAN_GRAIN
+
+#endif // endof FCLIB_IMPLEMENTATION
@@ -0,0 +1,640 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "parallel.h"
+
+#ifdef FCLIB_MINIMAL
+#error "search.h builds on arr_type_t, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @typedef `search_tree_t`
+/// @brief A copy of a sorted array in Eytzinger order, the order in which a
+/// binary search visits the elements, stored level by level like a binary
+/// heap. The first levels share a few cache lines and the 2^k children k
+/// levels below a node are adjacent, so a search can prefetch the line it
+/// will need a few steps ahead and needs no branches to descend.
+typedef struct fclib_search_tree_t {
+    /// @brief The element type of the sorted array
+    fclib_arr_type_t type;
+    /// @brief The number of elements of the sorted array
+    size_t len;
+    /// @brief The elements in Eytzinger order starting at index 1, the
+    /// element at index 0 is unused. Aligned to a cache line
+    char *keys;
+} fclib_search_tree_t;
+
+/// @function `search_lower_bound`
+/// @brief Finds the first element of the sorted array which is not less than
+/// the key, using a branch-free binary search. The elements are searched in
+/// the order in which they are stored and must be sorted ascending.
+///
+/// @param `arr` The sorted array to search
+/// @param `type` The element type of the array
+/// @param `key` A pointer to the key, of the element type
+/// @return `size_t` The index of the first element not less than the key, or
+/// the number of elements if all are less
+FCLIB_API size_t fclib_search_lower_bound( //
+    fclib_arr_t *arr,                      //
+    const fclib_arr_type_t type,           //
+    const void *key                        //
+);
+
+/// @function `search_upper_bound`
+/// @brief Finds the first element of the sorted array which is greater than
+/// the key, see `search_lower_bound`
+///
+/// @param `arr` The sorted array to search
+/// @param `type` The element type of the array
+/// @param `key` A pointer to the key, of the element type
+/// @return `size_t` The index of the first element greater than the key, or
+/// the number of elements if none is
+FCLIB_API size_t fclib_search_upper_bound( //
+    fclib_arr_t *arr,                      //
+    const fclib_arr_type_t type,           //
+    const void *key                        //
+);
+
+/// @function `search_batch`
+/// @brief Finds the lower or upper bound of every key in the sorted array.
+/// The searches of 16 keys are interleaved step by step, so their cache
+/// misses overlap instead of being waited for one after another, and large
+/// batches are split across `parallel_get_threads` threads.
+///
+/// @param `arr` The sorted array to search
+/// @param `type` The element type of the array and of the keys
+/// @param `keys` The keys to search for, in any order and shape
+/// @param `upper` Whether to find the upper bounds instead of lower bounds
+/// @return `arr_t *` A one-dimensional `size_t` array with the bound of every
+/// key, or NULL if the allocation failed
+FCLIB_API fclib_arr_t *fclib_search_batch( //
+    fclib_arr_t *arr,                      //
+    const fclib_arr_type_t type,           //
+    fclib_arr_t *keys,                     //
+    const bool upper                       //
+);
+
+/// @function `search_tree_create`
+/// @brief Copies the sorted array into a new search tree. Building takes one
+/// pass over the array, so it pays off when the array is searched many times.
+/// Searches of the tree return indices of the sorted array.
+///
+/// @param `arr` The sorted array to copy
+/// @param `type` The element type of the array
+/// @return `search_tree_t *` The new search tree, or NULL if the allocation
+/// failed
+FCLIB_API fclib_search_tree_t *fclib_search_tree_create( //
+    fclib_arr_t *arr,                                    //
+    const fclib_arr_type_t type                          //
+);
+
+/// @function `search_tree_lower_bound`
+/// @brief Finds the first element of the sorted array the tree was built from
+/// which is not less than the key
+///
+/// @param `tree` The search tree to search
+/// @param `key` A pointer to the key, of the element type of the tree
+/// @return `size_t` The index of the first element not less than the key in
+/// the sorted array, or its number of elements if all are less
+FCLIB_API size_t fclib_search_tree_lower_bound( //
+    const fclib_search_tree_t *tree,            //
+    const void *key                             //
+);
+
+/// @function `search_tree_upper_bound`
+/// @brief Finds the first element of the sorted array the tree was built from
+/// which is greater than the key
+///
+/// @param `tree` The search tree to search
+/// @param `key` A pointer to the key, of the element type of the tree
+/// @return `size_t` The index of the first element greater than the key in
+/// the sorted array, or its number of elements if none is
+FCLIB_API size_t fclib_search_tree_upper_bound( //
+    const fclib_search_tree_t *tree,            //
+    const void *key                             //
+);
+
+/// @function `search_tree_batch`
+/// @brief Finds the lower or upper bound of every key in the search tree,
+/// interleaving the searches like `search_batch`
+///
+/// @param `tree` The search tree to search
+/// @param `keys` The keys to search for, of the element type of the tree
+/// @param `upper` Whether to find the upper bounds instead of lower bounds
+/// @return `arr_t *` A one-dimensional `size_t` array with the bound of every
+/// key in the sorted array, or NULL if the allocation failed
+FCLIB_API fclib_arr_t *fclib_search_tree_batch( //
+    const fclib_search_tree_t *tree,            //
+    fclib_arr_t *keys,                          //
+    const bool upper                            //
+);
+
+/// @function `search_tree_free`
+/// @brief Frees the search tree
+///
+/// @param `tree` The search tree to free
+FCLIB_API void fclib_search_tree_free(fclib_search_tree_t *tree);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_search_tree_t search_tree_t;
+
+FCLIB_API static inline size_t search_lower_bound( //
+    arr_t *arr,                                    //
+    const arr_type_t type,                         //
+    const void *key                                //
+) {
+    return fclib_search_lower_bound(arr, type, key);
+}
+FCLIB_API static inline size_t search_upper_bound( //
+    arr_t *arr,                                    //
+    const arr_type_t type,                         //
+    const void *key                                //
+) {
+    return fclib_search_upper_bound(arr, type, key);
+}
+FCLIB_API static inline arr_t *search_batch( //
+    arr_t *arr,                              //
+    const arr_type_t type,                   //
+    arr_t *keys,                             //
+    const bool upper                         //
+) {
+    return fclib_search_batch(arr, type, keys, upper);
+}
+FCLIB_API static inline search_tree_t *search_tree_create( //
+    arr_t *arr,                                            //
+    const arr_type_t type                                  //
+) {
+    return fclib_search_tree_create(arr, type);
+}
+FCLIB_API static inline size_t search_tree_lower_bound( //
+    const search_tree_t *tree,                          //
+    const void *key                                     //
+) {
+    return fclib_search_tree_lower_bound(tree, key);
+}
+FCLIB_API static inline size_t search_tree_upper_bound( //
+    const search_tree_t *tree,                          //
+    const void *key                                     //
+) {
+    return fclib_search_tree_upper_bound(tree, key);
+}
+FCLIB_API static inline arr_t *search_tree_batch( //
+    const search_tree_t *tree,                    //
+    arr_t *keys,                                  //
+    const bool upper                              //
+) {
+    return fclib_search_tree_batch(tree, keys, upper);
+}
+FCLIB_API static inline void search_tree_free(search_tree_t *tree) {
+    fclib_search_tree_free(tree);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+// The number of searches which are interleaved by the batch lookups
+#define FCLIB_SEARCH_GROUP 16
+// The number of keys a thread should at least get in a batch lookup
+#define FCLIB_SEARCH_GRAIN 4096
+// The size of a cache line, one line holds the 2^k children k levels below a
+// node of a search tree for elements of 64 / 2^k bytes
+#define FCLIB_SEARCH_LINE 64
+
+// Whether the element `value` comes before the bound of `key`
+#define FCLIB_SEARCH_BEFORE(value, key, upper)                                 \
+    (((value) < (key)) | ((upper) & ((value) == (key))))
+
+// Finds the bound of one key in `count` sorted elements
+typedef size_t (*fclib_search_bound_fn_t)( //
+    const void *data,                      //
+    const size_t count,                    //
+    const void *key,                       //
+    const bool upper                       //
+);
+
+// Finds the bounds of `key_count` keys in `count` sorted elements
+typedef void (*fclib_search_batch_fn_t)( //
+    const void *data,                    //
+    const size_t count,                  //
+    const void *keys,                    //
+    const size_t key_count,              //
+    const bool upper,                    //
+    size_t *bounds                       //
+);
+
+// Copies the sorted elements at the tree indices `begin` to `end` in order
+typedef void (*fclib_search_build_fn_t)( //
+    const fclib_search_tree_t *tree,     //
+    const void *data,                    //
+    const size_t begin,                  //
+    const size_t end                     //
+);
+
+// Finds the tree indices of the bounds of `key_count` keys
+typedef void (*fclib_search_descend_fn_t)( //
+    const fclib_search_tree_t *tree,       //
+    const void *keys,                      //
+    const size_t key_count,                //
+    const bool upper,                      //
+    size_t *bounds                         //
+);
+
+// Returns the index in the sorted array of the element at the tree index, or
+// the number of elements for the tree index 0 which stands for no element.
+//
+// In a full tree of `levels` levels the node at `index` is the odd multiple
+// (2 * position + 1) * 2^(levels - 1 - level) - 1 in order, the nodes of the
+// last level are the even ones. The missing nodes at the end of the last
+// level are the last of its nodes in order, so every missing node in front
+// of the node is subtracted
+static size_t fclib_search_tree_rank( //
+    const size_t len,                 //
+    const size_t index                //
+) {
+    if (index == 0) {
+        return len;
+    }
+    const unsigned int bits = sizeof(unsigned long long) * 8 - 1;
+    const unsigned int last = bits - (unsigned int)__builtin_clzll(len);
+    const unsigned int level = bits - (unsigned int)__builtin_clzll(index);
+    const size_t position = index - ((size_t)1 << level);
+    const size_t full = ((2 * position + 1) << (last - level)) - 1;
+    const size_t present = len - ((size_t)1 << last) + 1;
+    const size_t before = (full + 1) / 2;
+    return before > present ? full - (before - present) : full;
+}
+
+// Returns the number of levels of a tree of `len` nodes which are full, all
+// levels but the last one
+static inline unsigned int fclib_search_tree_levels(const size_t len) {
+    if (len == 0) {
+        return 0;
+    }
+    return (unsigned int)(sizeof(unsigned long long) * 8 - 1) -
+        (unsigned int)__builtin_clzll(len);
+}
+
+// Returns the tree index of the bound from the index the descent ended at.
+// The bound is the last node the descent went left at, the descent went
+// right at every node below it, so the trailing one bits are dropped
+static inline size_t fclib_search_tree_exit(const size_t index) {
+    return index >> __builtin_ffsll((long long)~index);
+}
+
+// Generates the search kernels for the element type T
+#define FCLIB_SEARCH_KERNELS(T, NAME)                                          \
+    static size_t fclib_search_bound_##NAME(const void *data,                  \
+        const size_t count, const void *key, const bool upper) {               \
+        const T *values = (const T *)data;                                     \
+        if (count == 0) {                                                      \
+            return 0;                                                          \
+        }                                                                      \
+        T x;                                                                   \
+        memcpy(&x, key, sizeof(T));                                            \
+        const T *base = values;                                                \
+        size_t len = count;                                                    \
+        while (len > 1) {                                                      \
+            const size_t half = len / 2;                                       \
+            /* Both elements the next step may compare are fetched ahead */   \
+            __builtin_prefetch(base + len / 4);                                \
+            __builtin_prefetch(base + half + len / 4);                         \
+            base += FCLIB_SEARCH_BEFORE(base[half - 1], x, upper) * half;      \
+            len -= half;                                                       \
+        }                                                                      \
+        return (size_t)(base - values) + FCLIB_SEARCH_BEFORE(*base, x, upper); \
+    }                                                                          \
+    static void fclib_search_batch_##NAME(const void *data,                    \
+        const size_t count, const void *keys, const size_t key_count,          \
+        const bool upper, size_t *bounds) {                                    \
+        const T *values = (const T *)data;                                     \
+        const T *key_values = (const T *)keys;                                 \
+        if (count == 0) {                                                      \
+            memset(bounds, 0, key_count * sizeof(size_t));                     \
+            return;                                                            \
+        }                                                                      \
+        for (size_t first = 0; first < key_count;                              \
+            first += FCLIB_SEARCH_GROUP) {                                     \
+            size_t group = key_count - first;                                  \
+            if (group > FCLIB_SEARCH_GROUP) {                                  \
+                group = FCLIB_SEARCH_GROUP;                                    \
+            }                                                                  \
+            const T *x = key_values + first;                                   \
+            size_t base[FCLIB_SEARCH_GROUP] = {0};                             \
+            /* The lengths only depend on the count, so all searches of the */ \
+            /* group take the same steps and advance together */              \
+            size_t len = count;                                                \
+            while (len > 1) {                                                  \
+                const size_t half = len / 2;                                   \
+                for (size_t g = 0; g < group; g++) {                           \
+                    base[g] += FCLIB_SEARCH_BEFORE(                            \
+                                   values[base[g] + half - 1], x[g], upper) *  \
+                        half;                                                  \
+                }                                                              \
+                len -= half;                                                   \
+            }                                                                  \
+            for (size_t g = 0; g < group; g++) {                               \
+                bounds[first + g] = base[g] +                                  \
+                    FCLIB_SEARCH_BEFORE(values[base[g]], x[g], upper);         \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+    static void fclib_search_build_##NAME(const fclib_search_tree_t *tree,     \
+        const void *data, const size_t begin, const size_t end) {              \
+        const T *values = (const T *)data;                                     \
+        T *nodes = (T *)(void *)tree->keys;                                    \
+        for (size_t index = begin; index < end; index++) {                     \
+            nodes[index] = values[fclib_search_tree_rank(tree->len, index)];   \
+        }                                                                      \
+    }                                                                          \
+    static void fclib_search_descend_##NAME(const fclib_search_tree_t *tree,   \
+        const void *keys, const size_t key_count, const bool upper,            \
+        size_t *bounds) {                                                      \
+        const T *nodes = (const T *)(const void *)tree->keys;                  \
+        const T *key_values = (const T *)keys;                                 \
+        const size_t len = tree->len;                                          \
+        const unsigned int levels = fclib_search_tree_levels(len);             \
+        for (size_t first = 0; first < key_count;                              \
+            first += FCLIB_SEARCH_GROUP) {                                     \
+            size_t group = key_count - first;                                  \
+            if (group > FCLIB_SEARCH_GROUP) {                                  \
+                group = FCLIB_SEARCH_GROUP;                                    \
+            }                                                                  \
+            const T *x = key_values + first;                                   \
+            size_t index[FCLIB_SEARCH_GROUP];                                  \
+            for (size_t g = 0; g < group; g++) {                               \
+                index[g] = 1;                                                  \
+            }                                                                  \
+            for (unsigned int level = 0; level < levels; level++) {            \
+                for (size_t g = 0; g < group; g++) {                           \
+                    /* The children a few levels down share the line at */    \
+                    /* index * 64 bytes, which is fetched while descending */ \
+                    __builtin_prefetch(                                        \
+                        tree->keys + index[g] * FCLIB_SEARCH_LINE);            \
+                    index[g] = 2 * index[g] +                                  \
+                        FCLIB_SEARCH_BEFORE(nodes[index[g]], x[g], upper);     \
+                }                                                              \
+            }                                                                  \
+            /* The last level may be incomplete, a missing node is treated */ \
+            /* like an element before the key so the exit skips over it */    \
+            for (size_t g = 0; g < group; g++) {                               \
+                const bool missing = index[g] > len;                           \
+                const size_t at = missing ? 0 : index[g];                      \
+                index[g] = 2 * index[g] +                                      \
+                    (missing | FCLIB_SEARCH_BEFORE(nodes[at], x[g], upper));   \
+                bounds[first + g] = fclib_search_tree_exit(index[g]);          \
+            }                                                                  \
+        }                                                                      \
+    }
+
+FCLIB_SEARCH_KERNELS(int8_t, i8)
+FCLIB_SEARCH_KERNELS(int16_t, i16)
+FCLIB_SEARCH_KERNELS(int32_t, i32)
+FCLIB_SEARCH_KERNELS(int64_t, i64)
+FCLIB_SEARCH_KERNELS(uint8_t, u8)
+FCLIB_SEARCH_KERNELS(uint16_t, u16)
+FCLIB_SEARCH_KERNELS(uint32_t, u32)
+FCLIB_SEARCH_KERNELS(uint64_t, u64)
+FCLIB_SEARCH_KERNELS(float, f32)
+FCLIB_SEARCH_KERNELS(double, f64)
+
+#undef FCLIB_SEARCH_KERNELS
+
+// The kernels of all types in the order of `arr_type_t`
+static const fclib_search_bound_fn_t fclib_search_bounds[] = {
+    fclib_search_bound_i8,
+    fclib_search_bound_i16,
+    fclib_search_bound_i32,
+    fclib_search_bound_i64,
+    fclib_search_bound_u8,
+    fclib_search_bound_u16,
+    fclib_search_bound_u32,
+    fclib_search_bound_u64,
+    fclib_search_bound_f32,
+    fclib_search_bound_f64,
+};
+static const fclib_search_batch_fn_t fclib_search_batches[] = {
+    fclib_search_batch_i8,
+    fclib_search_batch_i16,
+    fclib_search_batch_i32,
+    fclib_search_batch_i64,
+    fclib_search_batch_u8,
+    fclib_search_batch_u16,
+    fclib_search_batch_u32,
+    fclib_search_batch_u64,
+    fclib_search_batch_f32,
+    fclib_search_batch_f64,
+};
+static const fclib_search_build_fn_t fclib_search_builds[] = {
+    fclib_search_build_i8,
+    fclib_search_build_i16,
+    fclib_search_build_i32,
+    fclib_search_build_i64,
+    fclib_search_build_u8,
+    fclib_search_build_u16,
+    fclib_search_build_u32,
+    fclib_search_build_u64,
+    fclib_search_build_f32,
+    fclib_search_build_f64,
+};
+static const fclib_search_descend_fn_t fclib_search_descends[] = {
+    fclib_search_descend_i8,
+    fclib_search_descend_i16,
+    fclib_search_descend_i32,
+    fclib_search_descend_i64,
+    fclib_search_descend_u8,
+    fclib_search_descend_u16,
+    fclib_search_descend_u32,
+    fclib_search_descend_u64,
+    fclib_search_descend_f32,
+    fclib_search_descend_f64,
+};
+
+FCLIB_API size_t fclib_search_lower_bound( //
+    fclib_arr_t *arr,                      //
+    const fclib_arr_type_t type,           //
+    const void *key                        //
+) {
+    return fclib_search_bounds[type](
+        fclib_arr_get_data(arr), fclib_arr_get_len(arr), key, false);
+}
+
+FCLIB_API size_t fclib_search_upper_bound( //
+    fclib_arr_t *arr,                      //
+    const fclib_arr_type_t type,           //
+    const void *key                        //
+) {
+    return fclib_search_bounds[type](
+        fclib_arr_get_data(arr), fclib_arr_get_len(arr), key, true);
+}
+
+typedef struct fclib_search_job_t {
+    fclib_arr_type_t type;
+    size_t size;
+    // The sorted elements, or NULL when searching the tree
+    const char *data;
+    size_t count;
+    const fclib_search_tree_t *tree;
+    const char *keys;
+    bool upper;
+    size_t *bounds;
+} fclib_search_job_t;
+
+static void fclib_search_batch_range( //
+    void *context,                    //
+    const size_t begin,               //
+    const size_t end                  //
+) {
+    const fclib_search_job_t *job = (const fclib_search_job_t *)context;
+    const char *keys = job->keys + begin * job->size;
+    size_t *bounds = job->bounds + begin;
+    if (job->data != NULL) {
+        fclib_search_batches[job->type](
+            job->data, job->count, keys, end - begin, job->upper, bounds);
+        return;
+    }
+    const fclib_search_tree_t *tree = job->tree;
+    fclib_search_descends[job->type](
+        tree, keys, end - begin, job->upper, bounds);
+    for (size_t i = 0; i < end - begin; i++) {
+        bounds[i] = fclib_search_tree_rank(tree->len, bounds[i]);
+    }
+}
+
+// Runs a batch lookup of all keys, see `search_batch`
+static fclib_arr_t *fclib_search_run( //
+    fclib_search_job_t *job,          //
+    fclib_arr_t *keys                 //
+) {
+    const size_t key_count = fclib_arr_get_len(keys);
+    fclib_arr_t *result = fclib_arr_create(1, sizeof(size_t), &key_count);
+    if (result == NULL) {
+        return NULL;
+    }
+    job->size = fclib_arr_type_size(job->type);
+    job->keys = fclib_arr_get_data(keys);
+    job->bounds = FCLIB_ALIGNCAST(size_t, fclib_arr_get_data(result));
+    fclib_parallel_for(
+        key_count, FCLIB_SEARCH_GRAIN, fclib_search_batch_range, job);
+    return result;
+}
+
+FCLIB_API fclib_arr_t *fclib_search_batch( //
+    fclib_arr_t *arr,                      //
+    const fclib_arr_type_t type,           //
+    fclib_arr_t *keys,                     //
+    const bool upper                       //
+) {
+    fclib_search_job_t job;
+    job.type = type;
+    job.data = fclib_arr_get_data(arr);
+    job.count = fclib_arr_get_len(arr);
+    job.tree = NULL;
+    job.upper = upper;
+    return fclib_search_run(&job, keys);
+}
+
+typedef struct fclib_search_build_t {
+    const fclib_search_tree_t *tree;
+    const char *data;
+} fclib_search_build_t;
+
+static void fclib_search_build_range( //
+    void *context,                    //
+    const size_t begin,               //
+    const size_t end                  //
+) {
+    const fclib_search_build_t *build = (const fclib_search_build_t *)context;
+    // The tree index 0 is unused, so the range is shifted by one
+    fclib_search_builds[build->tree->type](
+        build->tree, build->data, begin + 1, end + 1);
+}
+
+FCLIB_API fclib_search_tree_t *fclib_search_tree_create( //
+    fclib_arr_t *arr,                                    //
+    const fclib_arr_type_t type                          //
+) {
+    const size_t len = fclib_arr_get_len(arr);
+    const size_t size = fclib_arr_type_size(type);
+    // The keys follow the tree in the same allocation, with room to move
+    // them to the next cache line
+    fclib_search_tree_t *tree = (fclib_search_tree_t *)malloc(
+        sizeof(fclib_search_tree_t) + FCLIB_SEARCH_LINE + (len + 1) * size);
+    if (tree == NULL) {
+        return NULL;
+    }
+    const uintptr_t start = (uintptr_t)(tree + 1);
+    const uintptr_t aligned = (start + FCLIB_SEARCH_LINE - 1) &
+        ~(uintptr_t)(FCLIB_SEARCH_LINE - 1);
+    tree->type = type;
+    tree->len = len;
+    tree->keys = (char *)(tree + 1) + (aligned - start);
+    memset(tree->keys, 0, size);
+    fclib_search_build_t build = {tree, fclib_arr_get_data(arr)};
+    fclib_parallel_for(
+        len, FCLIB_SEARCH_GRAIN, fclib_search_build_range, &build);
+    return tree;
+}
+
+FCLIB_API size_t fclib_search_tree_lower_bound( //
+    const fclib_search_tree_t *tree,            //
+    const void *key                             //
+) {
+    size_t index;
+    fclib_search_descends[tree->type](tree, key, 1, false, &index);
+    return fclib_search_tree_rank(tree->len, index);
+}
+
+FCLIB_API size_t fclib_search_tree_upper_bound( //
+    const fclib_search_tree_t *tree,            //
+    const void *key                             //
+) {
+    size_t index;
+    fclib_search_descends[tree->type](tree, key, 1, true, &index);
+    return fclib_search_tree_rank(tree->len, index);
+}
+
+FCLIB_API fclib_arr_t *fclib_search_tree_batch( //
+    const fclib_search_tree_t *tree,            //
+    fclib_arr_t *keys,                          //
+    const bool upper                            //
+) {
+    fclib_search_job_t job;
+    job.type = tree->type;
+    job.data = NULL;
+    job.count = tree->len;
+    job.tree = tree;
+    job.upper = upper;
+    return fclib_search_run(&job, keys);
+}
+
+FCLIB_API void fclib_search_tree_free(fclib_search_tree_t *tree) {
+    free(tree);
+}
+
+#undef FCLIB_SEARCH_GROUP
+#undef FCLIB_SEARCH_GRAIN
+#undef FCLIB_SEARCH_LINE
+#undef FCLIB_SEARCH_BEFORE
+
+#endif // endof FCLIB_IMPLEMENTATION
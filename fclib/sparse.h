@@ -0,0 +1,835 @@
+#pragma once
+
+#ifndef FCLIB_API
+#define FCLIB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arr.h"
+#include "parallel.h"
+
+#ifdef FCLIB_MINIMAL
+#error "sparse.h builds on arr_type_t, which is not part of FCLIB_MINIMAL"
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @enum `sparse_format_t`
+/// @brief The storage formats of sparse matrices. `COO` is a plain list of
+/// (row, column, value) entries in any order, which is cheap to build. `CSR`
+/// groups the entries by row and `CSC` by column, with the entries of every
+/// row (or column) sorted and free of duplicates, which is what the products
+/// compute on
+typedef enum fclib_sparse_format_t {
+    FCLIB_SPARSE_COO,
+    FCLIB_SPARSE_CSR,
+    FCLIB_SPARSE_CSC,
+} fclib_sparse_format_t;
+
+/// @typedef `sparse_t`
+/// @brief A two-dimensional sparse matrix, which only stores its non-zero
+/// entries. `inner` and `values` hold the `nnz` stored entries. In `COO`
+/// format `outer` holds the row and `inner` the column of every entry. In
+/// `CSR` format the entries of row r are [`outer[r]`, `outer[r + 1]`) and
+/// `inner` holds their columns, `CSC` is the same with rows and columns
+/// swapped. Only `FCLIB_ARR_TYPE_F32` and `FCLIB_ARR_TYPE_F64` values are
+/// supported.
+typedef struct fclib_sparse_t {
+    fclib_sparse_format_t format;
+    fclib_arr_type_t type;
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    // The number of entries `inner` and `values` have room for
+    size_t cap;
+    size_t *outer;
+    size_t *inner;
+    char *values;
+} fclib_sparse_t;
+
+/// @function `sparse_create`
+/// @brief Creates an empty sparse matrix in `COO` format, to which entries
+/// are added with `sparse_add`
+///
+/// @param `rows` The number of rows of the matrix
+/// @param `cols` The number of columns of the matrix
+/// @param `type` The type of the values, `F32` or `F64`
+/// @param `capacity` The number of entries to reserve room for
+/// @return `sparse_t *` The empty matrix, or NULL if the type is not supported
+/// or the allocation failed
+FCLIB_API fclib_sparse_t *fclib_sparse_create( //
+    const size_t rows,                         //
+    const size_t cols,                         //
+    const fclib_arr_type_t type,               //
+    const size_t capacity                      //
+);
+
+/// @function `sparse_add`
+/// @brief Adds an entry to a matrix in `COO` format. Entries may be added in
+/// any order, entries at the same position are summed up on conversion
+///
+/// @param `sparse` The `COO` matrix to add the entry to
+/// @param `row` The row of the entry
+/// @param `col` The column of the entry
+/// @param `value` The value of the entry
+/// @return `bool` Whether the entry was added, false if the matrix is not in
+/// `COO` format, the position is out of bounds or the allocation failed
+FCLIB_API bool fclib_sparse_add( //
+    fclib_sparse_t *sparse,      //
+    const size_t row,            //
+    const size_t col,            //
+    const void *value            //
+);
+
+/// @function `sparse_convert`
+/// @brief Converts the matrix into the given format. The entries are grouped
+/// by a single counting sort pass, after which every row (or column) is
+/// sorted on its own
+///
+/// @param `sparse` The matrix to convert
+/// @param `format` The format of the converted matrix
+/// @return `sparse_t *` The converted matrix, or NULL if an allocation failed
+FCLIB_API fclib_sparse_t *fclib_sparse_convert( //
+    const fclib_sparse_t *sparse,               //
+    const fclib_sparse_format_t format          //
+);
+
+/// @function `sparse_from_dense`
+/// @brief Creates a sparse matrix from the non-zero elements of the
+/// two-dimensional array, whose first dimension are the rows like in
+/// `linalg_matmul`
+///
+/// @param `arr` The dense matrix
+/// @param `type` The element type of the array, `F32` or `F64`
+/// @param `format` The format of the sparse matrix
+/// @return `sparse_t *` The sparse matrix, or NULL if the array is not
+/// two-dimensional, the type is not supported or an allocation failed
+FCLIB_API fclib_sparse_t *fclib_sparse_from_dense( //
+    const fclib_arr_t *arr,                        //
+    const fclib_arr_type_t type,                   //
+    const fclib_sparse_format_t format             //
+);
+
+/// @function `sparse_to_dense`
+/// @brief Creates the dense two-dimensional array of the sparse matrix
+///
+/// @param `sparse` The matrix to expand
+/// @return `arr_t *` The rows x cols array, or NULL if the allocation failed
+FCLIB_API fclib_arr_t *fclib_sparse_to_dense(const fclib_sparse_t *sparse);
+
+/// @function `sparse_matvec`
+/// @brief Multiplies the sparse matrix with the dense vector `x`, see
+/// `sparse_matmul_into`
+///
+/// @param `a` The matrix in `CSR` or `CSC` format
+/// @param `x` The one-dimensional vector with cols elements
+/// @return `arr_t *` The one-dimensional product with rows elements, or NULL
+/// if the matrix is in `COO` format, the shapes do not match or the
+/// allocation failed
+FCLIB_API fclib_arr_t *fclib_sparse_matvec( //
+    const fclib_sparse_t *a,                //
+    const fclib_arr_t *x                    //
+);
+
+/// @function `sparse_matmul`
+/// @brief Multiplies the sparse matrix with the dense matrix `b`, see
+/// `sparse_matmul_into`
+///
+/// @param `a` The matrix in `CSR` or `CSC` format
+/// @param `b` The dense matrix with cols rows and n columns
+/// @return `arr_t *` The dense rows x n product, or NULL if the matrix is in
+/// `COO` format, the shapes do not match or the allocation failed
+FCLIB_API fclib_arr_t *fclib_sparse_matmul( //
+    const fclib_sparse_t *a,                //
+    const fclib_arr_t *b                    //
+);
+
+/// @function `sparse_matmul_into`
+/// @brief Multiplies the sparse matrix `a` with the dense vector or matrix
+/// `b` into `c`, either overwriting it (c = a * b) or adding to it (c += a *
+/// b). `b` and `c` are both one-dimensional vectors or both two-dimensional
+/// matrices of the value type of `a`, and `c` must not overlap `b`. The work
+/// grows with nnz * n instead of rows * cols * n.
+///
+/// A `CSR` matrix is split into row ranges with about the same number of
+/// entries, one per thread. A `CSC` matrix scatters its columns into `c`, so
+/// it is only split across the columns of `b`, which makes `CSR` the better
+/// format for matrix-vector products.
+///
+/// @param `c` The dense product with rows elements or rows x n elements
+/// @param `a` The matrix in `CSR` or `CSC` format
+/// @param `b` The dense vector with cols elements or matrix with cols x n
+/// elements
+/// @param `accumulate` Whether to add the product to `c` instead of
+/// overwriting it
+/// @return `bool` Whether the product was computed, false if the matrix is in
+/// `COO` format or the shapes do not match
+FCLIB_API bool fclib_sparse_matmul_into( //
+    fclib_arr_t *c,                      //
+    const fclib_sparse_t *a,             //
+    const fclib_arr_t *b,                //
+    const bool accumulate                //
+);
+
+/// @function `sparse_free`
+/// @brief Frees the sparse matrix
+///
+/// @param `sparse` The matrix to free
+FCLIB_API void fclib_sparse_free(fclib_sparse_t *sparse);
+
+// #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
+#ifdef FCLIB_STRIP_PREFIXES
+
+typedef fclib_sparse_format_t sparse_format_t;
+typedef fclib_sparse_t sparse_t;
+
+FCLIB_API static inline sparse_t *sparse_create( //
+    const size_t rows,                           //
+    const size_t cols,                           //
+    const arr_type_t type,                       //
+    const size_t capacity                        //
+) {
+    return fclib_sparse_create(rows, cols, type, capacity);
+}
+FCLIB_API static inline bool sparse_add( //
+    sparse_t *sparse,                    //
+    const size_t row,                    //
+    const size_t col,                    //
+    const void *value                    //
+) {
+    return fclib_sparse_add(sparse, row, col, value);
+}
+FCLIB_API static inline sparse_t *sparse_convert( //
+    const sparse_t *sparse,                       //
+    const sparse_format_t format                  //
+) {
+    return fclib_sparse_convert(sparse, format);
+}
+FCLIB_API static inline sparse_t *sparse_from_dense( //
+    const arr_t *arr,                                //
+    const arr_type_t type,                           //
+    const sparse_format_t format                     //
+) {
+    return fclib_sparse_from_dense(arr, type, format);
+}
+FCLIB_API static inline arr_t *sparse_to_dense(const sparse_t *sparse) {
+    return fclib_sparse_to_dense(sparse);
+}
+FCLIB_API static inline arr_t *sparse_matvec( //
+    const sparse_t *a,                        //
+    const arr_t *x                            //
+) {
+    return fclib_sparse_matvec(a, x);
+}
+FCLIB_API static inline arr_t *sparse_matmul( //
+    const sparse_t *a,                        //
+    const arr_t *b                            //
+) {
+    return fclib_sparse_matmul(a, b);
+}
+FCLIB_API static inline bool sparse_matmul_into( //
+    arr_t *c,                                    //
+    const sparse_t *a,                           //
+    const arr_t *b,                              //
+    const bool accumulate                        //
+) {
+    return fclib_sparse_matmul_into(c, a, b, accumulate);
+}
+FCLIB_API static inline void sparse_free(sparse_t *sparse) {
+    fclib_sparse_free(sparse);
+}
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+// The number of entries of a CSR matrix which form one unit of work when its
+// rows are split across threads
+#define FCLIB_SPARSE_CHUNK 4096
+// The number of multiply-adds below which a product runs on a single thread
+#define FCLIB_SPARSE_PARALLEL_MIN (1 << 16)
+
+// Allocates a matrix with room for `cap` entries and `outer_len` elements in
+// `outer`, all arrays get at least one element so NULL always means failure
+static fclib_sparse_t *fclib_sparse_alloc( //
+    const fclib_sparse_format_t format,    //
+    const fclib_arr_type_t type,           //
+    const size_t rows,                     //
+    const size_t cols,                     //
+    const size_t cap,                      //
+    const size_t outer_len                 //
+) {
+    fclib_sparse_t *sparse = (fclib_sparse_t *)malloc(sizeof(fclib_sparse_t));
+    if (sparse == NULL) {
+        return NULL;
+    }
+    sparse->format = format;
+    sparse->type = type;
+    sparse->rows = rows;
+    sparse->cols = cols;
+    sparse->nnz = 0;
+    sparse->cap = cap == 0 ? 1 : cap;
+    sparse->outer = (size_t *)malloc( //
+        (outer_len == 0 ? 1 : outer_len) * sizeof(size_t));
+    sparse->inner = (size_t *)malloc(sparse->cap * sizeof(size_t));
+    sparse->values = (char *)malloc(sparse->cap * fclib_arr_type_size(type));
+    if (sparse->outer == NULL || sparse->inner == NULL ||
+        sparse->values == NULL) {
+        fclib_sparse_free(sparse);
+        return NULL;
+    }
+    return sparse;
+}
+
+// Writes the row and column of every entry into `rows` and `cols`
+static void fclib_sparse_expand(  //
+    const fclib_sparse_t *sparse, //
+    size_t *rows,                 //
+    size_t *cols                  //
+) {
+    if (sparse->format == FCLIB_SPARSE_COO) {
+        memcpy(rows, sparse->outer, sparse->nnz * sizeof(size_t));
+        memcpy(cols, sparse->inner, sparse->nnz * sizeof(size_t));
+        return;
+    }
+    const bool by_rows = sparse->format == FCLIB_SPARSE_CSR;
+    size_t *const majors = by_rows ? rows : cols;
+    size_t *const minors = by_rows ? cols : rows;
+    const size_t major_count = by_rows ? sparse->rows : sparse->cols;
+    for (size_t major = 0; major < major_count; major++) {
+        for (size_t e = sparse->outer[major]; e < sparse->outer[major + 1];
+             e++) {
+            majors[e] = major;
+        }
+    }
+    memcpy(minors, sparse->inner, sparse->nnz * sizeof(size_t));
+}
+
+// Adds the value `src` to the value `dest`
+static void fclib_sparse_add_value( //
+    char *dest,                     //
+    const char *src,                //
+    const fclib_arr_type_t type     //
+) {
+    if (type == FCLIB_ARR_TYPE_F32) {
+        float a, b;
+        memcpy(&a, dest, sizeof(float));
+        memcpy(&b, src, sizeof(float));
+        a += b;
+        memcpy(dest, &a, sizeof(float));
+    } else {
+        double a, b;
+        memcpy(&a, dest, sizeof(double));
+        memcpy(&b, src, sizeof(double));
+        a += b;
+        memcpy(dest, &a, sizeof(double));
+    }
+}
+
+// Swaps the entries `i` and `j` of a segment
+static void fclib_sparse_swap( //
+    size_t *inner,             //
+    char *values,              //
+    const size_t size,         //
+    const size_t i,            //
+    const size_t j             //
+) {
+    const size_t index = inner[i];
+    inner[i] = inner[j];
+    inner[j] = index;
+    char value[sizeof(double)];
+    memcpy(value, values + i * size, size);
+    memcpy(values + i * size, values + j * size, size);
+    memcpy(values + j * size, value, size);
+}
+
+static void fclib_sparse_sift_down( //
+    size_t *inner,                  //
+    char *values,                   //
+    const size_t size,              //
+    size_t root,                    //
+    const size_t count              //
+) {
+    while (2 * root + 1 < count) {
+        size_t child = 2 * root + 1;
+        if (child + 1 < count && inner[child] < inner[child + 1]) {
+            child++;
+        }
+        if (inner[root] >= inner[child]) {
+            return;
+        }
+        fclib_sparse_swap(inner, values, size, root, child);
+        root = child;
+    }
+}
+
+// Sorts the entries of the segment of one row (or column) by their minor
+// index. Segments are mostly short or already sorted, where insertion sort is
+// fastest, so only long unsorted ones are heap sorted to stay O(n log n)
+static void fclib_sparse_sort_segment( //
+    size_t *inner,                     //
+    char *values,                      //
+    const size_t size,                 //
+    const size_t count                 //
+) {
+    bool sorted = true;
+    for (size_t i = 1; i < count && sorted; i++) {
+        sorted = inner[i - 1] <= inner[i];
+    }
+    if (sorted) {
+        return;
+    }
+    if (count <= 32) {
+        for (size_t i = 1; i < count; i++) {
+            for (size_t j = i; j > 0 && inner[j - 1] > inner[j]; j--) {
+                fclib_sparse_swap(inner, values, size, j - 1, j);
+            }
+        }
+        return;
+    }
+    for (size_t i = count / 2; i-- > 0;) {
+        fclib_sparse_sift_down(inner, values, size, i, count);
+    }
+    for (size_t end = count; end-- > 1;) {
+        fclib_sparse_swap(inner, values, size, 0, end);
+        fclib_sparse_sift_down(inner, values, size, 0, end);
+    }
+}
+
+FCLIB_API fclib_sparse_t *fclib_sparse_create( //
+    const size_t rows,                         //
+    const size_t cols,                         //
+    const fclib_arr_type_t type,               //
+    const size_t capacity                      //
+) {
+    if (type != FCLIB_ARR_TYPE_F32 && type != FCLIB_ARR_TYPE_F64) {
+        return NULL;
+    }
+    return fclib_sparse_alloc( //
+        FCLIB_SPARSE_COO, type, rows, cols, capacity, capacity);
+}
+
+FCLIB_API bool fclib_sparse_add( //
+    fclib_sparse_t *sparse,      //
+    const size_t row,            //
+    const size_t col,            //
+    const void *value            //
+) {
+    if (sparse->format != FCLIB_SPARSE_COO || row >= sparse->rows ||
+        col >= sparse->cols) {
+        return false;
+    }
+    const size_t size = fclib_arr_type_size(sparse->type);
+    if (sparse->nnz == sparse->cap) {
+        // Every array is replaced as soon as it has grown, so the matrix stays
+        // intact if growing a later one fails
+        const size_t cap = sparse->cap * 2;
+        size_t *outer = (size_t *)realloc( //
+            sparse->outer, cap * sizeof(size_t));
+        if (outer == NULL) {
+            return false;
+        }
+        sparse->outer = outer;
+        size_t *inner = (size_t *)realloc( //
+            sparse->inner, cap * sizeof(size_t));
+        if (inner == NULL) {
+            return false;
+        }
+        sparse->inner = inner;
+        char *values = (char *)realloc(sparse->values, cap * size);
+        if (values == NULL) {
+            return false;
+        }
+        sparse->values = values;
+        sparse->cap = cap;
+    }
+    sparse->outer[sparse->nnz] = row;
+    sparse->inner[sparse->nnz] = col;
+    memcpy(sparse->values + sparse->nnz * size, value, size);
+    sparse->nnz++;
+    return true;
+}
+
+FCLIB_API fclib_sparse_t *fclib_sparse_convert( //
+    const fclib_sparse_t *sparse,               //
+    const fclib_sparse_format_t format          //
+) {
+    const size_t nnz = sparse->nnz;
+    const size_t size = fclib_arr_type_size(sparse->type);
+    if (format == FCLIB_SPARSE_COO) {
+        fclib_sparse_t *result = fclib_sparse_alloc( //
+            format, sparse->type, sparse->rows, sparse->cols, nnz, nnz);
+        if (result == NULL) {
+            return NULL;
+        }
+        fclib_sparse_expand(sparse, result->outer, result->inner);
+        memcpy(result->values, sparse->values, nnz * size);
+        result->nnz = nnz;
+        return result;
+    }
+    const bool by_rows = format == FCLIB_SPARSE_CSR;
+    const size_t major_count = by_rows ? sparse->rows : sparse->cols;
+    fclib_sparse_t *result = fclib_sparse_alloc( //
+        format, sparse->type, sparse->rows, sparse->cols, nnz, major_count + 1);
+    const size_t alloc_count = nnz == 0 ? 1 : nnz;
+    size_t *majors = (size_t *)malloc(alloc_count * sizeof(size_t));
+    size_t *minors = (size_t *)malloc(alloc_count * sizeof(size_t));
+    if (result == NULL || majors == NULL || minors == NULL) {
+        if (result != NULL) {
+            fclib_sparse_free(result);
+        }
+        free(majors);
+        free(minors);
+        return NULL;
+    }
+    if (by_rows) {
+        fclib_sparse_expand(sparse, majors, minors);
+    } else {
+        fclib_sparse_expand(sparse, minors, majors);
+    }
+    // Counting sort by the major index, `outer` serves as the write cursor of
+    // every segment and is shifted back to the segment starts afterwards
+    size_t *outer = result->outer;
+    memset(outer, 0, (major_count + 1) * sizeof(size_t));
+    for (size_t e = 0; e < nnz; e++) {
+        outer[majors[e] + 1]++;
+    }
+    for (size_t major = 0; major < major_count; major++) {
+        outer[major + 1] += outer[major];
+    }
+    for (size_t e = 0; e < nnz; e++) {
+        const size_t i = outer[majors[e]]++;
+        result->inner[i] = minors[e];
+        memcpy(result->values + i * size, sparse->values + e * size, size);
+    }
+    memmove(outer + 1, outer, major_count * sizeof(size_t));
+    outer[0] = 0;
+    free(majors);
+    free(minors);
+    // Every segment is sorted on its own, then entries at the same position
+    // are adjacent and get summed up while the segments are compacted
+    size_t count = 0;
+    for (size_t major = 0; major < major_count; major++) {
+        const size_t begin = outer[major];
+        const size_t end = outer[major + 1];
+        fclib_sparse_sort_segment(result->inner + begin,
+            result->values + begin * size, size, end - begin);
+        outer[major] = count;
+        for (size_t e = begin; e < end; e++) {
+            if (count > outer[major] &&
+                result->inner[count - 1] == result->inner[e]) {
+                fclib_sparse_add_value(result->values + (count - 1) * size,
+                    result->values + e * size, sparse->type);
+                continue;
+            }
+            result->inner[count] = result->inner[e];
+            memmove(result->values + count * size, result->values + e * size,
+                size);
+            count++;
+        }
+    }
+    outer[major_count] = count;
+    result->nnz = count;
+    return result;
+}
+
+FCLIB_API fclib_sparse_t *fclib_sparse_from_dense( //
+    const fclib_arr_t *arr,                        //
+    const fclib_arr_type_t type,                   //
+    const fclib_sparse_format_t format             //
+) {
+    if (arr->len != 2 ||
+        (type != FCLIB_ARR_TYPE_F32 && type != FCLIB_ARR_TYPE_F64)) {
+        return NULL;
+    }
+    const size_t *dims = FCLIB_ALIGNCAST(const size_t, arr->value);
+    const size_t rows = dims[0];
+    const size_t cols = dims[1];
+    const size_t size = fclib_arr_type_size(type);
+    const char *data = arr->value + arr->len * sizeof(size_t);
+    // The columns of the array are contiguous, so it is read in CSC order
+    size_t nnz = 0;
+    for (size_t i = 0; i < rows * cols; i++) {
+        if (type == FCLIB_ARR_TYPE_F32
+                ? ((const float *)(const void *)data)[i] != 0.0f
+                : ((const double *)(const void *)data)[i] != 0.0) {
+            nnz++;
+        }
+    }
+    fclib_sparse_t *csc = fclib_sparse_alloc( //
+        FCLIB_SPARSE_CSC, type, rows, cols, nnz, cols + 1);
+    if (csc == NULL) {
+        return NULL;
+    }
+    csc->outer[0] = 0;
+    for (size_t col = 0; col < cols; col++) {
+        for (size_t row = 0; row < rows; row++) {
+            const size_t i = col * rows + row;
+            if (type == FCLIB_ARR_TYPE_F32
+                    ? ((const float *)(const void *)data)[i] != 0.0f
+                    : ((const double *)(const void *)data)[i] != 0.0) {
+                csc->inner[csc->nnz] = row;
+                memcpy(csc->values + csc->nnz * size, data + i * size, size);
+                csc->nnz++;
+            }
+        }
+        csc->outer[col + 1] = csc->nnz;
+    }
+    if (format == FCLIB_SPARSE_CSC) {
+        return csc;
+    }
+    fclib_sparse_t *result = fclib_sparse_convert(csc, format);
+    fclib_sparse_free(csc);
+    return result;
+}
+
+FCLIB_API fclib_arr_t *fclib_sparse_to_dense(const fclib_sparse_t *sparse) {
+    const size_t size = fclib_arr_type_size(sparse->type);
+    const size_t lengths[2] = {sparse->rows, sparse->cols};
+    fclib_arr_t *arr = fclib_arr_create(2, size, lengths);
+    if (arr == NULL) {
+        return NULL;
+    }
+    char *data = arr->value + arr->len * sizeof(size_t);
+    // All bits zero is 0.0 for both float types
+    memset(data, 0, sparse->rows * sparse->cols * size);
+    for (size_t major = 0, e = 0; e < sparse->nnz; e++) {
+        size_t row, col;
+        if (sparse->format == FCLIB_SPARSE_COO) {
+            row = sparse->outer[e];
+            col = sparse->inner[e];
+        } else {
+            while (sparse->outer[major + 1] <= e) {
+                major++;
+            }
+            const bool by_rows = sparse->format == FCLIB_SPARSE_CSR;
+            row = by_rows ? major : sparse->inner[e];
+            col = by_rows ? sparse->inner[e] : major;
+        }
+        fclib_sparse_add_value(data + (col * sparse->rows + row) * size,
+            sparse->values + e * size, sparse->type);
+    }
+    return arr;
+}
+
+typedef struct fclib_sparse_product_t fclib_sparse_product_t;
+
+// Computes a part of the product, a range of rows of `c` for CSR matrices and
+// a range of columns of `c` for CSC matrices
+typedef void (*fclib_sparse_kernel_t)( //
+    const fclib_sparse_product_t *p,   //
+    const size_t first,                //
+    const size_t last                  //
+);
+
+struct fclib_sparse_product_t {
+    fclib_sparse_kernel_t kernel;
+    const fclib_sparse_t *a;
+    const char *b;
+    char *c;
+    size_t n;
+    size_t chunks;
+    bool accumulate;
+};
+
+// Generates the CSR and CSC kernels for the value type T. A CSR row is a dot
+// product of its entries with a column of `b`, a CSC column scatters its
+// entries scaled by one element of `b` into a column of `c`
+#define FCLIB_SPARSE_KERNELS(T, NAME)                                          \
+    static void fclib_sparse_csr_##NAME(                                       \
+        const fclib_sparse_product_t *p, const size_t first,                   \
+        const size_t last) {                                                   \
+        const fclib_sparse_t *a = p->a;                                        \
+        const T *values = (const T *)(const void *)a->values;                  \
+        for (size_t j = 0; j < p->n; j++) {                                    \
+            const T *b = (const T *)(const void *)p->b + j * a->cols;          \
+            T *c = (T *)(void *)p->c + j * a->rows;                            \
+            for (size_t row = first; row < last; row++) {                      \
+                T sum = 0;                                                     \
+                for (size_t e = a->outer[row]; e < a->outer[row + 1]; e++) {   \
+                    sum += values[e] * b[a->inner[e]];                         \
+                }                                                              \
+                c[row] = p->accumulate ? c[row] + sum : sum;                   \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+    static void fclib_sparse_csc_##NAME(                                       \
+        const fclib_sparse_product_t *p, const size_t first,                   \
+        const size_t last) {                                                   \
+        const fclib_sparse_t *a = p->a;                                        \
+        const T *values = (const T *)(const void *)a->values;                  \
+        for (size_t j = first; j < last; j++) {                                \
+            const T *b = (const T *)(const void *)p->b + j * a->cols;          \
+            T *c = (T *)(void *)p->c + j * a->rows;                            \
+            if (!p->accumulate) {                                              \
+                for (size_t row = 0; row < a->rows; row++) {                   \
+                    c[row] = 0;                                                \
+                }                                                              \
+            }                                                                  \
+            for (size_t col = 0; col < a->cols; col++) {                       \
+                const T scale = b[col];                                        \
+                for (size_t e = a->outer[col]; e < a->outer[col + 1]; e++) {   \
+                    c[a->inner[e]] += values[e] * scale;                       \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    }
+
+FCLIB_SPARSE_KERNELS(float, f32)
+FCLIB_SPARSE_KERNELS(double, f64)
+
+// Returns the first row whose entries start at or after the entry `e`
+static size_t fclib_sparse_first_row( //
+    const fclib_sparse_t *a,          //
+    const size_t e                    //
+) {
+    size_t low = 0;
+    size_t high = a->rows;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (a->outer[mid] < e) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Maps a range of entry chunks to the rows starting in them, so consecutive
+// ranges get consecutive rows and every row is computed exactly once
+static void fclib_sparse_csr_range( //
+    void *context,                  //
+    const size_t begin,             //
+    const size_t end                //
+) {
+    const fclib_sparse_product_t *p = (const fclib_sparse_product_t *)context;
+    size_t first = 0;
+    if (begin > 0) {
+        first = fclib_sparse_first_row(p->a, begin * FCLIB_SPARSE_CHUNK);
+    }
+    size_t last = p->a->rows;
+    if (end < p->chunks) {
+        last = fclib_sparse_first_row(p->a, end * FCLIB_SPARSE_CHUNK);
+    }
+    p->kernel(p, first, last);
+}
+
+static void fclib_sparse_csc_range( //
+    void *context,                  //
+    const size_t begin,             //
+    const size_t end                //
+) {
+    const fclib_sparse_product_t *p = (const fclib_sparse_product_t *)context;
+    p->kernel(p, begin, end);
+}
+
+FCLIB_API fclib_arr_t *fclib_sparse_matvec( //
+    const fclib_sparse_t *a,                //
+    const fclib_arr_t *x                    //
+) {
+    if (x->len != 1) {
+        return NULL;
+    }
+    fclib_arr_t *y = fclib_arr_create( //
+        1, fclib_arr_type_size(a->type), &a->rows);
+    if (y == NULL) {
+        return NULL;
+    }
+    if (!fclib_sparse_matmul_into(y, a, x, false)) {
+        free(y);
+        return NULL;
+    }
+    return y;
+}
+
+FCLIB_API fclib_arr_t *fclib_sparse_matmul( //
+    const fclib_sparse_t *a,                //
+    const fclib_arr_t *b                    //
+) {
+    if (b->len != 2) {
+        return NULL;
+    }
+    const size_t *b_dims = FCLIB_ALIGNCAST(const size_t, b->value);
+    const size_t lengths[2] = {a->rows, b_dims[1]};
+    fclib_arr_t *c = fclib_arr_create(2, fclib_arr_type_size(a->type), lengths);
+    if (c == NULL) {
+        return NULL;
+    }
+    if (!fclib_sparse_matmul_into(c, a, b, false)) {
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+FCLIB_API bool fclib_sparse_matmul_into( //
+    fclib_arr_t *c,                      //
+    const fclib_sparse_t *a,             //
+    const fclib_arr_t *b,                //
+    const bool accumulate                //
+) {
+    if (a->format == FCLIB_SPARSE_COO || b->len != c->len ||
+        (b->len != 1 && b->len != 2)) {
+        return false;
+    }
+    const size_t *b_dims = FCLIB_ALIGNCAST(const size_t, b->value);
+    const size_t *c_dims = FCLIB_ALIGNCAST(const size_t, c->value);
+    const size_t n = b->len == 2 ? b_dims[1] : 1;
+    if (b_dims[0] != a->cols || c_dims[0] != a->rows ||
+        (b->len == 2 && c_dims[1] != n)) {
+        return false;
+    }
+    const bool is_f32 = a->type == FCLIB_ARR_TYPE_F32;
+    fclib_sparse_product_t p;
+    p.a = a;
+    p.b = b->value + b->len * sizeof(size_t);
+    p.c = c->value + c->len * sizeof(size_t);
+    p.n = n;
+    p.accumulate = accumulate;
+    const bool parallel = a->nnz * n >= FCLIB_SPARSE_PARALLEL_MIN;
+    if (a->format == FCLIB_SPARSE_CSR) {
+        p.kernel = is_f32 ? fclib_sparse_csr_f32 : fclib_sparse_csr_f64;
+        if (!parallel) {
+            p.kernel(&p, 0, a->rows);
+            return true;
+        }
+        // A thread should get enough entries to amortize its start
+        p.chunks = (a->nnz + FCLIB_SPARSE_CHUNK - 1) / FCLIB_SPARSE_CHUNK;
+        fclib_parallel_for(p.chunks, 4, fclib_sparse_csr_range, &p);
+    } else {
+        p.kernel = is_f32 ? fclib_sparse_csc_f32 : fclib_sparse_csc_f64;
+        if (!parallel) {
+            p.kernel(&p, 0, n);
+            return true;
+        }
+        const size_t per_column = a->nnz == 0 ? 1 : a->nnz;
+        const size_t grain = FCLIB_SPARSE_PARALLEL_MIN / 4 / per_column;
+        fclib_parallel_for(n, grain, fclib_sparse_csc_range, &p);
+    }
+    return true;
+}
+
+FCLIB_API void fclib_sparse_free(fclib_sparse_t *sparse) {
+    free(sparse->outer);
+    free(sparse->inner);
+    free(sparse->values);
+    free(sparse);
+}
+
+#undef FCLIB_SPARSE_KERNELS
+#undef FCLIB_SPARSE_CHUNK
+#undef FCLIB_SPARSE_PARALLEL_MIN
+
+#endif // endof FCLIB_IMPLEMENTATION
@@ -11,6 +11,7 @@ extern "C" {
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -267,6 +268,172 @@ typedef struct fclib_str_view_t {
 /// @return `str_view_t` A view into the given source string
 FCLIB_API fclib_str_view_t fclib_str_view_from_string(fclib_str_t *const src);
 
+/// @typedef `str_builder_t`
+/// @brief A string builder is a growable output buffer which produces a normal
+/// string once it is finished. The `str` field is a regular string whose `len`
+/// field is the number of bytes written so far, and `cap` is the number of
+/// bytes the string can hold before it needs to grow. The capacity grows
+/// geometrically, so appending `n` bytes in total costs amortized O(n) instead
+/// of the O(n^2) of repeated `str_append_lit` calls.
+typedef struct fclib_str_builder_t {
+    fclib_str_t *str;
+    size_t cap;
+} fclib_str_builder_t;
+
+/// @function `str_builder_init`
+/// @brief Creates a new, empty string builder which can hold at least
+/// `initial_capacity` bytes before it needs to grow
+///
+/// @param `initial_capacity` The number of bytes to reserve up front
+/// @return `str_builder_t` The new string builder
+FCLIB_API fclib_str_builder_t fclib_str_builder_init( //
+    const size_t initial_capacity                     //
+);
+
+/// @function `str_builder_reserve`
+/// @brief Makes sure that at least `additional` bytes can be written to the
+/// builder without it needing to grow and returns a pointer to the first free
+/// byte. The bytes written to that pointer only become part of the string once
+/// `str_builder_advance` is called.
+///
+/// @param `builder` The builder to reserve space in
+/// @param `additional` The number of bytes which will be written next
+/// @return `char *` Pointer to the first unwritten byte of the builder
+FCLIB_API char *fclib_str_builder_reserve( //
+    fclib_str_builder_t *builder,          //
+    const size_t additional                //
+);
+
+/// @function `str_builder_advance`
+/// @brief Commits `count` bytes which have been written to the pointer returned
+/// by the last `str_builder_reserve` call
+///
+/// @param `builder` The builder to advance
+/// @param `count` The number of bytes which have been written
+FCLIB_API void fclib_str_builder_advance( //
+    fclib_str_builder_t *builder,         //
+    const size_t count                    //
+);
+
+/// @function `str_builder_append_lit`
+/// @brief Appends `len` bytes of `value` to the builder
+///
+/// @param `builder` The builder to append to
+/// @param `value` The data to append
+/// @param `len` The number of bytes to append from `value`
+FCLIB_API void fclib_str_builder_append_lit( //
+    fclib_str_builder_t *builder,            //
+    const char *value,                       //
+    const size_t len                         //
+);
+
+/// @function `str_builder_append`
+/// @brief Appends the given string to the builder
+///
+/// @param `builder` The builder to append to
+/// @param `value` The string to append
+FCLIB_API void fclib_str_builder_append( //
+    fclib_str_builder_t *builder,        //
+    const fclib_str_t *value             //
+);
+
+/// @function `str_builder_append_char`
+/// @brief Appends a single character to the builder
+///
+/// @param `builder` The builder to append to
+/// @param `c` The character to append
+FCLIB_API void fclib_str_builder_append_char( //
+    fclib_str_builder_t *builder,             //
+    const char c                              //
+);
+
+/// @function `str_builder_append_i64`
+/// @brief Appends the decimal representation of `value` to the builder
+///
+/// @param `builder` The builder to append to
+/// @param `value` The value to format
+FCLIB_API void fclib_str_builder_append_i64( //
+    fclib_str_builder_t *builder,            //
+    const int64_t value                      //
+);
+
+/// @function `str_builder_append_u64`
+/// @brief Appends the decimal representation of `value` to the builder
+///
+/// @param `builder` The builder to append to
+/// @param `value` The value to format
+FCLIB_API void fclib_str_builder_append_u64( //
+    fclib_str_builder_t *builder,            //
+    const uint64_t value                     //
+);
+
+/// @function `str_builder_append_f64`
+/// @brief Appends `value` formatted like `str_format_f64`, which parses back to
+/// exactly the same double
+///
+/// @param `builder` The builder to append to
+/// @param `value` The value to format
+FCLIB_API void fclib_str_builder_append_f64( //
+    fclib_str_builder_t *builder,            //
+    const double value                       //
+);
+
+/// @function `str_builder_finish`
+/// @brief Finishes the builder, shrinking its string to the written length and
+/// returning it. The builder is empty afterwards and must not be used again
+/// unless it is re-initialized.
+///
+/// @param `builder` The builder to finish
+/// @return `str_t *` The built string, owned by the caller
+FCLIB_API fclib_str_t *fclib_str_builder_finish(fclib_str_builder_t *builder);
+
+/// @function `str_builder_free`
+/// @brief Frees the builder and everything written to it so far
+///
+/// @param `builder` The builder to free
+FCLIB_API void fclib_str_builder_free(fclib_str_builder_t *builder);
+
+/// @function `str_format_u64`
+/// @brief Writes the decimal representation of `value` to `buffer`. The buffer
+/// needs to hold at least 20 bytes, no null terminator is written.
+///
+/// @param `buffer` The buffer to write the digits to
+/// @param `value` The value to format
+/// @return `size_t` The number of characters written
+FCLIB_API size_t fclib_str_format_u64(char *buffer, const uint64_t value);
+
+/// @function `str_format_i64`
+/// @brief Writes the decimal representation of `value` to `buffer`. The buffer
+/// needs to hold at least 20 bytes, no null terminator is written.
+///
+/// @param `buffer` The buffer to write the digits to
+/// @param `value` The value to format
+/// @return `size_t` The number of characters written
+FCLIB_API size_t fclib_str_format_i64(char *buffer, const int64_t value);
+
+/// @function `str_format_f64`
+/// @brief Writes `value` to `buffer` using the shortest of `%.15g`, `%.16g`
+/// and `%.17g` which parses back to exactly the same double. This is usually,
+/// but not always, the shortest possible representation. Integral values below
+/// 2^53 take a fast path which never touches `snprintf`. NaN and infinities are
+/// written as `nan`, `inf` and `-inf`. The buffer needs to hold at least 32
+/// bytes, no null terminator is written.
+///
+/// @param `buffer` The buffer to write the number to
+/// @param `value` The value to format
+/// @return `size_t` The number of characters written
+FCLIB_API size_t fclib_str_format_f64(char *buffer, const double value);
+
+/// @function `str_format_f32`
+/// @brief Writes `value` to `buffer` using the shortest of `%.6g` through
+/// `%.9g` which parses back to exactly the same float. Behaves like
+/// `str_format_f64` otherwise.
+///
+/// @param `buffer` The buffer to write the number to
+/// @param `value` The value to format
+/// @return `size_t` The number of characters written
+FCLIB_API size_t fclib_str_format_f32(char *buffer, const float value);
+
 #endif // endof FCLIB_MINIMAL
 
 // #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
@@ -349,6 +516,93 @@ FCLIB_API static inline str_view_t str_view_from_string(str_t *const src) {
     return fclib_str_view_from_string(src);
 }
 
+typedef fclib_str_builder_t str_builder_t;
+
+FCLIB_API static inline str_builder_t str_builder_init( //
+    const size_t initial_capacity                       //
+) {
+    return fclib_str_builder_init(initial_capacity);
+}
+FCLIB_API static inline char *str_builder_reserve( //
+    str_builder_t *builder,                        //
+    const size_t additional                        //
+) {
+    return fclib_str_builder_reserve(builder, additional);
+}
+FCLIB_API static inline void str_builder_advance( //
+    str_builder_t *builder,                       //
+    const size_t count                            //
+) {
+    fclib_str_builder_advance(builder, count);
+}
+FCLIB_API static inline void str_builder_append_lit( //
+    str_builder_t *builder,                          //
+    const char *value,                               //
+    const size_t len                                 //
+) {
+    fclib_str_builder_append_lit(builder, value, len);
+}
+FCLIB_API static inline void str_builder_append( //
+    str_builder_t *builder,                      //
+    const str_t *value                           //
+) {
+    fclib_str_builder_append(builder, value);
+}
+FCLIB_API static inline void str_builder_append_char( //
+    str_builder_t *builder,                           //
+    const char c                                      //
+) {
+    fclib_str_builder_append_char(builder, c);
+}
+FCLIB_API static inline void str_builder_append_i64( //
+    str_builder_t *builder,                          //
+    const int64_t value                              //
+) {
+    fclib_str_builder_append_i64(builder, value);
+}
+FCLIB_API static inline void str_builder_append_u64( //
+    str_builder_t *builder,                          //
+    const uint64_t value                             //
+) {
+    fclib_str_builder_append_u64(builder, value);
+}
+FCLIB_API static inline void str_builder_append_f64( //
+    str_builder_t *builder,                          //
+    const double value                               //
+) {
+    fclib_str_builder_append_f64(builder, value);
+}
+FCLIB_API static inline str_t *str_builder_finish(str_builder_t *builder) {
+    return fclib_str_builder_finish(builder);
+}
+FCLIB_API static inline void str_builder_free(str_builder_t *builder) {
+    fclib_str_builder_free(builder);
+}
+FCLIB_API static inline size_t str_format_u64( //
+    char *buffer,                              //
+    const uint64_t value                       //
+) {
+    return fclib_str_format_u64(buffer, value);
+}
+FCLIB_API static inline size_t str_format_i64( //
+    char *buffer,                              //
+    const int64_t value                        //
+) {
+    return fclib_str_format_i64(buffer, value);
+}
+FCLIB_API static inline size_t str_format_f64( //
+    char *buffer,                              //
+    const double value                         //
+) {
+    return fclib_str_format_f64(buffer, value);
+}
+FCLIB_API static inline size_t str_format_f32( //
+    char *buffer,                              //
+    const float value                          //
+) {
+    return fclib_str_format_f32(buffer, value);
+}
+
 #endif // endof FCLIB_MINIMAL
 #endif // endof FCLIB_STRIP_PREFIXES
 
@@ -511,5 +765,225 @@ FCLIB_API fclib_str_view_t fclib_str_view_from_string(fclib_str_t *const src) {
     };
 }
 
+FCLIB_API fclib_str_builder_t fclib_str_builder_init( //
+    const size_t initial_capacity                     //
+) {
+    const size_t cap = initial_capacity < 16 ? 16 : initial_capacity;
+    fclib_str_t *str = (fclib_str_t *)malloc(sizeof(fclib_str_t) + cap + 1);
+    str->len = 0;
+    return (fclib_str_builder_t){
+        .str = str,
+        .cap = cap,
+    };
+}
+
+FCLIB_API char *fclib_str_builder_reserve( //
+    fclib_str_builder_t *builder,          //
+    const size_t additional                //
+) {
+    const size_t needed = builder->str->len + additional;
+    if (needed > builder->cap) {
+        // Grow geometrically so that many small appends stay amortized O(1)
+        size_t new_cap = builder->cap * 2;
+        if (new_cap < needed) {
+            new_cap = needed;
+        }
+        builder->str = (fclib_str_t *)realloc( //
+            builder->str, sizeof(fclib_str_t) + new_cap + 1);
+        builder->cap = new_cap;
+    }
+    return builder->str->value + builder->str->len;
+}
+
+FCLIB_API void fclib_str_builder_advance( //
+    fclib_str_builder_t *builder,         //
+    const size_t count                    //
+) {
+    builder->str->len += count;
+}
+
+FCLIB_API void fclib_str_builder_append_lit( //
+    fclib_str_builder_t *builder,            //
+    const char *value,                       //
+    const size_t len                         //
+) {
+    char *dest = fclib_str_builder_reserve(builder, len);
+    memcpy(dest, value, len);
+    builder->str->len += len;
+}
+
+FCLIB_API void fclib_str_builder_append( //
+    fclib_str_builder_t *builder,        //
+    const fclib_str_t *value             //
+) {
+    fclib_str_builder_append_lit(builder, value->value, value->len);
+}
+
+FCLIB_API void fclib_str_builder_append_char( //
+    fclib_str_builder_t *builder,             //
+    const char c                              //
+) {
+    char *dest = fclib_str_builder_reserve(builder, 1);
+    *dest = c;
+    builder->str->len++;
+}
+
+FCLIB_API void fclib_str_builder_append_i64( //
+    fclib_str_builder_t *builder,            //
+    const int64_t value                      //
+) {
+    char *dest = fclib_str_builder_reserve(builder, 20);
+    builder->str->len += fclib_str_format_i64(dest, value);
+}
+
+FCLIB_API void fclib_str_builder_append_u64( //
+    fclib_str_builder_t *builder,            //
+    const uint64_t value                     //
+) {
+    char *dest = fclib_str_builder_reserve(builder, 20);
+    builder->str->len += fclib_str_format_u64(dest, value);
+}
+
+FCLIB_API void fclib_str_builder_append_f64( //
+    fclib_str_builder_t *builder,            //
+    const double value                       //
+) {
+    char *dest = fclib_str_builder_reserve(builder, 32);
+    builder->str->len += fclib_str_format_f64(dest, value);
+}
+
+FCLIB_API fclib_str_t *fclib_str_builder_finish(fclib_str_builder_t *builder) {
+    const size_t len = builder->str->len;
+    fclib_str_t *result = (fclib_str_t *)realloc( //
+        builder->str, sizeof(fclib_str_t) + len + 1);
+    result->value[len] = 0;
+    builder->str = NULL;
+    builder->cap = 0;
+    return result;
+}
+
+FCLIB_API void fclib_str_builder_free(fclib_str_builder_t *builder) {
+    free(builder->str);
+    builder->str = NULL;
+    builder->cap = 0;
+}
+
+FCLIB_API size_t fclib_str_format_u64(char *buffer, const uint64_t value) {
+    // Two digits are emitted per division, which halves the number of the
+    // (comparatively slow) 64 bit divisions compared to a digit-by-digit loop
+    static const char digit_pairs[201] = "00010203040506070809"
+                                         "10111213141516171819"
+                                         "20212223242526272829"
+                                         "30313233343536373839"
+                                         "40414243444546474849"
+                                         "50515253545556575859"
+                                         "60616263646566676869"
+                                         "70717273747576777879"
+                                         "80818283848586878889"
+                                         "90919293949596979899";
+    // Count the digits up front so they can be written to their final place
+    // back to front, without an intermediate buffer
+    size_t len = 1;
+    uint64_t threshold = 10;
+    while (len < 20 && value >= threshold) {
+        len++;
+        threshold *= 10;
+    }
+    size_t pos = len;
+    uint64_t rest = value;
+    while (rest >= 100) {
+        const size_t pair = (size_t)(rest % 100) * 2;
+        rest /= 100;
+        buffer[--pos] = digit_pairs[pair + 1];
+        buffer[--pos] = digit_pairs[pair];
+    }
+    if (rest >= 10) {
+        const size_t pair = (size_t)rest * 2;
+        buffer[1] = digit_pairs[pair + 1];
+        buffer[0] = digit_pairs[pair];
+    } else {
+        buffer[0] = (char)('0' + rest);
+    }
+    return len;
+}
+
+FCLIB_API size_t fclib_str_format_i64(char *buffer, const int64_t value) {
+    if (value >= 0) {
+        return fclib_str_format_u64(buffer, (uint64_t)value);
+    }
+    buffer[0] = '-';
+    // Negate in unsigned space so that INT64_MIN does not overflow
+    return 1 + fclib_str_format_u64(buffer + 1, 0 - (uint64_t)value);
+}
+
+FCLIB_API size_t fclib_str_format_f64(char *buffer, const double value) {
+    if (value != value) {
+        memcpy(buffer, "nan", 3);
+        return 3;
+    }
+    if (value > 1.7976931348623157e308) {
+        memcpy(buffer, "inf", 3);
+        return 3;
+    }
+    if (value < -1.7976931348623157e308) {
+        memcpy(buffer, "-inf", 4);
+        return 4;
+    }
+    // Integral values which are exactly representable take the integer path
+    if (value > -9007199254740992.0 && value < 9007199254740992.0) {
+        const int64_t integral = (int64_t)value;
+        if ((double)integral == value) {
+            if (integral == 0 && 1.0 / value < 0) {
+                memcpy(buffer, "-0", 2);
+                return 2;
+            }
+            return fclib_str_format_i64(buffer, integral);
+        }
+    }
+    // Find the shortest precision which still round-trips. Nearly all doubles
+    // produced from decimal input round-trip at 15 digits, so most values only
+    // pay for a single format and parse
+    char tmp[32];
+    int len = 0;
+    for (int precision = 15; precision <= 17; precision++) {
+        len = snprintf(tmp, sizeof(tmp), "%.*g", precision, value);
+        if (precision == 17 || strtod(tmp, NULL) == value) {
+            break;
+        }
+    }
+    // The decimal separator of `snprintf` depends on the locale
+    for (int i = 0; i < len; i++) {
+        if (tmp[i] == ',') {
+            tmp[i] = '.';
+        }
+    }
+    memcpy(buffer, tmp, (size_t)len);
+    return (size_t)len;
+}
+
+FCLIB_API size_t fclib_str_format_f32(char *buffer, const float value) {
+    // Everything except the round-trip search is shared with the f64 path
+    if (value != value || value > 3.40282347e38f || value < -3.40282347e38f ||
+        (value > -16777216.0f && value < 16777216.0f &&
+            (float)(int32_t)value == value)) {
+        return fclib_str_format_f64(buffer, (double)value);
+    }
+    char tmp[32];
+    int len = 0;
+    for (int precision = 6; precision <= 9; precision++) {
+        len = snprintf(tmp, sizeof(tmp), "%.*g", precision, (double)value);
+        if (precision == 9 || strtof(tmp, NULL) == value) {
+            break;
+        }
+    }
+    for (int i = 0; i < len; i++) {
+        if (tmp[i] == ',') {
+            tmp[i] = '.';
+        }
+    }
+    memcpy(buffer, tmp, (size_t)len);
+    return (size_t)len;
+}
+
 #endif // endof FCLIB_MINIMAL
 #endif // endof FCLIB_IMPLEMENTATION
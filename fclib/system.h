@@ -1,5 +1,13 @@
 #pragma once
 
+// Command execution needs POSIX process APIs (kill, rusage) and GNU ones
+// (pipe2, vmsplice, environ) which are hidden without _GNU_SOURCE. This only
+// takes effect when this header is included before any system header,
+// otherwise compile with -D_GNU_SOURCE, which is checked below
+#if !defined(__WIN32__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #ifndef FCLIB_API
 #define FCLIB_API
 #endif
@@ -17,6 +25,17 @@ extern "C" {
 #include <direct.h>
 #define PATH_MAX 260
 #else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 #ifndef PATH_MAX
 #include <limits.h>
@@ -26,6 +45,12 @@ extern "C" {
 #endif
 #endif
 
+// glibc settles which APIs it declares at the first system header, so the
+// _GNU_SOURCE above comes too late if another header was included before
+#if defined(__GLIBC__) && !defined(__USE_GNU)
+#error "system.h needs _GNU_SOURCE, compile with -D_GNU_SOURCE"
+#endif
+
 #include "arr.h"
 #include "str.h"
 
@@ -39,16 +64,77 @@ int pclose(FILE *stream);
 #endif
 int fileno(FILE *stream);
 
+/// @typedef `command_usage_t`
+/// @brief The resources a command used, as reported by the kernel once it has
+/// been waited for. The CPU times, memory and I/O counts include all processes
+/// the command waited for itself. Times are in seconds, `max_rss` is in bytes
+/// and the I/O counts are in blocks of 512 bytes. Fields the platform does not
+/// report are 0.
+typedef struct fclib_command_usage_t {
+    double wall_time;
+    double user_time;
+    double system_time;
+    size_t max_rss;
+    size_t minor_faults;
+    size_t major_faults;
+    size_t input_blocks;
+    size_t output_blocks;
+    size_t voluntary_switches;
+    size_t involuntary_switches;
+} fclib_command_usage_t;
+
 /// @typedef `command_result_t`
-/// @brief The return value of the `system_command` function
+/// @brief The return value of the `system_command` function. If the command
+/// exited normally, `exited` is true and `exit_code` is its exit status. If it
+/// was killed by a signal, `term_signal` is that signal and `exit_code` is 128
+/// plus the signal number, like a shell reports it. Flint receives this struct
+/// by value, so under FCLIB_MINIMAL it only holds `exit_code` and `output`.
 typedef struct fclib_command_result_t {
     int exit_code;
     fclib_str_t *output;
+#ifndef FCLIB_MINIMAL
+    bool exited;
+    int term_signal;
+    bool core_dumped;
+    bool timed_out;
+    bool output_truncated;
+    fclib_command_usage_t usage;
+#endif
 } fclib_command_result_t;
 
+/// @typedef `command_options_t`
+/// @brief Limits applied to a single command. A command which runs longer than
+/// `timeout` seconds or produces more than `output_limit` bytes of output is
+/// sent SIGTERM, and SIGKILL if it is still alive `kill_grace` seconds later.
+/// Commands with a timeout or output limit run in their own process group, so
+/// everything they started is killed together with them. `cpu_limit` (in
+/// seconds of CPU time) and `memory_limit` (in bytes of address space) are
+/// enforced by the kernel through `setrlimit` in the child. A value of 0
+/// disables the respective limit. If `env` is not NULL, the command runs with
+/// that environment instead of the one of this process.
+typedef struct fclib_command_options_t {
+    double timeout;
+    double kill_grace;
+    uint64_t cpu_limit;
+    uint64_t memory_limit;
+    size_t output_limit;
+    struct fclib_env_t *env;
+} fclib_command_options_t;
+
+/// @typedef `pipeline_stage_t`
+/// @brief A single stage of a pipeline. `argv` is a one-dimensional array of
+/// `str_t *` holding the program and its arguments, the program is looked up
+/// in `PATH`. If `capture` is set, everything the stage writes to stdout is
+/// captured in addition to being passed on to the next stage.
+typedef struct fclib_pipeline_stage_t {
+    fclib_arr_t *argv;
+    bool capture;
+} fclib_pipeline_stage_t;
+
 /// @function `system_command`
 /// @brief Executes the given system command, captures all output and returns
-/// the output of the system command together with the exit code
+/// the output of the system command together with the exit code, the decoded
+/// termination status and the resources the command used
 ///
 /// @param `command` The command to execute
 /// @return `command_result_t` The result of the system command containing the
@@ -123,81 +209,1869 @@ FCLIB_API fclib_str_t *fclib_system_end_capture(void);
 /// @return `arr_t *` The captured output as an array of strings
 FCLIB_API fclib_arr_t *fclib_system_end_capture_lines(void);
 
+// FCLIB_MINIMAL controls whether to *only* emit symbols which are actually
+// present in Flint too, see `str.h` for more details
+#ifndef FCLIB_MINIMAL
+/// @typedef `env_var_t`
+/// @brief A variable of an environment, stored as `NAME=value` so it can be
+/// handed to a child process as it is. A removed variable only stores its name
+/// and hides the variable of the parent environment.
+typedef struct fclib_env_var_t {
+    uint64_t hash;
+    size_t name_len;
+    fclib_str_t *entry;
+    bool removed;
+} fclib_env_var_t;
+
+/// @typedef `env_t`
+/// @brief An environment, with its variables in a hash table by name. A
+/// derived environment only stores the variables which differ from its
+/// `parent` and shares all others with it, copy-on-write. The `envp` block for
+/// child processes is built when it is first needed and reused until the
+/// environment or one of its parents changes, so thousands of commands share
+/// the same block. A parent has to outlive all environments derived from it.
+typedef struct fclib_env_t {
+    struct fclib_env_t *parent;
+    fclib_env_var_t *vars;
+    size_t count;
+    size_t cap;
+    uint64_t version;
+    char **envp;
+    uint64_t envp_stamp;
+} fclib_env_t;
+
+/// @function `env_snapshot`
+/// @brief Parses the environment of this process into a new environment.
+/// Later changes to the process environment do not affect the snapshot.
+///
+/// @return `env_t *` The snapshot of the process environment
+FCLIB_API fclib_env_t *fclib_env_snapshot(void);
+
+/// @function `env_derive`
+/// @brief Creates an empty environment on top of `parent`. It sees all
+/// variables of the parent until it overrides or removes them, without
+/// copying any of them.
+///
+/// @param `parent` The environment to derive from
+/// @return `env_t *` The derived environment
+FCLIB_API fclib_env_t *fclib_env_derive(fclib_env_t *parent);
+
+/// @function `env_get`
+/// @brief Looks up a variable. The returned view stays valid until the
+/// variable is changed or the environment is freed.
+///
+/// @param `env` The environment to look the variable up in
+/// @param `name` The name of the variable
+/// @return `str_view_t` The value of the variable, with a NULL `value` if the
+/// variable is not set
+FCLIB_API fclib_str_view_t fclib_env_get( //
+    const fclib_env_t *env,               //
+    const fclib_str_t *name               //
+);
+
+/// @function `env_set`
+/// @brief Sets a variable, overriding the one of a parent environment
+///
+/// @param `env` The environment to change
+/// @param `name` The name of the variable, which must not contain `=`
+/// @param `value` The new value of the variable
+FCLIB_API void fclib_env_set( //
+    fclib_env_t *env,         //
+    const fclib_str_t *name,  //
+    const fclib_str_t *value  //
+);
+
+/// @function `env_unset`
+/// @brief Removes a variable, also hiding the one of a parent environment
+///
+/// @param `env` The environment to change
+/// @param `name` The name of the variable
+FCLIB_API void fclib_env_unset(fclib_env_t *env, const fclib_str_t *name);
+
+/// @function `env_envp`
+/// @brief Returns the NULL-terminated `NAME=value` block of the environment,
+/// as `execve` expects it. The block belongs to the environment and stays
+/// valid until the environment or one of its parents changes.
+///
+/// @param `env` The environment to get the block of
+/// @return `char *const *` The environment block
+FCLIB_API char *const *fclib_env_envp(fclib_env_t *env);
+
+/// @function `env_free`
+/// @brief Frees the environment. The variables it shares with its parent stay
+/// untouched.
+///
+/// @param `env` The environment to free
+FCLIB_API void fclib_env_free(fclib_env_t *env);
+
+/// @function `command_options_default`
+/// @brief Returns the options `system_command` uses, which do not limit the
+/// command in any way and give it one second between SIGTERM and SIGKILL
+///
+/// @return `command_options_t` The default command options
+FCLIB_API fclib_command_options_t fclib_command_options_default(void);
+
+/// @function `system_command_ex`
+/// @brief Executes the given system command like `system_command`, but applies
+/// the given limits to it. `timed_out` and `output_truncated` of the result
+/// tell whether the command has been killed because of a limit.
+///
+/// @param `command` The command to execute
+/// @param `options` The limits to apply, NULL for the default options
+/// @return `command_result_t` The result of the system command
+FCLIB_API fclib_command_result_t fclib_system_command_ex( //
+    fclib_str_t *const command,                           //
+    const fclib_command_options_t *options                //
+);
+
+/// @function `system_command_input`
+/// @brief Executes the given system command like `system_command_ex` and
+/// feeds `input` to its stdin. The input is written while the output is read,
+/// so the command never blocks on a full pipe, no matter how large both are.
+/// On Linux, large inputs are mapped into the pipe with `vmsplice` instead of
+/// being copied into it. Commands with input do not use the spawn server.
+///
+/// @param `command` The command to execute
+/// @param `input` The data to feed to the command's stdin
+/// @param `options` The limits to apply, NULL for the default options
+/// @return `command_result_t` The result of the system command
+FCLIB_API fclib_command_result_t fclib_system_command_input( //
+    fclib_str_t *const command,                              //
+    const fclib_str_t *input,                                //
+    const fclib_command_options_t *options                   //
+);
+
+/// @function `system_command_input_view`
+/// @brief Executes the given system command like `system_command_input`, but
+/// feeds the data the view points to to its stdin
+///
+/// @param `command` The command to execute
+/// @param `input` The view of the data to feed to the command's stdin
+/// @param `options` The limits to apply, NULL for the default options
+/// @return `command_result_t` The result of the system command
+FCLIB_API fclib_command_result_t fclib_system_command_input_view( //
+    fclib_str_t *const command,                                   //
+    const fclib_str_view_t input,                                 //
+    const fclib_command_options_t *options                        //
+);
+
+/// @function `system_command_input_file`
+/// @brief Executes the given system command like `system_command_ex` with the
+/// file at `path` as its stdin. The command reads the file directly, so its
+/// content does not pass through this process at all. The result has an exit
+/// code of -1 and no output if the file cannot be opened.
+///
+/// @param `command` The command to execute
+/// @param `path` The path of the file to use as the command's stdin
+/// @param `options` The limits to apply, NULL for the default options
+/// @return `command_result_t` The result of the system command
+FCLIB_API fclib_command_result_t fclib_system_command_input_file( //
+    fclib_str_t *const command,                                   //
+    const fclib_str_t *path,                                      //
+    const fclib_command_options_t *options                        //
+);
+
+/// @function `system_which`
+/// @brief Resolves the program like a shell does: names containing a `/` are
+/// used as they are, all others are looked up in the directories of `PATH`.
+/// Results are cached per name for the current value of `PATH`, so resolving
+/// the same program again costs no file system access. The cache is dropped
+/// whenever `PATH` changes.
+///
+/// @param `name` The name of the program to resolve
+/// @return `str_t *` The path of the executable, NULL if there is none
+FCLIB_API fclib_str_t *fclib_system_which(const fclib_str_t *name);
+
+/// @function `system_which_invalidate`
+/// @brief Removes the program from the cache of `system_which`, so the next
+/// lookup searches `PATH` again. Pipelines do this whenever a resolved program
+/// cannot be executed.
+///
+/// @param `name` The name of the program to forget, NULL to forget all
+FCLIB_API void fclib_system_which_invalidate(const fclib_str_t *name);
+
+/// @function `spawn_server_start`
+/// @brief Forks the spawn server, a small process which spawns all commands
+/// on behalf of this process from then on. Forking a large process is slow,
+/// forking the small server is not, so the server should be started early,
+/// before the process has grown. Every command still runs in the current
+/// working directory and environment of this process, which are sent to the
+/// server along with it. The descriptors of a make jobserver announced in
+/// `MAKEFLAGS` in the `R,W` form, e.g. by `jobserver_export`, are passed along
+/// too and end up under the announced numbers in every command, even if they
+/// were opened after the server was started. Commands fall back to being
+/// spawned directly whenever the server cannot spawn them, e.g. if the
+/// environment is too large for one request. Not thread-safe, start the
+/// server before any other thread runs commands.
+///
+/// @return `bool` Whether the spawn server is running now
+FCLIB_API bool fclib_spawn_server_start(void);
+
+/// @function `spawn_server_stop`
+/// @brief Stops the spawn server and waits for it to exit. Commands which are
+/// still running are not affected. Not thread-safe, no other thread may run
+/// commands while the server is stopped.
+FCLIB_API void fclib_spawn_server_stop(void);
+
+/// @function `system_pipeline`
+/// @brief Runs the stages as a pipeline like `a | b | c`, without going
+/// through a shell. The stages are connected by pipes directly, the stdout of
+/// each stage is the stdin of the next one. The result of each stage is stored
+/// in `results`. The output of the last stage holds its stdout and the stderr
+/// of all stages, the output of an intermediate stage holds its stdout if it
+/// is captured and is NULL otherwise. On Linux the output of captured stages
+/// is duplicated into the next stage with `tee`, so it is not copied back out
+/// of user space. The options apply to the pipeline as a whole, the pipeline
+/// is killed if any of its captured outputs exceeds the output limit. Stages
+/// which cannot be executed exit with 127.
+///
+/// @param `stages` The stages of the pipeline
+/// @param `count` The number of stages
+/// @param `options` The limits to apply, NULL for the default options
+/// @param `results` Where to store the result of each stage, `count` entries
+/// @return `bool` Whether the pipeline could be started
+FCLIB_API bool fclib_system_pipeline(       //
+    const fclib_pipeline_stage_t *stages,   //
+    const size_t count,                     //
+    const fclib_command_options_t *options, //
+    fclib_command_result_t *results         //
+);
+#endif // endof FCLIB_MINIMAL
+
 // #define FCLIB_STRIP_PREFIXES // Uncomment for debugging purposes
 #ifdef FCLIB_STRIP_PREFIXES
 
-typedef fclib_command_result_t command_result_t;
+typedef fclib_command_usage_t command_usage_t;
+typedef fclib_command_result_t command_result_t;
+typedef fclib_command_options_t command_options_t;
+typedef fclib_pipeline_stage_t pipeline_stage_t;
+
+FCLIB_API static inline command_result_t system_command( //
+    fclib_str_t *const command                           //
+) {
+    return fclib_system_command(command);
+}
+
+FCLIB_API static inline fclib_str_t *system_get_cwd(void) {
+    return fclib_system_get_cwd();
+}
+
+FCLIB_API static inline fclib_str_t *system_get_path_linux( //
+    const fclib_str_t *path                                 //
+) {
+    return fclib_system_get_path_linux(path);
+}
+
+FCLIB_API static inline fclib_str_t *system_get_path_windows( //
+    const fclib_str_t *path                                   //
+) {
+    return fclib_system_get_path_windows(path);
+}
+
+FCLIB_API static inline fclib_str_t *system_get_path( //
+    const fclib_str_t *path,                          //
+    const bool is_linux                               //
+) {
+    return fclib_system_get_path(path, is_linux);
+}
+
+FCLIB_API static inline void system_start_capture(void) {
+    fclib_system_start_capture();
+}
+
+FCLIB_API static inline fclib_str_t *system_end_capture(void) {
+    return fclib_system_end_capture();
+}
+
+FCLIB_API static inline fclib_arr_t *system_end_capture_lines(void) {
+    return fclib_system_end_capture_lines();
+}
+
+// FCLIB_MINIMAL STRIPPED START
+#ifndef FCLIB_MINIMAL
+typedef fclib_env_var_t env_var_t;
+typedef fclib_env_t env_t;
+
+FCLIB_API static inline env_t *env_snapshot(void) {
+    return fclib_env_snapshot();
+}
+
+FCLIB_API static inline env_t *env_derive(env_t *parent) {
+    return fclib_env_derive(parent);
+}
+
+FCLIB_API static inline fclib_str_view_t env_get( //
+    const env_t *env,                             //
+    const fclib_str_t *name                       //
+) {
+    return fclib_env_get(env, name);
+}
+
+FCLIB_API static inline void env_set( //
+    env_t *env,                       //
+    const fclib_str_t *name,          //
+    const fclib_str_t *value          //
+) {
+    fclib_env_set(env, name, value);
+}
+
+FCLIB_API static inline void env_unset(env_t *env, const fclib_str_t *name) {
+    fclib_env_unset(env, name);
+}
+
+FCLIB_API static inline char *const *env_envp(env_t *env) {
+    return fclib_env_envp(env);
+}
+
+FCLIB_API static inline void env_free(env_t *env) {
+    fclib_env_free(env);
+}
+
+FCLIB_API static inline command_options_t command_options_default(void) {
+    return fclib_command_options_default();
+}
+
+FCLIB_API static inline command_result_t system_command_ex( //
+    fclib_str_t *const command,                             //
+    const command_options_t *options                        //
+) {
+    return fclib_system_command_ex(command, options);
+}
+
+FCLIB_API static inline command_result_t system_command_input( //
+    fclib_str_t *const command,                                //
+    const fclib_str_t *input,                                  //
+    const command_options_t *options                           //
+) {
+    return fclib_system_command_input(command, input, options);
+}
+
+FCLIB_API static inline command_result_t system_command_input_view( //
+    fclib_str_t *const command,                                     //
+    const fclib_str_view_t input,                                   //
+    const command_options_t *options                                //
+) {
+    return fclib_system_command_input_view(command, input, options);
+}
+
+FCLIB_API static inline command_result_t system_command_input_file( //
+    fclib_str_t *const command,                                     //
+    const fclib_str_t *path,                                        //
+    const command_options_t *options                                //
+) {
+    return fclib_system_command_input_file(command, path, options);
+}
+
+FCLIB_API static inline fclib_str_t *system_which(const fclib_str_t *name) {
+    return fclib_system_which(name);
+}
+
+FCLIB_API static inline void system_which_invalidate(const fclib_str_t *name) {
+    fclib_system_which_invalidate(name);
+}
+
+FCLIB_API static inline bool spawn_server_start(void) {
+    return fclib_spawn_server_start();
+}
+
+FCLIB_API static inline void spawn_server_stop(void) {
+    fclib_spawn_server_stop();
+}
+
+FCLIB_API static inline bool system_pipeline( //
+    const pipeline_stage_t *stages,           //
+    const size_t count,                       //
+    const command_options_t *options,         //
+    command_result_t *results                 //
+) {
+    return fclib_system_pipeline(stages, count, options, results);
+}
+#endif // endof FCLIB_MINIMAL
+
+#endif // endof FCLIB_STRIP_PREFIXES
+
+#ifdef __cplusplus
+}
+#endif
+
+// #define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
+#ifdef FCLIB_IMPLEMENTATION
+
+#ifndef FCLIB_MINIMAL
+// Hashes the name of a program or variable with FNV-1a, names are short
+static uint64_t fclib_system_hash_name(const char *name, const size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)name[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+#endif // endof FCLIB_MINIMAL
+
+#ifndef __WIN32__
+// The runner always tracks the full status of a command. Under FCLIB_MINIMAL
+// the public result lacks those fields, so `system_command` copies the exit
+// code and output out of this one
+#ifdef FCLIB_MINIMAL
+typedef struct fclib_system_result_t {
+    int exit_code;
+    fclib_str_t *output;
+    bool exited;
+    int term_signal;
+    bool core_dumped;
+    bool timed_out;
+    bool output_truncated;
+    fclib_command_usage_t usage;
+} fclib_system_result_t;
+#else
+typedef fclib_command_result_t fclib_system_result_t;
+#endif
+
+// Reads once from `fd` and appends the data to `output`, which has room for
+// `cap` bytes and grows geometrically. Returns the result of `read`
+static ssize_t fclib_system_read_into( //
+    const int fd,                      //
+    fclib_str_t **output,              //
+    size_t *cap                        //
+) {
+    if ((*output)->len + 4096 > *cap) {
+        *cap = *cap * 2 < (*output)->len + 4096 ? (*output)->len + 4096 //
+                                                : *cap * 2;
+        *output = (fclib_str_t *)realloc( //
+            *output, sizeof(fclib_str_t) + *cap + 1);
+    }
+    const ssize_t got = read( //
+        fd, (*output)->value + (*output)->len, *cap - (*output)->len);
+    if (got > 0) {
+        (*output)->len += (size_t)got;
+    }
+    (*output)->value[(*output)->len] = '\0';
+    return got;
+}
+
+// Fills the termination status and resource usage fields of the result from
+// what `wait4` returned
+static void fclib_system_decode_status( //
+    fclib_system_result_t *result,      //
+    const int status,                   //
+    const struct rusage *usage,         //
+    const struct timespec *start        //
+) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    result->exited = WIFEXITED(status);
+    if (WIFEXITED(status)) {
+        result->exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        result->term_signal = WTERMSIG(status);
+        result->exit_code = 128 + result->term_signal;
+#ifdef WCOREDUMP
+        result->core_dumped = WCOREDUMP(status);
+#endif
+    }
+    fclib_command_usage_t *out = &result->usage;
+    out->wall_time = (double)(end.tv_sec - start->tv_sec) +
+        (double)(end.tv_nsec - start->tv_nsec) * 1e-9;
+    out->user_time = (double)usage->ru_utime.tv_sec +
+        (double)usage->ru_utime.tv_usec * 1e-6;
+    out->system_time = (double)usage->ru_stime.tv_sec +
+        (double)usage->ru_stime.tv_usec * 1e-6;
+    // Linux reports the maximum resident set size in kilobytes
+    out->max_rss = (size_t)usage->ru_maxrss * 1024;
+    out->minor_faults = (size_t)usage->ru_minflt;
+    out->major_faults = (size_t)usage->ru_majflt;
+    out->input_blocks = (size_t)usage->ru_inblock;
+    out->output_blocks = (size_t)usage->ru_oublock;
+    out->voluntary_switches = (size_t)usage->ru_nvcsw;
+    out->involuntary_switches = (size_t)usage->ru_nivcsw;
+}
+
+static double fclib_system_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+// A spawned command: its pid, the process group it leads or joined (0 if it
+// stays in ours), the read end of its output pipe and, for commands started by
+// the spawn server, the socket its exit status arrives on
+typedef struct fclib_system_child_t {
+    pid_t pid;
+    pid_t group;
+    int output_fd;
+    int status_fd;
+} fclib_system_child_t;
+
+// The stdin of a spawned command: either a file descriptor it reads from
+// directly, or data which is fed to it through a pipe
+typedef struct fclib_system_input_t {
+    int fd;
+    const char *data;
+    size_t len;
+} fclib_system_input_t;
+
+// Sends the next signal of the SIGTERM -> SIGKILL escalation to the command
+// and returns the time until which to wait for it to take effect
+static double fclib_system_escalate(   //
+    const fclib_system_child_t *child, //
+    int *kill_stage,                   //
+    const double kill_grace            //
+) {
+    const pid_t target = child->group > 0 ? -child->group : child->pid;
+    kill(target, *kill_stage == 0 ? SIGTERM : SIGKILL);
+    (*kill_stage)++;
+    return fclib_system_now() + kill_grace;
+}
+
+// Applies the resource limits of the options to the forked child. Only
+// async-signal-safe functions may be called between fork and exec
+static void fclib_system_apply_limits(const fclib_command_options_t *options) {
+    if (options->cpu_limit > 0) {
+        // The soft limit sends SIGXCPU, the hard limit one second later SIGKILL
+        const struct rlimit limit = {
+            (rlim_t)options->cpu_limit, (rlim_t)options->cpu_limit + 1};
+        setrlimit(RLIMIT_CPU, &limit);
+    }
+    if (options->memory_limit > 0) {
+        const struct rlimit limit = {
+            (rlim_t)options->memory_limit, (rlim_t)options->memory_limit};
+        setrlimit(RLIMIT_AS, &limit);
+    }
+}
+
+// Sets up the forked child and executes the command, never returns
+static void fclib_system_exec_child(        //
+    const char *command,                    //
+    const fclib_command_options_t *options, //
+    const bool own_group,                   //
+    char *const *envp,                      //
+    const int input_fd,                     //
+    const int output_fd                     //
+) {
+    if (own_group) {
+        setpgid(0, 0);
+    }
+    fclib_system_apply_limits(options);
+    if (input_fd >= 0) {
+        dup2(input_fd, STDIN_FILENO);
+    }
+    // Both stdout and stderr go into the pipe, just like `2>&1`
+    dup2(output_fd, STDOUT_FILENO);
+    dup2(output_fd, STDERR_FILENO);
+    if (envp != NULL) {
+        execle("/bin/sh", "sh", "-c", command, (char *)NULL, envp);
+    } else {
+        execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+    }
+    _exit(127);
+}
+
+// Forks and executes the command from the calling process. The command reads
+// from `input_fd`, or shares our stdin if it is -1, and runs with `envp`, or
+// our environment if it is NULL
+static bool fclib_system_spawn_direct(      //
+    const char *command,                    //
+    const fclib_command_options_t *options, //
+    const bool own_group,                   //
+    char *const *envp,                      //
+    const int input_fd,                     //
+    fclib_system_child_t *child             //
+) {
+    // The pipe is close-on-exec, so children spawned concurrently by other
+    // threads do not inherit it and keep it open
+    int pipe_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        return false;
+    }
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        fclib_system_exec_child( //
+            command, options, own_group, envp, input_fd, pipe_fds[1]);
+    }
+    if (own_group) {
+        // Set the group from both sides, so it exists no matter which process
+        // runs first
+        setpgid(pid, pid);
+    }
+    close(pipe_fds[1]);
+    child->pid = pid;
+    child->group = own_group ? pid : 0;
+    child->output_fd = pipe_fds[0];
+    child->status_fd = -1;
+    return true;
+}
+
+#ifndef FCLIB_MINIMAL
+// The spawn server is a small process forked at startup. Every request it
+// receives carries the command, its options, the working directory and
+// environment of the caller and a socket for the replies. For each request
+// the server forks a monitor process, which spawns the command, sends back
+// its pid and the read end of its output pipe and reports the exit status and
+// resource usage once the command has been reaped
+#define FCLIB_SPAWN_MAX_REQUEST 65536
+
+// The reply socket and the two descriptors of a make jobserver
+#define FCLIB_SPAWN_MAX_FDS 3
+
+// The request is followed by the command, the working directory and all
+// `NAME=value` variables of the environment, each terminated by a zero byte.
+// The descriptors of a jobserver announced in `MAKEFLAGS` in the `R,W` form
+// are passed along after the reply socket, `jobserver_fds` holds the numbers
+// they are announced with, or -1
+typedef struct fclib_spawn_request_t {
+    fclib_command_options_t options;
+    bool own_group;
+    size_t command_len;
+    size_t cwd_len;
+    size_t env_count;
+    size_t env_len;
+    int jobserver_fds[2];
+} fclib_spawn_request_t;
+
+typedef struct fclib_spawn_status_t {
+    int status;
+    struct rusage usage;
+} fclib_spawn_status_t;
+
+static pid_t fclib_spawn_server_pid = -1;
+static int fclib_spawn_server_fd = -1;
+
+// Sends a message over a socket, passing the first `fd_count` descriptors of
+// `fds` along with it
+static bool fclib_spawn_send( //
+    const int socket,         //
+    const void *data,         //
+    const size_t len,         //
+    const int *fds,           //
+    const size_t fd_count     //
+) {
+    struct iovec iov = {(void *)(uintptr_t)data, len};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    union {
+        char buffer[CMSG_SPACE(FCLIB_SPAWN_MAX_FDS * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    if (fd_count > 0) {
+        memset(&control, 0, sizeof(control));
+        msg.msg_control = control.buffer;
+        msg.msg_controllen = CMSG_SPACE(fd_count * sizeof(int));
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(fd_count * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), fds, fd_count * sizeof(int));
+    }
+    ssize_t sent;
+    do {
+        sent = sendmsg(socket, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    return sent == (ssize_t)len;
+}
+
+// Receives a message from a socket. The descriptors passed along with it are
+// stored in `fds` (close-on-exec), the remaining ones of the `max_fds` are set
+// to -1. Descriptors beyond `max_fds` are closed
+static ssize_t fclib_spawn_recv( //
+    const int socket,            //
+    void *data,                  //
+    const size_t len,            //
+    int *fds,                    //
+    const size_t max_fds         //
+) {
+    struct iovec iov = {data, len};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    union {
+        char buffer[CMSG_SPACE(FCLIB_SPAWN_MAX_FDS * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+    ssize_t got;
+    do {
+        got = recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+    } while (got < 0 && errno == EINTR);
+    for (size_t i = 0; i < max_fds; i++) {
+        fds[i] = -1;
+    }
+    struct cmsghdr *cmsg = got >= 0 ? CMSG_FIRSTHDR(&msg) : NULL;
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SCM_RIGHTS) {
+        const size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; i++) {
+            int fd;
+            memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            if (i < max_fds) {
+                fds[i] = fd;
+            } else {
+                close(fd);
+            }
+        }
+    }
+    return got;
+}
+
+// Gives the jobserver descriptors received with a request the numbers they
+// are announced with in `MAKEFLAGS`, without close-on-exec. The reply socket
+// and the received descriptors are moved above those numbers first, so none
+// of them is replaced. Returns false if a descriptor could not be moved
+static bool fclib_spawn_install_jobserver( //
+    int *reply_fd,                         //
+    const int *targets,                    //
+    int *received                          //
+) {
+    const int above = (targets[0] > targets[1] ? targets[0] : targets[1]) + 1;
+    int *const fds[3] = {reply_fd, &received[0], &received[1]};
+    for (size_t i = 0; i < 3; i++) {
+        if (*fds[i] >= 0 && *fds[i] < above) {
+            const int moved = fcntl(*fds[i], F_DUPFD_CLOEXEC, above);
+            if (moved < 0) {
+                return false;
+            }
+            close(*fds[i]);
+            *fds[i] = moved;
+        }
+    }
+    // A jobserver announced as `N,N` is passed only once
+    for (size_t i = 0; i < 2; i++) {
+        const int fd = received[i] >= 0 ? received[i] : received[0];
+        if (targets[i] >= 0 && dup2(fd, targets[i]) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The monitor process of a single request, never returns. The command runs
+// in the working directory and environment the caller had when it sent the
+// request, not the ones the server was started with, and inherits the
+// caller's jobserver descriptors
+static void fclib_spawn_server_monitor(   //
+    int reply_fd,                         //
+    const fclib_spawn_request_t *request, //
+    char *payload,                        //
+    int *jobserver_fds                    //
+) {
+    // The server ignores SIGCHLD to not leave zombie monitors behind, but the
+    // monitor has to reap its command
+    signal(SIGCHLD, SIG_DFL);
+    const char *command = payload;
+    const char *cwd = command + request->command_len + 1;
+    char *variable = payload + request->command_len + request->cwd_len + 2;
+    char **envp = (char **)malloc((request->env_count + 1) * sizeof(char *));
+    fclib_system_child_t child = {-1, 0, -1, -1};
+    if (envp != NULL && chdir(cwd) == 0 &&
+        fclib_spawn_install_jobserver( //
+            &reply_fd, request->jobserver_fds, jobserver_fds)) {
+        // The server checked that the block ends with a zero byte
+        for (size_t i = 0; i < request->env_count; i++) {
+            envp[i] = variable;
+            variable += strlen(variable) + 1;
+        }
+        envp[request->env_count] = NULL;
+        fclib_system_spawn_direct( //
+            command, &request->options, request->own_group, envp, -1, &child);
+    }
+    fclib_spawn_send( //
+        reply_fd, &child.pid, sizeof(child.pid), &child.output_fd,
+        child.output_fd >= 0 ? 1 : 0);
+    if (child.pid < 0) {
+        _exit(0);
+    }
+    close(child.output_fd);
+    fclib_spawn_status_t status;
+    memset(&status, 0, sizeof(status));
+    while (wait4(child.pid, &status.status, 0, &status.usage) < 0 &&
+        errno == EINTR) {
+    }
+    fclib_spawn_send(reply_fd, &status, sizeof(status), NULL, 0);
+    _exit(0);
+}
+
+// Checks a request received by the spawn server. `fds` holds the reply socket
+// followed by the jobserver descriptors passed along with it
+static bool fclib_spawn_request_valid(    //
+    const fclib_spawn_request_t *request, //
+    const char *message,                  //
+    const size_t len,                     //
+    const int *fds                        //
+) {
+    const size_t payload_len = len - sizeof(*request);
+    if (fds[0] < 0 ||
+        request->command_len + request->cwd_len + 2 + request->env_len !=
+            payload_len ||
+        message[len - 1] != '\0') {
+        return false;
+    }
+    // Every variable has to end within the message
+    size_t terminators = 0;
+    for (size_t i = len - request->env_len; i < len; i++) {
+        terminators += message[i] == '\0';
+    }
+    if (terminators != request->env_count) {
+        return false;
+    }
+    // The jobserver descriptors have to be passed exactly as announced and
+    // may not replace the standard streams of the command
+    const int *targets = request->jobserver_fds;
+    if (targets[0] < 0 && targets[1] < 0) {
+        return fds[1] < 0;
+    }
+    const bool shared = targets[0] == targets[1];
+    return targets[0] > 2 && targets[1] > 2 && fds[1] >= 0 &&
+        (fds[2] < 0) == shared;
+}
+
+// The main loop of the spawn server, never returns. The server exits once the
+// other end of its socket is closed
+static void fclib_spawn_server_loop(const int socket) {
+    signal(SIGCHLD, SIG_IGN);
+    char *buffer = (char *)malloc(FCLIB_SPAWN_MAX_REQUEST);
+    while (true) {
+        int fds[FCLIB_SPAWN_MAX_FDS];
+        const ssize_t got = fclib_spawn_recv( //
+            socket, buffer, FCLIB_SPAWN_MAX_REQUEST, fds, FCLIB_SPAWN_MAX_FDS);
+        if (got <= 0) {
+            _exit(0);
+        }
+        fclib_spawn_request_t request;
+        if ((size_t)got >= sizeof(request)) {
+            memcpy(&request, buffer, sizeof(request));
+            if (fclib_spawn_request_valid( //
+                    &request, buffer, (size_t)got, fds) &&
+                fork() == 0) {
+                close(socket);
+                fclib_spawn_server_monitor( //
+                    fds[0], &request, buffer + sizeof(request), fds + 1);
+            }
+        }
+        for (size_t i = 0; i < FCLIB_SPAWN_MAX_FDS; i++) {
+            if (fds[i] >= 0) {
+                close(fds[i]);
+            }
+        }
+    }
+}
+
+// Finds the descriptors of a jobserver announced in `MAKEFLAGS` in the `R,W`
+// form which a directly spawned command would inherit. They may have been
+// opened after the server was forked, so they are passed along with every
+// request. Both are set to -1 if there are none
+static void fclib_spawn_find_jobserver(int *fds) {
+    fds[0] = -1;
+    fds[1] = -1;
+    const char *makeflags = getenv("MAKEFLAGS");
+    if (makeflags == NULL) {
+        return;
+    }
+    // Make may announce the jobserver several times, the last one counts
+    const char *auth = NULL;
+    const char *keys[2] = {"--jobserver-auth=", "--jobserver-fds="};
+    for (size_t k = 0; k < 2; k++) {
+        for (const char *found = strstr(makeflags, keys[k]); found != NULL;
+            found = strstr(found + 1, keys[k])) {
+            if (auth == NULL || found > auth) {
+                auth = found + strlen(keys[k]);
+            }
+        }
+    }
+    // A fifo jobserver is opened by path and needs no descriptors
+    if (auth == NULL || *auth < '0' || *auth > '9') {
+        return;
+    }
+    char *end;
+    const long read_fd = strtol(auth, &end, 10);
+    if (*end != ',' || end[1] < '0' || end[1] > '9') {
+        return;
+    }
+    const long write_fd = strtol(end + 1, &end, 10);
+    if (read_fd > INT_MAX || write_fd > INT_MAX) {
+        return;
+    }
+    const int read_flags = fcntl((int)read_fd, F_GETFD);
+    const int write_flags = fcntl((int)write_fd, F_GETFD);
+    if (read_flags < 0 || (read_flags & FD_CLOEXEC) != 0 || write_flags < 0 ||
+        (write_flags & FD_CLOEXEC) != 0) {
+        return;
+    }
+    fds[0] = (int)read_fd;
+    fds[1] = (int)write_fd;
+}
+
+// Spawns the command through the spawn server. Returns false if the server is
+// not running or could not spawn the command
+static bool fclib_system_spawn_via_server(  //
+    const fclib_str_t *command,             //
+    const fclib_command_options_t *options, //
+    const bool own_group,                   //
+    fclib_system_child_t *child             //
+) {
+    fclib_spawn_request_t request;
+    memset(&request, 0, sizeof(request));
+    if (fclib_spawn_server_fd < 0) {
+        return false;
+    }
+    // The server was forked at startup, so the current working directory and
+    // environment are sent along with every command
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, sizeof(cwd)) == NULL) {
+        return false;
+    }
+    request.cwd_len = strlen(cwd);
+    char *message = (char *)malloc(FCLIB_SPAWN_MAX_REQUEST);
+    size_t len = sizeof(request) + command->len + request.cwd_len + 2;
+    if (message == NULL || len > FCLIB_SPAWN_MAX_REQUEST) {
+        free(message);
+        return false;
+    }
+    char *cursor = message + sizeof(request);
+    memcpy(cursor, command->value, command->len + 1);
+    cursor += command->len + 1;
+    memcpy(cursor, cwd, request.cwd_len + 1);
+    cursor += request.cwd_len + 1;
+    for (char **variable = environ; *variable != NULL; variable++) {
+        const size_t variable_len = strlen(*variable) + 1;
+        if (len + variable_len > FCLIB_SPAWN_MAX_REQUEST) {
+            // Too large for one message, the command is spawned directly
+            free(message);
+            return false;
+        }
+        memcpy(cursor, *variable, variable_len);
+        cursor += variable_len;
+        len += variable_len;
+        request.env_count++;
+        request.env_len += variable_len;
+    }
+    int reply_fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, reply_fds) != 0) {
+        free(message);
+        return false;
+    }
+    request.options = *options;
+    request.own_group = own_group;
+    request.command_len = command->len;
+    fclib_spawn_find_jobserver(request.jobserver_fds);
+    memcpy(message, &request, sizeof(request));
+    int fds[FCLIB_SPAWN_MAX_FDS] = {reply_fds[1], request.jobserver_fds[0],
+        request.jobserver_fds[1]};
+    size_t fd_count = 1;
+    if (fds[1] >= 0) {
+        fd_count = fds[1] == fds[2] ? 2 : 3;
+    }
+    const bool sent = fclib_spawn_send( //
+        fclib_spawn_server_fd, message, len, fds, fd_count);
+    free(message);
+    close(reply_fds[1]);
+    pid_t pid = -1;
+    int output_fd = -1;
+    if (!sent ||
+        fclib_spawn_recv(reply_fds[0], &pid, sizeof(pid), &output_fd, 1) !=
+            (ssize_t)sizeof(pid) ||
+        pid < 0 || output_fd < 0) {
+        if (output_fd >= 0) {
+            close(output_fd);
+        }
+        close(reply_fds[0]);
+        return false;
+    }
+    child->pid = pid;
+    child->group = own_group ? pid : 0;
+    child->output_fd = output_fd;
+    child->status_fd = reply_fds[0];
+    return true;
+}
+
+// The cache of `system_which`. All entries belong to the value of PATH stored
+// in `fclib_which_path_env`, the whole cache is dropped once PATH changes. An
+// invalidated entry keeps its name but has no path
+typedef struct fclib_which_entry_t {
+    uint64_t hash;
+    fclib_str_t *name;
+    fclib_str_t *path;
+} fclib_which_entry_t;
+
+static pthread_mutex_t fclib_which_lock = PTHREAD_MUTEX_INITIALIZER;
+static fclib_str_t *fclib_which_path_env = NULL;
+static fclib_which_entry_t *fclib_which_entries = NULL;
+static size_t fclib_which_count = 0;
+static size_t fclib_which_cap = 0;
+
+static bool fclib_which_is_executable(const char *path) {
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISREG(info.st_mode) &&
+        access(path, X_OK) == 0;
+}
+
+// Returns the entry of the name, or the empty slot it belongs into
+static fclib_which_entry_t *fclib_which_find( //
+    const uint64_t hash,                      //
+    const char *name,                         //
+    const size_t len                          //
+) {
+    size_t slot = (size_t)hash & (fclib_which_cap - 1);
+    while (true) {
+        fclib_which_entry_t *entry = &fclib_which_entries[slot];
+        if (entry->name == NULL) {
+            return entry;
+        }
+        if (entry->hash == hash && entry->name->len == len &&
+            memcmp(entry->name->value, name, len) == 0) {
+            return entry;
+        }
+        slot = (slot + 1) & (fclib_which_cap - 1);
+    }
+}
+
+static void fclib_which_clear(void) {
+    for (size_t i = 0; i < fclib_which_cap; i++) {
+        free(fclib_which_entries[i].name);
+        free(fclib_which_entries[i].path);
+    }
+    free(fclib_which_entries);
+    free(fclib_which_path_env);
+    fclib_which_entries = NULL;
+    fclib_which_path_env = NULL;
+    fclib_which_count = 0;
+    fclib_which_cap = 0;
+}
+
+// Stores the resolved path of the name, the cache lock has to be held
+static void fclib_which_insert( //
+    const uint64_t hash,        //
+    const fclib_str_t *name,    //
+    const fclib_str_t *path     //
+) {
+    if ((fclib_which_count + 1) * 2 > fclib_which_cap) {
+        fclib_which_entry_t *old_entries = fclib_which_entries;
+        const size_t old_cap = fclib_which_cap;
+        fclib_which_cap = old_cap == 0 ? 64 : old_cap * 2;
+        fclib_which_entries = (fclib_which_entry_t *)calloc( //
+            fclib_which_cap, sizeof(fclib_which_entry_t));
+        for (size_t i = 0; i < old_cap; i++) {
+            const fclib_which_entry_t *old = &old_entries[i];
+            if (old->name != NULL) {
+                *fclib_which_find(old->hash, old->name->value, old->name->len) =
+                    *old;
+            }
+        }
+        free(old_entries);
+    }
+    fclib_which_entry_t *entry = fclib_which_find(hash, name->value, name->len);
+    if (entry->name == NULL) {
+        entry->hash = hash;
+        entry->name = fclib_str_init(name->value, name->len);
+        fclib_which_count++;
+    }
+    free(entry->path);
+    entry->path = fclib_str_init(path->value, path->len);
+}
+
+// Searches the directories of PATH for the program. An empty directory stands
+// for the current directory
+static fclib_str_t *fclib_which_search( //
+    const fclib_str_t *name,            //
+    const char *path_env                //
+) {
+    fclib_str_builder_t candidate = fclib_str_builder_init(256);
+    const char *dir = path_env;
+    while (true) {
+        const char *end = strchr(dir, ':');
+        const size_t dir_len = end != NULL ? (size_t)(end - dir) : strlen(dir);
+        candidate.str->len = 0;
+        if (dir_len == 0) {
+            fclib_str_builder_append_char(&candidate, '.');
+        } else {
+            fclib_str_builder_append_lit(&candidate, dir, dir_len);
+        }
+        fclib_str_builder_append_char(&candidate, '/');
+        fclib_str_builder_append(&candidate, name);
+        candidate.str->value[candidate.str->len] = '\0';
+        if (fclib_which_is_executable(candidate.str->value)) {
+            return fclib_str_builder_finish(&candidate);
+        }
+        if (end == NULL) {
+            break;
+        }
+        dir = end + 1;
+    }
+    fclib_str_builder_free(&candidate);
+    return NULL;
+}
+#endif // endof FCLIB_MINIMAL
+
+// Blocks SIGPIPE for the calling thread, so writing into the pipe of a command
+// which has already exited fails with EPIPE instead of killing the process
+static void fclib_system_block_sigpipe( //
+    sigset_t *old_mask,                 //
+    bool *was_pending                   //
+) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &mask, old_mask);
+    sigset_t pending;
+    sigpending(&pending);
+    *was_pending = sigismember(&pending, SIGPIPE);
+}
+
+// Discards a SIGPIPE raised while it was blocked and restores the signal mask
+static void fclib_system_restore_sigpipe( //
+    const sigset_t *old_mask,             //
+    const bool was_pending                //
+) {
+    sigset_t pending;
+    sigpending(&pending);
+    if (!was_pending && sigismember(&pending, SIGPIPE)) {
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGPIPE);
+        const struct timespec no_wait = {0, 0};
+        while (sigtimedwait(&mask, NULL, &no_wait) < 0 && errno == EINTR) {
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, old_mask, NULL);
+}
+
+// Feeds the next part of the input into the command's stdin. Returns false
+// once all of it has been written or the command stopped reading
+static bool fclib_system_write_input(  //
+    const int fd,                      //
+    const fclib_system_input_t *input, //
+    size_t *sent                       //
+) {
+    const char *data = input->data + *sent;
+    const size_t left = input->len - *sent;
+    ssize_t written;
+#ifdef __linux__
+    if (left >= 65536) {
+        // Large inputs are mapped into the pipe instead of being copied into
+        // it. The command reads the pages themselves, which is fine as the
+        // input stays untouched until the command has finished
+        const struct iovec iov = {(void *)(uintptr_t)data, left};
+        written = vmsplice(fd, &iov, 1, SPLICE_F_NONBLOCK);
+    } else
+#endif
+    {
+        written = write(fd, data, left);
+    }
+    if (written > 0) {
+        *sent += (size_t)written;
+    } else if (written < 0 && errno != EINTR && errno != EAGAIN) {
+        return false;
+    }
+    return *sent < input->len;
+}
+
+// Waits for the command to terminate. The command may have closed its output
+// and still run, so its limits keep applying while waiting for it. Returns
+// false if the exit status could not be obtained
+static bool fclib_system_wait_child(        //
+    const fclib_system_child_t *child,      //
+    const fclib_command_options_t *options, //
+    double *deadline,                       //
+    int *kill_stage,                        //
+    fclib_system_result_t *result,          //
+    int *status,                            //
+    struct rusage *usage                    //
+) {
+    long sleep_ns = 100000;
+    while (true) {
+#ifndef FCLIB_MINIMAL
+        if (child->status_fd >= 0) {
+            // Commands of the spawn server report their status over a socket
+            int wait_ms = -1;
+            if (*deadline > 0) {
+                const double remaining = *deadline - fclib_system_now();
+                wait_ms = remaining > 0 ? (int)(remaining * 1000) + 1 : 0;
+            }
+            struct pollfd poll_fd = {child->status_fd, POLLIN, 0};
+            const int ready = poll(&poll_fd, 1, wait_ms);
+            if (ready < 0 && errno != EINTR) {
+                return false;
+            }
+            if (ready > 0) {
+                fclib_spawn_status_t message;
+                int unused_fd;
+                if (fclib_spawn_recv(child->status_fd, &message,
+                        sizeof(message), &unused_fd, 1) != sizeof(message)) {
+                    return false;
+                }
+                *status = message.status;
+                *usage = message.usage;
+                return true;
+            }
+        } else
+#endif // endof FCLIB_MINIMAL
+        {
+            const int flags = *deadline > 0 ? WNOHANG : 0;
+            const pid_t waited = wait4(child->pid, status, flags, usage);
+            if (waited == child->pid) {
+                return true;
+            }
+            if (waited < 0 && errno != EINTR) {
+                return false;
+            }
+            if (waited < 0) {
+                continue;
+            }
+            if (fclib_system_now() < *deadline) {
+                const struct timespec pause = {0, sleep_ns};
+                nanosleep(&pause, NULL);
+                sleep_ns = sleep_ns * 2 < 10000000 ? sleep_ns * 2 : 10000000;
+                continue;
+            }
+        }
+        if (*deadline <= 0 || fclib_system_now() < *deadline) {
+            continue;
+        }
+        result->timed_out = result->timed_out || !result->output_truncated;
+        if (*kill_stage < 2) {
+            *deadline = fclib_system_escalate( //
+                child, kill_stage, options->kill_grace);
+        } else {
+            // SIGKILL has already been sent, so blocking is safe now
+            *deadline = 0;
+        }
+    }
+}
+
+// Runs the command through `/bin/sh -c` with the given limits, using the spawn
+// server if it is running. A NULL `options` runs the command without limits,
+// a NULL `input` lets it share the stdin of this process
+static fclib_system_result_t fclib_system_run( //
+    fclib_str_t *const command,                //
+    const fclib_command_options_t *options,    //
+    const fclib_system_input_t *input          //
+) {
+    fclib_system_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.exit_code = -1;
+    const fclib_command_options_t no_limits = {0, 1.0, 0, 0, 0, NULL};
+    if (options == NULL) {
+        options = &no_limits;
+    }
+    const bool own_group = options->timeout > 0 || options->output_limit > 0;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Data is fed through a pipe, files are handed to the command directly
+    int input_fds[2] = {-1, -1};
+    if (input != NULL && input->fd < 0 && pipe2(input_fds, O_CLOEXEC) != 0) {
+        // ErrSystem.SpawnFailed
+        return result;
+    }
+    int stdin_fd = input_fds[0];
+    if (input != NULL && input->fd >= 0) {
+        stdin_fd = input->fd;
+    }
+
+    fclib_system_child_t child = {-1, 0, -1, -1};
+    char *const *envp = NULL;
+    bool spawned = false;
+#ifndef FCLIB_MINIMAL
+    if (options->env != NULL) {
+        envp = fclib_env_envp(options->env);
+    }
+    // The spawn server has no access to the input or environment, so commands
+    // with either are always spawned directly
+    if (input == NULL && envp == NULL) {
+        spawned = fclib_system_spawn_via_server( //
+            command, options, own_group, &child);
+    }
+#endif
+    if (!spawned &&
+        !fclib_system_spawn_direct(command->value, options, own_group, envp,
+            stdin_fd, &child)) {
+        // ErrSystem.SpawnFailed
+        if (input_fds[0] >= 0) {
+            close(input_fds[0]);
+            close(input_fds[1]);
+        }
+        return result;
+    }
+    int input_fd = input_fds[1];
+    size_t input_sent = 0;
+    sigset_t old_mask;
+    bool was_pending = false;
+    if (input_fd >= 0) {
+        close(input_fds[0]);
+        fcntl(input_fd, F_SETFL, O_NONBLOCK);
+        fclib_system_block_sigpipe(&old_mask, &was_pending);
+        if (input->len == 0) {
+            close(input_fd);
+            input_fd = -1;
+        }
+    }
+
+    // Feed the input and read the output at the same time until both pipes
+    // are closed, so the command never blocks on a full pipe. The command is
+    // killed once it exceeds one of its limits
+    const double start_time =
+        (double)start.tv_sec + (double)start.tv_nsec * 1e-9;
+    double deadline = options->timeout > 0 ? start_time + options->timeout : 0;
+    int kill_stage = 0;
+    size_t cap = 0;
+    result.output = fclib_str_create(0);
+    while (child.output_fd >= 0 || input_fd >= 0) {
+        int wait_ms = -1;
+        if (deadline > 0) {
+            const double remaining = deadline - fclib_system_now();
+            if (remaining <= 0) {
+                if (kill_stage == 2) {
+                    // Something which escaped the process group still holds
+                    // the pipe open, stop waiting for it
+                    break;
+                }
+                result.timed_out = result.timed_out || !result.output_truncated;
+                deadline = fclib_system_escalate( //
+                    &child, &kill_stage, options->kill_grace);
+                continue;
+            }
+            wait_ms = (int)(remaining * 1000) + 1;
+        }
+        // Closed pipes are -1, which poll ignores
+        struct pollfd poll_fds[2] = {
+            {child.output_fd, POLLIN, 0}, {input_fd, POLLOUT, 0}};
+        const int ready = poll(poll_fds, 2, wait_ms);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        if (input_fd >= 0 && poll_fds[1].revents != 0 &&
+            !fclib_system_write_input(input_fd, input, &input_sent)) {
+            // Closing the pipe signals the end of the input
+            close(input_fd);
+            input_fd = -1;
+        }
+        if (child.output_fd < 0 || poll_fds[0].revents == 0) {
+            continue;
+        }
+        ssize_t got;
+        if (result.output_truncated) {
+            // Drain and drop everything after the limit
+            char discard[4096];
+            got = read(child.output_fd, discard, sizeof(discard));
+        } else {
+            got = fclib_system_read_into(child.output_fd, &result.output, &cap);
+        }
+        if (got == 0 || (got < 0 && errno != EINTR)) {
+            close(child.output_fd);
+            child.output_fd = -1;
+            continue;
+        }
+        if (options->output_limit > 0 && !result.output_truncated &&
+            result.output->len > options->output_limit) {
+            result.output->len = options->output_limit;
+            result.output->value[result.output->len] = '\0';
+            result.output_truncated = true;
+            if (kill_stage == 0) {
+                deadline = fclib_system_escalate( //
+                    &child, &kill_stage, options->kill_grace);
+            }
+        }
+    }
+    if (child.output_fd >= 0) {
+        close(child.output_fd);
+    }
+    if (input_fds[1] >= 0) {
+        if (input_fd >= 0) {
+            close(input_fd);
+        }
+        fclib_system_restore_sigpipe(&old_mask, was_pending);
+    }
+
+    // Get command exit status and resource usage
+    int status = 0;
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    const bool waited = fclib_system_wait_child( //
+        &child, options, &deadline, &kill_stage, &result, &status, &usage);
+    if (child.status_fd >= 0) {
+        close(child.status_fd);
+    }
+    if (!waited) {
+        // ErrSystem.WaitFailed
+        result.exit_code = -1;
+        return result;
+    }
+    fclib_system_decode_status(&result, status, &usage, &start);
+    return result;
+}
+
+#ifndef FCLIB_MINIMAL
+// A captured output of a pipeline stage. For intermediate stages, `out_fd` is
+// the stdin of the next stage, which is fed everything read from `in_fd`. The
+// bytes in `output` past `forwarded` still have to be written to `out_fd`
+typedef struct fclib_pipeline_stream_t {
+    size_t stage;
+    int in_fd;
+    int out_fd;
+    fclib_str_t *output;
+    size_t cap;
+    size_t forwarded;
+    bool truncated;
+} fclib_pipeline_stream_t;
 
-FCLIB_API static inline command_result_t system_command( //
-    fclib_str_t *const command                           //
-) {
-    return fclib_system_command(command);
+// Moves data of a captured intermediate stage along. Returns false once the
+// stage's output reached its end
+static bool fclib_pipeline_stream_read(fclib_pipeline_stream_t *stream) {
+#ifdef __linux__
+    if (stream->out_fd >= 0 && stream->forwarded == stream->output->len) {
+        // Duplicate the data into the next stage within the kernel, then
+        // consume the original to capture it
+        const ssize_t teed = tee( //
+            stream->in_fd, stream->out_fd, 1 << 20, SPLICE_F_NONBLOCK);
+        if (teed == 0) {
+            return false;
+        }
+        if (teed > 0) {
+            // Read exactly what has been duplicated, more data may have
+            // arrived in the meantime
+            fclib_str_t *output = stream->output;
+            if (output->len + (size_t)teed > stream->cap) {
+                stream->cap = stream->cap * 2 < output->len + (size_t)teed
+                    ? output->len + (size_t)teed
+                    : stream->cap * 2;
+                output = (fclib_str_t *)realloc( //
+                    output, sizeof(fclib_str_t) + stream->cap + 1);
+                stream->output = output;
+            }
+            size_t left = (size_t)teed;
+            while (left > 0) {
+                const ssize_t got = read( //
+                    stream->in_fd, output->value + output->len, left);
+                if (got == 0 || (got < 0 && errno != EINTR)) {
+                    break;
+                }
+                if (got > 0) {
+                    output->len += (size_t)got;
+                    left -= (size_t)got;
+                }
+            }
+            output->value[output->len] = '\0';
+            stream->forwarded = output->len;
+            return true;
+        }
+        if (errno == EPIPE) {
+            // The next stage is gone, stop reading as well, so this stage
+            // ends with SIGPIPE just like in a shell pipeline
+            close(stream->out_fd);
+            stream->out_fd = -1;
+            return false;
+        }
+        // The next stage's pipe is full, so read the data and write it once
+        // there is room again
+    }
+#endif
+    const ssize_t got = fclib_system_read_into( //
+        stream->in_fd, &stream->output, &stream->cap);
+    return got != 0 && (got > 0 || errno == EINTR || errno == EAGAIN);
 }
 
-FCLIB_API static inline fclib_str_t *system_get_cwd(void) {
-    return fclib_system_get_cwd();
+// Writes pending captured data into the next stage
+static void fclib_pipeline_stream_write(fclib_pipeline_stream_t *stream) {
+    const ssize_t written = write(stream->out_fd,
+        stream->output->value + stream->forwarded,
+        stream->output->len - stream->forwarded);
+    if (written > 0) {
+        stream->forwarded += (size_t)written;
+    } else if (written < 0 && errno != EINTR && errno != EAGAIN) {
+        // The next stage is gone, stop reading as well
+        close(stream->out_fd);
+        stream->out_fd = -1;
+        close(stream->in_fd);
+        stream->in_fd = -1;
+    }
 }
 
-FCLIB_API static inline fclib_str_t *system_get_path_linux( //
-    const fclib_str_t *path                                 //
+// Forks the stages, connected by the given pipes. `programs` holds the
+// resolved program of each stage, NULL ones are looked up by execvp unless the
+// stages run with their own environment `envp`. `links`
+// holds the pipe between each stage and the next, `captures` the pipe a
+// captured stage writes into and `final_fd` the write end all stderr and the
+// last stdout go into. Returns the number of stages which have been started
+static size_t fclib_pipeline_fork(          //
+    char **const *argvs,                    //
+    fclib_str_t *const *programs,           //
+    char *const *envp,                      //
+    const size_t count,                     //
+    const fclib_command_options_t *options, //
+    const bool own_group,                   //
+    int (*links)[2],                        //
+    int (*captures)[2],                     //
+    const int final_fd,                     //
+    fclib_system_child_t *children          //
 ) {
-    return fclib_system_get_path_linux(path);
+    pid_t group = 0;
+    for (size_t i = 0; i < count; i++) {
+        const int in_fd = i > 0 ? links[i - 1][0] : -1;
+        int out_fd = final_fd;
+        if (i + 1 < count) {
+            out_fd = captures[i][1] >= 0 ? captures[i][1] : links[i][1];
+        }
+        const pid_t pid = fork();
+        if (pid < 0) {
+            return i;
+        }
+        if (pid == 0) {
+            if (own_group) {
+                setpgid(0, group);
+            }
+            fclib_system_apply_limits(options);
+            if (in_fd >= 0) {
+                dup2(in_fd, STDIN_FILENO);
+            }
+            dup2(out_fd, STDOUT_FILENO);
+            dup2(final_fd, STDERR_FILENO);
+            if (programs[i] != NULL && envp != NULL) {
+                execve(programs[i]->value, argvs[i], envp);
+            } else if (programs[i] != NULL) {
+                execv(programs[i]->value, argvs[i]);
+            } else if (envp == NULL) {
+                execvp(argvs[i][0], argvs[i]);
+            }
+            _exit(127);
+        }
+        if (own_group) {
+            group = group == 0 ? pid : group;
+            setpgid(pid, group);
+        }
+        children[i].pid = pid;
+        children[i].group = group;
+        children[i].output_fd = -1;
+        children[i].status_fd = -1;
+    }
+    return count;
 }
 
-FCLIB_API static inline fclib_str_t *system_get_path_windows( //
-    const fclib_str_t *path                                   //
+// Reads all captured outputs of a running pipeline until they are closed,
+// feeding intermediate ones into their next stages, and applies the limits
+static void fclib_pipeline_pump(            //
+    fclib_pipeline_stream_t *streams,       //
+    const size_t count,                     //
+    const fclib_system_child_t *leader,     //
+    const fclib_command_options_t *options, //
+    double *deadline,                       //
+    int *kill_stage,                        //
+    fclib_command_result_t *flags           //
 ) {
-    return fclib_system_get_path_windows(path);
+    struct pollfd *poll_fds = (struct pollfd *)malloc( //
+        count * sizeof(struct pollfd));
+    size_t *polled = (size_t *)malloc(count * sizeof(size_t));
+    while (true) {
+        size_t poll_count = 0;
+        for (size_t i = 0; i < count; i++) {
+            fclib_pipeline_stream_t *stream = &streams[i];
+            const bool pending = stream->out_fd >= 0 &&
+                stream->forwarded < stream->output->len;
+            if (pending) {
+                poll_fds[poll_count].fd = stream->out_fd;
+                poll_fds[poll_count].events = POLLOUT;
+            } else if (stream->in_fd >= 0) {
+                poll_fds[poll_count].fd = stream->in_fd;
+                poll_fds[poll_count].events = POLLIN;
+            } else {
+                if (stream->out_fd >= 0) {
+                    // Everything has been forwarded, signal the end of input
+                    close(stream->out_fd);
+                    stream->out_fd = -1;
+                }
+                continue;
+            }
+            poll_fds[poll_count].revents = 0;
+            polled[poll_count++] = i;
+        }
+        if (poll_count == 0) {
+            break;
+        }
+        int wait_ms = -1;
+        if (*deadline > 0) {
+            const double remaining = *deadline - fclib_system_now();
+            if (remaining <= 0) {
+                if (*kill_stage == 2) {
+                    // Something which escaped the process group still holds
+                    // a pipe open, stop waiting for it
+                    break;
+                }
+                flags->timed_out = flags->timed_out || !flags->output_truncated;
+                *deadline = fclib_system_escalate( //
+                    leader, kill_stage, options->kill_grace);
+                continue;
+            }
+            wait_ms = (int)(remaining * 1000) + 1;
+        }
+        const int ready = poll(poll_fds, (nfds_t)poll_count, wait_ms);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        for (size_t j = 0; ready > 0 && j < poll_count; j++) {
+            if (poll_fds[j].revents == 0) {
+                continue;
+            }
+            fclib_pipeline_stream_t *stream = &streams[polled[j]];
+            if (poll_fds[j].fd == stream->out_fd) {
+                fclib_pipeline_stream_write(stream);
+            } else if (!fclib_pipeline_stream_read(stream)) {
+                close(stream->in_fd);
+                stream->in_fd = -1;
+            }
+            if (options->output_limit > 0 &&
+                stream->output->len > options->output_limit) {
+                // Drop everything past the limit and kill the pipeline
+                stream->output->len = options->output_limit;
+                stream->output->value[stream->output->len] = '\0';
+                stream->forwarded = stream->output->len;
+                stream->truncated = true;
+                if (stream->out_fd >= 0) {
+                    close(stream->out_fd);
+                    stream->out_fd = -1;
+                }
+                flags->output_truncated = true;
+                if (*kill_stage == 0) {
+                    *deadline = fclib_system_escalate( //
+                        leader, kill_stage, options->kill_grace);
+                }
+            }
+        }
+    }
+    free(poll_fds);
+    free(polled);
 }
 
-FCLIB_API fclib_str_t *system_get_path( //
-    const fclib_str_t *path,            //
-    const bool is_linux                 //
+// Resolves the program of a stage. Stages running with their own environment
+// look the program up in its PATH, which bypasses the cache if it differs
+// from ours
+static fclib_str_t *fclib_pipeline_resolve( //
+    const fclib_str_t *name,                //
+    const fclib_env_t *env                  //
 ) {
-    return fclib_system_get_path(path, is_linux);
+    if (env == NULL || memchr(name->value, '/', name->len) != NULL) {
+        return fclib_system_which(name);
+    }
+    fclib_str_t *path_key = fclib_str_init("PATH", 4);
+    const fclib_str_view_t path = fclib_env_get(env, path_key);
+    free(path_key);
+    const char *own_path = getenv("PATH");
+    const char *env_path = path.value != NULL ? path.value : "/bin:/usr/bin";
+    if (own_path != NULL && strcmp(own_path, env_path) == 0) {
+        return fclib_system_which(name);
+    }
+    return name->len > 0 ? fclib_which_search(name, env_path) : NULL;
 }
 
-FCLIB_API void system_start_capture(void) {
-    fclib_system_start_capture();
-}
+// Runs the stages as a pipeline, see `system_pipeline`
+static bool fclib_pipeline_run(             //
+    const fclib_pipeline_stage_t *stages,   //
+    const size_t count,                     //
+    const fclib_command_options_t *options, //
+    fclib_command_result_t *results         //
+) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    const bool own_group = options->timeout > 0 || options->output_limit > 0;
 
-FCLIB_API fclib_str_t *system_end_capture(void) {
-    return fclib_system_end_capture();
-}
+    // The argument vectors are built and the programs resolved before forking,
+    // as the children may not allocate
+    char ***argvs = (char ***)calloc(count, sizeof(char **));
+    fclib_str_t **programs = (fclib_str_t **)calloc( //
+        count, sizeof(fclib_str_t *));
+    int (*links)[2] = (int (*)[2])malloc(count * sizeof(int[2]));
+    int (*captures)[2] = (int (*)[2])malloc(count * sizeof(int[2]));
+    fclib_system_child_t *children = (fclib_system_child_t *)calloc( //
+        count, sizeof(fclib_system_child_t));
+    fclib_pipeline_stream_t *streams = (fclib_pipeline_stream_t *)calloc( //
+        count, sizeof(fclib_pipeline_stream_t));
+    bool ok = true;
+    for (size_t i = 0; i < count; i++) {
+        links[i][0] = links[i][1] = -1;
+        captures[i][0] = captures[i][1] = -1;
+        fclib_arr_t *argv = stages[i].argv;
+        const size_t argc = argv != NULL && argv->len == 1 //
+            ? fclib_arr_get_len(argv)
+            : 0;
+        if (argc == 0) {
+            ok = false;
+            continue;
+        }
+        fclib_str_t *const *args = (fclib_str_t *const *)(const void *)( //
+            argv->value + argv->len * sizeof(size_t));
+        argvs[i] = (char **)malloc((argc + 1) * sizeof(char *));
+        for (size_t j = 0; j < argc; j++) {
+            argvs[i][j] = args[j]->value;
+        }
+        argvs[i][argc] = NULL;
+        programs[i] = fclib_pipeline_resolve(args[0], options->env);
+    }
+    int final_fds[2] = {-1, -1};
+    ok = ok && pipe2(final_fds, O_CLOEXEC) == 0;
+    for (size_t i = 0; ok && i + 1 < count; i++) {
+        ok = pipe2(links[i], O_CLOEXEC) == 0;
+        if (ok && stages[i].capture) {
+            ok = pipe2(captures[i], O_CLOEXEC) == 0;
+        }
+    }
 
-FCLIB_API fclib_arr_t *system_end_capture_lines(void) {
-    return fclib_system_end_capture_lines();
-}
+    size_t started = 0;
+    if (ok) {
+        char *const *envp = options->env != NULL //
+            ? fclib_env_envp(options->env)
+            : NULL;
+        started = fclib_pipeline_fork(argvs, programs, envp, count, options,
+            own_group, links, captures, final_fds[1], children);
+        ok = started == count;
+    }
+    // Keep only the ends the pipeline is driven through open
+    size_t stream_count = 0;
+    for (size_t i = 0; i + 1 < count; i++) {
+        fclib_pipeline_stream_t stream = {
+            i, captures[i][0], -1, NULL, 0, 0, false};
+        if (links[i][0] >= 0) {
+            close(links[i][0]);
+        }
+        if (captures[i][1] >= 0) {
+            close(captures[i][1]);
+            stream.out_fd = links[i][1];
+            fcntl(stream.in_fd, F_SETFL, O_NONBLOCK);
+            fcntl(stream.out_fd, F_SETFL, O_NONBLOCK);
+        } else if (links[i][1] >= 0) {
+            close(links[i][1]);
+        }
+        if (stream.in_fd >= 0) {
+            stream.output = fclib_str_create(0);
+            streams[stream_count++] = stream;
+        }
+    }
+    if (final_fds[1] >= 0) {
+        close(final_fds[1]);
+        fcntl(final_fds[0], F_SETFL, O_NONBLOCK);
+        const fclib_pipeline_stream_t stream = {
+            count - 1, final_fds[0], -1, fclib_str_create(0), 0, 0, false};
+        streams[stream_count++] = stream;
+    }
+    for (size_t i = 0; i < count; i++) {
+        free(argvs[i]);
+    }
+    free(argvs);
+    free(links);
+    free(captures);
 
-#endif // endof FCLIB_STRIP_PREFIXES
+    for (size_t i = 0; i < count; i++) {
+        memset(&results[i], 0, sizeof(results[i]));
+        results[i].exit_code = -1;
+    }
+    if (!ok) {
+        // ErrSystem.SpawnFailed
+        for (size_t i = 0; i < started; i++) {
+            kill(children[i].pid, SIGKILL);
+        }
+        for (size_t i = 0; i < stream_count; i++) {
+            close(streams[i].in_fd);
+            if (streams[i].out_fd >= 0) {
+                close(streams[i].out_fd);
+            }
+            free(streams[i].output);
+        }
+        for (size_t i = 0; i < started; i++) {
+            while (waitpid(children[i].pid, NULL, 0) < 0 && errno == EINTR) {
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            free(programs[i]);
+        }
+        free(programs);
+        free(children);
+        free(streams);
+        return false;
+    }
 
-#ifdef __cplusplus
+    fclib_command_result_t flags;
+    memset(&flags, 0, sizeof(flags));
+    double deadline = options->timeout > 0
+        ? (double)start.tv_sec + (double)start.tv_nsec * 1e-9 + options->timeout
+        : 0;
+    int kill_stage = 0;
+    sigset_t old_mask;
+    bool was_pending;
+    fclib_system_block_sigpipe(&old_mask, &was_pending);
+    fclib_pipeline_pump(streams, stream_count, &children[0], options,
+        &deadline, &kill_stage, &flags);
+    fclib_system_restore_sigpipe(&old_mask, was_pending);
+
+    // Hand the captured outputs over to the results of their stages
+    for (size_t i = 0; i < stream_count; i++) {
+        fclib_pipeline_stream_t *stream = &streams[i];
+        if (stream->in_fd >= 0) {
+            close(stream->in_fd);
+        }
+        if (stream->out_fd >= 0) {
+            close(stream->out_fd);
+        }
+        results[stream->stage].output = stream->output;
+        results[stream->stage].output_truncated = stream->truncated;
+    }
+
+    // Wait for all stages, the limits keep applying while waiting
+    for (size_t i = 0; i < count; i++) {
+        int status = 0;
+        struct rusage usage;
+        memset(&usage, 0, sizeof(usage));
+        if (fclib_system_wait_child(&children[i], options, &deadline,
+                &kill_stage, &flags, &status, &usage)) {
+            fclib_system_decode_status(&results[i], status, &usage, &start);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        results[i].timed_out = flags.timed_out;
+        if (programs[i] != NULL && results[i].exit_code == 127) {
+            // The cached program may be gone, so look it up again next time
+            fclib_str_t *const *args = (fclib_str_t *const *)(const void *)( //
+                stages[i].argv->value + stages[i].argv->len * sizeof(size_t));
+            fclib_system_which_invalidate(args[0]);
+        }
+        free(programs[i]);
+    }
+    free(programs);
+    free(children);
+    free(streams);
+    return true;
 }
+#endif // endof FCLIB_MINIMAL
 #endif
 
-#define FCLIB_IMPLEMENTATION // Uncomment for debugging purposes
-#ifdef FCLIB_IMPLEMENTATION
-
 FCLIB_API fclib_command_result_t fclib_system_command( //
     fclib_str_t *const command                         //
 ) {
-    fclib_command_result_t result = {-1, NULL};
-    const size_t BUFFER_SIZE = 4096;
-    char buffer[BUFFER_SIZE];
-
-    // Allocate initial output buffer to be an empty string
-    result.output = fclib_str_create(0);
+    fclib_command_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.exit_code = -1;
 
     if (command->len == 0) {
         // ErrSystem.EmptyCommand
-        free(result.output);
-        result.output = NULL;
         return result;
     }
 
+#ifdef __WIN32__
+    const size_t BUFFER_SIZE = 4096;
+    char buffer[BUFFER_SIZE];
+
+    // Allocate initial output buffer to be an empty string
+    result.output = fclib_str_create(0);
+
     // Replace all '/' characters with '\\' ones on Windows
     fclib_str_t *command_to_use = command;
-#ifdef __WIN32__
     fclib_str_t *command_cpy = fclib_str_init(command->value, command->len);
     size_t idx = 0;
     do {
@@ -210,16 +2084,11 @@ FCLIB_API fclib_command_result_t fclib_system_command( //
             break;
         }
     } while (command_cpy->value[idx] != ' ');
-#endif
 
     // Create command with stderr redirection
     fclib_str_t *full_command = ADD_STR_LIT(command_to_use, " 2>&1");
     char *c_command = (char *)full_command->value;
-#ifdef __WIN32__
     FILE *pipe = _popen(c_command, "r");
-#else
-    FILE *pipe = popen(c_command, "r");
-#endif
     free(full_command);
     if (!pipe) {
         // ErrSystem.SpawnFailed
@@ -236,14 +2105,21 @@ FCLIB_API fclib_command_result_t fclib_system_command( //
     }
 
     // Get command exit status
-#ifdef __WIN32__
     int status = _pclose(pipe);
-#else
-    int status = pclose(pipe);
+    result.exit_code = status;
+#ifndef FCLIB_MINIMAL
+    result.exited = true;
 #endif
-    result.exit_code = status & 0xFF;
 
     return result;
+#elif defined(FCLIB_MINIMAL)
+    const fclib_system_result_t full = fclib_system_run(command, NULL, NULL);
+    result.exit_code = full.exit_code;
+    result.output = full.output;
+    return result;
+#else
+    return fclib_system_run(command, NULL, NULL);
+#endif
 }
 
 FCLIB_API fclib_str_t *fclib_system_get_cwd(void) {
@@ -477,4 +2353,490 @@ FCLIB_API fclib_arr_t *fclib_system_end_capture_lines(void) {
     return output_array;
 }
 
+// FCLIB_MINIMAL START IMPLEMENTATION
+#ifndef FCLIB_MINIMAL
+#ifndef __WIN32__
+// Guards building the envp blocks, as commands running on several threads may
+// share an environment
+static pthread_mutex_t fclib_env_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// Returns the variable of the name from the environment's own table, or the
+// empty slot it belongs into. The table must not be empty
+static fclib_env_var_t *fclib_env_find( //
+    const fclib_env_t *env,             //
+    const uint64_t hash,                //
+    const char *name,                   //
+    const size_t len                    //
+) {
+    size_t slot = (size_t)hash & (env->cap - 1);
+    while (true) {
+        fclib_env_var_t *var = &env->vars[slot];
+        if (var->entry == NULL) {
+            return var;
+        }
+        if (var->hash == hash && var->name_len == len &&
+            memcmp(var->entry->value, name, len) == 0) {
+            return var;
+        }
+        slot = (slot + 1) & (env->cap - 1);
+    }
+}
+
+// Looks the variable up in the environment and all of its parents
+static const fclib_env_var_t *fclib_env_lookup( //
+    const fclib_env_t *env,                     //
+    const uint64_t hash,                        //
+    const char *name,                           //
+    const size_t len                            //
+) {
+    for (; env != NULL; env = env->parent) {
+        if (env->cap == 0) {
+            continue;
+        }
+        const fclib_env_var_t *var = fclib_env_find(env, hash, name, len);
+        if (var->entry != NULL) {
+            return var;
+        }
+    }
+    return NULL;
+}
+
+// Stores the `NAME=value` (or just `NAME` if removed) entry in the
+// environment's own table, replacing the previous entry of the name
+static void fclib_env_put(    //
+    fclib_env_t *env,         //
+    const size_t name_len,    //
+    fclib_str_t *entry,       //
+    const bool removed        //
+) {
+    if ((env->count + 1) * 2 > env->cap) {
+        fclib_env_var_t *old_vars = env->vars;
+        const size_t old_cap = env->cap;
+        env->cap = old_cap == 0 ? 64 : old_cap * 2;
+        env->vars = (fclib_env_var_t *)calloc( //
+            env->cap, sizeof(fclib_env_var_t));
+        for (size_t i = 0; i < old_cap; i++) {
+            const fclib_env_var_t *old = &old_vars[i];
+            if (old->entry != NULL) {
+                *fclib_env_find(env, old->hash, old->entry->value,
+                    old->name_len) = *old;
+            }
+        }
+        free(old_vars);
+    }
+    const uint64_t hash = fclib_system_hash_name(entry->value, name_len);
+    fclib_env_var_t *var = fclib_env_find(env, hash, entry->value, name_len);
+    if (var->entry == NULL) {
+        env->count++;
+    }
+    free(var->entry);
+    var->hash = hash;
+    var->name_len = name_len;
+    var->entry = entry;
+    var->removed = removed;
+}
+
+// Returns a number which changes whenever the environment or one of its
+// parents changes
+static uint64_t fclib_env_stamp(const fclib_env_t *env) {
+    uint64_t stamp = 0;
+    for (; env != NULL; env = env->parent) {
+        stamp += env->version;
+    }
+    return stamp;
+}
+
+// Builds the envp block from the block of the parent and the own variables,
+// the lock has to be held
+static char *const *fclib_env_build(fclib_env_t *env) {
+    const uint64_t stamp = fclib_env_stamp(env);
+    if (env->envp != NULL && env->envp_stamp == stamp) {
+        return env->envp;
+    }
+    free(env->envp);
+    size_t parent_count = 0;
+    char *const *parent_envp = NULL;
+    if (env->parent != NULL) {
+        parent_envp = fclib_env_build(env->parent);
+        while (parent_envp[parent_count] != NULL) {
+            parent_count++;
+        }
+    }
+    env->envp = (char **)malloc( //
+        (parent_count + env->count + 1) * sizeof(char *));
+    size_t len = 0;
+    for (size_t i = 0; i < parent_count; i++) {
+        // Overridden and removed variables come from the own table
+        const char *entry = parent_envp[i];
+        const char *equals = strchr(entry, '=');
+        const size_t name_len = (size_t)(equals - entry);
+        const uint64_t hash = fclib_system_hash_name(entry, name_len);
+        if (env->cap == 0 ||
+            fclib_env_find(env, hash, entry, name_len)->entry == NULL) {
+            env->envp[len++] = parent_envp[i];
+        }
+    }
+    for (size_t i = 0; i < env->cap; i++) {
+        const fclib_env_var_t *var = &env->vars[i];
+        if (var->entry != NULL && !var->removed) {
+            env->envp[len++] = var->entry->value;
+        }
+    }
+    env->envp[len] = NULL;
+    env->envp_stamp = stamp;
+    return env->envp;
+}
+
+FCLIB_API fclib_env_t *fclib_env_snapshot(void) {
+    fclib_env_t *env = (fclib_env_t *)calloc(1, sizeof(fclib_env_t));
+#ifdef __WIN32__
+    char **process_env = _environ;
+#else
+    char **process_env = environ;
+#endif
+    for (size_t i = 0; process_env != NULL && process_env[i] != NULL; i++) {
+        const char *entry = process_env[i];
+        const char *equals = strchr(entry, '=');
+        if (equals == NULL || equals == entry) {
+            continue;
+        }
+        const size_t name_len = (size_t)(equals - entry);
+        const uint64_t hash = fclib_system_hash_name(entry, name_len);
+        // Like getenv, the first of duplicated variables wins
+        if (env->cap > 0 &&
+            fclib_env_find(env, hash, entry, name_len)->entry != NULL) {
+            continue;
+        }
+        fclib_str_t *copy = fclib_str_init(entry, strlen(entry));
+        fclib_env_put(env, name_len, copy, false);
+    }
+    return env;
+}
+
+FCLIB_API fclib_env_t *fclib_env_derive(fclib_env_t *parent) {
+    fclib_env_t *env = (fclib_env_t *)calloc(1, sizeof(fclib_env_t));
+    env->parent = parent;
+    return env;
+}
+
+FCLIB_API fclib_str_view_t fclib_env_get( //
+    const fclib_env_t *env,               //
+    const fclib_str_t *name               //
+) {
+    const uint64_t hash = fclib_system_hash_name(name->value, name->len);
+    const fclib_env_var_t *var = fclib_env_lookup( //
+        env, hash, name->value, name->len);
+    if (var == NULL || var->removed) {
+        const fclib_str_view_t unset = {0, NULL};
+        return unset;
+    }
+    const fclib_str_view_t value = {
+        var->entry->len - var->name_len - 1,
+        var->entry->value + var->name_len + 1,
+    };
+    return value;
+}
+
+FCLIB_API void fclib_env_set( //
+    fclib_env_t *env,         //
+    const fclib_str_t *name,  //
+    const fclib_str_t *value  //
+) {
+    fclib_str_builder_t entry = fclib_str_builder_init( //
+        name->len + value->len + 1);
+    fclib_str_builder_append(&entry, name);
+    fclib_str_builder_append_char(&entry, '=');
+    fclib_str_builder_append(&entry, value);
+    fclib_env_put(env, name->len, fclib_str_builder_finish(&entry), false);
+    env->version++;
+}
+
+FCLIB_API void fclib_env_unset(fclib_env_t *env, const fclib_str_t *name) {
+    if (env->parent == NULL) {
+        // Without a parent, a variable which is not set needs nothing hiding it
+        if (env->cap == 0) {
+            return;
+        }
+        const uint64_t hash = fclib_system_hash_name(name->value, name->len);
+        if (fclib_env_find(env, hash, name->value, name->len)->entry == NULL) {
+            return;
+        }
+    }
+    fclib_env_put( //
+        env, name->len, fclib_str_init(name->value, name->len), true);
+    env->version++;
+}
+
+FCLIB_API char *const *fclib_env_envp(fclib_env_t *env) {
+#ifndef __WIN32__
+    pthread_mutex_lock(&fclib_env_lock);
+#endif
+    char *const *envp = fclib_env_build(env);
+#ifndef __WIN32__
+    pthread_mutex_unlock(&fclib_env_lock);
+#endif
+    return envp;
+}
+
+FCLIB_API void fclib_env_free(fclib_env_t *env) {
+    for (size_t i = 0; i < env->cap; i++) {
+        free(env->vars[i].entry);
+    }
+    free(env->vars);
+    free(env->envp);
+    free(env);
+}
+
+FCLIB_API fclib_command_options_t fclib_command_options_default(void) {
+    const fclib_command_options_t options = {0, 1.0, 0, 0, 0, NULL};
+    return options;
+}
+
+FCLIB_API fclib_command_result_t fclib_system_command_ex( //
+    fclib_str_t *const command,                           //
+    const fclib_command_options_t *options                //
+) {
+#ifdef __WIN32__
+    // Limits are not supported on Windows yet
+    (void)options;
+    return fclib_system_command(command);
+#else
+    if (command->len == 0) {
+        // ErrSystem.EmptyCommand
+        fclib_command_result_t result;
+        memset(&result, 0, sizeof(result));
+        result.exit_code = -1;
+        return result;
+    }
+    return fclib_system_run(command, options, NULL);
+#endif
+}
+
+FCLIB_API bool fclib_system_pipeline(       //
+    const fclib_pipeline_stage_t *stages,   //
+    const size_t count,                     //
+    const fclib_command_options_t *options, //
+    fclib_command_result_t *results         //
+) {
+    if (count == 0) {
+        return false;
+    }
+#ifdef __WIN32__
+    // Pipelines are not supported on Windows yet
+    (void)stages;
+    (void)options;
+    for (size_t i = 0; i < count; i++) {
+        memset(&results[i], 0, sizeof(results[i]));
+        results[i].exit_code = -1;
+    }
+    return false;
+#else
+    const fclib_command_options_t defaults = fclib_command_options_default();
+    return fclib_pipeline_run( //
+        stages, count, options != NULL ? options : &defaults, results);
+#endif
+}
+
+// Runs the command with the data as its stdin, shared by the str and view
+// variants of `system_command_input`
+static fclib_command_result_t fclib_system_command_fed( //
+    fclib_str_t *const command,                         //
+    const char *data,                                   //
+    const size_t len,                                   //
+    const fclib_command_options_t *options              //
+) {
+    fclib_command_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.exit_code = -1;
+#ifdef __WIN32__
+    // Input is not supported on Windows yet
+    (void)command;
+    (void)data;
+    (void)len;
+    (void)options;
+    return result;
+#else
+    if (command->len == 0) {
+        // ErrSystem.EmptyCommand
+        return result;
+    }
+    const fclib_system_input_t input = {-1, data, len};
+    return fclib_system_run(command, options, &input);
+#endif
+}
+
+FCLIB_API fclib_command_result_t fclib_system_command_input( //
+    fclib_str_t *const command,                              //
+    const fclib_str_t *input,                                //
+    const fclib_command_options_t *options                   //
+) {
+    return fclib_system_command_fed( //
+        command, input->value, input->len, options);
+}
+
+FCLIB_API fclib_command_result_t fclib_system_command_input_view( //
+    fclib_str_t *const command,                                   //
+    const fclib_str_view_t input,                                 //
+    const fclib_command_options_t *options                        //
+) {
+    return fclib_system_command_fed( //
+        command, input.value, input.len, options);
+}
+
+FCLIB_API fclib_command_result_t fclib_system_command_input_file( //
+    fclib_str_t *const command,                                   //
+    const fclib_str_t *path,                                      //
+    const fclib_command_options_t *options                        //
+) {
+    fclib_command_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.exit_code = -1;
+#ifdef __WIN32__
+    // Input is not supported on Windows yet
+    (void)command;
+    (void)path;
+    (void)options;
+    return result;
+#else
+    if (command->len == 0) {
+        // ErrSystem.EmptyCommand
+        return result;
+    }
+    const int fd = open(path->value, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        // ErrSystem.InputFailed
+        return result;
+    }
+    const fclib_system_input_t stdin_input = {fd, NULL, 0};
+    result = fclib_system_run(command, options, &stdin_input);
+    close(fd);
+    return result;
+#endif
+}
+
+FCLIB_API fclib_str_t *fclib_system_which(const fclib_str_t *name) {
+#ifdef __WIN32__
+    // PATHEXT lookups are not supported on Windows yet
+    (void)name;
+    return NULL;
+#else
+    if (name->len == 0) {
+        return NULL;
+    }
+    if (memchr(name->value, '/', name->len) != NULL) {
+        // Paths are not looked up, just like in a shell
+        return fclib_which_is_executable(name->value)
+            ? fclib_str_init(name->value, name->len)
+            : NULL;
+    }
+    const char *path_env = getenv("PATH");
+    if (path_env == NULL) {
+        // The default execvp searches without PATH
+        path_env = "/bin:/usr/bin";
+    }
+    const size_t path_len = strlen(path_env);
+    const uint64_t hash = fclib_system_hash_name(name->value, name->len);
+    pthread_mutex_lock(&fclib_which_lock);
+    if (fclib_which_path_env != NULL &&
+        (fclib_which_path_env->len != path_len ||
+            memcmp(fclib_which_path_env->value, path_env, path_len) != 0)) {
+        fclib_which_clear();
+    }
+    if (fclib_which_path_env == NULL) {
+        fclib_which_path_env = fclib_str_init(path_env, path_len);
+    }
+    if (fclib_which_cap > 0) {
+        const fclib_which_entry_t *entry = fclib_which_find( //
+            hash, name->value, name->len);
+        if (entry->path != NULL) {
+            fclib_str_t *path = fclib_str_init( //
+                entry->path->value, entry->path->len);
+            pthread_mutex_unlock(&fclib_which_lock);
+            return path;
+        }
+    }
+    // Search without holding the lock, as the file system may be slow
+    fclib_str_t *env = fclib_str_init(path_env, path_len);
+    pthread_mutex_unlock(&fclib_which_lock);
+    fclib_str_t *path = fclib_which_search(name, env->value);
+    if (path != NULL) {
+        pthread_mutex_lock(&fclib_which_lock);
+        // Only remember the result if PATH did not change in the meantime
+        if (fclib_which_path_env != NULL &&
+            fclib_which_path_env->len == env->len &&
+            memcmp(fclib_which_path_env->value, env->value, env->len) == 0) {
+            fclib_which_insert(hash, name, path);
+        }
+        pthread_mutex_unlock(&fclib_which_lock);
+    }
+    free(env);
+    return path;
+#endif
+}
+
+FCLIB_API void fclib_system_which_invalidate(const fclib_str_t *name) {
+#ifdef __WIN32__
+    (void)name;
+#else
+    pthread_mutex_lock(&fclib_which_lock);
+    if (name == NULL) {
+        fclib_which_clear();
+    } else if (fclib_which_cap > 0) {
+        const uint64_t hash = fclib_system_hash_name(name->value, name->len);
+        fclib_which_entry_t *entry = fclib_which_find( //
+            hash, name->value, name->len);
+        free(entry->path);
+        entry->path = NULL;
+    }
+    pthread_mutex_unlock(&fclib_which_lock);
+#endif
+}
+
+FCLIB_API bool fclib_spawn_server_start(void) {
+#ifdef __WIN32__
+    // Windows does not fork, so there is nothing to gain from a server
+    return false;
+#else
+    if (fclib_spawn_server_fd >= 0) {
+        return true;
+    }
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0) {
+        // ErrSystem.SocketFailed
+        return false;
+    }
+    const pid_t pid = fork();
+    if (pid < 0) {
+        // ErrSystem.ForkFailed
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        fclib_spawn_server_loop(fds[1]);
+    }
+    close(fds[1]);
+    fclib_spawn_server_pid = pid;
+    fclib_spawn_server_fd = fds[0];
+    return true;
+#endif
+}
+
+FCLIB_API void fclib_spawn_server_stop(void) {
+#ifndef __WIN32__
+    if (fclib_spawn_server_fd < 0) {
+        return;
+    }
+    // The server exits as soon as it sees its socket being closed
+    close(fclib_spawn_server_fd);
+    fclib_spawn_server_fd = -1;
+    while (waitpid(fclib_spawn_server_pid, NULL, 0) < 0 && errno == EINTR) {
+    }
+    fclib_spawn_server_pid = -1;
+#endif
+}
+#endif // endof FCLIB_MINIMAL
+
 #endif // endof FCLIB_IMPLEMENTATION